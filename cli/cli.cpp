@@ -215,7 +215,13 @@ int main(int argc, char** argv) {
 	//because of difference in number of arguments
 	
 	int algorithm_type = NO_ALG_TYPE;
-	int newArgc = argc - 1;
+	
+	//owcty and distr_map check all the properties on one state space, they get all the files at once
+	int filesPerCall = 1;
+	if(string(argv[1]).compare("owcty") == 0 || string(argv[1]).compare("distr_map") == 0)
+		filesPerCall = inputFiles.size();
+	
+	int newArgc = argc - 2 + filesPerCall;
 	if(dbg) cout << "size of newArgv with terminating char: " << newArgc << endl;	//only for testing-----------------
 	
 	char ** newArgv = new char* [newArgc];
@@ -237,16 +243,13 @@ int main(int argc, char** argv) {
 	
 	//------------------------------------------------------------------------------------------------
 	// Here starts cycle for all previously generated files, that will be input files for chosen algorithm
-	for(int a = 0; a < inputFiles.size(); a++) {
-	
-		stringstream ss(inputFiles.at(a));	
-		char name[100];
-		ss >> name;
+	for(int a = 0; a < inputFiles.size(); a += filesPerCall) {
 	
-		cout << "============ PROCESSING " << name << " ============\n";
-		
-		i--;	
-		newArgv[i++] = name;
+		i = argc - 3;
+		for(int f = a; f < a + filesPerCall; f++) {
+			cout << "============ PROCESSING " << inputFiles.at(f) << " ============\n";
+			newArgv[i++] = const_cast<char *>(inputFiles.at(f).c_str());
+		}
 		newArgv[i] = NULL;
 
 		// for testing-----------------------
@@ -324,13 +327,15 @@ int main(int argc, char** argv) {
 				}
 		}
 	
-		//Deletion od temporary input '.bio' file with model and one property
+		//Deletion od temporary input '.bio' files with model and one property
 		
-		string removeCMD = "rm ";
-		removeCMD += name;
-		if(dbg) cout << "Removing file " << name << "\n";
-		if(system(removeCMD.c_str()) == -1) {
-			cerr << "\nError: Can't remove temporaly file " << name << "\n";
+		for(int f = a; f < a + filesPerCall; f++) {
+			string removeCMD = "rm ";
+			removeCMD += inputFiles.at(f);
+			if(dbg) cout << "Removing file " << inputFiles.at(f) << "\n";
+			if(system(removeCMD.c_str()) == -1) {
+				cerr << "\nError: Can't remove temporaly file " << inputFiles.at(f) << "\n";
+			}
 		}
 
 
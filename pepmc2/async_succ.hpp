@@ -0,0 +1,220 @@
+#ifndef ASYNC_SUCC_HPP
+#define ASYNC_SUCC_HPP
+
+#include <vector>
+#include <map>
+#include <chrono>
+
+#include "lock_free_queue.hpp"
+#include "sync_counter.hpp"
+#include "succ.hpp"
+#include "coloring.hpp"
+
+#include <boost/thread.hpp>
+
+// Asynchronous variant of succ, there are no BFS levels and no barriers.
+//
+// Vertices are still partitioned among threads by hash_value and only the
+// owner of a vertex updates its paramset. The expensive part of the work --
+// intersecting the new paramset of a vertex with its out-edges -- is posted
+// as a job to the owner's job queue, from which any idle thread may steal.
+// The computation terminates when the counter of pending messages and jobs
+// drops to zero.
+class async_succ
+{
+public:
+	explicit async_succ(std::size_t thread_count)
+		: m_thread_count(thread_count)
+	{
+	}
+
+	template <typename Structure, typename Paramset, typename Crop>
+	struct impl
+	{
+		typedef std::pair<typename Structure::vertex_descriptor, Paramset> message_t;
+
+		impl(Structure const & s, std::size_t thread_count, Crop & crop)
+			: s(s), res(thread_count, coloring<Structure, Paramset>(s)), inboxes(thread_count), jobs(thread_count),
+			idle_ms(thread_count), stolen(thread_count), active(0), crop(crop)
+		{
+		}
+
+		template <typename V, typename P>
+		void send(V && v, P && p)
+		{
+			active.add(1);
+			std::size_t id = hash_value(v) % inboxes.size();
+			inboxes[id].push(std::make_pair(std::forward<V>(v), std::forward<P>(p)));
+		}
+
+		Structure const & s;
+		std::vector<coloring<Structure, Paramset> > res;
+
+		// inboxes[i] -- paramsets to be joined to vertices owned by i
+		std::vector<global_queue<message_t> > inboxes;
+		// jobs[i] -- vertices (with their incoming paramsets) to be expanded, posted by i
+		std::vector<global_queue<message_t> > jobs;
+
+		std::vector<double> idle_ms;
+		std::vector<std::size_t> stolen;
+		sync_counter active;
+		Crop & crop;
+	};
+
+	// Takes one job, own jobs first; the rest of the pulled queue is returned
+	// so it can still be stolen.
+	template <typename Structure, typename Paramset, typename Crop>
+	static bool take_job(impl<Structure, Paramset, Crop> & im, std::size_t id,
+		local_queue<typename impl<Structure, Paramset, Crop>::message_t> & work,
+		typename impl<Structure, Paramset, Crop>::message_t & job)
+	{
+		for (std::size_t i = 0; i < im.jobs.size(); ++i)
+		{
+			std::size_t victim = (id + i) % im.jobs.size();
+			work.pull(im.jobs[victim]);
+			if (work.empty())
+				continue;
+
+			job = work.top();
+			work.pop();
+			work.merge(im.jobs[victim]);
+			if (victim != id)
+				++im.stolen[id];
+			return true;
+		}
+		return false;
+	}
+
+	template <typename Structure, typename Paramset, typename Crop>
+	static void worker(impl<Structure, Paramset, Crop> & im, std::size_t id)
+	{
+#ifdef PEPMC_LINUX_SETAFFINITY
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(id, &cpuset);
+		sched_setaffinity(gettid(), sizeof cpuset, &cpuset);
+#endif
+
+		typedef std::chrono::steady_clock clock;
+		typedef typename impl<Structure, Paramset, Crop>::message_t message_t;
+
+		coloring<Structure, Paramset> & res = im.res[id];
+		local_queue<message_t> messages;
+		local_queue<message_t> work;
+		message_t job;
+
+		bool idle = false;
+		clock::time_point idle_since;
+
+		while (im.active.get() != 0)
+		{
+			// jobs go first, incoming messages meanwhile pile up in the
+			// inbox and are joined together
+			if (take_job(im, id, work, job))
+			{
+				if (idle)
+				{
+					idle = false;
+					im.idle_ms[id] += std::chrono::duration<double, std::milli>(clock::now() - idle_since).count();
+				}
+
+				typename Structure::vertex_descriptor const & u = job.first;
+				Paramset const & pu = job.second;
+				coloring<Structure, Paramset> results(im.s);
+
+				typename Structure::out_edge_enumerator out_edges(im.s, u);
+				for (; out_edges.valid(); out_edges.next())
+				{
+					typename Structure::vertex_descriptor const & v = out_edges.target();
+					Paramset puv = pu;
+					out_edges.paramset_intersect(puv);
+					im.crop(v, puv);
+					if (!puv.empty())
+					{
+						puv.retag(out_edges.source());
+						results[v].set_union(std::move(puv));
+					}
+				}
+
+				for (auto ci = results.begin(); ci != results.end(); ++ci)
+					im.send(ci->first, std::move(ci->second));
+				im.active.sub(1);
+				continue;
+			}
+
+			messages.pull(im.inboxes[id]);
+			if (messages.empty())
+			{
+				if (!idle)
+				{
+					idle = true;
+					idle_since = clock::now();
+				}
+				boost::this_thread::yield();
+				continue;
+			}
+
+			std::size_t count = messages.size();
+			coloring<Structure, Paramset> incoming(im.s);
+			for (; !messages.empty(); messages.pop())
+				incoming[messages.top().first].set_union(messages.top().second);
+
+			// the parameters already present have been propagated before,
+			// only the incoming ones need to be expanded
+			for (auto ci = incoming.begin(); ci != incoming.end(); ++ci)
+			{
+				if (res[ci->first].set_union(ci->second))
+				{
+					im.active.add(1);
+					im.jobs[id].push(std::make_pair(ci->first, std::move(ci->second)));
+				}
+			}
+			im.active.sub(count);
+		}
+
+		if (idle)
+			im.idle_ms[id] += std::chrono::duration<double, std::milli>(clock::now() - idle_since).count();
+	}
+
+	template <typename Structure, typename InitEnum, typename Paramset, typename Crop, typename Visitor>
+	coloring<Structure, Paramset> operator()(
+		Structure const & s,
+		InitEnum init_enum,
+		Paramset const & p,
+		Crop crop,
+		Visitor & visitor)
+	{
+		impl<Structure, Paramset, Crop> im(s, m_thread_count, crop);
+
+		for (; init_enum.valid(); init_enum.next())
+		{
+			typename Structure::out_edge_enumerator out_edges(s, init_enum.get());
+			for (; out_edges.valid(); out_edges.next())
+			{
+				typename Structure::vertex_descriptor const & v = out_edges.target();
+
+				Paramset puv = p;
+				out_edges.paramset_intersect(puv);
+				crop(v, puv);
+				puv.retag(out_edges.source());
+
+				im.send(v, puv);
+			}
+		}
+
+		std::vector<boost::thread> th;
+		for (std::size_t i = 1; i < m_thread_count; ++i)
+			th.push_back(boost::thread(boost::bind(&worker<Structure, Paramset, Crop>, boost::ref(im), i)));
+		worker(im, 0);
+		for (std::size_t i = 0; i < th.size(); ++i)
+			th[i].join();
+		visitor.succ_idle_times(im.idle_ms);
+		visitor.succ_steals(im.stolen);
+		return coloring<Structure, Paramset>(s, std::move(im.res));
+	}
+
+private:
+	std::size_t m_thread_count;
+};
+
+#endif
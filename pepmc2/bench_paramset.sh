@@ -0,0 +1,59 @@
+#!/bin/sh
+#
+# Compares the interval-tree paramset (bin/divine.pepmc) with the original
+# vector-based one (bin/divine.pepmc-vector, built by `make pepmc-vector`)
+# on real runs. For every model prints the wall time, the total number of
+# regions in the computed colorings and the peak memory (when GNU time is
+# available).
+#
+# usage: bench_paramset.sh [pepmc options] model.bio...
+
+BIN=`dirname $0`/../bin
+
+OPTS=
+while [ $# -gt 0 ]; do
+    case "$1" in
+	-j) OPTS="$OPTS $1 $2"; shift 2;;
+	-*) OPTS="$OPTS $1"; shift;;
+	*) break;;
+    esac
+done
+
+if [ $# -eq 0 ]; then
+    echo "usage: $0 [pepmc options] model.bio..." >&2
+    exit 1
+fi
+
+for b in pepmc pepmc-vector; do
+    if [ ! -x $BIN/divine.$b ]; then
+	echo "$BIN/divine.$b not found" >&2
+	exit 1
+    fi
+done
+
+OUT=`mktemp`
+trap 'rm -f $OUT' EXIT
+
+printf "%-30s %-14s %10s %10s %12s\n" model paramset "time [s]" regions "memory [kB]"
+for m in "$@"; do
+    for b in pepmc pepmc-vector; do
+	start=`date +%s.%N`
+	if [ -x /usr/bin/time ]; then
+	    /usr/bin/time -f "max memory: %M" -o $OUT.mem $BIN/divine.$b -V $OPTS $m > $OUT 2>&1
+	    mem=`sed -n 's/^max memory: //p' $OUT.mem`
+	    rm -f $OUT.mem
+	else
+	    $BIN/divine.$b -V $OPTS $m > $OUT 2>&1
+	    mem=-
+	fi
+	end=`date +%s.%N`
+
+	regions=`tr '\r' '\n' < $OUT | sed -n 's/^coloring regions: //p' | awk '{ s += $1 } END { print s }'`
+	time=`echo "$start $end" | awk '{ printf "%.2f", $2 - $1 }'`
+	case $b in
+	    pepmc) name=interval;;
+	    *) name=vector;;
+	esac
+	printf "%-30s %-14s %10s %10s %12s\n" `basename $m` $name $time $regions $mem
+    done
+done
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <boost/functional/hash.hpp>
+#include "packed_key.hpp"
 #include <boost/tuple/tuple_comparison.hpp>
 
 template <typename Proposition>
@@ -77,6 +78,28 @@ public:
 		return v.fair_left && v.fair_right;
 	}
 
+	// packed vertices, see coloring.hpp
+	std::size_t key_bits() const
+	{
+		return m_pks.key_bits() + key_bit_width(m_ba.m_states.size()) + 2;
+	}
+
+	void pack(vertex_descriptor const & v, key_writer & w) const
+	{
+		m_pks.pack(v.vertex, w);
+		w.put(v.state, key_bit_width(m_ba.m_states.size()));
+		w.put(v.fair_left, 1);
+		w.put(v.fair_right, 1);
+	}
+
+	void unpack(key_reader & r, vertex_descriptor & v) const
+	{
+		m_pks.unpack(r, v.vertex);
+		v.state = r.get(key_bit_width(m_ba.m_states.size()));
+		v.fair_left = r.get(1);
+		v.fair_right = r.get(1);
+	}
+
 	class init_enumerator
 	{
 	public:
@@ -0,0 +1,304 @@
+#ifndef COLORING_HPP
+#define COLORING_HPP
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <cstring>
+#include <type_traits>
+
+#include "packed_key.hpp"
+
+// Map from vertices of a structure to values (paramsets mostly), used
+// instead of std::map for colorings.
+//
+// Vertices are kept packed by the structure into fixed-width keys, the keys
+// lie in one array and the values in a deque, the hash table of every shard
+// holds just 32-bit indices into them. A coloring consists of shards, the
+// shard of a vertex is given by hash_value(v) % shards -- the same function
+// succ uses to assign vertices to threads, so the colorings of the threads
+// are joined by moving their shards without copying anything.
+template <typename Structure, typename Value>
+class coloring
+{
+	struct shard
+	{
+		std::vector<std::uint64_t> keys;
+		std::deque<Value> values;
+		// index of the entry + 1, 0 for an empty slot
+		std::vector<std::uint32_t> slots;
+	};
+
+public:
+	typedef typename Structure::vertex_descriptor vertex_descriptor;
+	typedef std::pair<vertex_descriptor, Value> value_type;
+
+	template <typename Coloring, typename V>
+	class basic_iterator
+	{
+	public:
+		struct entry
+		{
+			vertex_descriptor first;
+			V & second;
+		};
+
+		struct arrow_proxy
+		{
+			entry e;
+			entry * operator->()
+			{
+				return &e;
+			}
+		};
+
+		basic_iterator(Coloring & c, std::size_t shard, std::size_t index)
+			: m_c(&c), m_shard(shard), m_index(index)
+		{
+			this->skip_empty();
+		}
+
+		// iterator converts to const_iterator
+		template <typename OColoring, typename OV>
+		basic_iterator(basic_iterator<OColoring, OV> const & o,
+			typename std::enable_if<std::is_convertible<OColoring *, Coloring *>::value>::type * = 0)
+			: m_c(o.m_c), m_shard(o.m_shard), m_index(o.m_index)
+		{
+		}
+
+		entry operator*() const
+		{
+			entry e = { m_c->key(m_shard, m_index), m_c->m_shards[m_shard].values[m_index] };
+			return e;
+		}
+
+		arrow_proxy operator->() const
+		{
+			arrow_proxy p = { **this };
+			return p;
+		}
+
+		basic_iterator & operator++()
+		{
+			++m_index;
+			this->skip_empty();
+			return *this;
+		}
+
+		friend bool operator==(basic_iterator const & lhs, basic_iterator const & rhs)
+		{
+			return lhs.m_shard == rhs.m_shard && lhs.m_index == rhs.m_index;
+		}
+
+		friend bool operator!=(basic_iterator const & lhs, basic_iterator const & rhs)
+		{
+			return !(lhs == rhs);
+		}
+
+	private:
+		template <typename OColoring, typename OV>
+		friend class basic_iterator;
+
+		void skip_empty()
+		{
+			while (m_shard < m_c->m_shards.size() && m_index == m_c->m_shards[m_shard].values.size())
+			{
+				++m_shard;
+				m_index = 0;
+			}
+		}
+
+		Coloring * m_c;
+		std::size_t m_shard;
+		std::size_t m_index;
+	};
+
+	typedef basic_iterator<coloring, Value> iterator;
+	typedef basic_iterator<coloring const, Value const> const_iterator;
+
+	explicit coloring(Structure const & s, std::size_t shards = 1)
+		: m_s(&s), m_words(key_words(s.key_bits())), m_shards(shards)
+	{
+	}
+
+	// joins single-shard colorings, vertex v must be in parts[hash_value(v) % parts.size()]
+	coloring(Structure const & s, std::vector<coloring> && parts)
+		: m_s(&s), m_words(key_words(s.key_bits()))
+	{
+		for (std::size_t i = 0; i < parts.size(); ++i)
+		{
+			BOOST_ASSERT(parts[i].m_shards.size() == 1);
+			m_shards.push_back(std::move(parts[i].m_shards[0]));
+		}
+	}
+
+	iterator begin()
+	{
+		return iterator(*this, 0, 0);
+	}
+
+	iterator end()
+	{
+		return iterator(*this, m_shards.size(), 0);
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(*this, 0, 0);
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(*this, m_shards.size(), 0);
+	}
+
+	std::size_t size() const
+	{
+		std::size_t res = 0;
+		for (std::size_t i = 0; i < m_shards.size(); ++i)
+			res += m_shards[i].values.size();
+		return res;
+	}
+
+	bool empty() const
+	{
+		return this->size() == 0;
+	}
+
+	void clear()
+	{
+		for (std::size_t i = 0; i < m_shards.size(); ++i)
+			m_shards[i] = shard();
+	}
+
+	iterator find(vertex_descriptor const & v)
+	{
+		std::size_t sh, index;
+		if (!this->lookup(v, sh, index))
+			return this->end();
+		return iterator(*this, sh, index);
+	}
+
+	const_iterator find(vertex_descriptor const & v) const
+	{
+		std::size_t sh, index;
+		if (!this->lookup(v, sh, index))
+			return this->end();
+		return const_iterator(*this, sh, index);
+	}
+
+	// the reference stays valid when other vertices are inserted
+	Value & operator[](vertex_descriptor const & v)
+	{
+		key_buffer key(m_words);
+		key_writer w(key.words);
+		m_s->pack(v, w);
+
+		shard & s = m_shards[this->shard_of(v)];
+		if ((s.values.size() + 1) * 10 > s.slots.size() * 7)
+			this->grow(s);
+
+		std::size_t slot = this->find_slot(s, key.words);
+		if (s.slots[slot] == 0)
+		{
+			s.keys.insert(s.keys.end(), key.words, key.words + m_words);
+			s.values.push_back(Value());
+			s.slots[slot] = s.values.size();
+		}
+		return s.values[s.slots[slot] - 1];
+	}
+
+private:
+	struct key_buffer
+	{
+		explicit key_buffer(std::size_t n)
+			: words(n <= 4? local: new std::uint64_t[n])
+		{
+		}
+
+		~key_buffer()
+		{
+			if (words != local)
+				delete [] words;
+		}
+
+		std::uint64_t local[4];
+		std::uint64_t * words;
+	};
+
+	std::size_t shard_of(vertex_descriptor const & v) const
+	{
+		return m_shards.size() == 1? 0: hash_value(v) % m_shards.size();
+	}
+
+	std::size_t hash(std::uint64_t const * key) const
+	{
+		std::uint64_t h = 0xcbf29ce484222325ULL;
+		for (std::size_t i = 0; i < m_words; ++i)
+		{
+			h = (h ^ key[i]) * 0x9e3779b97f4a7c15ULL;
+			h ^= h >> 29;
+		}
+		return h;
+	}
+
+	// the slot holding the key or the empty slot where it belongs
+	std::size_t find_slot(shard const & s, std::uint64_t const * key) const
+	{
+		std::size_t mask = s.slots.size() - 1;
+		std::size_t slot = this->hash(key) & mask;
+		for (; s.slots[slot] != 0; slot = (slot + 1) & mask)
+		{
+			std::uint64_t const * stored = &s.keys[(s.slots[slot] - 1) * m_words];
+			if (std::memcmp(stored, key, m_words * sizeof(std::uint64_t)) == 0)
+				break;
+		}
+		return slot;
+	}
+
+	bool lookup(vertex_descriptor const & v, std::size_t & sh, std::size_t & index) const
+	{
+		sh = this->shard_of(v);
+		shard const & s = m_shards[sh];
+		if (s.values.empty())
+			return false;
+
+		key_buffer key(m_words);
+		key_writer w(key.words);
+		m_s->pack(v, w);
+
+		std::size_t slot = this->find_slot(s, key.words);
+		if (s.slots[slot] == 0)
+			return false;
+		index = s.slots[slot] - 1;
+		return true;
+	}
+
+	void grow(shard & s) const
+	{
+		std::vector<std::uint32_t> slots(s.slots.empty()? 16: 2 * s.slots.size());
+		std::size_t mask = slots.size() - 1;
+		for (std::size_t i = 0; i < s.values.size(); ++i)
+		{
+			std::size_t slot = this->hash(&s.keys[i * m_words]) & mask;
+			while (slots[slot] != 0)
+				slot = (slot + 1) & mask;
+			slots[slot] = i + 1;
+		}
+		s.slots.swap(slots);
+	}
+
+	vertex_descriptor key(std::size_t sh, std::size_t index) const
+	{
+		vertex_descriptor v;
+		key_reader r(&m_shards[sh].keys[index * m_words]);
+		m_s->unpack(r, v);
+		return v;
+	}
+
+	Structure const * m_s;
+	std::size_t m_words;
+	std::vector<shard> m_shards;
+};
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef COLOURED_OWCTY_HPP
+#define COLOURED_OWCTY_HPP
+
+#include <vector>
+#include <map>
+#include <deque>
+
+#include "coloring.hpp"
+
+#include <boost/thread.hpp>
+
+// Accepting cycle detection over the parameter space in a single fixpoint,
+// the OWCTY algorithm with paramsets as colours.
+//
+// The reachable part of the product (the base coloring) is made explicit
+// first, every edge is labelled by the parameters it is enabled for. Then
+// the colours of vertices are repeatedly cut by
+//
+//  - reachability: a parameter stays in a vertex only if the vertex can be
+//    reached in at least one step from an accepting vertex of that colour,
+//  - elimination: a parameter stays in a vertex only if the vertex has
+//    a predecessor of that colour.
+//
+// Both steps are pointwise in the parameters, so in the fixpoint a parameter
+// stays in an accepting vertex iff the vertex lies on an accepting cycle for
+// that parameter. The result is the same as that of the nested search from
+// every accepting vertex (nonnaive), at the cost of a few reachabilities.
+template <typename Structure, typename Paramset>
+class coloured_graph
+{
+public:
+	typedef typename Structure::vertex_descriptor vertex_descriptor;
+	typedef std::pair<std::size_t, Paramset> edge_t;
+
+	template <typename Coloring>
+	coloured_graph(Structure const & s, Coloring const & c, std::size_t thread_count)
+		: m_index(s)
+	{
+		for (auto ci = c.begin(); ci != c.end(); ++ci)
+		{
+			if (ci->second.empty())
+				continue;
+			m_index[ci->first] = m_vertices.size();
+			m_vertices.push_back(ci->first);
+			m_colors.push_back(ci->second);
+			m_final.push_back(s.final(ci->first));
+		}
+
+		// evaluating the edges of the model is the expensive part, vertices
+		// are split among threads; every thread fills only its own m_succs
+		m_succs.resize(m_vertices.size());
+		std::vector<boost::thread> th;
+		for (std::size_t i = 1; i < thread_count; ++i)
+			th.push_back(boost::thread(boost::bind(&coloured_graph::add_edges, this, boost::cref(s), i, thread_count)));
+		this->add_edges(s, 0, thread_count);
+		for (std::size_t i = 0; i < th.size(); ++i)
+			th[i].join();
+
+		m_preds.resize(m_vertices.size());
+		for (std::size_t u = 0; u < m_succs.size(); ++u)
+		{
+			for (std::size_t e = 0; e < m_succs[u].size(); ++e)
+				m_preds[m_succs[u][e].first].push_back(std::make_pair(u, e));
+		}
+	}
+
+	std::size_t size() const
+	{
+		return m_vertices.size();
+	}
+
+	vertex_descriptor const & vertex(std::size_t v) const
+	{
+		return m_vertices[v];
+	}
+
+	bool final(std::size_t v) const
+	{
+		return m_final[v];
+	}
+
+	Paramset const & color(std::size_t v) const
+	{
+		return m_colors[v];
+	}
+
+	// Keeps only the parameters for which a vertex is reachable from an
+	// accepting vertex, returns true if anything was removed.
+	bool reach()
+	{
+		std::vector<Paramset> reached(m_vertices.size());
+		std::deque<std::pair<std::size_t, Paramset> > queue;
+
+		for (std::size_t u = 0; u < m_vertices.size(); ++u)
+		{
+			if (m_final[u] && !m_colors[u].empty())
+				queue.push_back(std::make_pair(u, m_colors[u]));
+		}
+
+		for (; !queue.empty(); queue.pop_front())
+		{
+			std::size_t u = queue.front().first;
+			for (std::size_t e = 0; e < m_succs[u].size(); ++e)
+			{
+				std::size_t v = m_succs[u][e].first;
+				Paramset p = queue.front().second;
+				p.set_intersection(m_succs[u][e].second);
+				p.set_intersection(m_colors[v]);
+				p.set_difference(reached[v]);
+				if (p.empty())
+					continue;
+
+				reached[v].set_union(p);
+				// accepting vertices propagate their whole colour from the start
+				if (!m_final[v])
+					queue.push_back(std::make_pair(v, std::move(p)));
+			}
+		}
+
+		bool changed = false;
+		for (std::size_t v = 0; v < m_vertices.size(); ++v)
+		{
+			Paramset lost = m_colors[v];
+			lost.set_difference(reached[v]);
+			if (!lost.empty())
+			{
+				changed = true;
+				m_colors[v] = std::move(reached[v]);
+			}
+		}
+		return changed;
+	}
+
+	// Removes parameters for which a vertex has no predecessor, returns true
+	// if anything was removed.
+	bool eliminate()
+	{
+		std::deque<std::size_t> queue;
+		std::vector<bool> queued(m_vertices.size());
+		for (std::size_t v = 0; v < m_vertices.size(); ++v)
+		{
+			if (!m_colors[v].empty())
+			{
+				queue.push_back(v);
+				queued[v] = true;
+			}
+		}
+
+		bool changed = false;
+		for (; !queue.empty(); queue.pop_front())
+		{
+			std::size_t v = queue.front();
+			queued[v] = false;
+			if (m_colors[v].empty())
+				continue;
+
+			Paramset incoming;
+			for (std::size_t i = 0; i < m_preds[v].size(); ++i)
+			{
+				std::size_t u = m_preds[v][i].first;
+				Paramset p = m_colors[u];
+				p.set_intersection(m_succs[u][m_preds[v][i].second].second);
+				incoming.set_union(std::move(p));
+			}
+
+			Paramset lost = m_colors[v];
+			lost.set_difference(incoming);
+			if (lost.empty())
+				continue;
+
+			changed = true;
+			m_colors[v].set_difference(lost);
+			for (std::size_t e = 0; e < m_succs[v].size(); ++e)
+			{
+				std::size_t w = m_succs[v][e].first;
+				if (!queued[w])
+				{
+					queue.push_back(w);
+					queued[w] = true;
+				}
+			}
+		}
+		return changed;
+	}
+
+private:
+	void add_edges(Structure const & s, std::size_t id, std::size_t thread_count)
+	{
+		for (std::size_t u = id; u < m_vertices.size(); u += thread_count)
+		{
+			typename Structure::out_edge_enumerator out_edges(s, m_vertices[u]);
+			for (; out_edges.valid(); out_edges.next())
+			{
+				typename coloring<Structure, std::size_t>::const_iterator ti = m_index.find(out_edges.target());
+				if (ti == m_index.end())
+					continue;
+
+				Paramset p = m_colors[u];
+				out_edges.paramset_intersect(p);
+				p.set_intersection(m_colors[ti->second]);
+				if (!p.empty())
+					m_succs[u].push_back(std::make_pair(ti->second, std::move(p)));
+			}
+		}
+	}
+
+	std::vector<vertex_descriptor> m_vertices;
+	coloring<Structure, std::size_t> m_index;
+	std::vector<Paramset> m_colors;
+	std::vector<bool> m_final;
+
+	// m_succs[u] -- targets and labels of edges from u
+	std::vector<std::vector<edge_t> > m_succs;
+	// m_preds[v] -- (u, i) for the edge m_succs[u][i] to v
+	std::vector<std::vector<std::pair<std::size_t, std::size_t> > > m_preds;
+};
+
+#endif
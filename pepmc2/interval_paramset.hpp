@@ -0,0 +1,504 @@
+#ifndef INTERVAL_PARAMSET_HPP
+#define INTERVAL_PARAMSET_HPP
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <ostream>
+#include <boost/none.hpp>
+
+// Paramset with the interface of `paramset`, but stored as a tree of interval
+// lists instead of a flat vector of boxes.
+//
+// A node at the level `d` partitions the values of the `d`-th parameter into
+// sorted disjoint intervals, each of them pointing to the node describing the
+// remaining parameters. Nodes below the last level are leaves holding tags.
+// Adjacent intervals with equal subtrees are always merged, so every set
+// (together with its tags) has a single representation regardless of the
+// order of operations and the number of fragments does not grow with the
+// number of fixpoint iterations.
+//
+// Nodes are immutable and shared among paramsets, a copy costs O(1). Set
+// operations walk both trees simultaneously; in intersections and differences
+// the intervals of one set lying before the next interval of the other set
+// are skipped by binary search, so a small set is intersected with a large one
+// in O(log n) per interval.
+//
+// Intervals are half-open as in `paramset`, an interval with both bounds equal
+// stands for a single value (a fixed parameter).
+template <typename T, typename Tag = boost::none_t>
+class interval_paramset
+{
+public:
+	typedef T value_type;
+	typedef Tag tag_type;
+
+	struct region_t
+	{
+		region_t()
+		{
+		}
+
+		template <typename ConstIterator>
+		region_t(ConstIterator first, ConstIterator last)
+			: box(first, last)
+		{
+		}
+
+		template <typename ConstIterator, typename OTag>
+		region_t(ConstIterator first, ConstIterator last, OTag && tag)
+			: box(first, last), tag(std::forward<OTag>(tag))
+		{
+		}
+
+		std::vector<std::pair<value_type, value_type> > box;
+		tag_type tag;
+	};
+
+	interval_paramset()
+		: m_regions_valid(false)
+	{
+	}
+
+	interval_paramset(interval_paramset const & other)
+		: m_root(other.m_root), m_regions_valid(false)
+	{
+	}
+
+	interval_paramset(interval_paramset && other)
+		: m_root(std::move(other.m_root)), m_regions(std::move(other.m_regions)), m_regions_valid(other.m_regions_valid)
+	{
+		other.m_regions_valid = false;
+	}
+
+	interval_paramset & operator=(interval_paramset const & other)
+	{
+		m_root = other.m_root;
+		this->invalidate();
+		return *this;
+	}
+
+	interval_paramset & operator=(interval_paramset && other)
+	{
+		m_root = std::move(other.m_root);
+		m_regions = std::move(other.m_regions);
+		m_regions_valid = other.m_regions_valid;
+		other.m_regions_valid = false;
+		return *this;
+	}
+
+	void clear()
+	{
+		m_root.reset();
+		this->invalidate();
+	}
+
+	bool empty() const
+	{
+		return !m_root;
+	}
+
+	template <typename ConstIterator>
+	void add_region(ConstIterator first, ConstIterator last)
+	{
+		this->add_region(first, last, tag_type());
+	}
+
+	template <typename ConstIterator, typename OTag>
+	void add_region(ConstIterator first, ConstIterator last, OTag && tag)
+	{
+		std::vector<std::pair<value_type, value_type> > box(first, last);
+
+		node_ptr n = std::make_shared<node>(std::forward<OTag>(tag));
+		for (std::size_t i = box.size(); n && i != 0; --i)
+		{
+			std::vector<segment_t> segments;
+			append(segments, box[i-1].first, box[i-1].second, n);
+			n = make_node(std::move(segments));
+		}
+
+		bool changed = false;
+		m_root = unite(m_root, n, changed);
+		this->invalidate();
+	}
+
+	bool set_union(interval_paramset && other)
+	{
+		return this->set_union(static_cast<interval_paramset const &>(other));
+	}
+
+	bool set_union(interval_paramset const & other)
+	{
+		bool changed = false;
+		m_root = unite(m_root, other.m_root, changed);
+		if (changed)
+			this->invalidate();
+		return changed;
+	}
+
+	void set_difference(interval_paramset const & other)
+	{
+		m_root = subtract(m_root, other.m_root);
+		this->invalidate();
+	}
+
+	void set_intersection(interval_paramset const & other)
+	{
+		m_root = intersect(m_root, other.m_root);
+		this->invalidate();
+	}
+
+	// Removes and returns the parameters lying above `value` in the dimension
+	// `dim`, if `up`, or below it otherwise.
+	interval_paramset remove_cut(std::size_t dim, value_type value, bool up)
+	{
+		interval_paramset res;
+		if (m_root)
+		{
+			node_ptr kept;
+			cut(m_root, 0, dim, value, up, kept, res.m_root);
+			m_root = std::move(kept);
+			this->invalidate();
+		}
+		return std::move(res);
+	}
+
+	// The regions are only materialized on request (to print the set or to
+	// look up tags), the vector is kept until the set changes.
+	std::vector<region_t> const & regions() const
+	{
+		if (!m_regions_valid)
+		{
+			m_regions.clear();
+			if (m_root)
+			{
+				std::vector<std::pair<value_type, value_type> > box;
+				collect(m_root, box, m_regions);
+			}
+			m_regions_valid = true;
+		}
+		return m_regions;
+	}
+
+	template <typename OTag>
+	void retag(OTag && tag)
+	{
+		if (!m_root)
+			return;
+		node_ptr leaf = std::make_shared<node>(std::forward<OTag>(tag));
+		m_root = retag(m_root, leaf);
+		this->invalidate();
+	}
+
+	friend std::ostream & operator<<(std::ostream & out, interval_paramset const & v)
+	{
+		std::vector<region_t> const & regions = v.regions();
+		for (std::size_t i = 0; i < regions.size(); ++i)
+		{
+			out << "[";
+			for (std::size_t j = 0; j < regions[i].box.size(); ++j)
+				out << "(" << regions[i].box[j].first << ", " << regions[i].box[j].second << ")";
+			out << "]";
+		}
+		return out;
+	}
+
+private:
+	struct node;
+	typedef std::shared_ptr<node const> node_ptr;
+
+	struct segment_t
+	{
+		segment_t(value_type first, value_type second, node_ptr const & child)
+			: first(first), second(second), child(child)
+		{
+		}
+
+		value_type first;
+		value_type second;
+		node_ptr child;
+	};
+
+	// Inner nodes have at least one segment, leaves have none.
+	struct node
+	{
+		explicit node(std::vector<segment_t> && segments)
+			: segments(std::move(segments)), tag()
+		{
+		}
+
+		template <typename OTag>
+		explicit node(OTag && tag)
+			: tag(std::forward<OTag>(tag))
+		{
+		}
+
+		std::vector<segment_t> segments;
+		tag_type tag;
+	};
+
+	static bool same_tag(boost::none_t const &, boost::none_t const &)
+	{
+		return true;
+	}
+
+	template <typename U>
+	static bool same_tag(U const & lhs, U const & rhs)
+	{
+		return lhs == rhs;
+	}
+
+	static bool equal(node_ptr const & lhs, node_ptr const & rhs)
+	{
+		if (lhs == rhs)
+			return true;
+		if (!lhs || !rhs || lhs->segments.size() != rhs->segments.size())
+			return false;
+		if (lhs->segments.empty())
+			return same_tag(lhs->tag, rhs->tag);
+
+		for (std::size_t i = 0; i < lhs->segments.size(); ++i)
+		{
+			segment_t const & l = lhs->segments[i];
+			segment_t const & r = rhs->segments[i];
+			if (l.first != r.first || l.second != r.second || !equal(l.child, r.child))
+				return false;
+		}
+		return true;
+	}
+
+	static node_ptr make_node(std::vector<segment_t> && segments)
+	{
+		if (segments.empty())
+			return node_ptr();
+		return std::make_shared<node>(std::move(segments));
+	}
+
+	// Appends the interval [first, second) mapped to `child`, merges it with
+	// the preceding one if possible.
+	static void append(std::vector<segment_t> & segments, value_type first, value_type second, node_ptr const & child)
+	{
+		if (!child || second < first)
+			return;
+
+		if (!segments.empty() && segments.back().second == first && first != second
+			&& segments.back().first != segments.back().second && equal(segments.back().child, child))
+		{
+			segments.back().second = second;
+			return;
+		}
+
+		segments.push_back(segment_t(first, second, child));
+	}
+
+	// Returns true if the segment ends before `value`.
+	static bool before(segment_t const & s, value_type value)
+	{
+		return s.second < value || (s.second == value && s.first != s.second);
+	}
+
+	// Walks the segments of `a` and `b` together. Calls `op` for every piece
+	// covered by either of them, with the empty pointer in place of the
+	// missing child. Pieces covered by only `a` (resp. `b`) are skipped
+	// entirely unless `keep_a` (resp. `keep_b`) is set.
+	template <typename Op>
+	static node_ptr combine(node const & a, node const & b, bool keep_a, bool keep_b, Op op)
+	{
+		typedef typename std::vector<segment_t>::const_iterator iter;
+
+		std::vector<segment_t> res;
+		iter ai = a.segments.begin(), ae = a.segments.end();
+		iter bi = b.segments.begin(), be = b.segments.end();
+		value_type alo = ai->first;
+		value_type blo = bi->first;
+
+		while (ai != ae || bi != be)
+		{
+			if (bi == be)
+			{
+				if (!keep_a)
+					break;
+				append(res, alo, ai->second, op(ai->child, node_ptr()));
+				if (++ai != ae)
+					alo = ai->first;
+				continue;
+			}
+
+			if (ai == ae)
+			{
+				if (!keep_b)
+					break;
+				append(res, blo, bi->second, op(node_ptr(), bi->child));
+				if (++bi != be)
+					blo = bi->first;
+				continue;
+			}
+
+			if (alo < blo)
+			{
+				if (!keep_a)
+				{
+					ai = std::lower_bound(ai, ae, blo, &before);
+					if (ai != ae)
+						alo = std::max(ai->first, blo);
+					continue;
+				}
+
+				value_type hi = std::min(ai->second, blo);
+				append(res, alo, hi, op(ai->child, node_ptr()));
+				alo = hi;
+				if (alo == ai->second && ++ai != ae)
+					alo = ai->first;
+				continue;
+			}
+
+			if (blo < alo)
+			{
+				if (!keep_b)
+				{
+					bi = std::lower_bound(bi, be, alo, &before);
+					if (bi != be)
+						blo = std::max(bi->first, alo);
+					continue;
+				}
+
+				value_type hi = std::min(bi->second, alo);
+				append(res, blo, hi, op(node_ptr(), bi->child));
+				blo = hi;
+				if (blo == bi->second && ++bi != be)
+					blo = bi->first;
+				continue;
+			}
+
+			value_type hi = std::min(ai->second, bi->second);
+			append(res, alo, hi, op(ai->child, bi->child));
+			alo = blo = hi;
+			if (alo == ai->second && ++ai != ae)
+				alo = ai->first;
+			if (blo == bi->second && ++bi != be)
+				blo = bi->first;
+		}
+
+		return make_node(std::move(res));
+	}
+
+	// Tags of `a` take precedence, `changed` is set if `b` is not a subset of `a`.
+	static node_ptr unite(node_ptr const & a, node_ptr const & b, bool & changed)
+	{
+		if (!b)
+			return a;
+		if (!a)
+		{
+			changed = true;
+			return b;
+		}
+		if (a == b || a->segments.empty())
+			return a;
+
+		return combine(*a, *b, true, true, [&changed](node_ptr const & ca, node_ptr const & cb) {
+			return unite(ca, cb, changed);
+		});
+	}
+
+	static node_ptr intersect(node_ptr const & a, node_ptr const & b)
+	{
+		if (!a || !b)
+			return node_ptr();
+		if (a == b || a->segments.empty())
+			return a;
+
+		return combine(*a, *b, false, false, [](node_ptr const & ca, node_ptr const & cb) {
+			return intersect(ca, cb);
+		});
+	}
+
+	static node_ptr subtract(node_ptr const & a, node_ptr const & b)
+	{
+		if (!a || a == b)
+			return node_ptr();
+		if (!b)
+			return a;
+		if (a->segments.empty())
+			return node_ptr();
+
+		return combine(*a, *b, true, false, [](node_ptr const & ca, node_ptr const & cb) {
+			return subtract(ca, cb);
+		});
+	}
+
+	// Splits `n` (at the level `level`) by the value `value` in the dimension
+	// `dim`; the part on the `up` side goes to `removed`, the rest to `kept`.
+	static void cut(node_ptr const & n, std::size_t level, std::size_t dim, value_type value, bool up,
+		node_ptr & kept, node_ptr & removed)
+	{
+		std::vector<segment_t> kept_segments, removed_segments;
+		std::vector<segment_t> & lower = up? kept_segments: removed_segments;
+		std::vector<segment_t> & upper = up? removed_segments: kept_segments;
+
+		for (std::size_t i = 0; i < n->segments.size(); ++i)
+		{
+			segment_t const & s = n->segments[i];
+
+			if (level < dim)
+			{
+				node_ptr k, r;
+				cut(s.child, level + 1, dim, value, up, k, r);
+				append(kept_segments, s.first, s.second, k);
+				append(removed_segments, s.first, s.second, r);
+			}
+			else if (s.first == s.second)
+			{
+				append(s.first >= value? upper: lower, s.first, s.second, s.child);
+			}
+			else
+			{
+				if (s.first < value)
+					append(lower, s.first, std::min(s.second, value), s.child);
+				if (s.second > value)
+					append(upper, std::max(s.first, value), s.second, s.child);
+			}
+		}
+
+		kept = make_node(std::move(kept_segments));
+		removed = make_node(std::move(removed_segments));
+	}
+
+	static node_ptr retag(node_ptr const & n, node_ptr const & leaf)
+	{
+		if (n->segments.empty())
+			return leaf;
+
+		std::vector<segment_t> res;
+		for (std::size_t i = 0; i < n->segments.size(); ++i)
+			append(res, n->segments[i].first, n->segments[i].second, retag(n->segments[i].child, leaf));
+		return make_node(std::move(res));
+	}
+
+	static void collect(node_ptr const & n, std::vector<std::pair<value_type, value_type> > & box, std::vector<region_t> & res)
+	{
+		if (n->segments.empty())
+		{
+			res.push_back(region_t(box.begin(), box.end(), n->tag));
+			return;
+		}
+
+		for (std::size_t i = 0; i < n->segments.size(); ++i)
+		{
+			box.push_back(std::make_pair(n->segments[i].first, n->segments[i].second));
+			collect(n->segments[i].child, box, res);
+			box.pop_back();
+		}
+	}
+
+	void invalidate()
+	{
+		m_regions_valid = false;
+	}
+
+	node_ptr m_root;
+	mutable std::vector<region_t> m_regions;
+	mutable bool m_regions_valid;
+};
+
+#endif
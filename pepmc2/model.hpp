@@ -287,8 +287,8 @@ public:
 	// Transfers all `p` from `src` to `dest` such that the derivation at `state` in the direction `dim` is
 	//  1. positive, if `up`, or
 	//  2. negative, if not `up`.
-	template <typename State, typename PT, typename Tag>
-	void paramset_transfer(paramset<PT, Tag> & src, paramset<PT, Tag> & dest, State const & state, std::size_t dim, bool up) const
+	template <typename State, typename Paramset>
+	void paramset_transfer(Paramset & src, Paramset & dest, State const & state, std::size_t dim, bool up) const
 	{
 		value_type val, denom;
 		std::size_t ret_dim;
@@ -313,8 +313,8 @@ public:
 	// Removes as few parameters as possible from `p_down` and `p_up` so that
 	//  1. for all `p` in `p_down` the derivation at state in the direction `dim` is negative,
 	//  2. for all `p` in `p_up` the derivation at state in the direction `dim` is positive.
-	template <typename State, typename PT, typename Tag>
-	void fix_paramsets(paramset<PT, Tag> & p_down, paramset<PT, Tag> & p_up, State const & state, std::size_t dim) const
+	template <typename State, typename Paramset>
+	void fix_paramsets(Paramset & p_down, Paramset & p_up, State const & state, std::size_t dim) const
 	{
 		value_type val, denom;
 		std::size_t ret_dim;
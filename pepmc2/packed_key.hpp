@@ -0,0 +1,92 @@
+#ifndef PACKED_KEY_HPP
+#define PACKED_KEY_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+
+// Vertices are stored in colorings as fixed-width bit strings, every field
+// takes just enough bits for the largest value it can hold. Structures
+// provide key_bits(), pack() and unpack() in terms of these two classes.
+
+// number of bits needed to store values less than n
+inline std::size_t key_bit_width(std::size_t n)
+{
+	std::size_t bits = 0;
+	for (; n > 1; n = (n + 1) / 2)
+		++bits;
+	return bits;
+}
+
+inline std::size_t key_words(std::size_t bits)
+{
+	return (bits + 63) / 64;
+}
+
+class key_writer
+{
+public:
+	explicit key_writer(std::uint64_t * words)
+		: m_words(words), m_pos(0)
+	{
+	}
+
+	void put(std::size_t value, std::size_t bits)
+	{
+		BOOST_ASSERT(bits >= 64 || value < (std::uint64_t(1) << bits));
+
+		for (; bits != 0; )
+		{
+			std::size_t offset = m_pos % 64;
+			std::size_t chunk = 64 - offset < bits? 64 - offset: bits;
+
+			std::uint64_t & word = m_words[m_pos / 64];
+			if (offset == 0)
+				word = 0;
+			word |= std::uint64_t(value) << offset;
+
+			value = chunk < 64? value >> chunk: 0;
+			m_pos += chunk;
+			bits -= chunk;
+		}
+	}
+
+private:
+	std::uint64_t * m_words;
+	std::size_t m_pos;
+};
+
+class key_reader
+{
+public:
+	explicit key_reader(std::uint64_t const * words)
+		: m_words(words), m_pos(0)
+	{
+	}
+
+	std::size_t get(std::size_t bits)
+	{
+		std::uint64_t value = 0;
+		for (std::size_t done = 0; done != bits; )
+		{
+			std::size_t offset = m_pos % 64;
+			std::size_t chunk = 64 - offset < bits - done? 64 - offset: bits - done;
+
+			std::uint64_t part = m_words[m_pos / 64] >> offset;
+			if (chunk < 64)
+				part &= (std::uint64_t(1) << chunk) - 1;
+			value |= part << done;
+
+			m_pos += chunk;
+			done += chunk;
+		}
+		return value;
+	}
+
+private:
+	std::uint64_t const * m_words;
+	std::size_t m_pos;
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include "model.hpp"
 #include "paramset.hpp"
 #include "buchi_automaton.hpp"
+#include "packed_key.hpp"
 
 #include "../src/system/bio/data_model/Model.h"
 
@@ -90,6 +91,28 @@ public:
 		}
 	};
 
+	// packed vertices, see coloring.hpp
+	std::size_t key_bits() const
+	{
+		std::size_t res = 0;
+		for (std::size_t i = 0; i < m_thresholds.size(); ++i)
+			res += key_bit_width(m_thresholds[i].size());
+		return res;
+	}
+
+	void pack(vertex_descriptor const & v, key_writer & w) const
+	{
+		for (std::size_t i = 0; i < m_thresholds.size(); ++i)
+			w.put(v.coords[i], key_bit_width(m_thresholds[i].size()));
+	}
+
+	void unpack(key_reader & r, vertex_descriptor & v) const
+	{
+		v.coords.resize(m_thresholds.size());
+		for (std::size_t i = 0; i < m_thresholds.size(); ++i)
+			v.coords[i] = r.get(key_bit_width(m_thresholds[i].size()));
+	}
+
 	template <typename State>
 	class real_state
 	{
@@ -217,12 +240,12 @@ public:
 			return res;
 		}
 
-		template <typename Tag>
-		void paramset_intersect(paramset<T, Tag> & p) const
+		template <typename Paramset>
+		void paramset_intersect(Paramset & p) const
 		{
 			BOOST_ASSERT(m_dim < m_source.coords.size());
 
-			paramset<T, Tag> removed = std::move(p);
+			Paramset removed = std::move(p);
 			p.clear();
 
 			std::vector<bool> shifts(m_g->m_model.dims());
@@ -3,10 +3,12 @@
 
 #include <vector>
 #include <map>
+#include <chrono>
 
 #include "semaphore.hpp"
 #include "sync_counter.hpp"
 #include "barrier.hpp"
+#include "coloring.hpp"
 
 #include <boost/thread.hpp>
 
@@ -35,7 +37,7 @@ public:
 		typedef std::vector<message_t> message_queue_t;
 
 		impl(Structure const & s, std::size_t thread_count, Crop & crop)
-			: s(s), res(thread_count), active_processes(0), crop(crop), m_barrier(thread_count)
+			: s(s), res(thread_count, coloring<Structure, Paramset>(s)), idle_ms(thread_count), active_processes(0), crop(crop), m_barrier(thread_count)
 		{
 			event_queues.resize(thread_count, std::vector<message_queue_t *>(thread_count));
 			for (std::size_t i = 0; i < thread_count; ++i)
@@ -63,10 +65,12 @@ public:
 		}
 
 		Structure const & s;
-		std::vector<std::map<typename Structure::vertex_descriptor, Paramset> > res;
+		std::vector<coloring<Structure, Paramset> > res;
 
 		// event_queues[i][j] -- messages from j to i
 		std::vector<std::vector<message_queue_t *> > event_queues;
+		// time spent waiting at the barrier, per thread
+		std::vector<double> idle_ms;
 		barrier m_barrier;
 		sync_counter active_processes;
 		Crop & crop;
@@ -131,21 +135,26 @@ public:
 
 		std::size_t bfs_levels = 0;
 
+		typedef std::chrono::steady_clock clock;
+		clock::time_point wait_start;
+
 		typedef std::pair<typename Structure::vertex_descriptor, Paramset> message_t;
 		typedef std::vector<message_t> message_queue_t;
 
 		queue_set<Structure, Paramset, Crop> qs(id, im);
 		std::vector<message_queue_t *> in_queues(im.event_queues.size());
 
-		std::map<typename Structure::vertex_descriptor, Paramset> & res = im.res[id];
+		coloring<Structure, Paramset> & res = im.res[id];
 
 		for (; im.active_processes.get() != 0; ++bfs_levels)
 		{
 			qs.fetch(in_queues);
 
+			wait_start = clock::now();
 			im.m_barrier.wait();
+			im.idle_ms[id] += std::chrono::duration<double, std::milli>(clock::now() - wait_start).count();
 
-			std::map<typename Structure::vertex_descriptor, Paramset> results;
+			coloring<Structure, Paramset> results(im.s);
 
 			for (std::size_t i = 0; i < in_queues.size(); ++i)
 			{
@@ -186,14 +195,16 @@ public:
 			im.active_processes.add(results.size());
 			qs.post(in_queues);
 
+			wait_start = clock::now();
 			im.m_barrier.wait();
+			im.idle_ms[id] += std::chrono::duration<double, std::milli>(clock::now() - wait_start).count();
 		}
 
 		return bfs_levels;
 	}
 
 	template <typename Structure, typename InitEnum, typename Paramset, typename Crop, typename Visitor>
-	std::map<typename Structure::vertex_descriptor, Paramset> operator()(
+	coloring<Structure, Paramset> operator()(
 		Structure const & s,
 		InitEnum init_enum,
 		Paramset const & p,
@@ -226,10 +237,8 @@ public:
 		visitor.succ_bfs_levels(bfs_levels);
 		for (std::size_t i = 0; i < th.size(); ++i)
 			th[i].join();
-		std::map<typename Structure::vertex_descriptor, Paramset> res;
-		for (std::size_t i = 0; i < im.res.size(); ++i)
-			res.insert(im.res[i].begin(), im.res[i].end());
-		return res;
+		visitor.succ_idle_times(im.idle_ms);
+		return coloring<Structure, Paramset>(s, std::move(im.res));
 	}
 
 private:
@@ -70,6 +70,30 @@ public:
 		return v.fair;
 	}
 
+	// packed vertices, see coloring.hpp
+	std::size_t key_bits() const
+	{
+		return m_ss.key_bits() + key_bit_width(m_ss.dims()) + 2 * this->offset_bits() + 1;
+	}
+
+	void pack(vertex_descriptor const & v, key_writer & w) const
+	{
+		m_ss.pack(v.vertex, w);
+		w.put(v.dim, key_bit_width(m_ss.dims()));
+		w.put(v.above, this->offset_bits());
+		w.put(v.bellow, this->offset_bits());
+		w.put(v.fair, 1);
+	}
+
+	void unpack(key_reader & r, vertex_descriptor & v) const
+	{
+		m_ss.unpack(r, v.vertex);
+		v.dim = r.get(key_bit_width(m_ss.dims()));
+		v.above = r.get(this->offset_bits());
+		v.bellow = r.get(this->offset_bits());
+		v.fair = r.get(1);
+	}
+
 	class init_enumerator
 	{
 	public:
@@ -125,18 +149,18 @@ public:
 			return m_target;
 		}
 
-		template <typename Tag>
-		void paramset_intersect(paramset<T, Tag> & p) const
+		template <typename Paramset>
+		void paramset_intersect(Paramset & p) const
 		{
 			m_inner.paramset_intersect(p);
 			if (m_target.above + m_target.bellow == 0)
 				return;
 
-			paramset<T, Tag> p_transient;
+			Paramset p_transient;
 			for (std::size_t dim = 0; dim < m_g.m_ss.dims(); ++dim)
 			{
-				paramset<T, Tag> p_down = p;
-				paramset<T, Tag> p_up = p;
+				Paramset p_down = p;
+				Paramset p_up = p;
 
 				auto v = m_target.vertex;
 
@@ -239,6 +263,16 @@ public:
 	{
 		return o << v.m_ss;
 	}
+
+private:
+	// above and bellow never exceed the number of thresholds in a dimension
+	std::size_t offset_bits() const
+	{
+		std::size_t res = 0;
+		for (std::size_t i = 0; i < m_ss.m_thresholds.size(); ++i)
+			res = std::max(res, key_bit_width(m_ss.m_thresholds[i].size() + 1));
+		return res;
+	}
 };
 
 #endif
@@ -1,4 +1,5 @@
 #include "common/distr_reporter.hh"
+#include "common/profile.hh"
 #include <cmath>
 #include <vector>
 #include <string>
@@ -11,7 +12,7 @@ using namespace divine;
 #define TAG_REPORTER_DATA DIVINE_TAG_USER+137 // zmenit; jinam....
 #define TAG_REPORTER_WORKSTATIONS DIVINE_TAG_USER+138 // zmenit; jinam....
 
-const size_int_t divine::distr_reporter_t::BASIC_ITEMS = 6;
+const size_int_t divine::distr_reporter_t::BASIC_ITEMS = 8;
 
 void distr_reporter_t::print_specific_value(ostream & out, const string label,
                                             const size_int_t i)
@@ -70,6 +71,10 @@ void distr_reporter_t::collect()
     {
       cout <<id<<": There were unreceived messages! Probably wrong usage of distributed_t! "<<endl;
     }
+
+  // nobody may send the data below before the check above is done everywhere,
+  // otherwise they could be received (and lost) by process_messages()
+  distributed->network.barrier();
   
   
   double* buf;
@@ -97,6 +102,11 @@ void distr_reporter_t::collect()
   buf[4] = states_stored;
   buf[5] = succs_calls;
 
+  buf[6] = vm_info.getvmpeakrss()/1024.0;
+  size_t sent_bytes;
+  distributed->network.get_all_sent_msgs_size(sent_bytes);
+  buf[7] = sent_bytes;
+
   int pom=0;
   for(map<string,double>::iterator i = specific_info.begin(); i!=specific_info.end(); i++, pom++) {
     buf[BASIC_ITEMS+pom] = (*i).second;
@@ -160,12 +170,16 @@ void distr_reporter_t::print(size_t type_of_output, ostream& out) {
     item_labels[3] = "MsgSentUser";
     item_labels[4] = "StatesStored";
     item_labels[5] = "SuccsCalls";
+    item_labels[6] = "VMPeakRSS"; //in MB as VMSize
+    item_labels[7] = "BytesSent";
     specific_long_name[item_labels[0]] = "Time";
     specific_long_name[item_labels[1]] = "Virtual Mem. Size";
     specific_long_name[item_labels[2]] = "Messages Sent";
     specific_long_name[item_labels[3]] = "User Messages Sent";
     specific_long_name[item_labels[4]] = "States Stored";
     specific_long_name[item_labels[5]] = "Successor func. calls";
+    specific_long_name[item_labels[6]] = "Peak Resident Mem. Size";
+    specific_long_name[item_labels[7]] = "Bytes Sent";
     size_int_t pom = 0;
     for (map<string,double>::iterator i = specific_info.begin();
          i!=specific_info.end(); i++, pom++)
@@ -205,7 +219,7 @@ void distr_reporter_t::print(size_t type_of_output, ostream& out) {
       else if (type_of_output == REPORTER_OUTPUT_NORMAL) {
 	// seq-like output; print only max values of system things
 	// and master info of others
-	if ((i != 2)&&(i !=3)&&(i<BASIC_ITEMS)) { // in short output we do not want messege counts
+	if ((i != 2)&&(i !=3)&&(i != 7)&&(i<BASIC_ITEMS)) { // in short output we do not want messege counts
 	  _set_pr(out, max);
 	  out << item_labels[i] <<":"<<max<<endl;
 	}
@@ -270,13 +284,17 @@ void distr_reporter_t::collect_and_print(size_t type_of_output) {
   out.close();
 }
 
-
-
-
-
-
-
-
-
-
-
+void distr_reporter_t::set_profile_info()
+{
+#if defined(DIVINE_PROFILE)
+  for (int p = 0; p < profiler_t::PROBE_COUNT; p++)
+    {
+      string name = profiler_t::get_probe_name(profiler_t::probe_t(p));
+      set_info("Prof"+name+"Calls", profiler.get_calls(profiler_t::probe_t(p)), REPORTER_SUM);
+      set_info("Prof"+name+"Time", profiler.get_time(profiler_t::probe_t(p)), REPORTER_MAX);
+    }
+  map<string, double> phase_times = profiler.get_phase_times();
+  for (map<string, double>::const_iterator i = phase_times.begin(); i != phase_times.end(); i++)
+    set_info("Phase"+i->first+"Time", i->second, REPORTER_MAX);
+#endif
+}
@@ -123,6 +123,12 @@ namespace divine {
 
     void set_global_info(std::string s, std::string a, const std::string & long_name)
     { set_global_info(s,a); global_long_name[s] = long_name; }
+    //!Sets the totals of \ref profiler (probes and phases) to report.
+    /*!Calls of probes are summed over workstations, times are reported as
+     * maxima. Does nothing unless compiled with DIVINE_PROFILE. All
+     * workstations must have passed the same phases.
+     */
+    void set_profile_info();
 
   }
 ;
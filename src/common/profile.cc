@@ -0,0 +1,146 @@
+#include "common/profile.hh"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+profiler_t divine::profiler;
+
+namespace {
+  const char * PROBE_NAMES[profiler_t::PROBE_COUNT] = {
+    "GetSuccs", "Insert", "IsStored", "Reconstruct",
+    "Flush", "ProcessMessages", "Synchronized"
+  };
+
+  struct open_phase_t
+  {
+    const char * name;
+    uint64_t start;
+  };
+
+  //phases started and not finished by this thread
+  thread_local std::vector<open_phase_t> open_phases;
+  thread_local int thread_id = -1;
+}
+
+profiler_t::profiler_t(): origin(now()), threads(0)
+{
+  for (int p = 0; p < PROBE_COUNT; p++)
+    {
+      calls[p] = 0;
+      time[p] = 0;
+    }
+}
+
+const char * profiler_t::get_probe_name(probe_t _probe)
+{
+  return PROBE_NAMES[_probe];
+}
+
+int profiler_t::thread_index()
+{
+  if (thread_id < 0)
+    thread_id = threads.fetch_add(1);
+  return thread_id;
+}
+
+void profiler_t::begin_phase(const char * _name)
+{
+  open_phase_t phase;
+  phase.name = _name;
+  phase.start = now();
+  open_phases.push_back(phase);
+}
+
+void profiler_t::end_phase()
+{
+  if (open_phases.empty())
+    return;
+
+  phase_t phase;
+  phase.name = open_phases.back().name;
+  phase.start = open_phases.back().start;
+  phase.end = now();
+  phase.thread = thread_index();
+  for (int p = 0; p < PROBE_COUNT; p++)
+    phase.probe_time[p] = time[p].load(std::memory_order_relaxed);
+  open_phases.pop_back();
+
+  std::lock_guard<std::mutex> lock(phases_mutex);
+  phases.push_back(phase);
+}
+
+std::map<std::string, double> profiler_t::get_phase_times() const
+{
+  std::lock_guard<std::mutex> lock(phases_mutex);
+  std::map<std::string, double> result;
+  for (size_t i = 0; i < phases.size(); i++)
+    result[phases[i].name] += (phases[i].end - phases[i].start) / 1e9;
+  return result;
+}
+
+void profiler_t::write_trace(std::ostream & _out, int _pid) const
+{
+  std::lock_guard<std::mutex> lock(phases_mutex);
+
+  //times are in microseconds since the construction of the profiler
+  _out << "{\"traceEvents\":[" << std::endl;
+  _out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << _pid
+       << ",\"args\":{\"name\":\"workstation " << _pid << "\"}}";
+  for (size_t i = 0; i < phases.size(); i++)
+    {
+      const phase_t & phase = phases[i];
+      _out << "," << std::endl
+           << "{\"name\":\"" << phase.name << "\",\"cat\":\"phase\",\"ph\":\"X\""
+           << ",\"ts\":" << (phase.start - origin) / 1000
+           << ",\"dur\":" << (phase.end - phase.start) / 1000
+           << ",\"pid\":" << _pid << ",\"tid\":" << phase.thread << "}";
+      //cumulative times of probes (in ms) as counters
+      _out << "," << std::endl
+           << "{\"name\":\"probes\",\"ph\":\"C\",\"ts\":" << (phase.end - origin) / 1000
+           << ",\"pid\":" << _pid << ",\"args\":{";
+      for (int p = 0; p < PROBE_COUNT; p++)
+        _out << (p ? "," : "") << "\"" << PROBE_NAMES[p] << "\":"
+             << phase.probe_time[p] / 1000000;
+      _out << "}}";
+    }
+  _out << std::endl << "],\"otherData\":{";
+  for (int p = 0; p < PROBE_COUNT; p++)
+    _out << (p ? "," : "") << "\"" << PROBE_NAMES[p] << "Calls\":" << calls[p].load()
+         << ",\"" << PROBE_NAMES[p] << "Time\":" << get_time(probe_t(p));
+  _out << "}}" << std::endl;
+}
+
+void profiler_t::write_trace_file(const std::string & _base, int _pid) const
+{
+  std::ostringstream file_name;
+  file_name << _base << ".trace." << _pid << ".json";
+  std::ofstream out(file_name.str().c_str());
+  write_trace(out, _pid);
+}
+
+void profiler_t::write_summary(std::ostream & _out) const
+{
+  _out << std::left << std::setw(20) << "probe" << std::right
+       << std::setw(14) << "calls" << std::setw(12) << "time [s]"
+       << std::setw(12) << "avg [us]" << std::endl;
+  for (int p = 0; p < PROBE_COUNT; p++)
+    {
+      uint64_t c = calls[p].load();
+      _out << std::left << std::setw(20) << PROBE_NAMES[p] << std::right
+           << std::setw(14) << c << std::setw(12) << std::fixed << std::setprecision(3)
+           << get_time(probe_t(p)) << std::setw(12)
+           << (c ? get_time(probe_t(p)) * 1e6 / c : 0.0) << std::endl;
+    }
+
+  std::map<std::string, double> phase_times = get_phase_times();
+  for (std::map<std::string, double>::const_iterator i = phase_times.begin();
+       i != phase_times.end(); i++)
+    _out << std::left << std::setw(20) << i->first << std::right
+         << std::setw(26) << i->second << "  (phase)" << std::endl;
+  _out.unsetf(std::ios::floatfield);
+  _out << std::setprecision(6);
+}
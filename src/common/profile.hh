@@ -0,0 +1,160 @@
+/*!\file
+ * The main contribution of this file is the class profiler_t - timers and
+ * counters of hot paths of the library and a timeline of phases of
+ * algorithms.
+ *
+ * The instrumentation is compiled in only if DIVINE_PROFILE is defined
+ * (configure --enable-profile). Otherwise the macros DIVINE_PROFILE_SCOPE,
+ * DIVINE_PROFILE_BEGIN and DIVINE_PROFILE_END expand to nothing and the
+ * instrumented code is exactly the same as without them.
+ */
+#ifndef DIVINE_PROFILE_HH
+#define DIVINE_PROFILE_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <time.h>
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+//!Timers and counters of hot paths and a timeline of phases
+/*!Hot paths (see probe_t) are measured by DIVINE_PROFILE_SCOPE placed at
+ * the beginning of the instrumented function - every call adds one to the
+ * counter of the probe and its duration to the time of the probe. The
+ * probes may be used by several threads at once.
+ *
+ * Phases of algorithms are marked by DIVINE_PROFILE_BEGIN(name) and
+ * DIVINE_PROFILE_END(). Phases may be nested, a phase must end in the
+ * thread that has started it. Every finished phase is kept for the
+ * timeline together with the times of probes at its end.
+ *
+ * write_trace() exports the timeline in the Chrome trace format (JSON, to
+ * be opened by chrome://tracing or Perfetto), write_summary() prints the
+ * totals of probes and phases. distr_reporter_t::set_profile_info() adds
+ * the totals to the report merged over all workstations.
+ *
+ * There is one global instance - profiler.
+ */
+class profiler_t
+{
+public:
+  //!Instrumented hot paths
+  enum probe_t
+  {
+    PROBE_GET_SUCCS,          //!< explicit_system_t::get_succs() of affine systems
+    PROBE_STORAGE_INSERT,     //!< explicit_storage_t::insert()
+    PROBE_STORAGE_IS_STORED,  //!< explicit_storage_t::is_stored()
+    PROBE_STORAGE_RECONSTRUCT,//!< explicit_storage_t::reconstruct()
+    PROBE_NET_FLUSH,          //!< network_t::flush_buffer()
+    PROBE_PROCESS_MESSAGES,   //!< distributed_t::process_messages()
+    PROBE_SYNCHRONIZED,       //!< distributed_t::synchronized()
+    PROBE_COUNT
+  };
+
+  //!A constructor - the timeline starts now
+  profiler_t();
+
+  //!Returns the time of a monotonic clock in nanoseconds
+  static uint64_t now()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+  //!Counts one call of _probe that took _ns nanoseconds
+  void add(probe_t _probe, uint64_t _ns)
+  {
+    calls[_probe].fetch_add(1, std::memory_order_relaxed);
+    time[_probe].fetch_add(_ns, std::memory_order_relaxed);
+  }
+
+  //!Starts a phase called _name (the name is not copied)
+  void begin_phase(const char * _name);
+
+  //!Ends the last phase started by the calling thread
+  void end_phase();
+
+  //!Returns the number of calls of _probe
+  uint64_t get_calls(probe_t _probe) const { return calls[_probe].load(); }
+
+  //!Returns the time spent in _probe in seconds
+  double get_time(probe_t _probe) const { return time[_probe].load() / 1e9; }
+
+  //!Returns the name of _probe (an identifier)
+  static const char * get_probe_name(probe_t _probe);
+
+  //!Returns the total time of finished phases in seconds by their names
+  std::map<std::string, double> get_phase_times() const;
+
+  //!Writes the timeline in the Chrome trace format
+  /*!_pid identifies the process (the workstation) in the trace, so the
+   * events of traces of several workstations can be put together.*/
+  void write_trace(std::ostream & _out, int _pid) const;
+
+  //!Writes the timeline to the file _base.trace._pid.json
+  void write_trace_file(const std::string & _base, int _pid) const;
+
+  //!Writes the totals of probes and phases
+  void write_summary(std::ostream & _out) const;
+
+protected:
+  struct phase_t
+  {
+    const char * name;
+    int thread;
+    uint64_t start;
+    uint64_t end;
+    uint64_t probe_time[PROBE_COUNT];
+  };
+
+  int thread_index();
+
+  uint64_t origin;
+  std::atomic<uint64_t> calls[PROBE_COUNT];
+  std::atomic<uint64_t> time[PROBE_COUNT];
+  std::atomic<int> threads;
+
+  mutable std::mutex phases_mutex;
+  std::vector<phase_t> phases;
+};
+
+//!The global profiler
+extern profiler_t profiler;
+
+//!Measures one call of a probe - from the construction to the destruction
+class profile_scope_t
+{
+public:
+  profile_scope_t(profiler_t::probe_t _probe): probe(_probe), start(profiler_t::now()) {}
+  ~profile_scope_t() { profiler.add(probe, profiler_t::now() - start); }
+
+private:
+  profiler_t::probe_t probe;
+  uint64_t start;
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#if defined(DIVINE_PROFILE)
+#define DIVINE_PROFILE_SCOPE(probe) \
+  divine::profile_scope_t divine_profile_scope(divine::profiler_t::probe)
+#define DIVINE_PROFILE_BEGIN(name) divine::profiler.begin_phase(name)
+#define DIVINE_PROFILE_END() divine::profiler.end_phase()
+#else
+#define DIVINE_PROFILE_SCOPE(probe)
+#define DIVINE_PROFILE_BEGIN(name)
+#define DIVINE_PROFILE_END()
+#endif
+
+#endif
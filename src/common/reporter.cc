@@ -20,6 +20,7 @@ void reporter_t::print(ostream& out) {
   vm_info.scan();
   out <<setprecision(0);
   out << "VMsize:"<< vm_info.vmsize/1024.0 << endl;  //vm_info.vmsize is in kB, we want MB, thus "/1024.0"
+  out << "VMPeakRSS:"<< vm_info.getvmpeakrss()/1024.0 << endl;
   //  out << "Memory (VM RSS):\t"<< vm_info.vmrss<<endl;
   //  out << "Memory (VM data):\t"<< vm_info.vmdata<<endl;
   for(map<string,double>::iterator i = specific_info.begin(); i!=specific_info.end(); i++) {
@@ -112,6 +112,32 @@ int vminfo_t::getvmrss()
   return vmrss;
 }
 
+int vminfo_t::getvmpeakrss()
+{
+  int peak = 0;
+#if defined(__linux__)
+  // VmHWM is not at a fixed line of the status file, scan() cannot read it
+  char line[1000];
+  FILE *statusfile;
+  if ((statusfile = fopen (filename,"r")) != NULL) {
+      while (fgets (line, sizeof line, statusfile))
+          if (sscanf (line, "VmHWM:%d kB", &peak) == 1)
+              break;
+      fclose(statusfile);
+  }
+#endif
+  if (peak == 0) {
+      struct rusage rusage;
+      if (getrusage (RUSAGE_SELF, &rusage) == 0)
+#ifdef __APPLE__
+          peak = rusage.ru_maxrss / 1024; //in bytes on OS X
+#else
+          peak = rusage.ru_maxrss;
+#endif
+  }
+  return peak;
+}
+
 // }}}
 // {{{ timeinfo  
 timeinfo_t::timeinfo_t()
@@ -41,6 +41,7 @@ public:
   int getvmsize();
   int getvmrss();
   int getvmdata();
+  int getvmpeakrss(); //peak resident set size (in kB) since the start
   void print();
 };
 
@@ -1,10 +1,22 @@
 #include <iostream>
 #include <stdexcept>
 #include <string.h>
+#include <sys/time.h>
 #include "distributed/distributed.hh"
+#include "common/profile.hh"
 
 using namespace divine;
 
+//! Number of children of a workstation in the synchronization tree
+static const int SYNC_TREE_ARITY = 4;
+
+static double sync_clock(void)
+{
+  timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
 distributed_t::distributed_t(error_vector_t& arg0):errvec(arg0)
 {
   mode = PRE_INIT;
@@ -12,8 +24,11 @@ distributed_t::distributed_t(error_vector_t& arg0):errvec(arg0)
   network_id = -1;
   process_user_message = NULL;
   process_message_functor = 0;
+  partitioner = NULL;
 
   fsync_state = -1;
+  fsync_tree_phase = -1;
+  fsync_tree_pending = 0;
   finfo_exchange = false;
   fproc_msgs_buf_exclusive_mem = false;
   fstatistics = NULL;
@@ -55,6 +70,9 @@ void distributed_t::initialize()
       network.initialize_buffers();
 
       fstat_all_sync_barriers_cnt = 0;
+      fstat_all_sync_rounds_cnt = 0;
+      fstat_all_sync_rounds_time = 0;
+      fsync_round_start = 0;
       fstatistics = new vector<distr_stat_t>(cluster_size);
 
       for (i=0; i<cluster_size; i++)
@@ -260,6 +278,26 @@ int distributed_t::get_all_sync_barriers_cnt(void)
   return fstat_all_sync_barriers_cnt;
 }
 
+int distributed_t::get_all_sync_rounds_cnt(void)
+{
+  if (mode != NORMAL)
+    {
+      errvec << "Something is not properly initialized" << thr(DISTRIBUTED_ERR_TYPE);
+    }
+
+  return fstat_all_sync_rounds_cnt;
+}
+
+double distributed_t::get_all_sync_rounds_time(void)
+{
+  if (mode != NORMAL)
+    {
+      errvec << "Something is not properly initialized" << thr(DISTRIBUTED_ERR_TYPE);
+    }
+
+  return fstat_all_sync_rounds_time;
+}
+
 void distributed_t::set_busy(void)
 {
   if (mode != NORMAL)
@@ -300,6 +338,19 @@ void distributed_t::set_hash_function(hash_functions_t hf)
   hasher.set_hash_function(hf);
 }
 
+void distributed_t::set_partitioner(partitioner_t *p)
+{
+  partitioner = p;
+}
+
+string distributed_t::get_partitioner_name(void) const
+{
+  if (partitioner)
+    return partitioner->get_name();
+  else
+    return "hash";
+}
+
 int distributed_t::partition_function(state_t &state)
 {
   if (mode != NORMAL)
@@ -309,6 +360,8 @@ int distributed_t::partition_function(state_t &state)
   
   if (cluster_size == 1)
     return 0;
+  else if (partitioner)
+    return partitioner->get_owner(state);
   else {
     size_t len = state.size;
     unsigned char *data = reinterpret_cast<unsigned char*>(state.ptr);
@@ -340,8 +393,200 @@ void distributed_t::force_poll(void)
 }
 #endif /* ! ORIG_POLL */
 
+void distributed_t::get_user_msgs_cnt(int &sent, int &received)
+{
+  network.get_all_sent_msgs_cnt(sent);
+  network.get_all_received_msgs_cnt(received);
+
+  // synchronization messages themselves are left out, so that two waves
+  // of the tree can be compared directly
+  sent -= get_all_sent_sync_msgs_cnt();
+  received -= get_all_received_sync_msgs_cnt();
+}
+
+void distributed_t::sync_round_started(void)
+{
+  fstat_all_sync_rounds_cnt += 1;
+  fsync_round_start = sync_clock();
+}
+
+void distributed_t::sync_round_finished(void)
+{
+  fstat_all_sync_rounds_time += sync_clock() - fsync_round_start;
+}
+
+/* Tree synchronization
+ *
+ * The manager starts a wave, which goes down the tree of workstations
+ * (workstation i has children arity * i + 1, ..., arity * i + arity).
+ * Every workstation reports to its parent the numbers of user messages sent
+ * and received in its subtree as soon as all its children have reported,
+ * together with a flag telling whether some of the workstations was busy.
+ * The manager declares termination after two consecutive waves in which
+ * nobody was busy and all the numbers of messages were equal. The data
+ * of the info are collected during the second wave (each workstation adds
+ * its own contribution and merges those of its children) and the manager
+ * distributes the result down the tree in the completion message.
+ */
+void distributed_t::sync_tree_wave(int phase)
+{
+  int first = SYNC_TREE_ARITY * network_id + 1;
+
+  fsync_tree_phase = phase;
+  fsync_tree_pending = 0;
+  sync_tree_collector.sent_msgs = 0;
+  sync_tree_collector.received_msgs = 0;
+  sync_tree_collector.refused = 0;
+
+  if (phase == DIVINE_TAG_SYNC_TWO && finfo_exchange)
+    {
+      pinfo->update_local();
+    }
+
+  for (int i = first; i < first + SYNC_TREE_ARITY && i < cluster_size; i++)
+    {
+      network.send_urgent_message(static_cast<char *>(static_cast<void *>(&phase)),
+				  sizeof(phase), i, DIVINE_TAG_SYNC_TREE_WAVE);
+
+      (*fstatistics)[i].all_sent_sync_msgs_cnt += 1;
+      fsync_tree_pending += 1;
+    }
+
+  if (fsync_tree_pending == 0)
+    {
+      sync_tree_report();
+    }
+}
+
+void distributed_t::sync_tree_receive_report(int size, int src, int tag)
+{
+  sync_tree_data_t child;
+
+  if (fsync_tree_phase == DIVINE_TAG_SYNC_TWO && finfo_exchange)
+    {
+      network.receive_urgent_message(sync_sr_buf, size, src, tag);
+
+      memcpy(&child, sync_sr_buf, sizeof(child));
+      pinfo->merge(sync_sr_buf + sizeof(child));
+    }
+  else
+    {
+      network.receive_urgent_message(static_cast<char *>(static_cast<void *>(&child)),
+				     size, src, tag);
+    }
+
+  (*fstatistics)[src].all_received_sync_msgs_cnt += 1;
+
+  if (fsync_tree_phase < 0)
+    {
+      errvec << "Received DIVINE_TAG_SYNC_TREE_REPORT when shouldn't have!"
+	     << thr(DISTRIBUTED_ERR_TYPE);
+    }
+
+  sync_tree_collector.sent_msgs += child.sent_msgs;
+  sync_tree_collector.received_msgs += child.received_msgs;
+  sync_tree_collector.refused |= child.refused;
+
+  if (--fsync_tree_pending == 0)
+    {
+      sync_tree_report();
+    }
+}
+
+void distributed_t::sync_tree_report(void)
+{
+  int sent_msgs, recved_msgs;
+  int phase = fsync_tree_phase;
+
+  get_user_msgs_cnt(sent_msgs, recved_msgs);
+
+  sync_tree_collector.sent_msgs += sent_msgs;
+  sync_tree_collector.received_msgs += recved_msgs;
+  if (fbusy || fsync_state < 0)
+    {
+      sync_tree_collector.refused = 1;
+    }
+
+  fsync_tree_phase = -1;
+
+  if (network_id != NETWORK_ID_MANAGER)
+    {
+      int send_to = (network_id - 1) / SYNC_TREE_ARITY;
+
+      if (phase == DIVINE_TAG_SYNC_TWO && finfo_exchange)
+	{
+	  memcpy(sync_sr_buf, &sync_tree_collector, sizeof(sync_tree_collector));
+	  memcpy(sync_sr_buf + sizeof(sync_tree_collector), ptr_info_data,
+		 info_data_size);
+
+	  network.send_urgent_message(sync_sr_buf,
+				      sizeof(sync_tree_collector) + info_data_size,
+				      send_to, DIVINE_TAG_SYNC_TREE_REPORT);
+	}
+      else
+	{
+	  network.send_urgent_message(static_cast<char *>
+				      (static_cast<void *> (&sync_tree_collector)),
+				      sizeof(sync_tree_collector),
+				      send_to, DIVINE_TAG_SYNC_TREE_REPORT);
+	}
+
+      (*fstatistics)[send_to].all_sent_sync_msgs_cnt += 1;
+      return;
+    }
+
+  sync_round_finished();
+
+  bool idle = !sync_tree_collector.refused &&
+    sync_tree_collector.sent_msgs == sync_tree_collector.received_msgs;
+
+  if (phase == DIVINE_TAG_SYNC_ONE && idle)
+    {
+      sync_one_result.sent_msgs = sync_tree_collector.sent_msgs;
+      sync_one_result.received_msgs = sync_tree_collector.received_msgs;
+
+      fsync_state = DIVINE_TAG_SYNC_TWO;
+      sync_round_started();
+      sync_tree_wave(DIVINE_TAG_SYNC_TWO);
+    }
+  else if (phase == DIVINE_TAG_SYNC_TWO && idle &&
+	   sync_tree_collector.sent_msgs == sync_one_result.sent_msgs)
+    {
+      fsync_state = DIVINE_TAG_SYNC_COMPLETION;
+      sync_tree_complete();
+    }
+  else
+    {
+      fsync_state = DIVINE_TAG_SYNC_READY;
+    }
+}
+
+void distributed_t::sync_tree_complete(void)
+{
+  int first = SYNC_TREE_ARITY * network_id + 1;
+  int dummy = 0;
+  char *sbuf = static_cast<char *>(static_cast<void *>(&dummy));
+  int ssize = sizeof(dummy);
+
+  if (finfo_exchange)
+    {
+      sbuf = ptr_info_data;
+      ssize = info_data_size;
+    }
+
+  for (int i = first; i < first + SYNC_TREE_ARITY && i < cluster_size; i++)
+    {
+      network.send_urgent_message(sbuf, ssize, i, DIVINE_TAG_SYNC_TREE_COMPLETION);
+
+      (*fstatistics)[i].all_sent_sync_msgs_cnt += 1;
+    }
+
+  fsynchronized = true;
+}
+
 void distributed_t::process_messages(void)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_PROCESS_MESSAGES);
   int size, src, tag;
   bool flag, some_new_msgs = false;
   char *buf;
@@ -466,6 +711,8 @@ void distributed_t::process_messages(void)
 		      
 			if (network_id == NETWORK_ID_MANAGER)
 			  {
+			    sync_round_finished();
+
 			    // + 1 takes the precious receive into account
 			    if (!fbusy && 
 				sync_collector.received_msgs + 1 == sync_collector.sent_msgs)
@@ -473,6 +720,7 @@ void distributed_t::process_messages(void)
 				sync_one_result = sync_collector;
 				
 				fsync_state = DIVINE_TAG_SYNC_TWO;
+				sync_round_started();
 				
 				network.get_all_sent_msgs_cnt(sent_msgs);
 				network.get_all_received_msgs_cnt(recved_msgs);
@@ -619,6 +867,8 @@ void distributed_t::process_messages(void)
 
 			if (network_id == NETWORK_ID_MANAGER)
 			  {
+			    sync_round_finished();
+
 			    // + 1 takes the previous receive into account
 			    if (!fbusy && 
 				sync_collector.received_msgs + 1 == sync_collector.sent_msgs &&
@@ -844,6 +1094,52 @@ void distributed_t::process_messages(void)
 		      }
 		    break;
 		  }
+		case DIVINE_TAG_SYNC_TREE_WAVE:
+		  {
+		    int phase;
+
+		    network.receive_urgent_message(static_cast<char *>(static_cast<void *>
+								       (&phase)),
+						   size, src, tag);
+
+		    (*fstatistics)[src].all_received_sync_msgs_cnt += 1;
+
+		    sync_tree_wave(phase);
+		    break;
+		  }
+		case DIVINE_TAG_SYNC_TREE_REPORT:
+		  {
+		    sync_tree_receive_report(size, src, tag);
+		    break;
+		  }
+		case DIVINE_TAG_SYNC_TREE_COMPLETION:
+		  {
+		    if (fsync_state >= 0)
+		      {
+			if (!finfo_exchange)
+			  {
+			    int dummy;
+
+			    network.receive_urgent_message(static_cast<char *>
+							   (static_cast<void *>(&dummy)),
+							   size, src, tag);
+			  }
+			else
+			  {
+			    network.receive_urgent_message(ptr_info_data, size, src, tag);
+			  }
+
+			(*fstatistics)[src].all_received_sync_msgs_cnt += 1;
+
+			sync_tree_complete();
+		      }
+		    else
+		      {
+			errvec << "Received DIVINE_TAG_SYNC_TREE_COMPLETION when shouldn't have!"
+			       << thr(DISTRIBUTED_ERR_TYPE);
+		      }
+		    break;
+		  }
 		default:
 		  {
 		    errvec << "Unprocessed urgent internal message!" << thr(DISTRIBUTED_ERR_TYPE);
@@ -960,6 +1256,14 @@ void distributed_t::process_messages(void)
       distr_sync_skipped = 100;
 #endif
       fsync_state = DIVINE_TAG_SYNC_ONE;
+      sync_round_started();
+
+      // the ring is needed only for infos that cannot be merged
+      if (!finfo_exchange || pinfo->mergeable())
+	{
+	  sync_tree_wave(DIVINE_TAG_SYNC_ONE);
+	  return;
+	}
 
       network.get_all_sent_msgs_cnt(sent_msgs);
       network.get_all_received_msgs_cnt(recved_msgs);
@@ -981,6 +1285,7 @@ void distributed_t::process_messages(void)
 
 bool distributed_t::synchronized(void)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_SYNCHRONIZED);
   if (mode != NORMAL)
     {
       errvec << "Something is not properly initialized" << thr(DISTRIBUTED_ERR_TYPE);
@@ -1013,6 +1318,7 @@ bool distributed_t::synchronized(void)
 
 bool distributed_t::synchronized(abstract_info_t &info)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_SYNCHRONIZED);
   if (mode != NORMAL)
     {
       errvec << "Something is not properly initialized" << thr(DISTRIBUTED_ERR_TYPE);
@@ -1030,7 +1336,8 @@ bool distributed_t::synchronized(abstract_info_t &info)
 			 << thr(DISTRIBUTED_ERR_TYPE);
 		}
 
-      sync_sr_buf = new char[sizeof(sync_collector) + info_data_size];
+      // the header of tree messages is the larger one
+      sync_sr_buf = new char[sizeof(sync_tree_collector) + info_data_size];
 
       finfo_exchange = true;
     }
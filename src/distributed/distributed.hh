@@ -5,9 +5,12 @@
 
 #ifndef DOXYGEN_PROCESSING
 #include <string>
+#include <cstring>
+#include <type_traits>
 #include "common/error.hh"
 #include "system/state.hh"
 #include "distributed/network.hh"
+#include "distributed/partitioner.hh"
  
 #define DISTRIBUTED_ERR_TYPE 12
 
@@ -25,6 +28,12 @@ namespace divine {
   const int DIVINE_TAG_SYNC_TWO = 2;
   //! Constant used internaly, of no relevance to user of distributed_t
   const int DIVINE_TAG_SYNC_COMPLETION = 3;
+  //! Constant used internaly, of no relevance to user of distributed_t
+  const int DIVINE_TAG_SYNC_TREE_WAVE = 4;
+  //! Constant used internaly, of no relevance to user of distributed_t
+  const int DIVINE_TAG_SYNC_TREE_REPORT = 5;
+  //! Constant used internaly, of no relevance to user of distributed_t
+  const int DIVINE_TAG_SYNC_TREE_COMPLETION = 6;
   //! All messages sent by user must have tags greater or equal to this constant.
   const int DIVINE_TAG_USER = 144;
 
@@ -37,6 +46,13 @@ namespace divine {
   class abstract_info_t {
   public:
     virtual void update(void) {}
+    //! Sets the data to the contribution of the calling workstation alone
+    virtual void update_local(void) {}
+    //! Adds data collected on another part of the cluster to the data
+    virtual void merge(const char *other) {}
+    //! Whether the data can be collected along a tree (using update_local()
+    //! and merge()) instead of the ring of workstations
+    virtual bool mergeable(void) { return false; }
     virtual void get_data_ptr(char *&ptr) = 0;
     virtual void get_data_size(int &size) = 0;
     virtual ~abstract_info_t() {}
@@ -46,6 +62,26 @@ namespace divine {
   struct no_const_data_type_t {
     int x;
   };
+
+  //! Tells whether \a T has a merge() function, used internaly
+  template <class T>
+  class has_merge_t {
+    template <class U> static char test(decltype(&U::merge));
+    template <class U> static long test(...);
+  public:
+    static const bool value = sizeof(test<T>(0)) == 1;
+  };
+
+  template <class T>
+  void merge_info_data(T &data, const char *other, std::true_type)
+  {
+    T o;
+    memcpy(static_cast<void *>(&o), other, sizeof(T));
+    data.merge(o);
+  }
+
+  template <class T>
+  void merge_info_data(T &, const char *, std::false_type) {}
   
   //! Class used to collect data during synchronization
   /*! Instances of this class are passed to distributed_t::synchronized(abstract_info_t &info)
@@ -58,6 +94,11 @@ namespace divine {
    *
    *  The word "updateable" means that each workstation can change the data being collected
    *  during the synchronization process (by calling the update() function).
+   *
+   *  If the type also has a "void merge(const updateable_data_t &other)" function,
+   *  the data are collected along a tree of workstations: update() is called on
+   *  value-initialized data on every workstation and the results of subtrees are
+   *  combined by merge().
    *  For more information see distributed_t::synchronized(abstract_info_t &info) function.*/
   template <class updateable_data_t, class constant_data_t = no_const_data_type_t>
   class updateable_info_t : public abstract_info_t {
@@ -68,6 +109,9 @@ namespace divine {
     //! Structure that stores collected data
     updateable_data_t data;
     virtual void update(void);
+    virtual void update_local(void);
+    virtual void merge(const char *other);
+    virtual bool mergeable(void) { return has_merge_t<updateable_data_t>::value; }
     virtual void get_data_ptr(char *&ptr);
     virtual void get_data_size(int &size);
     virtual ~updateable_info_t() {}
@@ -84,6 +128,11 @@ namespace divine {
    *
    *  The word "updateable" means that each workstation can change the data being collected
    *  during the synchronization process (by calling the update() function).
+   *
+   *  If the type also has a "void merge(const updateable_data_t &other)" function,
+   *  the data are collected along a tree of workstations: update() is called on
+   *  value-initialized data on every workstation and the results of subtrees are
+   *  combined by merge().
    *  For more information see distributed_t::synchronized(abstract_info_t &info) function.*/
   template <class updateable_data_t>
   class updateable_info_t<updateable_data_t, no_const_data_type_t>: public abstract_info_t {
@@ -91,6 +140,9 @@ namespace divine {
     //! Structure that stores collected data
     updateable_data_t data;
     virtual void update(void);
+    virtual void update_local(void);
+    virtual void merge(const char *other);
+    virtual bool mergeable(void) { return has_merge_t<updateable_data_t>::value; }
     virtual void get_data_ptr(char *&ptr);
     virtual void get_data_size(int &size);
     virtual ~updateable_info_t() {}
@@ -111,6 +163,8 @@ namespace divine {
   private:
     static_data_t data;
   public:
+    // the data of the manager are distributed, so they need no merging
+    virtual bool mergeable(void) { return true; }
     virtual void get_data_ptr(char *&ptr); 
     virtual void get_data_size(int &size);
     virtual ~static_info_t() {}
@@ -147,6 +201,9 @@ namespace divine {
     abstract_info_t *pinfo;
 
     int fstat_all_sync_barriers_cnt;
+    int fstat_all_sync_rounds_cnt;
+    double fstat_all_sync_rounds_time;
+    double fsync_round_start;
     vector<distr_stat_t> *fstatistics;
 
     int* tmp_buf_cl_size;
@@ -163,7 +220,22 @@ namespace divine {
     struct sync_data_t {int sent_msgs; int received_msgs; };
     sync_data_t sync_one_result, sync_collector;
 
+    // tree synchronization: the workstation i reports to (i - 1) / arity
+    struct sync_tree_data_t {int sent_msgs; int received_msgs; int refused; };
+    sync_tree_data_t sync_tree_collector;
+    int fsync_tree_phase;
+    int fsync_tree_pending;
+
+    void get_user_msgs_cnt(int &sent, int &received);
+    void sync_round_started(void);
+    void sync_round_finished(void);
+    void sync_tree_wave(int phase);
+    void sync_tree_receive_report(int size, int src, int tag);
+    void sync_tree_report(void);
+    void sync_tree_complete(void);
+
     hash_function_t hasher;
+    partitioner_t *partitioner;
 
   public:
     network_t network; //!< instance of network_t, you can use it to send/receive messages, etc.
@@ -244,6 +316,14 @@ namespace divine {
     //! Get all synchronization barriers count
     /*! \return Number of synchronization barriers on the calling workstation.*/
     int get_all_sync_barriers_cnt(void);
+    //! Get all synchronization rounds count
+    /*! \return Number of rounds of termination detection started by the calling
+     *  workstation (non-zero on the manager workstation only).*/
+    int get_all_sync_rounds_cnt(void);
+    //! Get time spent in synchronization rounds
+    /*! \return Total duration (in seconds) of the rounds counted by
+     *  get_all_sync_rounds_cnt().*/
+    double get_all_sync_rounds_time(void);
 
     //! Avoids synchronization
     /*! This method must be called before process_messages() to be effective. */
@@ -274,6 +354,16 @@ namespace divine {
     //! Sets hash function to be used for partitioning.
     void set_hash_function(hash_functions_t);
 
+    //! Sets the partition function
+    /*! \param p - the partition function, NULL restores the default one (hashing
+     *              of the whole state). It is not deleted by distributed_t.
+     *
+     *  The same partition function must be set on all workstations before
+     *  the first state is sent.*/
+    void set_partitioner(partitioner_t *p);
+    //! Returns a short description of the partition function in use
+    string get_partitioner_name(void) const;
+
     //! Function to determine owner of a state.
     /*!\param state = a state, which association with a computer is to be retrieved
      * \return computer unique identifier of the state owner
@@ -353,7 +443,13 @@ namespace divine {
      *  sends the contents of the structure to workstation 1, workstation 1 sends it 
      *  to workstation 2, etc. The last workstation then completes the round.
      *  On every workstation the update() function is called, which can manipulate
-     *  with the attributes.*/
+     *  with the attributes.
+     *
+     *  If the info is mergeable (see abstract_info_t::mergeable()), both the
+     *  termination detection and the collection of data run along a tree
+     *  of workstations instead, so a round takes a logarithmic number of steps
+     *  in the size of the cluster. The synchronized() function without info
+     *  always uses the tree.*/
     bool synchronized(abstract_info_t &info);
   };
 
@@ -363,6 +459,20 @@ namespace divine {
     data.update();
   }
 
+  template <class updateable_data_t>
+  void updateable_info_t<updateable_data_t, no_const_data_type_t>::update_local()
+  {
+    data = updateable_data_t();
+    data.update();
+  }
+
+  template <class updateable_data_t>
+  void updateable_info_t<updateable_data_t, no_const_data_type_t>::merge(const char *other)
+  {
+    merge_info_data(data, other,
+		    std::integral_constant<bool, has_merge_t<updateable_data_t>::value>());
+  }
+
   template <class updateable_data_t>
   void updateable_info_t<updateable_data_t, no_const_data_type_t>::get_data_ptr(char *&ptr)
   {
@@ -381,6 +491,20 @@ namespace divine {
     data.update(const_data);
   }
 
+  template <class updateable_data_t, class constant_data_t>
+  void updateable_info_t<updateable_data_t, constant_data_t>::update_local()
+  {
+    data = updateable_data_t();
+    data.update(const_data);
+  }
+
+  template <class updateable_data_t, class constant_data_t>
+  void updateable_info_t<updateable_data_t, constant_data_t>::merge(const char *other)
+  {
+    merge_info_data(data, other,
+		    std::integral_constant<bool, has_merge_t<updateable_data_t>::value>());
+  }
+
   template <class updateable_data_t, class constant_data_t>
   void updateable_info_t<updateable_data_t, constant_data_t>::get_data_ptr(char *&ptr)
   {
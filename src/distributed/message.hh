@@ -4,6 +4,7 @@
  * Network support unit header*/
 
 #ifndef DOXYGEN_PROCESSING
+#include <cstring>
 #include "common/types.hh"
 #include "system/state.hh"
 #include "storage/explicit_storage.hh"
@@ -144,6 +145,22 @@ class message_t
    * for a deallocation of written state.ptr.
    */ 
   void read_state(state_t & state);
+  //!Reads a state stored by append_state() at `buf' without copying it
+  /*!\param buf = the data of a received message beginning with a state
+   * (e.g. the buffer passed to a message processing function)
+   * \param state = the state which will point to the memory of \a buf
+   * \return the pointer to the data following the state
+   *
+   * \warning The state must not be deallocated and it is valid only as
+   * long as \a buf is valid.
+   */
+  static const byte_t * read_state_in_place(const byte_t * const buf,
+                                            state_t & state)
+  {
+    memcpy(&state.size, buf, sizeof(size_t));
+    state.ptr = (char *)(buf + sizeof(size_t));
+    return buf + sizeof(size_t) + state.size;
+  }
   //!Copies a reference to state stored in the message to `ref'
   void read_state_ref(state_ref_t & ref);
   //!Copies a flag from the message to `flag'
@@ -4,6 +4,7 @@
 #include <string.h>
 #include "distributed/network.hh"
 #include "distributed/distributed.hh"
+#include "common/profile.hh"
   
   using namespace divine;
   
@@ -148,6 +149,7 @@ network_t::network_t(error_vector_t& arg0):errvec(arg0)
   tmp_sbuf = NULL;
   tmp_rbuf = NULL;
   tmp_buf_cl_size = NULL;
+  fbegun_sb = NULL;
 }
 
 network_t::~network_t()
@@ -695,6 +697,21 @@ bool network_t::get_all_sent_msgs_cnt(int& cnt)
   return true;
 }
 
+bool network_t::get_all_sent_msgs_size(size_t& size)
+{
+  // Throw error if not initialized
+  if (!finitialized)
+    {
+      flast_net_rc = NET_ERR_NOT_INITIALIZED;
+      errvec << net_err_msgs[flast_net_rc].message << thr(net_err_msgs[flast_net_rc].type);
+      return false;
+    }
+
+  size = fstat_sent_messages_size + fstat_sent_urgent_messages_size;
+
+  return true;
+}
+
 bool network_t::get_all_received_msgs_cnt(int& cnt)
 {
   // Throw error if not initialized
@@ -1083,7 +1100,8 @@ bool network_t::abort(void)
 static int nqueued_max;
 #endif
 
-bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urgent)
+network_t::net_send_buffer_t *network_t::prepare_send_buffer(int size, int dest, int tag,
+							  bool urgent)
 {
   net_send_buffer_t *sb, *tmpsb;
   int flag;
@@ -1099,7 +1117,7 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
     {
       flast_net_rc = NET_ERR_NOT_INITIALIZED;
       errvec << net_err_msgs[flast_net_rc].message << thr(net_err_msgs[flast_net_rc].type);
-      return false;
+      return NULL;
     }
    
   // Throw error if msg size exceeds permitted limit
@@ -1107,7 +1125,7 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
     {
       flast_net_rc = NET_ERR_INVALID_MSG_SIZE;
       errvec << net_err_msgs[flast_net_rc].message << thr(net_err_msgs[flast_net_rc].type);
-      return false;
+      return NULL;
     }
 
   // Throw error if destination does not exist
@@ -1115,7 +1133,7 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
     {
       flast_net_rc = NET_ERR_INVALID_DESTINATION;
       errvec << net_err_msgs[flast_net_rc].message << thr(net_err_msgs[flast_net_rc].type);
-      return false;
+      return NULL;
     }
 
 #if defined(LIMIT_SENDS)
@@ -1137,7 +1155,7 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
 #endif
 	  if (MPI_Test(&tmpsb->req, &flag, MPI_STATUS_IGNORE) != MPI_SUCCESS) {
 	    errvec << "MPI_Test failed!" << thr();
-	    return false;
+	    return NULL;
 	  }
 #if defined(OPT_STATS_MPI_CALLS)
 	  stats_update(&stats_Test, MPI_Wtime() - start);
@@ -1160,17 +1178,17 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
     if (flag) {
       if (sb->msgs_cnt != 0) {
 	errvec << "There is available buffer with non-zero msgs_cnt!" << thr();
-	return false;
+	return NULL;
       }
       if (sb->pending && sb->size == 0) {
 	errvec << "There was pending buffer with zero size!" << thr();
-	return false;
+	return NULL;
       }
       if (sb->pending)
 	sbuffs.total_pending_size -= sb->size;
       if (sbuffs.total_pending_size < 0) {
 	errvec << "Problem with calculating total_pending_size, it went negative!" << thr();
-	return false;
+	return NULL;
       }
       sb->size = 0;
       sb->pending = false;
@@ -1196,7 +1214,7 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
 #endif
 		 if (MPI_Test(&sbp->req, &thisflag, MPI_STATUS_IGNORE) != MPI_SUCCESS) {
 		     errvec << "MPI_Test failed!" << thr();
-		     return false;
+		     return NULL;
 		 }
 #if defined(OPT_STATS_MPI_CALLS)
 		 stats_update(&stats_Test, MPI_Wtime() - start);
@@ -1212,7 +1230,7 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
 		  if (sbuffs.total_pending_size < 0)
 		    {
 		      errvec << "Problem with calculating total_pending_size, it went negative!" << thr();
-		      return false;
+		      return NULL;
 		    }
 		  sbpprev->next = sbpnext;
 		  if (sbpnext == NULL)
@@ -1279,7 +1297,7 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
 #endif
 	    if (MPI_Test(&tmpsb->req, &flag, MPI_STATUS_IGNORE) != MPI_SUCCESS) {
 	      errvec << "MPI_Test failed!" << thr();
-	      return false;
+	      return NULL;
 	    }
 #if defined(OPT_STATS_MPI_CALLS)
 	    stats_update(&stats_Test, MPI_Wtime() - start);
@@ -1297,17 +1315,17 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
       if (flag) {
 	if (sb->msgs_cnt != 0) {
 	  errvec << "There is available buffer with non-zero msgs_cnt!" << thr();
-	  return false;
+	  return NULL;
 	}
 	if (sb->pending && sb->size == 0) {
 	  errvec << "There was pending buffer with zero size!" << thr();
-	  return false;
+	  return NULL;
 	}
 	if (sb->pending)
 	  sbuffs.total_pending_size -= sb->size;
 	if (sbuffs.total_pending_size < 0) {
 	  errvec << "Problem with calculating total_pending_size, it went negative!" << thr();
-	  return false;
+	  return NULL;
 	}
 	sb->size = 0;
 	sb->pending = false;
@@ -1334,10 +1352,16 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
     }
   }
 
-  // Copy message to the right place
+  // Write the header of the message, the data follow
   memcpy(sb->ptr + sb->size, &size, size_of_int);
   memcpy(sb->ptr + sb->size + size_of_int, &tag, size_of_int);
-  memcpy(sb->ptr + sb->size + 2 * size_of_int, buf, size);
+
+  return sb;
+}
+
+bool network_t::complete_send(net_send_buffer_t *sb, int size, int dest, bool urgent)
+{
+  net_send_buffers_t& sbuffs = (*send_buffer)[dest];
 
   if (urgent) {
     if (sb->msgs_cnt != 0 || sb->size != 0) {
@@ -1428,6 +1452,65 @@ bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urg
   return true;
 }
 
+bool network_t::send_message_ex(char* buf, int size, int dest, int tag, bool urgent)
+{
+  net_send_buffer_t *sb = prepare_send_buffer(size, dest, tag, urgent);
+  if (!sb)
+    return false;
+
+  // Copy message to the right place
+  memcpy(sb->ptr + sb->size + 2 * size_of_int, buf, size);
+
+  return complete_send(sb, size, dest, urgent);
+}
+
+char *network_t::begin_message(int size, int dest, int tag)
+{
+  if (fbegun_sb)
+    {
+      errvec << "begin_message() called before the previous message was ended!" << thr();
+      return NULL;
+    }
+
+  net_send_buffer_t *sb = prepare_send_buffer(size, dest, tag, false);
+  if (!sb)
+    return NULL;
+
+  fbegun_sb = sb;
+  fbegun_size = size;
+  fbegun_dest = dest;
+  return sb->ptr + sb->size + 2 * size_of_int;
+}
+
+bool network_t::end_message()
+{
+  if (!fbegun_sb)
+    {
+      errvec << "end_message() called without begin_message()!" << thr();
+      return false;
+    }
+
+  net_send_buffer_t *sb = fbegun_sb;
+  fbegun_sb = NULL;
+  return complete_send(sb, fbegun_size, fbegun_dest, false);
+}
+
+bool network_t::send_state(const state_t state, const char *data, int size, int dest, int tag)
+{
+  size_t len = state.size;
+  char *ptr = begin_message(sizeof(size_t) + len + size, dest, tag);
+  if (!ptr)
+    return false;
+
+  // the same layout as message_t::append_state() + append_data()
+  memcpy(ptr, &len, sizeof(size_t));
+  memcpy(ptr + sizeof(size_t), state.ptr, len);
+  if (size)
+    memcpy(ptr + sizeof(size_t) + len, data, size);
+
+  return end_message();
+}
+
 bool network_t::send_message(char* buf, int size, int dest, int tag)
 {
   return (send_message_ex(buf, size, dest, tag, false));
@@ -1452,6 +1535,7 @@ bool network_t::send_urgent_message(const message_t & message, int dest, int tag
 
 bool network_t::flush_buffer(int dest)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_NET_FLUSH);
   net_send_buffer_t *sb;
 
   // Throw error if not intialized
@@ -2027,7 +2111,7 @@ bool network_t::message_probe(int src, int tag, bool &flag, int &size,
 #endif
 
 #if defined(OPT_STATS_TAGS)
-	  for (int i = 0; i <= DIVINE_TAG_SYNC_COMPLETION; i++)
+	  for (int i = 0; i <= DIVINE_TAG_SYNC_TREE_COMPLETION; i++)
 	    {
 	      if (tag_count[i] != 0)
 		{
@@ -402,9 +402,9 @@ public:
 
     // statistics
     int fstat_sent_messages_cnt; // only non-urgent
-    int fstat_sent_messages_size; // only non-urgent
+    size_t fstat_sent_messages_size; // only non-urgent
     int fstat_sent_urgent_messages_cnt; // only urgent
-    int fstat_sent_urgent_messages_size; // only urgent
+    size_t fstat_sent_urgent_messages_size; // only urgent
 
     int fstat_received_messages_cnt; // only non-urgent
     int fstat_received_messages_size; // only non-urgent
@@ -418,9 +418,16 @@ public:
     char fprocessor_name[MPI_MAX_PROCESSOR_NAME + 1]; // computer name
 
     int size_of_int; // holds the value sizeof(int)
+
+    // message started by begin_message() and not yet completed by end_message()
+    net_send_buffer_t *fbegun_sb;
+    int fbegun_size;
+    int fbegun_dest;
  
     bool get_comm_matrix(net_comm_matrix_type_t cm_type, pcomm_matrix_t& ret, int target);
     bool send_message_ex(char* buf, int size, int dest, int tag, bool urgent);
+    net_send_buffer_t *prepare_send_buffer(int size, int dest, int tag, bool urgent);
+    bool complete_send(net_send_buffer_t *sb, int size, int dest, bool urgent);
     bool message_probe(int src, int tag, bool &flag, int &size, 
 		       MPI_Status& status, bool blocking);
     bool is_new_message_ex(int& size, int& src, int& tag, bool& flag, 
@@ -552,6 +559,39 @@ public:
      *  is not connected to buffering mechanism, so the messages are sent immediately.
      *  Different functions are used to receive messages sent by this function.*/
     bool send_urgent_message(const message_t & message, int dest, int tag);
+
+    //! Starts a message written directly to the send buffer
+    /*! \param size - size of the message (in sizeof(char))
+     *  \param dest - id of the workstation that receives the data
+     *  \param tag - additional information attached to the message, which is typically used to
+     *               identify the type of the message
+     *  \return pointer to \a size bytes in the send buffer designated for \a dest or
+     *          \b NULL if the function fails
+     *
+     *  Together with end_message() this function works as send_message(), but the data are
+     *  not copied from the user's memory - they are written (serialized) by the caller
+     *  directly to the send buffer, which is posted by MPI_Isend as a whole. The message
+     *  has to be completed by end_message() before any other message is sent or any buffer
+     *  is flushed.*/
+    char *begin_message(int size, int dest, int tag);
+
+    //! Completes the message started by begin_message()
+    /*! \return \b true if the function succeeds, \b false otherwise*/
+    bool end_message();
+
+    //! Sends a state followed by additional data without an intermediate message_t
+    /*! \param state - the state to send
+     *  \param data - additional data to send (e.g. a reference of the predecessor)
+     *  \param size - size of the additional data (may be 0)
+     *  \param dest - id of the workstation that receives the state
+     *  \param tag - additional information attached to the message
+     *  \return \b true if the function succeeds, \b false otherwise
+     *
+     *  The state is serialized directly to the send buffer (see begin_message()).
+     *  The message has the same layout as a message_t filled by message_t::append_state()
+     *  and message_t::append_data(), so the receiver can read it either by message_t or in
+     *  place by message_t::read_state_in_place().*/
+    bool send_state(const state_t state, const char *data, int size, int dest, int tag);
     //! One send buffer flush
     /*! \param dest - identifcation of the buffer (id of the workstation the buffer is
      *                designated for) to be flushed
@@ -769,6 +809,11 @@ public:
      *               calling workstation
      *  \return \b true if the function succeeds, \b false otherwise.*/
     bool get_all_sent_msgs_cnt(int& cnt);   
+    //! Get the size of all sent messages (including urgent messages)
+    /*! \param size - output parameter that receives the number of bytes of all messages
+     *                sent by the calling workstation (with the headers of messages)
+     *  \return \b true if the function succeeds, \b false otherwise.*/
+    bool get_all_sent_msgs_size(size_t& size);
     //! Get all received messages count (including urgent messages)
     /*! \param cnt - output parameter that receives the count of all messages received on the
      *               calling workstation
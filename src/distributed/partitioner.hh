@@ -0,0 +1,43 @@
+/*!\file
+ * The main contribution of this file is the abstract interface partitioner_t
+ * of partition functions used by distributed_t
+ */
+#ifndef DIVINE_PARTITIONER_HH
+#define DIVINE_PARTITIONER_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <string>
+#include "system/state.hh"
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+//!Abstract interface of a partition function
+/*!By default distributed_t::partition_function() assigns states to
+ * workstations by hashing. A system which knows the structure of its states
+ * can supply a partition function keeping neighbouring states on the same
+ * workstation (see distributed_t::set_partitioner()), which saves messages
+ * sent for cross transitions.
+ *
+ * get_owner() must return the same value for the same state on all
+ * workstations and it may be called by several threads at once.
+ */
+class partitioner_t
+{
+public:
+  //!Returns the id of the workstation the state belongs to
+  virtual int get_owner(const state_t & _state) const = 0;
+
+  //!Returns a short description of the partition function (for reports)
+  virtual std::string get_name() const = 0;
+
+  //!A destructor
+  virtual ~partitioner_t() {}
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
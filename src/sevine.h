@@ -10,6 +10,8 @@
 #include "common/bit_string.hh"
 #include "storage/compressor.hh"
 #include "storage/explicit_storage.hh"
+#include "storage/succ_cache.hh"
+#include "storage/snapshot.hh"
 #include "system/system.hh"
 #include "system/system_abilities.hh"
 #include "system/process.hh"
@@ -26,10 +28,13 @@
 #include "system/data.hh"
 #include "common/sysinfo.hh"
 #include "common/reporter.hh"
+#include "common/profile.hh"
 #include "common/process_decomposition.hh"
 #include "common/deb.hh"
 #include "system/bio/affine_system.hh"
 #include "system/bio/affine_explicit_system.hh"
+#include "system/bio/affine_graph.hh"
 #include "system/bio/affine_atomic_propositions.hh"
 #include "system/bio/affine_property.hh"
+#include "system/bio/affine_partitioner.hh"
 
@@ -1,4 +1,5 @@
 #include <string>
+#include <stdint.h>
 #include "storage/compressor.hh"
 #include "huffman.cc"
 
@@ -15,6 +16,9 @@ bool compressor_t::init(int method_id_in, int oversize_in)
   case HUFFMAN_COMPRESS: // Huffman
     huffman_init(2*65536);
     break;
+  case RADIX_COMPRESS: // mixed radix
+    radix_init();
+    break;
   default:
     gerr<<"Uknown compression method."<<thr();
     return false;
@@ -28,6 +32,115 @@ void compressor_t::clear()
   huffman_clear();
   method_id = 0;
   oversize = 0;
+  radix_size = 0;
+}
+
+void compressor_t::set_fields(const std::vector<std::size_t> & _max_values)
+{
+  max_values = _max_values;
+}
+
+void compressor_t::radix_init()
+{
+  if (max_values.empty())
+    gerr<<"Radix compression needs the ranges of fields of states."<<thr();
+
+  layout.set_fields(max_values);
+  values.resize(max_values.size());
+  group_end.clear();
+  group_bits.clear();
+
+  // greedily join the fields while the product of their radices fits into
+  // 64 bits, the group is then stored in the number of bits of its largest
+  // value (product - 1)
+  const uint64_t max_product = ~uint64_t(0);
+  uint64_t product = 1;
+  size_t bits = 0;
+  for (size_t i = 0; i <= max_values.size(); i++)
+    {
+      uint64_t radix = (i < max_values.size() ? uint64_t(max_values[i]) + 1 : 0);
+      if (i == max_values.size() || radix == 0 || product > max_product / radix)
+        {
+          size_t group = 0;
+          while (group < 64 && ((product - 1) >> group))
+            group++;
+          group_end.push_back(i);
+          group_bits.push_back(group);
+          bits += group;
+          product = 1;
+        }
+      if (i < max_values.size())
+        product *= (radix ? radix : max_product);
+    }
+
+  radix_size = (bits + 7) / 8;
+  if (!radix_size)
+    radix_size = 1; // compressed states of zero size cannot be stored
+}
+
+void compressor_t::radix_compress(state_t state, char *& pointer, int& size)
+{
+  if (state.size != layout.get_size())
+    gerr<<"Radix compression: the state does not match the ranges of fields."<<thr();
+
+  layout.unpack(state.ptr, &values[0]);
+
+  pointer = new char[radix_size + oversize];
+  memset(pointer, 0, radix_size);
+  unsigned char *out = reinterpret_cast<unsigned char *>(pointer);
+
+  size_t bit = 0;
+  for (size_t g = 0, first = 0; g < group_end.size(); first = group_end[g], g++)
+    {
+      // Horner's scheme, the first field of the group is the lowest digit
+      uint64_t number = 0;
+      for (size_t i = group_end[g]; i-- > first; )
+        number = number * (uint64_t(max_values[i]) + 1) + values[i];
+
+      for (size_t b = 0; b < group_bits[g]; )
+        {
+          size_t shift = (bit + b) & 7;
+          out[(bit + b) >> 3] |= static_cast<unsigned char>((number >> b) << shift);
+          b += 8 - shift;
+        }
+      bit += group_bits[g];
+    }
+  size = radix_size;
+}
+
+void compressor_t::radix_decompress(state_t& state, const char *pointer)
+{
+  const unsigned char *in = reinterpret_cast<const unsigned char *>(pointer);
+
+  size_t bit = 0;
+  for (size_t g = 0, first = 0; g < group_end.size(); first = group_end[g], g++)
+    {
+      uint64_t number = 0;
+      for (size_t b = 0; b < group_bits[g]; )
+        {
+          size_t shift = (bit + b) & 7;
+          number |= (uint64_t(in[(bit + b) >> 3]) >> shift) << b;
+          b += 8 - shift;
+        }
+      if (group_bits[g] < 64)
+        number &= (uint64_t(1) << group_bits[g]) - 1;
+
+      for (size_t i = first; i < group_end[g]; i++)
+        {
+          uint64_t radix = uint64_t(max_values[i]) + 1;
+          if (radix)
+            {
+              values[i] = number % radix;
+              number /= radix;
+            }
+          else
+            values[i] = number;
+        }
+      bit += group_bits[g];
+    }
+
+  state = new_state(layout.get_size());
+  layout.pack(&values[0], state.ptr);
 }
 
 // arguments are: state, result, size of compressed state
@@ -44,6 +157,9 @@ bool compressor_t::compress(state_t arg1,char *&arg2,int& arg3)
     arg2=huffman_compress(arg1, tmp_int, oversize);
     arg3=tmp_int;
     break;
+  case RADIX_COMPRESS: // mixed radix
+    radix_compress(arg1, arg2, arg3);
+    break;
   default:
     gerr<<"Uknown compression method."<<thr();
     return false;
@@ -76,6 +192,9 @@ bool compressor_t::decompress(state_t &state, char* memptr, int statesize)
 //      cout<<"   Calling hufmann-decompress:"<<endl;
     huffman_decompress(state, memptr, statesize, oversize);
     break;
+  case RADIX_COMPRESS:
+    radix_decompress(state, memptr);
+    break;
   default:
     gerr<<"Uknown compression method."<<thr();
     return false;
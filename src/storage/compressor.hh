@@ -8,11 +8,14 @@
  * \author Jiri Barnat
  */
 
+#include <vector>
 #include "system/state.hh"
+#include "system/bio/affine_state_layout.hh"
 #include "common/error.hh"
 
 #define NO_COMPRESS 11
 #define HUFFMAN_COMPRESS 12
+#define RADIX_COMPRESS 13
 
 namespace divine {
 
@@ -35,14 +38,38 @@ public:
    *  compressed state (appendix) and pointer to explicit_system_t. */
   bool init(int method, int appendix_size);
 
+  //! Sets the ranges of fields of states (required by RADIX_COMPRESS)
+  /*! States are expected to be bit-packed by affine_state_layout_t set to
+   *  the same _max_values. RADIX_COMPRESS stores the fields as digits of
+   *  a mixed radix number (field i has the radix _max_values[i]+1), which
+   *  saves the unused codes of fields whose range is not a power of two.
+   *  Must be called before init(). */
+  void set_fields(const std::vector<std::size_t> & _max_values);
+
+  //! Returns the size of a compressed state (RADIX_COMPRESS only)
+  std::size_t get_radix_size() const { return radix_size; }
+
   //! Clears data structures initialized inside compressor
   /*! Dealocates data that are created during initialization of compressor. This
    *  is needed especially for clearing the arena of compressor. */
   void clear();
 
 private:
+  void radix_init();
+  void radix_compress(state_t state, char *& pointer, int& size);
+  void radix_decompress(state_t& state, const char *pointer);
+
   int method_id;
   int oversize;
+
+  // RADIX_COMPRESS: the fields are split into groups whose products of
+  // radices fit into 64 bits, every group is one number of group_bits bits
+  std::vector<std::size_t> max_values;
+  affine_state_layout_t layout;
+  std::vector<std::size_t> group_end;
+  std::vector<std::size_t> group_bits;
+  std::vector<std::size_t> values;
+  std::size_t radix_size;
 };
 
 };
@@ -1,4 +1,7 @@
 #include "storage/explicit_storage.hh"
+#include "storage/succ_cache.hh"
+#include "storage/snapshot.hh"
+#include "common/profile.hh"
 #include <string>
 #include <sstream>
 
@@ -59,6 +62,11 @@ explicit_storage_t::explicit_storage_t(error_vector_t& errorvector):errvec(error
   mem_used=0;
   mem_max_used=0;
 
+  hashing_method = CHAINED_HASHING;
+  shared = false;
+
+  succ_cache = 0;
+  snapshot = 0;
 }
 
 // }}}
@@ -70,11 +78,27 @@ void explicit_storage_t::init()
 
   memset (&storage,0,sizeof(storage_t));
 
+  if (shared && (hashing_method != OPEN_ADDRESSING || compression_method != NO_COMPRESS))
+    {
+      errvec<<"storage: shared storage requires open addressing and no compression"
+	    <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+
+  if (hashing_method == OPEN_ADDRESSING)
+    {
+      open_table.init(ht_size, appendix_size, shared);
+      compressor.clear();
+      compressor.set_fields(compression_fields);
+      compressor.init(compression_method, appendix_size);
+      return;
+    }
+
   mem_counting(ht_size * sizeof(ht_member_t));      
   storage.ht_base = new ht_member_t[ht_size];
   memset (storage.ht_base,0, ht_size * sizeof(ht_member_t));
 
   compressor.clear();
+  compressor.set_fields(compression_fields);
   compressor.init(compression_method, appendix_size);
 }
 
@@ -115,7 +139,8 @@ void explicit_storage_t::set_compression_method(size_t compression_method_id)
     }
   if (
       compression_method_id == NO_COMPRESS ||
-      compression_method_id == HUFFMAN_COMPRESS
+      compression_method_id == HUFFMAN_COMPRESS ||
+      compression_method_id == RADIX_COMPRESS
       )
     {
       compression_method = compression_method_id;
@@ -127,6 +152,46 @@ void explicit_storage_t::set_compression_method(size_t compression_method_id)
     }
 }
 
+void explicit_storage_t::set_compression_fields(const std::vector<size_t> & max_values)
+{
+  if (initialized)
+    {
+      errvec<<"storage: you cannot call set function after init"
+	    <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+  compression_fields = max_values;
+}
+
+void explicit_storage_t::set_hashing_method(size_t hashing_method_id)
+{
+  if (initialized)
+    {
+      errvec<<"storage: you cannot call set function after init"
+	    <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+  if (
+      hashing_method_id == CHAINED_HASHING ||
+      hashing_method_id == OPEN_ADDRESSING
+      )
+    {
+      hashing_method = hashing_method_id;
+    }
+  else
+    {      
+      errvec<<"storage: unknown hashing method"
+	    <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+}
+
+void explicit_storage_t::set_shared(bool is_shared)
+{
+  if (initialized)
+    {
+      errvec<<"storage: you cannot call set function after init"
+	    <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+  shared = is_shared;
+}
 
 void explicit_storage_t::set_col_resize(size_t coltable_resize_by)
 {
@@ -174,36 +239,48 @@ void explicit_storage_t::set_appendix_size(size_t appendix_size_in)
 
 size_t explicit_storage_t::get_mem_used()
 {
-  return mem_used;
+  return mem_used + open_table.get_mem_used() +
+    (succ_cache ? succ_cache->get_mem_used() : 0);
 }
 
 size_t explicit_storage_t::get_mem_max_used()
 {
-  return mem_max_used;
+  return mem_max_used + open_table.get_mem_max_used() +
+    (succ_cache ? succ_cache->get_mem_used() : 0);
 }
 
 size_t explicit_storage_t::get_states_stored()
 {
+  if (hashing_method == OPEN_ADDRESSING)
+    return open_table.get_stored();
   return storage.states_stored;
 }
 
 size_t explicit_storage_t::get_states_max_stored()
 {
+  if (hashing_method == OPEN_ADDRESSING)
+    return open_table.get_max_stored();
   return storage.states_max_stored;
 }
 
 size_t explicit_storage_t::get_coltables()
 {
+  if (hashing_method == OPEN_ADDRESSING)
+    return open_table.get_slots();
   return storage.states_col;
 }
 
 size_t explicit_storage_t::get_max_coltable()
 {
+  if (hashing_method == OPEN_ADDRESSING)
+    return open_table.get_max_probe();
   return storage.states_max_col;
 }
 
 size_t explicit_storage_t::get_ht_occupancy()
 {
+  if (hashing_method == OPEN_ADDRESSING)
+    return open_table.get_used();
   return storage.ht_occupancy;
 }
 
@@ -227,6 +304,67 @@ void explicit_storage_t::mem_counting(int modify_mem_counter_by)
     }
 }
 
+// }}}
+// {{{ open addressing
+
+size_t explicit_storage_t::open_hash(state_t state)
+{
+  // the table takes the slot and the fingerprint from the upper bits
+  return hasher.get_hash(reinterpret_cast<unsigned char *>(state.ptr),state.size,
+			 EXPLICIT_STORAGE_HASH_SEED) * size_t(0x9E3779B97F4A7C15ULL);
+}
+
+// the key of uncompressed state is the state itself, otherwise the
+// compressed state has to be deleted by the caller
+bool explicit_storage_t::open_key(state_t state, char *& key, int& key_size)
+{
+  if (compression_method == NO_COMPRESS)
+    {
+      key = state.ptr;
+      key_size = state.size;
+      return true;
+    }
+  return compressor.compress(state,key,key_size);
+}
+
+void explicit_storage_t::open_mem_check()
+{
+  if (mem_limit > 0 && get_mem_used() > mem_limit)
+    {      
+      errvec <<"Memory limit reached."
+	     <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+}
+
+bool explicit_storage_t::open_insert(state_t state, state_ref_t& state_reference)
+{
+  char *key = 0;
+  int key_size = 0;
+  bool inserted = false;
+
+  if (!open_key(state,key,key_size))
+    {
+      errvec<<"insert(): Cannot compress the state."
+	    <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+      return false;
+    }
+
+  char *block = open_table.insert(key,key_size,open_hash(state),inserted);
+  if (key != state.ptr)
+    delete [] key;
+  if (!block)
+    {
+      errvec<<"insert(): Address of the state does not fit into the hash table."
+	    <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+      return false;
+    }
+
+  open_ref(block,state_reference);
+  if (inserted)
+    open_mem_check();
+  return !inserted;
+}
+
 // }}}
 // {{{ insert 
 
@@ -240,7 +378,13 @@ void explicit_storage_t::insert (state_t state)
 
 void explicit_storage_t::insert (state_t state, state_ref_t& state_reference)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_STORAGE_INSERT);
 //    std::cout <<"  Storage.insert ..."<<endl;
+  if (hashing_method == OPEN_ADDRESSING)
+    {
+      open_insert(state,state_reference);
+      return;
+    }
 
   size_t hresult = 0;
   size_t pos = 0;
@@ -381,6 +525,9 @@ bool explicit_storage_t::is_stored_if_not_insert(state_t state,state_ref_t& stat
   //int tmp_extra_mem = 0;
   bool already_stored=false;
 
+  if (hashing_method == OPEN_ADDRESSING)
+    return open_insert(state,state_reference);
+
   hresult = hasher.get_hash(reinterpret_cast<unsigned char *>(state.ptr),state.size,
 			    EXPLICIT_STORAGE_HASH_SEED);  
   hresult = hresult % ht_size;
@@ -504,11 +651,24 @@ bool explicit_storage_t::is_stored (state_t state)
 
 bool explicit_storage_t::is_stored (state_t state, state_ref_t& state_reference)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_STORAGE_IS_STORED);
 //    std::cout <<"  Storage.is_stored ... "<<endl;
   size_t hresult = 0;
 
   char *cstate = 0;
   int cstate_size = 0;
+
+  if (hashing_method == OPEN_ADDRESSING)
+    {
+      if (!open_key(state,cstate,cstate_size))
+	return false;
+      char *block = open_table.find(cstate,cstate_size,open_hash(state));
+      if (cstate != state.ptr)
+	delete [] cstate;
+      if (block)
+	open_ref(block,state_reference);
+      return (block != 0);
+    }
   
   hresult = hasher.get_hash(reinterpret_cast<unsigned char *>(state.ptr),state.size,
 			    EXPLICIT_STORAGE_HASH_SEED);  
@@ -555,6 +715,19 @@ bool explicit_storage_t::is_stored (state_t state, state_ref_t& state_reference)
 
 bool explicit_storage_t::delete_by_ref (state_ref_t state_reference)
 {
+  if (succ_cache)
+    succ_cache->erase(state_reference);
+
+  if (hashing_method == OPEN_ADDRESSING)
+    {
+      if (!open_table.remove(open_block(state_reference)))
+	{
+	  errvec <<"delete_by_ref(): invalid reference ..."
+		 <<psh(EXPLICIT_STORAGE_ERR_TYPE);
+	  return false;
+	}
+      return true;
+    }
   
   if (!(storage.ht_base[state_reference.hres].col_table))
     {
@@ -574,7 +747,7 @@ bool explicit_storage_t::delete_by_ref (state_ref_t state_reference)
 	{
 	  mem_counting(-(storage.ht_base[state_reference.hres].col_table[state_reference.id].size));
 	  mem_counting(-appendix_size);
-	  delete [] (storage.ht_base[state_reference.hres].col_table[state_reference.id].ptr);
+	  free_block(storage.ht_base[state_reference.hres].col_table[state_reference.id].ptr);
 	  storage.ht_base[state_reference.hres].col_table[state_reference.id].ptr = 0;
 	  storage.ht_base[state_reference.hres].col_table[state_reference.id].size = 0;
 	}
@@ -589,6 +762,15 @@ bool explicit_storage_t::delete_by_ref (state_ref_t state_reference)
 void explicit_storage_t::delete_all_states(bool leave_collision_lists)
 {
   size_t tmp_col_size;
+
+  if (succ_cache)
+    succ_cache->clear();
+
+  if (hashing_method == OPEN_ADDRESSING)
+    {
+      open_table.clear();
+      return;
+    }
   
   for (size_t ht_row=0; ht_row<ht_size; ht_row++)
     {
@@ -600,7 +782,7 @@ void explicit_storage_t::delete_all_states(bool leave_collision_lists)
 	    {
 	      mem_counting(-(storage.ht_base[ht_row].col_table[pos_in_row].size));
 	      mem_counting(-appendix_size);
-	      delete [] (storage.ht_base[ht_row].col_table[pos_in_row].ptr);
+	      free_block(storage.ht_base[ht_row].col_table[pos_in_row].ptr);
 	      storage.ht_base[ht_row].col_table[pos_in_row].ptr = 0;
 	      storage.ht_base[ht_row].col_table[pos_in_row].size = 0;
 	    }
@@ -630,6 +812,7 @@ void explicit_storage_t::delete_all_states(bool leave_collision_lists)
 
 state_t explicit_storage_t::reconstruct(state_ref_t state_reference)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_STORAGE_RECONSTRUCT);
 
 
 //    std::cout <<"  Storage.reconstruct ... "<<state_reference.to_string()<<endl;
@@ -637,6 +820,14 @@ state_t explicit_storage_t::reconstruct(state_ref_t state_reference)
   result.ptr = 0;
   result.size = 0;
 
+  if (hashing_method == OPEN_ADDRESSING)
+    {
+      char *block = open_block(state_reference);
+      compressor.decompress(result,open_hash_table_t::key(block),
+			    open_hash_table_t::key_size(block));
+      return result;
+    }
+
   if (storage.ht_base[state_reference.hres].col_table)
     {
       if (storage.ht_base[state_reference.hres].col_table[state_reference.id].ptr)
@@ -668,6 +859,9 @@ void* explicit_storage_t::app_by_ref(state_ref_t refer)
       return 0;
     }
 
+  if (hashing_method == OPEN_ADDRESSING)
+    return open_hash_table_t::appendix(open_block(refer));
+
   if (!(storage.ht_base[refer.hres].col_table))
     {
       errvec <<"Invalid reference used in set_app_by_ref()."
@@ -692,6 +886,128 @@ void* explicit_storage_t::app_by_ref(state_ref_t refer)
 }
 
 // }}}
+// {{{ snapshots 
+
+void explicit_storage_t::free_block(char *block)
+{
+  // blocks restored by load_snapshot() live in the mapped snapshot
+  if (!(snapshot && snapshot->contains(block)))
+    delete [] block;
+}
+
+void explicit_storage_t::save_snapshot(snapshot_t & out)
+{
+  if (hashing_method == OPEN_ADDRESSING)
+    {
+      errvec <<"save_snapshot(): snapshots require chained hashing"
+	     <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+
+  size_t rows = 0;
+  for (size_t ht_row=0; ht_row<ht_size; ht_row++)
+    if (storage.ht_base[ht_row].col_table)
+      rows++;
+
+  out.write_value(ht_size);
+  out.write_value(appendix_size);
+  out.write_value(compression_method);
+  out.write_value(rows);
+  for (size_t ht_row=0; ht_row<ht_size; ht_row++)
+    {
+      if (!storage.ht_base[ht_row].col_table)
+	continue;
+      out.write_value(ht_row);
+      out.write_value(storage.ht_base[ht_row].col_size);
+      for (size_t pos=0; pos<storage.ht_base[ht_row].col_size; pos++)
+	{
+	  col_member_t & member = storage.ht_base[ht_row].col_table[pos];
+	  // size -1 stands for a free slot (references must not change)
+	  int size = (member.ptr ? member.size : -1);
+	  out.write_value(size);
+	  if (member.ptr)
+	    out.write(member.ptr, member.size + appendix_size);
+	}
+      out.align();
+    }
+}
+
+void explicit_storage_t::load_snapshot(snapshot_t & in, void (*loaded)(state_ref_t))
+{
+  if (hashing_method == OPEN_ADDRESSING || !initialized || get_states_stored())
+    {
+      errvec <<"load_snapshot(): an empty initialized storage with chained hashing is required"
+	     <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+
+  size_t saved_ht_size, saved_appendix_size, saved_compression_method, rows;
+  in.read_value(saved_ht_size);
+  in.read_value(saved_appendix_size);
+  in.read_value(saved_compression_method);
+  if (saved_ht_size != ht_size || saved_appendix_size != appendix_size ||
+      saved_compression_method != compression_method)
+    {
+      errvec <<"load_snapshot(): the snapshot was saved with another "
+	     <<"hash table size, appendix or compression"
+	     <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+    }
+
+  snapshot = &in;
+  in.read_value(rows);
+  for (size_t r=0; r<rows; r++)
+    {
+      size_t ht_row, col_size;
+      in.read_value(ht_row);
+      in.read_value(col_size);
+      if (ht_row >= ht_size || col_size == 0)
+	{
+	  errvec <<"load_snapshot(): invalid snapshot"
+		 <<thr(EXPLICIT_STORAGE_ERR_TYPE);
+	}
+
+      mem_counting(col_size * sizeof(col_member_t));
+      storage.ht_base[ht_row].col_table = new col_member_t[col_size];
+      memset(storage.ht_base[ht_row].col_table,0,sizeof(col_member_t)*col_size);
+      storage.ht_base[ht_row].col_size = col_size;
+      storage.states_col += col_size;
+      if (storage.states_max_col < col_size)
+	storage.states_max_col = col_size;
+
+      bool first = true;
+      for (size_t pos=0; pos<col_size; pos++)
+	{
+	  int size;
+	  in.read_value(size);
+	  if (size < 0)
+	    continue;
+	  col_member_t & member = storage.ht_base[ht_row].col_table[pos];
+	  member.ptr = const_cast<char *>(in.read_in_place(size + appendix_size));
+	  member.size = size;
+	  mem_counting(size + appendix_size);
+
+	  storage.states_stored ++;
+	  if (first)
+	    storage.ht_occupancy ++;
+	  else
+	    storage.collisions ++;
+	  first = false;
+
+	  if (loaded)
+	    {
+	      state_ref_t ref;
+	      ref.hres = ht_row;
+	      ref.id = pos;
+	      loaded(ref);
+	    }
+	}
+      in.skip_align();
+    }
+
+  storage.states_max_stored = storage.states_stored;
+  storage.max_ht_occupancy = storage.ht_occupancy;
+  storage.max_collisions = storage.collisions;
+}
+
+// }}}
 
 
 
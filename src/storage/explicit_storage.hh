@@ -10,6 +10,7 @@
 #ifndef DOXYGEN_PROCESSING
 #include "system/state.hh"
 #include "storage/compressor.hh"
+#include "storage/open_hash_table.hh"
 #include "common/error.hh"
 #include "common/hash_function.hh"
 
@@ -19,6 +20,12 @@ namespace divine {
 #define EXPLICIT_STORAGE_ERR_TYPE 11
 #define EXPLICIT_STORAGE_HASH_SEED 0xBA9A9ABA
 
+#define CHAINED_HASHING 21
+#define OPEN_ADDRESSING 22
+
+  class succ_cache_t;
+  class snapshot_t;
+
 
   //!State reference class
   /*!This class is a constant-sized short representation of state stored
@@ -164,21 +171,47 @@ namespace divine {
     /*! Returns maximum number of states stored in the set. */
     size_t get_states_max_stored();
 
-    /*! Returns sum of sizes of collision tables (sum of lengths of all collision lists). */
+    /*! Returns sum of sizes of collision tables (sum of lengths of all
+     *  collision lists). With OPEN_ADDRESSING returns the number of slots
+     *  of the table. */
     size_t get_coltables();
 
-    /*! Returns maximum size of a single collision table (maximum length of a collision list). */
+    /*! Returns maximum size of a single collision table (maximum length of
+     *  a collision list). With OPEN_ADDRESSING returns the length of the
+     *  longest probe sequence. */
     size_t get_max_coltable();   
 
     /*! Returns the number of occupied lines (lines with at least one state
-     *  stored) in the hashtable. */
+     *  stored) in the hashtable. With OPEN_ADDRESSING tombstones of deleted
+     *  states are counted as well. */
     size_t get_ht_occupancy();        
 
+    /*! Sets the hashing method. Where the possibilities are:
+     *  CHAINED_HASHING (default) - every line of the hash table has its own
+     *  collision table, and OPEN_ADDRESSING - flat table with linear
+     *  probing that grows when it fills up (see open_hash_table_t). With
+     *  OPEN_ADDRESSING the hash table size is the initial number of slots
+     *  and the collision table settings are ignored. The call of this
+     *  function must preceed the call of init member function. */
+    void set_hashing_method(size_t);
+
+    /*! Allows concurrent calls of insert(), is_stored() and
+     *  is_stored_if_not_insert() from more threads. Requires
+     *  OPEN_ADDRESSING and NO_COMPRESS. The call of this function must
+     *  preceed the call of init member function. */
+    void set_shared(bool);
+
     /*! Sets compression method. Where the possibilities are: NO_COMPRESS
-     * (default) and HUFFMAN_COMPRESS. The call of this function must
+     * (default), HUFFMAN_COMPRESS and RADIX_COMPRESS (requires
+     * set_compression_fields()). The call of this function must
      * preceed the call of init member function. */
     void set_compression_method(size_t);
 
+    /*! Sets the ranges of fields of states for RADIX_COMPRESS, see
+     * compressor_t::set_fields(). The call of this function must
+     * preceed the call of init member function. */
+    void set_compression_fields(const std::vector<size_t> &);
+
     /*! Sets the hash table size (default: 2^16 = 65536). The call of this
      * function must preceed the call of init member function. The call of
      * this function must preceed the call of init member function. */
@@ -201,6 +234,29 @@ namespace divine {
      * init member function. */
     bool set_mem_limit(size_t);
 
+    /*! Attaches a cache of successors (see succ_cache_t) to the storage,
+     *  0 detaches it. The storage does not take the ownership of the
+     *  cache, it only erases the records of deleted states and counts the
+     *  memory of the cache in get_mem_used(). */
+    void set_succ_cache(succ_cache_t * _cache) { succ_cache = _cache; }
+
+    /*! Returns the attached cache of successors (0 if there is none). */
+    succ_cache_t * get_succ_cache() { return succ_cache; }
+
+    /*! Writes all stored states together with their appendices to the
+     *  snapshot. Requires CHAINED_HASHING. */
+    void save_snapshot(snapshot_t &);
+
+    /*! Restores the states written by save_snapshot() from the mapped
+     *  snapshot. The storage must be initialized and empty and it must
+     *  have the same hash table size, appendix size and compression as the
+     *  saved one. States are not inserted again - the stored blocks point
+     *  directly to the snapshot (which must not be unmapped while the
+     *  storage is used) and the references of states are the same as in
+     *  the saved storage. If the second argument is given, it is called
+     *  for the reference of every restored state. */
+    void load_snapshot(snapshot_t &, void (*)(state_ref_t) = 0);
+
     /*! Sets the size of instance of an appendix structure. The call of this function must
      * preceed the call of init member function. */
     void set_appendix_size(size_t);       
@@ -233,6 +289,13 @@ namespace divine {
 	  return false;
 	}
 
+      if (hashing_method == OPEN_ADDRESSING)
+	{
+	  memcpy(&result, open_hash_table_t::appendix(open_block(refer)),
+		 sizeof(appendix_t));
+	  return true;
+	}
+
       if (!(storage.ht_base[refer.hres].col_table))
 	{
 	  errvec <<"Invalid reference used in get_app_by_ref()."
@@ -270,6 +333,13 @@ namespace divine {
 		 <<psh(EXPLICIT_STORAGE_ERR_TYPE);
 	  return false;
 	}
+
+      if (hashing_method == OPEN_ADDRESSING)
+	{
+	  memcpy(open_hash_table_t::appendix(open_block(refer)), &appen,
+		 sizeof(appendix_t));
+	  return true;
+	}
       
       if (!(storage.ht_base[refer.hres].col_table))
 	{
@@ -326,6 +396,7 @@ namespace divine {
     bool initialized;
 
     size_t compression_method;
+    std::vector<size_t> compression_fields;
     compressor_t compressor;
 
     size_t ht_size;
@@ -342,6 +413,26 @@ namespace divine {
     
     void mem_counting(int);
     hash_function_t hasher;
+
+    size_t hashing_method;
+    bool shared;
+    open_hash_table_t open_table;   // used by OPEN_ADDRESSING
+    succ_cache_t *succ_cache;
+    snapshot_t *snapshot;   // blocks restored by load_snapshot() point here
+
+    void free_block(char *);
+
+    // with OPEN_ADDRESSING the reference holds the address of the block
+    static char *open_block(state_ref_t refer)
+    { return reinterpret_cast<char *>(refer.hres); }
+
+    static void open_ref(char *block, state_ref_t & refer)
+    { refer.hres = reinterpret_cast<size_t>(block); refer.id = 0; }
+
+    size_t open_hash(state_t);
+    bool open_key(state_t, char *&, int&);
+    void open_mem_check();
+    bool open_insert(state_t, state_ref_t&);
     
     //size_t hash_function(state_t);
     
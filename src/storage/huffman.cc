@@ -38,6 +38,7 @@ void huffman_init(int state_size)
 void huffman_clear()
 {
   delete [] stream.ptr;
+  stream.ptr = 0;
 }
 
 char* huffman_compress(state_t q, int &size, int oversize)
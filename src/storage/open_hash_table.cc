@@ -0,0 +1,298 @@
+#include "storage/open_hash_table.hh"
+#include <sched.h>
+
+using namespace divine;
+
+const size_t open_hash_table_t::EMPTY;
+const size_t open_hash_table_t::TOMBSTONE;
+const size_t open_hash_table_t::PTR_BITS;
+const size_t open_hash_table_t::PTR_MASK;
+
+// {{{ constructor, destructor
+
+open_hash_table_t::open_hash_table_t():
+  table(0), slots(0), appendix_size(0), shared(false),
+  stored(0), max_stored(0), used(0), max_probe(0),
+  mem_used(0), mem_max_used(0), active(0), growing(false)
+{
+}
+
+open_hash_table_t::~open_hash_table_t()
+{
+  if (table)
+    {
+      clear();
+      delete [] table;
+    }
+}
+
+// }}}
+// {{{ init
+
+std::atomic<size_t> *open_hash_table_t::allocate(size_t _slots)
+{
+  std::atomic<size_t> *result = new std::atomic<size_t>[_slots];
+  for (size_t i=0; i<_slots; i++)
+    result[i].store(EMPTY, std::memory_order_relaxed);
+  mem_counting(_slots * sizeof(std::atomic<size_t>));
+  return result;
+}
+
+void open_hash_table_t::init(size_t _slots, size_t _appendix_size, bool _shared)
+{
+  if (table)
+    {
+      clear();
+      delete [] table;
+      mem_counting(-long(slots * sizeof(std::atomic<size_t>)));
+    }
+
+  // home() uses 32 bits of the hash
+  const size_t max_slots = size_t(1) << 32;
+  slots = 16;
+  while (slots < _slots && slots < max_slots)
+    slots *= 2;
+
+  appendix_size = _appendix_size;
+  shared = _shared;
+  table = allocate(slots);
+}
+
+// }}}
+// {{{ synchronization
+
+void open_hash_table_t::enter()
+{
+  if (!shared)
+    return;
+  for (;;)
+    {
+      while (growing.load())
+	sched_yield();
+      active.fetch_add(1);
+      if (!growing.load())
+	return;
+      active.fetch_sub(1);
+    }
+}
+
+void open_hash_table_t::leave()
+{
+  if (shared)
+    active.fetch_sub(1);
+}
+
+void open_hash_table_t::update_max(std::atomic<size_t> & _max, size_t _value)
+{
+  size_t old = _max.load(std::memory_order_relaxed);
+  while (old < _value)
+    {
+      if (!shared)
+	{
+	  _max.store(_value, std::memory_order_relaxed);
+	  return;
+	}
+      if (_max.compare_exchange_weak(old, _value))
+	return;
+    }
+}
+
+void open_hash_table_t::mem_counting(long int _bytes)
+{
+  add(mem_used, _bytes);
+  update_max(mem_max_used, mem_used.load(std::memory_order_relaxed));
+}
+
+// }}}
+// {{{ find, insert
+
+char *open_hash_table_t::find(const char *_key, size_t _size, size_t _hash)
+{
+  enter();
+
+  const size_t fp = fingerprint(_hash);
+  const size_t mask = slots - 1;
+  size_t i = home(slot_hash(_hash), slots);
+  char *result = 0;
+
+  for (size_t probe=0; probe<slots; probe++)
+    {
+      size_t word = table[i].load(std::memory_order_acquire);
+      if (word == EMPTY)
+	break;
+      if (matches(word, fp, _key, _size))
+	{
+	  result = reinterpret_cast<char *>(word & PTR_MASK);
+	  break;
+	}
+      i = (i + 1) & mask;
+    }
+
+  leave();
+  return result;
+}
+
+char *open_hash_table_t::insert(const char *_key, size_t _size, size_t _hash,
+				bool & _inserted)
+{
+  enter();
+
+  const size_t fp = fingerprint(_hash);
+  const size_t mask = slots - 1;
+  const size_t size = block_size(_size);
+  size_t i = home(slot_hash(_hash), slots);
+  size_t probe = 0;
+  char *block = 0;
+
+  _inserted = false;
+  for (;;)
+    {
+      size_t word = table[i].load(std::memory_order_acquire);
+      if (word == EMPTY)
+	{
+	  // the block is created only once, even if the slot is stolen
+	  if (!block)
+	    {
+	      block = new char[size];
+	      if (reinterpret_cast<size_t>(block) & ~PTR_MASK)
+		{
+		  delete [] block;
+		  leave();
+		  return 0;
+		}
+	      header_t *header = reinterpret_cast<header_t *>(block);
+	      header->size = _size;
+	      header->hash = slot_hash(_hash);
+	      memcpy(key(block), _key, _size);
+	      memset(key(block) + _size, 0, appendix_size);
+	    }
+
+	  size_t new_word = (fp << PTR_BITS) | reinterpret_cast<size_t>(block);
+	  if (shared)
+	    {
+	      // somebody was faster, examine the slot again
+	      if (!table[i].compare_exchange_strong(word, new_word,
+						    std::memory_order_acq_rel))
+		continue;
+	    }
+	  else
+	    table[i].store(new_word, std::memory_order_relaxed);
+
+	  _inserted = true;
+	  mem_counting(size);
+	  add(stored, 1);
+	  add(used, 1);
+	  update_max(max_stored, stored.load(std::memory_order_relaxed));
+	  update_max(max_probe, probe);
+	  break;
+	}
+
+      if (matches(word, fp, _key, _size))
+	{
+	  if (block)
+	    delete [] block;
+	  block = reinterpret_cast<char *>(word & PTR_MASK);
+	  break;
+	}
+
+      i = (i + 1) & mask;
+      probe++;
+    }
+
+  leave();
+
+  if (_inserted && used.load(std::memory_order_relaxed) * 10 > slots * 7)
+    grow();
+
+  return block;
+}
+
+// }}}
+// {{{ grow
+
+void open_hash_table_t::grow()
+{
+  if (shared)
+    {
+      bool expected = false;
+      if (!growing.compare_exchange_strong(expected, true))
+	return; // somebody else is growing the table
+      while (active.load())
+	sched_yield();
+    }
+
+  if (used.load() * 10 > slots * 7 && slots < (size_t(1) << 32))
+    {
+      const size_t new_slots = 2 * slots;
+      const size_t mask = new_slots - 1;
+      std::atomic<size_t> *new_table = allocate(new_slots);
+
+      // tombstones are dropped, blocks stay where they are
+      for (size_t i=0; i<slots; i++)
+	{
+	  size_t word = table[i].load(std::memory_order_relaxed);
+	  if (word <= TOMBSTONE)
+	    continue;
+	  const header_t *header = reinterpret_cast<const header_t *>(word & PTR_MASK);
+	  size_t j = home(header->hash, new_slots);
+	  while (new_table[j].load(std::memory_order_relaxed) != EMPTY)
+	    j = (j + 1) & mask;
+	  new_table[j].store(word, std::memory_order_relaxed);
+	}
+
+      delete [] table;
+      mem_counting(-long(slots * sizeof(std::atomic<size_t>)));
+      table = new_table;
+      slots = new_slots;
+      used.store(stored.load());
+    }
+
+  if (shared)
+    growing.store(false);
+}
+
+// }}}
+// {{{ remove, clear
+
+bool open_hash_table_t::remove(char *_block)
+{
+  const header_t *header = reinterpret_cast<const header_t *>(_block);
+  const size_t mask = slots - 1;
+  size_t i = home(header->hash, slots);
+
+  for (size_t probe=0; probe<slots; probe++)
+    {
+      size_t word = table[i].load(std::memory_order_relaxed);
+      if (word == EMPTY)
+	break;
+      if (word > TOMBSTONE && (word & PTR_MASK) == reinterpret_cast<size_t>(_block))
+	{
+	  table[i].store(TOMBSTONE, std::memory_order_relaxed);
+	  mem_counting(-long(block_size(key_size(_block))));
+	  add(stored, -1);
+	  delete [] _block;
+	  return true;
+	}
+      i = (i + 1) & mask;
+    }
+  return false;
+}
+
+void open_hash_table_t::clear()
+{
+  for (size_t i=0; i<slots; i++)
+    {
+      size_t word = table[i].load(std::memory_order_relaxed);
+      if (word > TOMBSTONE)
+	{
+	  char *block = reinterpret_cast<char *>(word & PTR_MASK);
+	  mem_counting(-long(block_size(key_size(block))));
+	  delete [] block;
+	}
+      table[i].store(EMPTY, std::memory_order_relaxed);
+    }
+  stored.store(0);
+  used.store(0);
+}
+
+// }}}
@@ -0,0 +1,164 @@
+/*!\file
+ *  open addressing hash table of states (backend of explicit_storage_t)
+ */
+#ifndef _DIVINE_OPEN_HASH_TABLE_HH_
+#define _DIVINE_OPEN_HASH_TABLE_HH_
+
+#ifndef DOXYGEN_PROCESSING
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+  //!Open addressing hash table of (compressed) states
+  /*!States are stored in blocks allocated one per state. A block consists
+   * of a small header (size of the state and the hash of the state), the
+   * state itself (padded to whole words) and the appendix. The appendix is
+   * therefore aligned and its fields may be updated by atomic instructions.
+   * Blocks never move, hence the address of a block is a stable reference
+   * of the state.
+   *
+   * The table is a flat array of slots searched by linear probing. A slot
+   * is one word holding the address of a block (the lower 48 bits) together
+   * with a 16 bits fingerprint of the hash of the state, so most of the
+   * mismatching blocks are skipped without being touched. Deleted states
+   * leave a tombstone in their slot. The table grows (twice) when it is
+   * more than 70% full (tombstones included).
+   *
+   * Slots are claimed by compare-and-swap, therefore find() and insert()
+   * may be called concurrently if the table has been initialized as
+   * shared. In the shared mode every operation registers itself in a
+   * counter of active operations and growing waits for all of them to
+   * finish; remove() and clear() must not run concurrently with other
+   * operations. In the unshared mode no atomic read-modify-write
+   * instruction is used.
+   */
+  class open_hash_table_t {
+  public:
+    //!Header of a block, followed by the state and the appendix
+    typedef struct {
+      uint32_t size;  // size of the state
+      uint32_t hash;  // hash of the state, determines the home slot
+    } header_t;
+
+    open_hash_table_t();
+    ~open_hash_table_t();
+
+    /*! Allocates the table of (at least) _slots slots, frees the previous
+     *  contents. */
+    void init(size_t _slots, size_t _appendix_size, bool _shared);
+
+    /*! Returns the block storing the state _key of size _size and hash
+     *  _hash or 0 if the state is not stored. */
+    char *find(const char *_key, size_t _size, size_t _hash);
+
+    /*! Returns the block storing the given state, the state is inserted (a
+     *  new block is allocated) if it is not stored yet. _inserted is set
+     *  accordingly. Returns 0 if the address of the new block cannot be
+     *  stored in a slot. */
+    char *insert(const char *_key, size_t _size, size_t _hash, bool & _inserted);
+
+    /*! Removes the state stored in the given block and frees the block.
+     *  Returns false if the block is not stored in the table. */
+    bool remove(char *_block);
+
+    /*! Removes and frees all stored states. */
+    void clear();
+
+    //!Returns the state stored in the block
+    static char *key(char *_block) { return _block + sizeof(header_t); }
+    //!Returns the size of the state stored in the block
+    static size_t key_size(const char *_block)
+    { return reinterpret_cast<const header_t *>(_block)->size; }
+    //!Returns the appendix stored in the block
+    static char *appendix(char *_block)
+    { return key(_block) + padded(key_size(_block)); }
+
+    //!Returns the number of slots
+    size_t get_slots() const { return slots; }
+    //!Returns the number of stored states
+    size_t get_stored() const { return stored; }
+    //!Returns the maximal number of stored states
+    size_t get_max_stored() const { return max_stored; }
+    //!Returns the number of occupied slots (tombstones included)
+    size_t get_used() const { return used; }
+    //!Returns the length of the longest probe sequence so far
+    size_t get_max_probe() const { return max_probe; }
+    //!Returns the number of allocated bytes
+    size_t get_mem_used() const { return mem_used; }
+    //!Returns the maximal number of allocated bytes
+    size_t get_mem_max_used() const { return mem_max_used; }
+
+  protected:
+    static const size_t EMPTY = 0;
+    static const size_t TOMBSTONE = 1;
+    static const size_t PTR_BITS = 48;
+    static const size_t PTR_MASK = (size_t(1) << PTR_BITS) - 1;
+
+    std::atomic<size_t> *table;
+    size_t slots;           // power of two
+    size_t appendix_size;
+    bool shared;
+
+    std::atomic<size_t> stored;
+    std::atomic<size_t> max_stored;
+    std::atomic<size_t> used;
+    std::atomic<size_t> max_probe;
+    std::atomic<size_t> mem_used;
+    std::atomic<size_t> mem_max_used;
+
+    // shared mode only
+    std::atomic<size_t> active;    // number of running operations
+    std::atomic<bool> growing;
+
+    static size_t fingerprint(size_t _hash)
+    { return (_hash >> 16) & 0xFFFF; }
+
+    static size_t home(uint32_t _hash, size_t _slots)
+    { return _hash & (_slots - 1); }
+
+    static size_t padded(size_t _size)
+    { return (_size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1); }
+
+    size_t block_size(size_t _size) const
+    { return sizeof(header_t) + padded(_size) + appendix_size; }
+
+    static uint32_t slot_hash(size_t _hash)
+    { return uint32_t(_hash >> 32); }
+
+    static bool matches(size_t _word, size_t _fp, const char *_key, size_t _size)
+    {
+      if ((_word >> PTR_BITS) != _fp || _word <= TOMBSTONE)
+	return false;
+      const char *block = reinterpret_cast<const char *>(_word & PTR_MASK);
+      return key_size(block) == _size &&
+	memcmp(block + sizeof(header_t), _key, _size) == 0;
+    }
+
+    void add(std::atomic<size_t> & _counter, long int _value)
+    {
+      if (shared)
+	_counter.fetch_add(_value);
+      else
+	_counter.store(_counter.load(std::memory_order_relaxed) + _value,
+		       std::memory_order_relaxed);
+    }
+
+    void enter();
+    void leave();
+    void grow();
+    void mem_counting(long int _bytes);
+    void update_max(std::atomic<size_t> & _max, size_t _value);
+    std::atomic<size_t> *allocate(size_t _slots);
+
+  private:
+    open_hash_table_t(const open_hash_table_t &);
+    open_hash_table_t & operator=(const open_hash_table_t &);
+  };
+
+#ifndef DOXYGEN_PROCESSING
+}
+#endif //end of namespace divine which shouldn't be seen by Doxygen
+#endif
@@ -0,0 +1,115 @@
+#include "storage/snapshot.hh"
+#include "common/error.hh"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+namespace {
+  const char MAGIC[8] = { 'D', 'V', 'S', 'N', 'A', 'P', '0', '1' };
+}
+
+snapshot_t::snapshot_t(): written(0), base(0), length(0), pos(0)
+{
+}
+
+snapshot_t::~snapshot_t()
+{
+  unmap();
+}
+
+void snapshot_t::create(const std::string & _file)
+{
+  file = _file;
+  written = 0;
+  out.open((file + ".tmp").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out)
+    gerr << "Cannot create snapshot " << file << ".tmp" << thr();
+  write(MAGIC, sizeof(MAGIC));
+}
+
+void snapshot_t::write(const void * _data, size_t _size)
+{
+  out.write(static_cast<const char *>(_data), _size);
+  if (!out)
+    gerr << "Cannot write snapshot " << file << ".tmp" << thr();
+  written += _size;
+}
+
+void snapshot_t::align()
+{
+  static const char zeros[8] = { 0 };
+  if (written % 8)
+    write(zeros, 8 - written % 8);
+}
+
+void snapshot_t::commit()
+{
+  out.close();
+  if (!out)
+    gerr << "Cannot write snapshot " << file << ".tmp" << thr();
+  if (rename((file + ".tmp").c_str(), file.c_str()))
+    gerr << "Cannot rename snapshot " << file << ".tmp" << thr();
+}
+
+void snapshot_t::map(const std::string & _file)
+{
+  unmap();
+  file = _file;
+
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    gerr << "Cannot open snapshot " << file << thr();
+  struct stat info;
+  if (fstat(fd, &info) || size_t(info.st_size) < sizeof(MAGIC))
+    {
+      close(fd);
+      gerr << "Invalid snapshot " << file << thr();
+    }
+
+  // private mapping - appendices of restored states are updated in memory
+  void * p = mmap(0, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    gerr << "Cannot map snapshot " << file << thr();
+  base = static_cast<char *>(p);
+  length = info.st_size;
+  pos = 0;
+
+  if (memcmp(read_in_place(sizeof(MAGIC)), MAGIC, sizeof(MAGIC)))
+    gerr << "Invalid snapshot " << file << thr();
+}
+
+void snapshot_t::unmap()
+{
+  if (base)
+    munmap(base, length);
+  base = 0;
+  length = pos = 0;
+}
+
+const char * snapshot_t::read_in_place(size_t _size)
+{
+  if (!base || _size > length - pos)
+    gerr << "Snapshot " << file << " is truncated" << thr();
+  const char * result = base + pos;
+  pos += _size;
+  return result;
+}
+
+void snapshot_t::read(void * _data, size_t _size)
+{
+  memcpy(_data, read_in_place(_size), _size);
+}
+
+void snapshot_t::skip_align()
+{
+  if (pos % 8)
+    read_in_place(8 - pos % 8);
+}
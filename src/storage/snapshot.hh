@@ -0,0 +1,143 @@
+/*!\file
+ * The main contribution of this file is the class snapshot_t - a file
+ * holding a checkpoint of a computation, read back by mmap()
+ */
+#ifndef DIVINE_SNAPSHOT_HH
+#define DIVINE_SNAPSHOT_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <fstream>
+#include <queue>
+#include <string>
+#include <vector>
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+//!File with a checkpoint of a computation
+/*!A snapshot is written sequentially by create(), write*() and commit().
+ * The data are written to a temporary file first and commit() renames it,
+ * so a computation killed while writing leaves the previous snapshot
+ * untouched.
+ *
+ * A snapshot is read back by map(), which maps the whole file to memory
+ * (privately - changes are not written to the file), and read*(). The
+ * data returned by read_in_place() stay valid until unmap() (or the
+ * destruction of the snapshot), explicit_storage_t::load_snapshot() uses
+ * them directly as the stored states.
+ *
+ * Data are stored in the native format of the machine, snapshots are
+ * therefore not portable. All errors are reported through gerr.
+ */
+class snapshot_t
+{
+public:
+  //!A constructor - creates a snapshot that is neither written nor mapped
+  snapshot_t();
+  //!A destructor - unmaps the snapshot
+  ~snapshot_t();
+
+  //!Starts writing of the snapshot _file
+  void create(const std::string & _file);
+
+  //!Appends _size bytes to the written snapshot
+  void write(const void * _data, size_t _size);
+
+  //!Appends a value of a plain type to the written snapshot
+  template <class T>
+  void write_value(const T & _value) { write(&_value, sizeof(T)); }
+
+  //!Appends the length and the elements of a vector
+  template <class T>
+  void write_vector(const std::vector<T> & _vector)
+  {
+    write_value(_vector.size());
+    if (!_vector.empty())
+      write(&_vector[0], _vector.size() * sizeof(T));
+  }
+
+  //!Appends the length and the elements of a queue (the queue is copied)
+  template <class T>
+  void write_queue(std::queue<T> _queue)
+  {
+    write_value(_queue.size());
+    for (; !_queue.empty(); _queue.pop())
+      write_value(_queue.front());
+  }
+
+  //!Pads the written snapshot to a multiple of 8 bytes
+  void align();
+
+  //!Finishes writing - the snapshot replaces the previous one
+  void commit();
+
+  //!Maps the snapshot _file to memory for reading
+  void map(const std::string & _file);
+
+  //!Unmaps the snapshot
+  void unmap();
+
+  //!Returns _size bytes of the mapped snapshot (without copying) and skips them
+  const char * read_in_place(size_t _size);
+
+  //!Copies _size bytes of the mapped snapshot to _data
+  void read(void * _data, size_t _size);
+
+  //!Reads a value written by write_value()
+  template <class T>
+  void read_value(T & _value) { read(&_value, sizeof(T)); }
+
+  //!Reads a vector written by write_vector()
+  template <class T>
+  void read_vector(std::vector<T> & _vector)
+  {
+    size_t size;
+    read_value(size);
+    _vector.resize(size);
+    if (size)
+      read(&_vector[0], size * sizeof(T));
+  }
+
+  //!Reads a queue written by write_queue() (the elements are appended)
+  template <class T>
+  void read_queue(std::queue<T> & _queue)
+  {
+    size_t size;
+    read_value(size);
+    for (size_t i = 0; i < size; i++)
+      {
+        T value;
+        read_value(value);
+        _queue.push(value);
+      }
+  }
+
+  //!Skips the padding written by align()
+  void skip_align();
+
+  //!Returns true if _ptr points into the mapped snapshot
+  bool contains(const void * _ptr) const
+  { return base && _ptr >= base && _ptr < base + length; }
+
+  //!Returns the name of the file of the snapshot
+  const std::string & get_file() const { return file; }
+
+protected:
+  std::string file;
+  std::ofstream out;
+  size_t written;
+  char * base;
+  size_t length;
+  size_t pos;
+
+private:
+  snapshot_t(const snapshot_t &);
+  snapshot_t & operator=(const snapshot_t &);
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
@@ -0,0 +1,170 @@
+#include "storage/succ_cache.hh"
+#include <cstring>
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+size_t succ_cache_t::ref_hash_t::operator()(const state_ref_t & _ref) const
+{
+  return (_ref.hres * size_t(0x9E3779B97F4A7C15ULL)) ^ _ref.id;
+}
+
+succ_cache_t::succ_cache_t():
+  mem_limit(0), mem_used(0), chunk_size(0), chunk_free(0), building(false), record_count(0),
+  hits(0), misses(0), rejected(0)
+{
+}
+
+succ_cache_t::~succ_cache_t()
+{
+  clear();
+}
+
+void succ_cache_t::set_mem_limit(size_t _bytes)
+{
+  clear();
+  mem_limit = _bytes;
+}
+
+void succ_cache_t::clear()
+{
+  index_t().swap(index);
+  for (size_t i = 0; i < chunks.size(); i++)
+    delete [] chunks[i];
+  chunks.clear();
+  chunk_size = chunk_free = 0;
+  mem_used = 0;
+  building = false;
+}
+
+bool succ_cache_t::lookup(const state_ref_t & _ref, std::vector<succ_t> & _succs)
+{
+  if (!enabled())
+    return false;
+
+  index_t::const_iterator found = index.find(_ref);
+  if (found == index.end())
+    {
+      misses++;
+      return false;
+    }
+  hits++;
+
+  const char * p = found->second;
+  uint32_t count;
+  memcpy(&count, p, sizeof(count));
+  p += sizeof(count);
+
+  _succs.resize(count);
+  for (uint32_t i = 0; i < count; i++)
+    {
+      int32_t size;
+      memcpy(&size, p, sizeof(size));
+      p += sizeof(size);
+      succ_t & succ = _succs[i];
+      if (size == 0)
+        {
+          memcpy(&succ.ref, p, sizeof(state_ref_t));
+          p += sizeof(state_ref_t);
+          succ.network_id = -1;
+          succ.state.ptr = 0;
+          succ.state.size = 0;
+        }
+      else
+        {
+          int32_t network_id;
+          memcpy(&network_id, p, sizeof(network_id));
+          p += sizeof(network_id);
+          succ.network_id = network_id;
+          succ.state.ptr = const_cast<char *>(p);
+          succ.state.size = size;
+          p += size;
+        }
+    }
+  return true;
+}
+
+void succ_cache_t::start(const state_ref_t & _ref)
+{
+  building = enabled() && mem_used < mem_limit;
+  if (!building)
+    {
+      if (enabled())
+        rejected++;
+      return;
+    }
+  building_ref = _ref;
+  record.resize(sizeof(uint32_t));
+  record_count = 0;
+}
+
+void succ_cache_t::add_local(const state_ref_t & _succ)
+{
+  if (!building)
+    return;
+  size_t pos = record.size();
+  int32_t size = 0;
+  record.resize(pos + sizeof(size) + sizeof(state_ref_t));
+  memcpy(&record[pos], &size, sizeof(size));
+  memcpy(&record[pos + sizeof(size)], &_succ, sizeof(state_ref_t));
+  record_count++;
+}
+
+void succ_cache_t::add_remote(const state_t & _succ, int _network_id)
+{
+  if (!building)
+    return;
+  size_t pos = record.size();
+  int32_t size = _succ.size;
+  int32_t network_id = _network_id;
+  record.resize(pos + sizeof(size) + sizeof(network_id) + _succ.size);
+  memcpy(&record[pos], &size, sizeof(size));
+  memcpy(&record[pos + sizeof(size)], &network_id, sizeof(network_id));
+  memcpy(&record[pos + sizeof(size) + sizeof(network_id)], _succ.ptr, _succ.size);
+  record_count++;
+}
+
+void succ_cache_t::finish()
+{
+  if (!building)
+    return;
+  building = false;
+
+  // a new chunk is counted as a whole, so the budget is never exceeded
+  size_t needed = ENTRY_OVERHEAD;
+  if (record.size() > chunk_free)
+    needed += (record.size() > CHUNK ? record.size() : CHUNK);
+  if (mem_used + needed > mem_limit || index.find(building_ref) != index.end())
+    {
+      rejected++;
+      return;
+    }
+
+  memcpy(&record[0], &record_count, sizeof(record_count));
+  char * p = allocate(record.size());
+  memcpy(p, &record[0], record.size());
+  index[building_ref] = p;
+  mem_used += ENTRY_OVERHEAD;
+}
+
+void succ_cache_t::erase(const state_ref_t & _ref)
+{
+  // the space of the record is not reused, only clear() frees it
+  if (index.erase(_ref))
+    mem_used -= ENTRY_OVERHEAD;
+}
+
+char * succ_cache_t::allocate(size_t _size)
+{
+  if (_size > chunk_free)
+    {
+      chunk_size = (_size > CHUNK ? _size : CHUNK);
+      chunks.push_back(new char[chunk_size]);
+      chunk_free = chunk_size;
+      mem_used += chunk_size;
+    }
+  char * p = chunks.back() + chunk_size - chunk_free;
+  chunk_free -= _size;
+  return p;
+}
@@ -0,0 +1,142 @@
+/*!\file
+ * The main contribution of this file is the class succ_cache_t - a cache
+ * of successors of stored states bounded by a memory budget
+ */
+#ifndef DIVINE_SUCC_CACHE_HH
+#define DIVINE_SUCC_CACHE_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include "system/state.hh"
+#include "storage/explicit_storage.hh"
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+//!Cache of successors of states stored in explicit_storage_t
+/*!Iterative algorithms (distr_map, the phases of owcty) generate the
+ * successors of the same states again and again, which is expensive for
+ * affine systems. The cache keeps the successors of a state (given by its
+ * reference) in a compact record:
+ *  - a successor stored on this workstation is kept as its state_ref_t,
+ *  - a successor of another workstation is kept as the bytes of the state
+ *    together with the network id of its owner (it has to be sent anyway).
+ *
+ * A record is built by start(), add_local()/add_remote() and finish().
+ * The memory used by the records is bounded by set_mem_limit(). Once the
+ * limit is reached, finish() drops the new records (their states are
+ * expanded by the system again) instead of evicting the old ones - the
+ * algorithms scan all states in every iteration, so any eviction would
+ * only replace the cached states by the ones scanned later.
+ *
+ * A cache attached to explicit_storage_t (see
+ * explicit_storage_t::set_succ_cache()) forgets the records of deleted
+ * states and its memory is included in explicit_storage_t::get_mem_used().
+ *
+ * The cache is not thread safe.
+ */
+class succ_cache_t
+{
+public:
+  //!A successor returned by lookup()
+  struct succ_t
+  {
+    //!The network id of the owner of a remote successor
+    int network_id;
+    //!The reference of a local successor
+    state_ref_t ref;
+    //!The remote successor (ptr is 0 for local ones), valid until clear()
+    state_t state;
+
+    bool is_local() const { return state.ptr == 0; }
+  };
+
+  //!A constructor - creates a disabled cache (with no memory)
+  succ_cache_t();
+  //!A destructor
+  ~succ_cache_t();
+
+  //!Sets the memory budget in bytes (0 disables the cache), clears the cache
+  void set_mem_limit(size_t _bytes);
+
+  //!Returns true if the cache is enabled
+  bool enabled() const { return mem_limit > 0; }
+
+  //!Removes all records (counters are kept)
+  void clear();
+
+  //!Looks up the successors of the state _ref
+  /*!Returns true and fills _succs if the record has been found. The
+   * references and states in _succs point into the cache.*/
+  bool lookup(const state_ref_t & _ref, std::vector<succ_t> & _succs);
+
+  //!Starts a new record of successors of the state _ref
+  void start(const state_ref_t & _ref);
+
+  //!Appends a successor stored on this workstation to the new record
+  void add_local(const state_ref_t & _succ);
+
+  //!Appends a successor owned by the workstation _network_id to the new record
+  void add_remote(const state_t & _succ, int _network_id);
+
+  //!Stores the new record if the memory budget allows it
+  void finish();
+
+  //!Forgets the record of the state _ref (the state has been deleted)
+  void erase(const state_ref_t & _ref);
+
+  //!Returns the number of bytes allocated by the cache
+  size_t get_mem_used() const { return mem_used; }
+
+  //!Returns the number of successful lookups
+  size_t get_hits() const { return hits; }
+
+  //!Returns the number of unsuccessful lookups
+  size_t get_misses() const { return misses; }
+
+  //!Returns the number of records dropped due to the memory budget
+  size_t get_rejected() const { return rejected; }
+
+protected:
+  struct ref_hash_t
+  {
+    size_t operator()(const state_ref_t & _ref) const;
+  };
+
+  //record: uint32_t number of successors, then every successor as
+  //int32_t size (0 = local), then state_ref_t (local) or int32_t network id
+  //and size bytes of the state (remote)
+  typedef std::unordered_map<state_ref_t, char *, ref_hash_t> index_t;
+
+  static const size_t CHUNK = 1 << 16;
+  //estimated overhead of an entry of index_t
+  static const size_t ENTRY_OVERHEAD = 64;
+
+  char * allocate(size_t _size);
+
+  size_t mem_limit;
+  size_t mem_used;
+  index_t index;
+  std::vector<char *> chunks;
+  size_t chunk_size;   // size of the last chunk
+  size_t chunk_free;   // free bytes at the end of the last chunk
+
+  //the record being built
+  bool building;
+  state_ref_t building_ref;
+  std::vector<char> record;
+  uint32_t record_count;
+
+  size_t hits;
+  size_t misses;
+  size_t rejected;
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
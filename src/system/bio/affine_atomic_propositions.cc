@@ -76,13 +76,12 @@
   }
   
   //!Returns whether the AP is valid in the given state
-  bool divine::affine_ap_t::valid(state_t _state)
+  bool divine::affine_ap_t::valid(const size_t *_where)
   {
     if (is_empty) return true;
         
     size_t treshold_pos = treshold;
-    size_t *_s=static_cast<size_t*>(static_cast<void*>(_state.ptr));
-    size_t value = _s[index];
+    size_t value = _where[index];
     switch (op)
       {
       // strict inequalities coincide with nonstrict because we do not care
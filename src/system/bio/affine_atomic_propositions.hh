@@ -82,7 +82,21 @@ namespace divine {
     void set(std::string = std::string("true"));
 
     //!Returns whether the AP is valid in the given state
-    bool valid(state_t _state);
+    /*!_where are the threshold indices of variables (the unpacked state,
+     * see affine_state_layout_t)*/
+    bool valid(const size_t *_where);
+
+    //!Returns whether the AP is empty (true)
+    bool is_true() const { return is_empty; }
+
+    //!Returns the index of the variable of the AP
+    int get_index() const { return index; }
+
+    //!Returns the comparison operator (AFFINE_AP_LESS, ...)
+    int get_op() const { return op; }
+
+    //!Returns the threshold index the variable is compared with
+    size_t get_treshold() const { return treshold; }
 
     //! Returns a string representation of the object
     std::string to_string();
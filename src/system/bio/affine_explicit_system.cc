@@ -9,6 +9,7 @@
 #include "common/bit_string.hh"
 #include "common/error.hh"
 #include "common/deb.hh"
+#include "common/profile.hh"
 
 #ifndef DOXYGEN_PROCESSING
 using namespace divine;
@@ -17,48 +18,50 @@ using std::ostream;
 using std::vector;
 using std::cout;
 
-// for given _state_ synchronizes the potential successor state _s_ (_sz_ is size without prop) 
-//  with the property process and adds the newly created synchronized state to succs 
-//  (duplicate of _s_);
-//!!! _s_ is deleted when the procedure is finished
- void affine_explicit_system_t::sync_with_prop(state_t& state, state_t& s, succ_container_t& succs)
+// for given _where_ (unpacked state) synchronizes the potential successor state _s_ (_sz_ is size without prop) 
+//  with the property process and adds the newly created synchronized states to succs 
+//  (_s_ itself and duplicates of _s_ if more transitions are enabled);
+//!!! _s_ is added to succs or deleted, the caller must not use it any more
+ void affine_explicit_system_t::sync_with_prop(const size_t *_where, state_t& s, succ_container_t& succs)
   {
     //first we get the current position of the property process
-    size_t *_pps=static_cast<size_t*>(static_cast<void*>(state.ptr));
-    size_t pp_pos = _pps[get_dim()];
+    size_t pp_pos = _where[get_dim()];
   
-    //now we go through all transitions of the property process
-    affine_property_t* propproc = 
-      dynamic_cast<affine_property_t *>(get_property_process());
-    for (size_t ppt=0; ppt < propproc->get_trans_count();ppt++)
+    //now we go through the compiled transitions going from this position
+    affine_property_t* propproc = get_property_of(s);
+    size_t count;
+    const affine_compiled_transition_t * trans = propproc->get_compiled_transitions(pp_pos, count);
+
+    //the last enabled transition takes _s_ itself, the others get a copy
+    size_t last_target = size_t(-1);
+    for (size_t ppt=0; ppt < count; ppt++)
       {
-        affine_property_transition_t *trans = dynamic_cast<affine_property_transition_t *>
-        			( (dynamic_cast<affine_property_t*>(get_property_process()))-> get_transition(ppt) );
-      
-        //if the transition does not go from the current state we skip it
-        size_t tmp_from_id = trans->get_from_id();
-        if ( tmp_from_id == pp_pos)  
-	  	{
-	  	  //we of course consider only enabled transitions
-	  	  if (trans->enabled(state))
-	  	    {
-	  	      //ok, then set properly the value of property process
-	  	      size_t target_of_pp=trans->get_to_id();
-			  size_t *_ppss=static_cast<size_t*>(static_cast<void*>(s.ptr));
-			  size_t backup_value = _ppss[get_dim()];
-			  _ppss[get_dim()] = target_of_pp;
-
-			  // we create a new successor state
-			  state_t s1=duplicate_state(s);
-	  	      //and insert it into the succs container
-	  	      succs.push_back(s1);
-
-			  // roll back the original _s_ (this is for safety, might be removed)
-			  _ppss[get_dim()] = backup_value;
-	  	    }
-	  	}		  
+        //we of course consider only enabled transitions
+        if (!propproc->enabled(trans[ppt], _where))
+          continue;
+        if (last_target != size_t(-1))
+          {
+            state_t s1=duplicate_state(s);
+            state_layout.set(s1,get_dim(),last_target);
+            succs.push_back(s1);
+          }
+        last_target = trans[ppt].to_id;
+      }
+
+    if (last_target != size_t(-1))
+      {
+        state_layout.set(s,get_dim(),last_target);
+        succs.push_back(s);
       }
-    delete_state(s); //all generated states were cloned (from this one)
+    else
+      delete_state(s); //no transition of the property process is enabled
+}
+
+state_t affine_explicit_system_t::pack_state(const size_t *_values)
+{
+  state_t s = new_state(get_state_size());
+  state_layout.pack(_values, s.ptr);
+  return s;
 }
 
 ////METHODS of explicit_system:
@@ -68,6 +71,13 @@ affine_explicit_system_t::affine_explicit_system_t(error_vector_t & evect):
  //empty constructor
 }
 
+affine_explicit_system_t::affine_explicit_system_t(const affine_explicit_system_t & second):
+   system_t(second.terr), explicit_system_t(second.terr), affine_system_t(second),
+   hashf(second.hashf)
+{
+ copy_private_part(second);
+}
+
 affine_explicit_system_t::~affine_explicit_system_t()
 {
  //empty destructor
@@ -82,8 +92,8 @@ bool affine_explicit_system_t::is_accepting(state_t _state, size_int_t _acc_grou
 {
   if (get_with_property())
     {
-      size_t aux=*(static_cast<size_t*>(static_cast<void*>(sizeof(size_t)*get_dim()+_state.ptr)));
-      return static_cast<affine_property_t*>(get_property_process())->get_accepting(aux);
+      size_t aux=state_layout.get(_state,get_dim());
+      return get_property_of(_state)->get_accepting(aux);
     }
   return false;
 }
@@ -204,8 +214,7 @@ void affine_explicit_system_t::recursive_init(divine::state_t _state, size_t _va
 
   for (size_t tres_id = _ins[_var].from; tres_id < _ins[_var].to; tres_id++)
     {
-      size_t *_s=static_cast<size_t*>(static_cast<void*>(_state.ptr));
-      _s[_var]=tres_id;
+      state_layout.set(_state,_var,tres_id);
       recursive_init(_state, _var+1, _succ, _ins);
     }  
 }
@@ -223,14 +232,14 @@ void affine_explicit_system_t::print_aov()
 
 int affine_explicit_system_t::get_succs(divine::state_t _state, succ_container_t & succs)
 {
+  DIVINE_PROFILE_SCOPE(PROBE_GET_SUCCS);
   const bool dbg=false;
   const bool avg=true;   // computing most_significant by average (true) or sum (false)
   succs.clear();
 
   if (inited==0) error ("get_succs",1);
 
-  size_t *_s=static_cast<size_t*>(static_cast<void*>(_state.ptr));
-  if (_s[0]==get_treshs(0)) //this is the pre-initial state, we have to generate all initial states
+  if (state_layout.get(_state,0)==get_treshs(0)) //this is the pre-initial state, we have to generate all initial states
     {
       state_t ss = duplicate_state(_state);      
       // we have to remember initials in order to repeatedly generate successors
@@ -287,6 +296,7 @@ int affine_explicit_system_t::get_succs(divine::state_t _state, succ_container_t
       // =======================================================================
 
       // memset(array_of_values,0,4*sizeof(real_t)*get_dim());
+      // (get_succs1() also unpacks _state to state_values)
       get_succs1(_state, succs, true);
 
       if (dbg) cerr<<"AFTER get_succs1()"<<endl;
@@ -325,7 +335,7 @@ int affine_explicit_system_t::get_succs(divine::state_t _state, succ_container_t
       // computed only when randomize == 2
       if ( randomize == 2 ) 
 		{
-		  size_t* _aux=static_cast<size_t*>(static_cast<void*>(_state.ptr));
+		  const size_t* _aux=&state_values[0];
 		  size_t whereMax=4*get_dim();
 
 		  for ( size_t i = 0; i < 4*get_dim(); i+=4 )
@@ -411,7 +421,7 @@ int affine_explicit_system_t::get_succs(divine::state_t _state, succ_container_t
 		size_t int_prob = 1;
 		bool chosen = false;
 
-		size_t* _aux=static_cast<size_t*>(static_cast<void*>(_state.ptr));
+		const size_t* _aux=&state_values[0];
 
 		for ( size_t i = 0; i < 4*get_dim(); i+=4 )
 		  {
@@ -495,7 +505,7 @@ int affine_explicit_system_t::get_succs(divine::state_t _state, succ_container_t
       if ( selfloop_present ) {   // get back the selfloop when needed
 		state_t _s = duplicate_state(_state);
         if (get_with_property())
-          sync_with_prop(_state, _s, succs);
+          sync_with_prop(&state_values[0], _s, succs);
         else
           succs.push_back(_s);
       }
@@ -506,14 +516,15 @@ int affine_explicit_system_t::get_succs(divine::state_t _state, succ_container_t
 		  //UP direction
 		  if ( array_of_values[i] >0 )
 			{	      
-			  state_t _s = duplicate_state(_state);
-			  size_t* _aux=static_cast<size_t*>(static_cast<void*>(_s.ptr));
 			  size_t _var= (i-(i%4)) / 4; 
-			  if (_aux[_var] < get_treshs(_var)-2)
-				_aux[_var]++;
+			  size_t backup_value = state_values[_var];
+			  if (state_values[_var] < get_treshs(_var)-2)
+				state_values[_var]++;
+			  state_t _s = pack_state(&state_values[0]);
+			  state_values[_var] = backup_value;
 
 			  if (get_with_property())
-		    	sync_with_prop(_state, _s, succs);
+		    	sync_with_prop(&state_values[0], _s, succs);
 			  else
 		    	succs.push_back(_s);
 
@@ -524,14 +535,15 @@ int affine_explicit_system_t::get_succs(divine::state_t _state, succ_container_t
 		  //DOWN direction
 		  if ( array_of_values[i+3] >0 )
 			{
-			  state_t _s = duplicate_state(_state);
-			  size_t* _aux=static_cast<size_t*>(static_cast<void*>(_s.ptr));
 			  size_t _var= (i-(i%4)) / 4; 
-			  if (_aux[_var] > 0)
-				_aux[_var]--;
+			  size_t backup_value = state_values[_var];
+			  if (state_values[_var] > 0)
+				state_values[_var]--;
+			  state_t _s = pack_state(&state_values[0]);
+			  state_values[_var] = backup_value;
 
 			  if (get_with_property())
-		    	sync_with_prop(_state, _s, succs);
+		    	sync_with_prop(&state_values[0], _s, succs);
 			  else
 		    	succs.push_back(_s);
 
@@ -564,7 +576,9 @@ int affine_explicit_system_t::get_succs1(divine::state_t _state, succ_container_
 {
   const bool dbg=false;
 
-  size_t *_s=static_cast<size_t*>(static_cast<void*>(_state.ptr));
+  state_values.resize(state_layout.get_fields());
+  state_layout.unpack(_state.ptr, &state_values[0]);
+  size_t *_s=&state_values[0];
 
   if (dbg) std::cerr << "Generating succs for " << write_state(_state) << endl;
 
@@ -576,15 +590,15 @@ int affine_explicit_system_t::get_succs1(divine::state_t _state, succ_container_
         {
           if (dbg) std::cerr<<"  - below"<<std::endl;
 		  if (dbg) {cerr<<"   ";print_aov(); }
-          recursive(&enabled,m_d,false,_s,0,(with_most_significant ? array_of_values : NULL));
+          face(&enabled,m_d,false,_s,(with_most_significant ? array_of_values : NULL));
 		  if (dbg) {cerr<<"   ";print_aov(); }
           if (enabled)
             {
               _s[m_d]--;
-		      state_t ss = duplicate_state(_state);
+		      state_t ss = pack_state(_s);
               _s[m_d]++;
 			  if (get_with_property())
-				sync_with_prop(_state, ss, succs);
+				sync_with_prop(_s, ss, succs);
 			  else
 				succs.push_back(ss);
             }
@@ -605,17 +619,17 @@ int affine_explicit_system_t::get_succs1(divine::state_t _state, succ_container_
           else
           */
           //SVEN Debug
-          recursive(&enabled,m_d,true,_s,0,(with_most_significant ? array_of_values : NULL));
+          face(&enabled,m_d,true,_s,(with_most_significant ? array_of_values : NULL));
           
           if (enabled)
             {
 			  if (get_with_property())
 				{
-				  state_t ss = duplicate_state(_state);
-				  sync_with_prop(_state, ss, succs);
+				  state_t ss = pack_state(_s);
+				  sync_with_prop(_s, ss, succs);
 				}
 			  else	      
-			succs.push_back(duplicate_state(_state));
+			succs.push_back(pack_state(_s));
             }
           _s[m_d]--;
           enabled=false;
@@ -660,7 +674,7 @@ int affine_explicit_system_t::get_succs1(divine::state_t _state, succ_container_
 		      if (get_with_property())
 		        {
 		          state_t _ss = duplicate_state(_state);
-		          sync_with_prop(_state, _ss, succs);
+		          sync_with_prop(_s, _ss, succs);
 		        }
 		        else
 		        {
@@ -34,8 +34,15 @@ class affine_explicit_system_t : public explicit_system_t, public affine_system_
 {
 private:
   //!Implements synchronization with property process, used by get_succs.
+  //!_where is the unpacked state the guards are evaluated in.
   //!Note that this deletes s from the memory.
-  virtual void sync_with_prop(state_t& state, state_t& s, succ_container_t& succs);
+  virtual void sync_with_prop(const size_t *_where, state_t& s, succ_container_t& succs);
+
+  //! The state processed by get_succs1() unpacked by state_layout
+  std::vector<size_t> state_values;
+
+  //! Returns a new state packed from the unpacked state _values
+  state_t pack_state(const size_t *_values);
 
   //! Internal function to enumerate initial states.
   void recursive_init(divine::state_t _state, size_t _var, succ_container_t & _succ, interval_t *_ins);
@@ -55,6 +62,9 @@ private:
  //!A constructor
  /*!\param evect = \evector used for reporting of error messages*/
  affine_explicit_system_t(error_vector_t & evect);
+ //!A copy constructor
+ /*!See affine_system_t::affine_system_t(const affine_system_t &)*/
+ affine_explicit_system_t(const affine_explicit_system_t & second);
  //!A destructor
  virtual ~affine_explicit_system_t();//!<A destructor.
  
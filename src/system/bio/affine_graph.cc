@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "system/bio/affine_graph.hh"
+#include "system/explicit_system.hh"
+#include "common/error.hh"
+#include "common/profile.hh"
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+namespace {
+  const char MAGIC[8] = { 'D', 'V', 'G', 'R', 'A', 'P', 'H', '1' };
+  const ulong_int_t BYTE_ORDER_MARK = 0x01020304;
+  const size_t COPY_BUFFER_SIZE = 1 << 16;
+
+  //a graph is valid only for the model (including the abstraction and the
+  //property) it was generated from, they are told by the compiled model
+  ulong_long_int_t model_hash(const affine_system_t & _sys)
+  {
+    std::ostringstream out;
+    _sys.write_compiled(out);
+    std::string data = out.str();
+    hash_function_t hashf;
+    return hashf.get_hash((unsigned char *)data.data(), data.size());
+  }
+}
+
+// {{{ affine_graph_writer_t
+
+affine_graph_writer_t::affine_graph_writer_t(): written(0), closed(0)
+{
+  memset(&header, 0, sizeof(header));
+}
+
+affine_graph_writer_t::~affine_graph_writer_t()
+{
+  if (out.is_open())
+    {
+      out.close();
+      std::remove((file + ".tmp").c_str());
+      remove_temporaries();
+    }
+}
+
+void affine_graph_writer_t::create(const std::string & _file, affine_system_t & _sys)
+{
+  file = _file;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.state_size = _sys.get_state_size();
+  header.byte_order = BYTE_ORDER_MARK;
+  header.model_hash = model_hash(_sys);
+  written = closed = 0;
+
+  out.open((file + ".tmp").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  succ_out.open((file + ".succs.tmp").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  begin_out.open((file + ".begin.tmp").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  flags_out.open((file + ".flags.tmp").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  initials_out.open((file + ".initials.tmp").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out || !succ_out || !begin_out || !flags_out || !initials_out)
+    gerr << "Cannot create state graph " << file << ".tmp" << thr();
+
+  //the header is rewritten by commit()
+  write(out, file, &header, sizeof(header));
+  written += sizeof(header);
+  pad(written);
+  header.states_at = written;
+
+  ulong_long_int_t begin = 0;
+  write(begin_out, file, &begin, sizeof(begin));
+}
+
+void affine_graph_writer_t::write(std::ofstream & _out, const std::string & _name,
+                                  const void * _data, size_t _size)
+{
+  _out.write(static_cast<const char *>(_data), _size);
+  if (!_out)
+    gerr << "Cannot write state graph " << _name << thr();
+}
+
+size_t affine_graph_writer_t::add_state(const state_t & _state)
+{
+  if (_state.size != header.state_size)
+    gerr << "State of size " << _state.size << " added to the state graph "
+         << file << " of states of size " << header.state_size << thr();
+  if (header.state_count >= ulong_int_t(-1))
+    gerr << "Too many states for the state graph " << file << thr();
+  write(out, file, _state.ptr, _state.size);
+  written += _state.size;
+  return header.state_count++;
+}
+
+void affine_graph_writer_t::add_initial(size_t _index)
+{
+  ulong_int_t index = _index;
+  write(initials_out, file, &index, sizeof(index));
+  header.initial_count++;
+}
+
+void affine_graph_writer_t::add_succ(size_t _index)
+{
+  ulong_int_t index = _index;
+  write(succ_out, file, &index, sizeof(index));
+  header.trans_count++;
+}
+
+void affine_graph_writer_t::close_state(bool _accepting, int _succs_result)
+{
+  if (closed >= header.state_count)
+    gerr << "Closing a state that is not in the state graph " << file << thr();
+  byte_t f = (_accepting ? FLAG_ACCEPTING : 0) | (_succs_result << 1);
+  write(flags_out, file, &f, sizeof(f));
+  write(begin_out, file, &header.trans_count, sizeof(header.trans_count));
+  closed++;
+}
+
+void affine_graph_writer_t::pad(size_t & _written)
+{
+  static const char zeros[8] = { 0 };
+  if (_written % 8)
+    {
+      write(out, file, zeros, 8 - _written % 8);
+      _written += 8 - _written % 8;
+    }
+}
+
+//appends the temporary file _name to the graph
+void affine_graph_writer_t::append(const std::string & _name, size_t & _written)
+{
+  std::ifstream in(_name.c_str(), std::ios::in | std::ios::binary);
+  if (!in)
+    gerr << "Cannot read " << _name << thr();
+  std::vector<char> buffer(COPY_BUFFER_SIZE);
+  while (in)
+    {
+      in.read(&buffer[0], buffer.size());
+      write(out, file, &buffer[0], in.gcount());
+      _written += in.gcount();
+    }
+  pad(_written);
+}
+
+void affine_graph_writer_t::remove_temporaries()
+{
+  std::remove((file + ".succs.tmp").c_str());
+  std::remove((file + ".begin.tmp").c_str());
+  std::remove((file + ".flags.tmp").c_str());
+  std::remove((file + ".initials.tmp").c_str());
+}
+
+void affine_graph_writer_t::commit()
+{
+  if (closed != header.state_count)
+    gerr << "State graph " << file << " has " << header.state_count - closed
+         << " unclosed states" << thr();
+
+  succ_out.close();
+  begin_out.close();
+  flags_out.close();
+  initials_out.close();
+  if (!succ_out || !begin_out || !flags_out || !initials_out)
+    gerr << "Cannot write state graph " << file << thr();
+
+  pad(written);
+  header.succ_begin_at = written;
+  append(file + ".begin.tmp", written);
+  header.succs_at = written;
+  append(file + ".succs.tmp", written);
+  header.flags_at = written;
+  append(file + ".flags.tmp", written);
+  header.initials_at = written;
+  append(file + ".initials.tmp", written);
+  remove_temporaries();
+
+  //the table is at most half full
+  header.table_size = 1;
+  while (header.table_size < 2 * header.state_count)
+    header.table_size *= 2;
+  header.table_at = written;
+  std::vector<char> zeros(COPY_BUFFER_SIZE, 0);
+  for (size_t left = header.table_size * sizeof(ulong_int_t); left > 0; )
+    {
+      size_t n = std::min(left, zeros.size());
+      write(out, file, &zeros[0], n);
+      written += n;
+      left -= n;
+    }
+  out.close();
+  if (!out)
+    gerr << "Cannot write state graph " << file << ".tmp" << thr();
+
+  //the header and the table are written to the mapped file, states are
+  //read from it
+  std::string tmp = file + ".tmp";
+  int fd = open(tmp.c_str(), O_RDWR);
+  if (fd < 0)
+    gerr << "Cannot open state graph " << tmp << thr();
+  void * p = mmap(0, written, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    gerr << "Cannot map state graph " << tmp << thr();
+  char * base = static_cast<char *>(p);
+
+  memcpy(base, &header, sizeof(header));
+  const char * states = base + header.states_at;
+  ulong_int_t * table = reinterpret_cast<ulong_int_t *>(base + header.table_at);
+  hash_function_t hashf;
+  size_t mask = header.table_size - 1;
+  for (size_t i = 0; i < header.state_count; i++)
+    {
+      unsigned char * s = (unsigned char *)(states + i * header.state_size);
+      size_t slot = hashf.get_hash(s, header.state_size) & mask;
+      while (table[slot])
+        slot = (slot + 1) & mask;
+      table[slot] = i + 1;
+    }
+
+  bool ok = msync(base, written, MS_SYNC) == 0;
+  munmap(base, written);
+  if (!ok || std::rename(tmp.c_str(), file.c_str()))
+    gerr << "Cannot write state graph " << file << thr();
+}
+
+// }}}
+
+// {{{ affine_graph_explicit_system_t
+
+affine_graph_explicit_system_t::affine_graph_explicit_system_t(error_vector_t & evect,
+                                                               const std::string & _graph):
+  system_t(evect), affine_explicit_system_t(evect), graph(_graph),
+  base(0), length(0), header(0)
+{
+}
+
+affine_graph_explicit_system_t::affine_graph_explicit_system_t(const affine_graph_explicit_system_t & second):
+  system_t(second.terr), affine_explicit_system_t(second), graph(second.graph),
+  base(0), length(0), header(0)
+{
+  if (second.base)
+    map_graph();
+}
+
+affine_graph_explicit_system_t::~affine_graph_explicit_system_t()
+{
+  if (base)
+    munmap(base, length);
+}
+
+slong_int_t affine_graph_explicit_system_t::read(const char * const filename)
+{
+  slong_int_t result = affine_explicit_system_t::read(filename);
+  if (result == 0)
+    map_graph();
+  return result;
+}
+
+void affine_graph_explicit_system_t::map_graph()
+{
+  int fd = open(graph.c_str(), O_RDONLY);
+  if (fd < 0)
+    gerr << "Cannot open state graph " << graph << thr();
+  struct stat info;
+  if (fstat(fd, &info) || size_t(info.st_size) < sizeof(affine_graph_header_t))
+    {
+      close(fd);
+      gerr << "Invalid state graph " << graph << thr();
+    }
+  void * p = mmap(0, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    gerr << "Cannot map state graph " << graph << thr();
+  base = static_cast<char *>(p);
+  length = info.st_size;
+
+  header = reinterpret_cast<const affine_graph_header_t *>(base);
+  if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) || header->byte_order != BYTE_ORDER_MARK ||
+      header->table_size == 0 || (header->table_size & (header->table_size - 1)) ||
+      header->table_at + header->table_size * sizeof(ulong_int_t) > length ||
+      header->states_at + header->state_count * header->state_size > header->succ_begin_at ||
+      header->succ_begin_at + (header->state_count + 1) * sizeof(ulong_long_int_t) > header->succs_at ||
+      header->succs_at + header->trans_count * sizeof(ulong_int_t) > header->flags_at ||
+      header->flags_at + header->state_count > header->initials_at ||
+      header->initials_at + header->initial_count * sizeof(ulong_int_t) > header->table_at)
+    gerr << "Invalid state graph " << graph << thr();
+
+  states = base + header->states_at;
+  succ_begin = reinterpret_cast<const ulong_long_int_t *>(base + header->succ_begin_at);
+  targets = reinterpret_cast<const ulong_int_t *>(base + header->succs_at);
+  flags = reinterpret_cast<const byte_t *>(base + header->flags_at);
+  table = reinterpret_cast<const ulong_int_t *>(base + header->table_at);
+
+  if (header->model_hash != model_hash(*this) || header->state_size != get_state_size())
+    gerr << "State graph " << graph << " does not belong to the model" << thr();
+}
+
+size_t affine_graph_explicit_system_t::find(const state_t & _state) const
+{
+  if (_state.size != header->state_size)
+    return size_t(-1);
+  size_t mask = header->table_size - 1;
+  size_t slot = graph_hashf.get_hash((unsigned char *)_state.ptr, _state.size) & mask;
+  for (; table[slot]; slot = (slot + 1) & mask)
+    {
+      size_t index = table[slot] - 1;
+      if (!memcmp(states + index * header->state_size, _state.ptr, _state.size))
+        return index;
+    }
+  return size_t(-1);
+}
+
+bool affine_graph_explicit_system_t::is_accepting(state_t state, size_int_t, size_int_t)
+{
+  size_t index = find(state);
+  if (index == size_t(-1))
+    gerr << "State not found in the state graph " << graph << thr();
+  return flags[index] & affine_graph_writer_t::FLAG_ACCEPTING;
+}
+
+int affine_graph_explicit_system_t::get_succs(state_t state, succ_container_t & succs)
+{
+  DIVINE_PROFILE_SCOPE(PROBE_GET_SUCCS);
+  succs.clear();
+  size_t index = find(state);
+  if (index == size_t(-1))
+    gerr << "State not found in the state graph " << graph << thr();
+
+  size_t size = header->state_size;
+  for (ulong_long_int_t k = succ_begin[index]; k < succ_begin[index + 1]; k++)
+    {
+      state_t s = new_state(size);
+      memcpy(s.ptr, states + size_t(targets[k]) * size, size);
+      succs.push_back(s);
+    }
+  return flags[index] >> 1;
+}
+
+// }}}
@@ -0,0 +1,169 @@
+/*!\file
+ * The main contribution of this file are the classes affine_graph_writer_t
+ * and affine_graph_explicit_system_t - a binary file with a precomputed
+ * state graph of an affine system and the system exploring it
+ */
+#ifndef DIVINE_AFFINE_GRAPH_HH
+#define DIVINE_AFFINE_GRAPH_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <fstream>
+#include <string>
+#include "system/bio/affine_explicit_system.hh"
+#include "common/hash_function.hh"
+#include "common/types.hh"
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+//!Header of a state graph file (see affine_graph_writer_t)
+struct affine_graph_header_t
+{
+  char magic[8];
+  ulong_int_t state_size;
+  ulong_int_t byte_order;
+  //!hash of the compiled model the graph was generated from
+  ulong_long_int_t model_hash;
+  ulong_long_int_t state_count;
+  ulong_long_int_t trans_count;
+  ulong_long_int_t initial_count;
+  //!number of slots of the table of states (a power of 2)
+  ulong_long_int_t table_size;
+  //!offsets of the sections in the file
+  ulong_long_int_t states_at, succ_begin_at, succs_at, flags_at, initials_at, table_at;
+};
+
+//!Writer of a state graph file
+/*!A state graph file holds the state space of an affine system (states
+ * numbered from 0) in the following sections, stored in the native
+ * format of the machine:
+ * - states: the packed states, state_size bytes each
+ * - succ_begin: state_count+1 offsets to succs, the successors of the
+ *   state i are succs[succ_begin[i]] .. succs[succ_begin[i+1]-1]
+ * - succs: trans_count indices of states
+ * - flags: a byte per state, FLAG_ACCEPTING and the result of get_succs()
+ *   shifted by 1
+ * - initials: the indices of the initial states
+ * - table: open addressing table (linear probing) of state indices plus 1
+ *   (0 is an empty slot) hashed by their bytes, used to find the index of
+ *   a state
+ *
+ * The graph is written sequentially: the states are appended by
+ * add_state() and their successors by add_succ() and close_state(), both
+ * in the order of indices, so a breadth-first search can write the graph
+ * while it runs. The successors and flags are kept in temporary files,
+ * commit() concatenates them and builds the table in the mapped file, so
+ * writing takes only a constant amount of memory. The file is written
+ * under a temporary name and renamed by commit().
+ *
+ * Errors are reported through gerr.
+ */
+class affine_graph_writer_t
+{
+public:
+  //!Flag of accepting states
+  static const byte_t FLAG_ACCEPTING = 1;
+
+  //!A constructor - creates a writer that is not writing
+  affine_graph_writer_t();
+  //!A destructor - removes the temporary files of an uncommitted graph
+  ~affine_graph_writer_t();
+
+  //!Starts writing of the graph _file of states of the model _sys
+  void create(const std::string & _file, affine_system_t & _sys);
+
+  //!Appends a state and returns its index
+  size_t add_state(const state_t & _state);
+
+  //!Marks the state _index as initial
+  void add_initial(size_t _index);
+
+  //!Appends a successor (given by its index) of the first unclosed state
+  void add_succ(size_t _index);
+
+  //!Closes the first unclosed state - all its successors have been added
+  /*!\param _accepting = whether the state is accepting
+   * \param _succs_result = the value returned by get_succs() for the state*/
+  void close_state(bool _accepting, int _succs_result);
+
+  //!Finishes writing - all the states have to be closed
+  void commit();
+
+  //!Returns the number of states added so far
+  size_t get_state_count() const { return header.state_count; }
+
+protected:
+  void write(std::ofstream & _out, const std::string & _name,
+             const void * _data, size_t _size);
+  void append(const std::string & _name, size_t & _written);
+  void pad(size_t & _written);
+  void remove_temporaries();
+
+  std::string file;
+  std::ofstream out, succ_out, begin_out, flags_out, initials_out;
+  affine_graph_header_t header;
+  size_t written;
+  size_t closed;
+};
+
+//!Affine system exploring a state graph file instead of computing successors
+/*!The model is read as by affine_explicit_system_t (from the .bio or .cbio
+ * file the graph was generated from, it is still needed for printing and
+ * partitioning of states), read() then maps the graph file to memory and
+ * get_succs() and is_accepting() only look up the states in it. The
+ * mapping is read only, a copy of the system maps the file again (the
+ * pages of the file are shared).
+ *
+ * read() checks that the graph was generated from the same model (with
+ * the same abstraction and property), get_succs() of a state that is not
+ * in the graph is reported through gerr. A graph holds one property, add_property()
+ * is not supported.
+ */
+class affine_graph_explicit_system_t : public affine_explicit_system_t
+{
+public:
+  //!A constructor - _graph is the graph file read() maps
+  affine_graph_explicit_system_t(error_vector_t & evect, const std::string & _graph);
+  //!A copy constructor - maps the graph of second again
+  affine_graph_explicit_system_t(const affine_graph_explicit_system_t & second);
+  //!A destructor - unmaps the graph
+  virtual ~affine_graph_explicit_system_t();
+
+  using affine_explicit_system_t::read;
+  //!Reads the model and maps the graph
+  virtual slong_int_t read(const char * const filename);
+
+  //!Implements explicit_system_t::is_accepting() by the flags of the graph
+  virtual bool is_accepting(state_t state, size_int_t acc_group=0, size_int_t pair_member=1);
+  using affine_explicit_system_t::get_succs;
+  //!Implements explicit_system_t::get_succs() by the successors in the graph
+  virtual int get_succs(state_t state, succ_container_t & succs);
+
+  //!Returns the number of states of the graph
+  size_t get_graph_state_count() const { return header->state_count; }
+  //!Returns the number of transitions of the graph
+  size_t get_graph_trans_count() const { return header->trans_count; }
+
+protected:
+  void map_graph();
+  //!Returns the index of _state in the graph
+  size_t find(const state_t & _state) const;
+
+  std::string graph;
+  char * base;
+  size_t length;
+  const affine_graph_header_t * header;
+  const char * states;
+  const ulong_long_int_t * succ_begin;
+  const ulong_int_t * targets;
+  const byte_t * flags;
+  const ulong_int_t * table;
+  hash_function_t graph_hashf;
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
@@ -0,0 +1,355 @@
+#include "system/bio/affine_kernel.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AFFINE_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+template <class T>
+static inline const T * ptr(const std::vector<T> & _v)
+{
+  return _v.empty() ? 0 : &_v[0];
+}
+
+affine_kernel_t::affine_kernel_t(): compiled(false), dim(0), simd(detect_simd())
+{
+}
+
+affine_kernel_t::simd_t affine_kernel_t::detect_simd()
+{
+#ifdef AFFINE_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return SIMD_AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return SIMD_SSE2;
+#endif
+  return SIMD_NONE;
+}
+
+void affine_kernel_t::set_simd(simd_t _simd)
+{
+  simd_t best = detect_simd();
+  simd = (_simd > best ? best : _simd);
+}
+
+void affine_kernel_t::compile(const Model<real_t> & model)
+{
+  dim = model.getDims();
+
+  thr_begin.assign(1, 0);
+  thr_value.clear();
+  eq_begin.assign(1, 0);
+  sum_constant.clear();
+  sum_param.clear();
+  var_begin.assign(1, 0);
+  ramp_begin.assign(1, 0);
+  step_begin.assign(1, 0);
+  var_index.clear();
+  ramp_var.clear();
+  ramp_min.clear();
+  ramp_max.clear();
+  ramp_min_value.clear();
+  ramp_max_value.clear();
+  step_var.clear();
+  step_theta.clear();
+  step_a.clear();
+  step_b.clear();
+  dep_table.assign(dim*dim, 0);
+  used_begin.assign(1, 0);
+  used_var.clear();
+
+  // thresholds (Model keeps them in the order of their definition)
+  std::vector<std::pair<std::size_t, std::vector<real_t> > > thresholds = model.getThresholds();
+  for (size_t v = 0; v < dim; v++)
+    {
+      for (size_t i = 0; i < thresholds.size(); i++)
+        if (thresholds[i].first == v)
+          {
+            thr_value.insert(thr_value.end(), thresholds[i].second.begin(), thresholds[i].second.end());
+            break;
+          }
+      thr_begin.push_back(thr_value.size());
+    }
+
+  // equations
+  for (size_t v = 0; v < dim; v++)
+    {
+      std::vector<Summember<real_t> > eq = model.getEquationForVariable(v);
+      for (size_t s = 0; s < eq.size(); s++)
+        {
+          sum_constant.push_back(eq[s].GetConstant());
+          if (eq[s].hasParam())
+            {
+              std::pair<real_t,real_t> param = model.getParamRange(eq[s].GetParam() - 1);
+              sum_param.push_back((param.second + param.first) * 0.5);
+            }
+          else
+            sum_param.push_back(1);
+
+          std::vector<std::size_t> vars = eq[s].GetVars();
+          for (size_t i = 0; i < vars.size(); i++)
+            {
+              var_index.push_back(vars[i] - 1);
+              dep_table[v*dim + vars[i] - 1] = 1;
+            }
+          var_begin.push_back(var_index.size());
+
+          std::vector<Summember<real_t>::ramp> ramps = eq[s].GetRamps();
+          for (size_t r = 0; r < ramps.size(); r++)
+            {
+              ramp_var.push_back(ramps[r].dim - 1);
+              ramp_min.push_back(ramps[r].min);
+              ramp_max.push_back(ramps[r].max);
+              ramp_min_value.push_back(ramps[r].min_value);
+              ramp_max_value.push_back(ramps[r].max_value);
+            }
+          ramp_begin.push_back(ramp_var.size());
+
+          for (size_t r = 0; r < eq[s].GetSteps().size(); r++)
+            {
+              step_var.push_back(eq[s].GetSteps().at(r).dim - 1);
+              step_theta.push_back(eq[s].GetSteps().at(r).theta);
+              step_a.push_back(eq[s].GetSteps().at(r).a);
+              step_b.push_back(eq[s].GetSteps().at(r).b);
+            }
+          step_begin.push_back(step_var.size());
+        }
+      eq_begin.push_back(sum_constant.size());
+
+      std::vector<char> used(dim, 0);
+      for (size_t s = eq_begin[v]; s < eq_begin[v+1]; s++)
+        {
+          for (size_t i = var_begin[s]; i < var_begin[s+1]; i++)
+            used[var_index[i]] = 1;
+          for (size_t r = ramp_begin[s]; r < ramp_begin[s+1]; r++)
+            used[ramp_var[r]] = 1;
+          for (size_t r = step_begin[s]; r < step_begin[s+1]; r++)
+            used[step_var[r]] = 1;
+        }
+      for (size_t w = 0; w < dim; w++)
+        if (used[w])
+          used_var.push_back(w);
+      used_begin.push_back(used_var.size());
+    }
+
+  p.thr_begin = ptr(thr_begin);
+  p.thr_value = ptr(thr_value);
+  p.eq_begin = ptr(eq_begin);
+  p.sum_constant = ptr(sum_constant);
+  p.sum_param = ptr(sum_param);
+  p.var_begin = ptr(var_begin);
+  p.ramp_begin = ptr(ramp_begin);
+  p.step_begin = ptr(step_begin);
+  p.var_index = ptr(var_index);
+  p.ramp_var = ptr(ramp_var);
+  p.ramp_min = ptr(ramp_min);
+  p.ramp_max = ptr(ramp_max);
+  p.ramp_min_value = ptr(ramp_min_value);
+  p.ramp_max_value = ptr(ramp_max_value);
+  p.step_var = ptr(step_var);
+  p.step_theta = ptr(step_theta);
+  p.step_a = ptr(step_a);
+  p.step_b = ptr(step_b);
+
+  compiled = true;
+}
+
+// The order of multiplications is the same as in the original evaluation
+// over Summember<T> (constant, variables, parameter, ramps, steps), hence
+// the results are bit-for-bit identical.
+real_t affine_kernel_t::value(const size_t *_where, size_t _var) const
+{
+  real_t sum = 0;
+
+  for (size_t s = p.eq_begin[_var]; s < p.eq_begin[_var+1]; s++)
+    {
+      real_t under_sum = p.sum_constant[s];
+
+      for (size_t i = p.var_begin[s]; i < p.var_begin[s+1]; i++)
+        under_sum *= p.thr_value[p.thr_begin[p.var_index[i]] + _where[p.var_index[i]]];
+
+      under_sum *= p.sum_param[s];
+
+      for (size_t r = p.ramp_begin[s]; r < p.ramp_begin[s+1]; r++)
+        {
+          real_t x = p.thr_value[p.thr_begin[p.ramp_var[r]] + _where[p.ramp_var[r]]];
+          real_t res = (x - p.ramp_min[r]) / (p.ramp_max[r] - p.ramp_min[r]);
+          res = res < 0 ? 0 : (res > 1 ? 1 : res);
+          under_sum *= res * (p.ramp_max_value[r] - p.ramp_min_value[r]);
+        }
+
+      for (size_t r = p.step_begin[s]; r < p.step_begin[s+1]; r++)
+        {
+          real_t x = p.thr_value[p.thr_begin[p.step_var[r]] + _where[p.step_var[r]]];
+          under_sum *= (x < p.step_theta[r] ? p.step_a[r] : p.step_b[r]);
+        }
+
+      sum += under_sum;
+    }
+
+  return sum;
+}
+
+void affine_kernel_t::value_batch(const real_t *_x, size_t _stride, size_t _n,
+                                  size_t _var, real_t *_out) const
+{
+  switch (simd)
+    {
+    case SIMD_AVX2: value_batch_avx2(_x, _stride, _n, _var, _out); break;
+    case SIMD_SSE2: value_batch_sse2(_x, _stride, _n, _var, _out); break;
+    default: value_batch_scalar(_x, _stride, _n, _var, _out); break;
+    }
+}
+
+void affine_kernel_t::value_batch_scalar(const real_t *_x, size_t _stride, size_t _n,
+                                         size_t _var, real_t *_out) const
+{
+  for (size_t j = 0; j < _n; j++)
+    {
+      real_t sum = 0;
+
+      for (size_t s = p.eq_begin[_var]; s < p.eq_begin[_var+1]; s++)
+        {
+          real_t under_sum = p.sum_constant[s];
+
+          for (size_t i = p.var_begin[s]; i < p.var_begin[s+1]; i++)
+            under_sum *= _x[p.var_index[i]*_stride + j];
+
+          under_sum *= p.sum_param[s];
+
+          for (size_t r = p.ramp_begin[s]; r < p.ramp_begin[s+1]; r++)
+            {
+              real_t res = (_x[p.ramp_var[r]*_stride + j] - p.ramp_min[r]) / (p.ramp_max[r] - p.ramp_min[r]);
+              res = res < 0 ? 0 : (res > 1 ? 1 : res);
+              under_sum *= res * (p.ramp_max_value[r] - p.ramp_min_value[r]);
+            }
+
+          for (size_t r = p.step_begin[s]; r < p.step_begin[s+1]; r++)
+            under_sum *= (_x[p.step_var[r]*_stride + j] < p.step_theta[r] ? p.step_a[r] : p.step_b[r]);
+
+          sum += under_sum;
+        }
+
+      _out[j] = sum;
+    }
+}
+
+#ifdef AFFINE_KERNEL_X86
+
+// The clamping of ramps and the steps are done by comparisons and blends
+// (not by min/max), so that the results are the same as in value() even
+// for signed zeros.
+
+__attribute__((target("sse2")))
+void affine_kernel_t::value_batch_sse2(const real_t *_x, size_t _stride, size_t _n,
+                                       size_t _var, real_t *_out) const
+{
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d one = _mm_set1_pd(1);
+
+  for (size_t j = 0; j < _n; j += 2)
+    {
+      __m128d sum = _mm_setzero_pd();
+
+      for (size_t s = p.eq_begin[_var]; s < p.eq_begin[_var+1]; s++)
+        {
+          __m128d under_sum = _mm_set1_pd(p.sum_constant[s]);
+
+          for (size_t i = p.var_begin[s]; i < p.var_begin[s+1]; i++)
+            under_sum = _mm_mul_pd(under_sum, _mm_loadu_pd(_x + p.var_index[i]*_stride + j));
+
+          under_sum = _mm_mul_pd(under_sum, _mm_set1_pd(p.sum_param[s]));
+
+          for (size_t r = p.ramp_begin[s]; r < p.ramp_begin[s+1]; r++)
+            {
+              __m128d x = _mm_loadu_pd(_x + p.ramp_var[r]*_stride + j);
+              __m128d res = _mm_div_pd(_mm_sub_pd(x, _mm_set1_pd(p.ramp_min[r])),
+                                       _mm_set1_pd(p.ramp_max[r] - p.ramp_min[r]));
+              __m128d gt = _mm_cmpgt_pd(res, one);
+              res = _mm_or_pd(_mm_and_pd(gt, one), _mm_andnot_pd(gt, res));
+              __m128d lt = _mm_cmplt_pd(res, zero);
+              res = _mm_andnot_pd(lt, res);
+              under_sum = _mm_mul_pd(under_sum, _mm_mul_pd(res, _mm_set1_pd(p.ramp_max_value[r] - p.ramp_min_value[r])));
+            }
+
+          for (size_t r = p.step_begin[s]; r < p.step_begin[s+1]; r++)
+            {
+              __m128d x = _mm_loadu_pd(_x + p.step_var[r]*_stride + j);
+              __m128d lt = _mm_cmplt_pd(x, _mm_set1_pd(p.step_theta[r]));
+              __m128d val = _mm_or_pd(_mm_and_pd(lt, _mm_set1_pd(p.step_a[r])),
+                                      _mm_andnot_pd(lt, _mm_set1_pd(p.step_b[r])));
+              under_sum = _mm_mul_pd(under_sum, val);
+            }
+
+          sum = _mm_add_pd(sum, under_sum);
+        }
+
+      _mm_storeu_pd(_out + j, sum);
+    }
+}
+
+__attribute__((target("avx2")))
+void affine_kernel_t::value_batch_avx2(const real_t *_x, size_t _stride, size_t _n,
+                                       size_t _var, real_t *_out) const
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1);
+
+  for (size_t j = 0; j < _n; j += 4)
+    {
+      __m256d sum = _mm256_setzero_pd();
+
+      for (size_t s = p.eq_begin[_var]; s < p.eq_begin[_var+1]; s++)
+        {
+          __m256d under_sum = _mm256_set1_pd(p.sum_constant[s]);
+
+          for (size_t i = p.var_begin[s]; i < p.var_begin[s+1]; i++)
+            under_sum = _mm256_mul_pd(under_sum, _mm256_loadu_pd(_x + p.var_index[i]*_stride + j));
+
+          under_sum = _mm256_mul_pd(under_sum, _mm256_set1_pd(p.sum_param[s]));
+
+          for (size_t r = p.ramp_begin[s]; r < p.ramp_begin[s+1]; r++)
+            {
+              __m256d x = _mm256_loadu_pd(_x + p.ramp_var[r]*_stride + j);
+              __m256d res = _mm256_div_pd(_mm256_sub_pd(x, _mm256_set1_pd(p.ramp_min[r])),
+                                          _mm256_set1_pd(p.ramp_max[r] - p.ramp_min[r]));
+              res = _mm256_blendv_pd(res, one, _mm256_cmp_pd(res, one, _CMP_GT_OQ));
+              res = _mm256_blendv_pd(res, zero, _mm256_cmp_pd(res, zero, _CMP_LT_OQ));
+              under_sum = _mm256_mul_pd(under_sum, _mm256_mul_pd(res, _mm256_set1_pd(p.ramp_max_value[r] - p.ramp_min_value[r])));
+            }
+
+          for (size_t r = p.step_begin[s]; r < p.step_begin[s+1]; r++)
+            {
+              __m256d x = _mm256_loadu_pd(_x + p.step_var[r]*_stride + j);
+              __m256d lt = _mm256_cmp_pd(x, _mm256_set1_pd(p.step_theta[r]), _CMP_LT_OQ);
+              under_sum = _mm256_mul_pd(under_sum, _mm256_blendv_pd(_mm256_set1_pd(p.step_b[r]),
+                                                                    _mm256_set1_pd(p.step_a[r]), lt));
+            }
+
+          sum = _mm256_add_pd(sum, under_sum);
+        }
+
+      _mm256_storeu_pd(_out + j, sum);
+    }
+}
+
+#else //AFFINE_KERNEL_X86
+
+void affine_kernel_t::value_batch_sse2(const real_t *_x, size_t _stride, size_t _n,
+                                       size_t _var, real_t *_out) const
+{
+  value_batch_scalar(_x, _stride, _n, _var, _out);
+}
+
+void affine_kernel_t::value_batch_avx2(const real_t *_x, size_t _stride, size_t _n,
+                                       size_t _var, real_t *_out) const
+{
+  value_batch_scalar(_x, _stride, _n, _var, _out);
+}
+
+#endif //AFFINE_KERNEL_X86
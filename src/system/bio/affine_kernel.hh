@@ -0,0 +1,176 @@
+/*!\file
+ * The main contribution of this file is the class affine_kernel_t - a flat
+ * (compiled) form of the equations of a multiaffine ODE model
+ */
+#ifndef DIVINE_AFFINE_KERNEL_HH
+#define DIVINE_AFFINE_KERNEL_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <vector>
+#include "system/bio/data_model/Model.h"
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+typedef double real_t;
+
+//!Compiled evaluation kernel of a multiaffine ODE system
+/*!Model<real_t> keeps the equations as vectors of Summember<real_t> that
+ * are returned by value, hence every lookup copies the whole equation. This
+ * class flattens the equations (after Model<T>::RunAbstraction() has been
+ * run) into contiguous structure-of-arrays tables, so that value() only
+ * walks plain arrays of indices and coefficients.
+ *
+ * All tables are indexed by a summember index s. The factors of the
+ * summember s are stored in the ranges [var_begin[s], var_begin[s+1]),
+ * [ramp_begin[s], ramp_begin[s+1]) and [step_begin[s], step_begin[s+1])
+ * of the corresponding factor tables. Summembers of the equation of the
+ * variable v are in the range [eq_begin[v], eq_begin[v+1]).
+ */
+class affine_kernel_t
+{
+public:
+  //!A constructor - creates an empty (not compiled) kernel
+  affine_kernel_t();
+
+  //!Flattens equations and thresholds of the given model
+  /*!Has to be called after Model<T>::RunAbstraction(), since the
+   * abstraction replaces sigmoids and Hill functions by ramps and adds
+   * new thresholds.*/
+  void compile(const Model<real_t> & model);
+
+  //!Returns true if compile() has been called
+  bool is_compiled() const { return compiled; }
+
+  //!Returns the number of variables
+  size_t get_dim() const { return dim; }
+
+  //!Returns the number of thresholds of the given variable
+  size_t get_treshs(size_t _var) const
+  { return thr_begin[_var+1] - thr_begin[_var]; }
+
+  //!Returns the value of the given threshold
+  real_t get_tresh(size_t _var, size_t _tresh_id) const
+  { return thr_value[thr_begin[_var] + _tresh_id]; }
+
+  //!Returns the array of all threshold values of the given variable
+  const real_t * get_treshs_values(size_t _var) const
+  { return &thr_value[thr_begin[_var]]; }
+
+  //!Returns true if the equation of _var contains variable _next_dim
+  //! as a multiaffine factor (ramps and steps are not considered)
+  bool dep(size_t _var, size_t _next_dim) const
+  { return dep_table[_var*dim + _next_dim] != 0; }
+
+  //!Evaluates the right-hand side of the equation of _var in the
+  //! threshold-grid point _where (one threshold index per variable)
+  real_t value(const size_t *_where, size_t _var) const;
+
+  //!Returns the number of summembers in the equation of _var
+  size_t get_sums(size_t _var) const
+  { return eq_begin[_var+1] - eq_begin[_var]; }
+
+  //!Returns the number of variables used in the equation of _var
+  size_t get_used_count(size_t _var) const
+  { return used_begin[_var+1] - used_begin[_var]; }
+
+  //!Returns the _i-th variable used in the equation of _var
+  size_t get_used(size_t _var, size_t _i) const
+  { return used_var[used_begin[_var] + _i]; }
+
+  //!Instruction sets usable by value_batch()
+  enum simd_t { SIMD_NONE = 0, SIMD_SSE2 = 1, SIMD_AVX2 = 2 };
+
+  //!Returns the best instruction set supported by the running CPU
+  static simd_t detect_simd();
+
+  //!Returns the instruction set used by value_batch()
+  simd_t get_simd() const { return simd; }
+
+  //!Sets the instruction set used by value_batch()
+  /*!Cannot be set to a better one than detect_simd() returns.*/
+  void set_simd(simd_t _simd);
+
+  //!Returns the number of points evaluated at once by value_batch()
+  static size_t batch_width() { return 4; }
+
+  //!Evaluates the equation of _var in _n threshold-grid points at once
+  /*!The points are given by the threshold values (not indices) of
+   * variables: _x[v*_stride + j] is the value of variable v in the j-th
+   * point. Only rows of variables used in the equation are read (see
+   * get_used()). _stride has to be a multiple of batch_width() not smaller
+   * than _n, all _stride points have to be valid (padded) and _out has
+   * to have room for _stride values.
+   *
+   * Every point is computed with the same operations in the same order
+   * as value(), hence the results are identical to the scalar ones.*/
+  void value_batch(const real_t *_x, size_t _stride, size_t _n,
+                   size_t _var, real_t *_out) const;
+
+protected:
+  bool compiled;
+  size_t dim;
+  simd_t simd;
+
+  void value_batch_scalar(const real_t *_x, size_t _stride, size_t _n,
+                          size_t _var, real_t *_out) const;
+  void value_batch_sse2(const real_t *_x, size_t _stride, size_t _n,
+                        size_t _var, real_t *_out) const;
+  void value_batch_avx2(const real_t *_x, size_t _stride, size_t _n,
+                        size_t _var, real_t *_out) const;
+
+  // thresholds of all variables
+  std::vector<size_t> thr_begin;
+  std::vector<real_t> thr_value;
+
+  // equations
+  std::vector<size_t> eq_begin;
+
+  // summembers
+  std::vector<real_t> sum_constant;
+  std::vector<real_t> sum_param;   // midpoint of the parameter range, 1 if none
+  std::vector<size_t> var_begin;
+  std::vector<size_t> ramp_begin;
+  std::vector<size_t> step_begin;
+
+  // multiaffine factors
+  std::vector<size_t> var_index;
+
+  // ramp factors
+  std::vector<size_t> ramp_var;
+  std::vector<real_t> ramp_min;
+  std::vector<real_t> ramp_max;
+  std::vector<real_t> ramp_min_value;
+  std::vector<real_t> ramp_max_value;
+
+  // step factors
+  std::vector<size_t> step_var;
+  std::vector<real_t> step_theta;
+  std::vector<real_t> step_a;
+  std::vector<real_t> step_b;
+
+  // dep_table[v*dim + w] != 0 iff w is a multiaffine factor in the equation of v
+  std::vector<char> dep_table;
+
+  // variables used (in any factor) in the equation of v are in the range
+  // [used_begin[v], used_begin[v+1]) of used_var
+  std::vector<size_t> used_begin;
+  std::vector<size_t> used_var;
+
+  // plain pointers to the tables (set by compile()), the evaluation uses
+  // them since vector::operator[] is not inlined in unoptimized builds
+  struct {
+    const size_t *thr_begin, *eq_begin, *var_begin, *ramp_begin, *step_begin;
+    const size_t *var_index, *ramp_var, *step_var;
+    const real_t *thr_value, *sum_constant, *sum_param;
+    const real_t *ramp_min, *ramp_max, *ramp_min_value, *ramp_max_value;
+    const real_t *step_theta, *step_a, *step_b;
+  } p;
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
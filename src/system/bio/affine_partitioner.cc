@@ -0,0 +1,190 @@
+#include "system/bio/affine_partitioner.hh"
+#include "system/bio/affine_explicit_system.hh"
+#include "common/error.hh"
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <set>
+#include <sstream>
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+namespace {
+  struct more_treshs_t
+  {
+    affine_explicit_system_t & sys;
+    more_treshs_t(affine_explicit_system_t & _sys): sys(_sys) {}
+    bool operator()(size_t _a, size_t _b) const
+    { return sys.get_treshs(_a) > sys.get_treshs(_b); }
+  };
+}
+
+affine_partitioner_t::affine_partitioner_t(affine_explicit_system_t & _sys,
+                                           const std::string & _spec, int _parts):
+  layout(_sys.state_layout)
+{
+  // split the specification to the kind, the variables and the number of samples
+  std::string spec = _spec;
+  size_t samples = 0;
+  size_t at = spec.find('@');
+  if (at != std::string::npos)
+    {
+      samples = atoi(spec.c_str() + at + 1);
+      if (samples == 0)
+        gerr << "Invalid number of sampled states in partition " << _spec << thr();
+      spec.erase(at);
+    }
+
+  size_t colon = spec.find(':');
+  std::string kind = spec.substr(0, colon);
+  size_t wanted = 1;
+  if (kind == "slab")
+    wanted = 1;
+  else if (kind == "block")
+    wanted = 2;
+  else
+    gerr << "Unknown partition " << _spec << " (use slab[:x] or block[:x,y,...])" << thr();
+
+  if (colon != std::string::npos)
+    {
+      std::istringstream list(spec.substr(colon + 1));
+      std::string var;
+      while (std::getline(list, var, ','))
+        {
+          size_t id = _sys.get_varid(var);
+          if (std::find(vars.begin(), vars.end(), id) != vars.end())
+            gerr << "Variable " << var << " given twice in partition " << _spec << thr();
+          vars.push_back(id);
+        }
+      if (kind == "slab" && vars.size() != 1)
+        gerr << "Slab partition needs exactly one variable" << thr();
+    }
+  else
+    {
+      // the variables with the most thresholds
+      std::vector<size_t> all(_sys.get_dim());
+      for (size_t i = 0; i < all.size(); i++)
+        all[i] = i;
+      std::stable_sort(all.begin(), all.end(), more_treshs_t(_sys));
+      all.resize(std::min(wanted, all.size()));
+      vars = all;
+    }
+
+  // factorize the number of workstations among the variables, every prime
+  // factor (the largest first) goes to the variable with the widest parts
+  std::vector<int> primes;
+  for (int n = _parts, p = 2; n > 1; )
+    {
+      if (n % p == 0)
+        {
+          primes.push_back(p);
+          n /= p;
+        }
+      else
+        p++;
+    }
+
+  std::vector<int> parts(vars.size(), 1);
+  for (size_t j = primes.size(); j-- > 0; )
+    {
+      size_t best = 0;
+      for (size_t i = 1; i < vars.size(); i++)
+        if ((_sys.get_treshs(vars[i]) + 1.0) / parts[i] >
+            (_sys.get_treshs(vars[best]) + 1.0) / parts[best])
+          best = i;
+      parts[best] *= primes[j];
+    }
+
+  std::vector<std::vector<size_t> > counts;
+  if (samples)
+    sample(_sys, samples, counts);
+
+  // every coordinate gets the part containing the middle of its weight,
+  // the weight is 1 or (with sampling) the number of sampled states + 1
+  part.resize(vars.size());
+  stride.resize(vars.size());
+  int weight_of_part = 1;
+  for (size_t i = 0; i < vars.size(); i++)
+    {
+      // coordinates are 0..get_treshs() (see set_state_layout())
+      size_t values = _sys.get_treshs(vars[i]) + 1;
+      std::vector<double> weight(values, 1.0);
+      if (samples)
+        for (size_t v = 0; v < values; v++)
+          weight[v] += counts[i][v];
+
+      double total = 0;
+      for (size_t v = 0; v < values; v++)
+        total += weight[v];
+
+      part[i].resize(values);
+      double before = 0;
+      for (size_t v = 0; v < values; v++)
+        {
+          int p = int((before + weight[v] / 2) * parts[i] / total);
+          part[i][v] = std::min(p, parts[i] - 1);
+          before += weight[v];
+        }
+
+      stride[i] = weight_of_part;
+      weight_of_part *= parts[i];
+    }
+
+  std::ostringstream n;
+  n << kind << ":";
+  for (size_t i = 0; i < vars.size(); i++)
+    n << (i ? "," : "") << _sys.get_varname(vars[i]);
+  if (samples)
+    n << "@" << samples;
+  n << " (";
+  for (size_t i = 0; i < vars.size(); i++)
+    n << (i ? "x" : "") << parts[i];
+  n << ")";
+  name = n.str();
+}
+
+int affine_partitioner_t::get_owner(const state_t & _state) const
+{
+  int owner = 0;
+  for (size_t i = 0; i < vars.size(); i++)
+    owner += stride[i] * part[i][layout.get(_state.ptr, vars[i])];
+  return owner;
+}
+
+void affine_partitioner_t::sample(const affine_explicit_system_t & _sys, size_t _states,
+                                  std::vector<std::vector<size_t> > & _counts) const
+{
+  // a copy of the system, so the statistics of _sys are not affected
+  affine_explicit_system_t sys(_sys);
+  succ_container_t succs(sys);
+  std::set<std::string> seen;
+  std::queue<state_t> queue;
+
+  _counts.resize(vars.size());
+  for (size_t i = 0; i < vars.size(); i++)
+    _counts[i].assign(sys.get_treshs(vars[i]) + 1, 0);
+
+  state_t initial = sys.get_initial_state();
+  seen.insert(std::string(initial.ptr, initial.size));
+  queue.push(initial);
+
+  for (; !queue.empty(); queue.pop())
+    {
+      state_t s = queue.front();
+      for (size_t i = 0; i < vars.size(); i++)
+        _counts[i][layout.get(s.ptr, vars[i])]++;
+
+      sys.get_succs(s, succs);
+      for (size_t j = 0; j < succs.size(); j++)
+        {
+          if (seen.size() < _states &&
+              seen.insert(std::string(succs[j].ptr, succs[j].size)).second)
+            queue.push(succs[j]);
+          else
+            delete_state(succs[j]);
+        }
+      delete_state(s);
+    }
+}
@@ -0,0 +1,72 @@
+/*!\file
+ * The main contribution of this file is the class affine_partitioner_t -
+ * partition function of affine systems by blocks of the threshold grid
+ */
+#ifndef DIVINE_AFFINE_PARTITIONER_HH
+#define DIVINE_AFFINE_PARTITIONER_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <string>
+#include <vector>
+#include "distributed/partitioner.hh"
+#include "system/bio/affine_state_layout.hh"
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+class affine_explicit_system_t;
+
+//!Partition function of affine systems by blocks of the threshold grid
+/*!Successors of a rectangle are its neighbours in the threshold grid,
+ * hashing the whole state thus sends almost every transition to another
+ * workstation. This partition function cuts the grid along the selected
+ * variables into slabs (one variable) or blocks (more variables), so only
+ * the transitions crossing the cuts are sent. The position of the property
+ * automaton is not taken into account.
+ *
+ * The partition is given by a string
+ * <tt>slab[:x]</tt> or <tt>block[:x,y,...]</tt> optionally followed by
+ * <tt>\@n</tt>, where x, y are the names of variables (by default the
+ * variable with the most thresholds, resp. the two of them). The number of
+ * workstations is factorized among the variables. Without \@n the ranges of
+ * the variables are cut into equally wide parts, otherwise the first n
+ * states (in breadth-first order) are generated and the cuts are placed
+ * so that the parts hold the same number of these states.
+ *
+ * The sampling is deterministic, so all workstations compute the same
+ * partition without communication.
+ */
+class affine_partitioner_t : public partitioner_t
+{
+public:
+  //!A constructor - creates the partition given by _spec for _parts workstations
+  /*!Errors in _spec are reported through gerr.*/
+  affine_partitioner_t(affine_explicit_system_t & _sys,
+                       const std::string & _spec, int _parts);
+
+  //!Implements partitioner_t::get_owner()
+  virtual int get_owner(const state_t & _state) const;
+
+  //!Implements partitioner_t::get_name()
+  virtual std::string get_name() const { return name; }
+
+protected:
+  void sample(const affine_explicit_system_t & _sys, size_t _states,
+              std::vector<std::vector<size_t> > & _counts) const;
+
+  affine_state_layout_t layout;
+  std::string name;
+  //!The selected variables
+  std::vector<size_t> vars;
+  //!part[i][v] - the part of the i-th selected variable with coordinate v
+  std::vector<std::vector<int> > part;
+  //!stride[i] - the weight of the part of the i-th variable in the owner
+  std::vector<int> stride;
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
@@ -118,13 +118,13 @@ std::string divine::affine_property_transition_t::to_string() const
   return result;    
 };
 
-bool divine::affine_property_transition_t::enabled(divine::state_t _state)
+bool divine::affine_property_transition_t::enabled(const size_t *_where)
 {
   std::list<divine::affine_ap_t>::iterator i;
   
   for (i=positive_guards->begin(); i!=positive_guards->end(); i++)
     {
-      if (!(i->valid(_state)))
+      if (!(i->valid(_where)))
 		{
 		  return false;
 		}	  
@@ -132,7 +132,7 @@ bool divine::affine_property_transition_t::enabled(divine::state_t _state)
 
   for (i=negative_guards->begin(); i!=negative_guards->end(); i++)
     {
-      if ((i->valid(_state)))
+      if ((i->valid(_where)))
 		{
 		  return false;
 		}	  
@@ -142,6 +142,75 @@ bool divine::affine_property_transition_t::enabled(divine::state_t _state)
  
 
 
+bool divine::affine_property_transition_t::compile(std::vector<divine::affine_guard_interval_t> & _intervals)
+{
+  size_t first = _intervals.size();
+  std::list<divine::affine_ap_t>::iterator i;
+  
+  for (int negated = 0; negated < 2; negated++)
+    {
+      std::list<divine::affine_ap_t> *guards = (negated ? negative_guards : positive_guards);
+      if (guards == 0) continue;
+      for (i=guards->begin(); i!=guards->end(); i++)
+	{
+	  if (i->is_true())
+	    {
+	      if (negated) //(not true) is never valid
+		{
+		  _intervals.resize(first);
+		  return false;
+		}
+	      continue;
+	    }
+
+	  //strict and nonstrict inequalities coincide (see affine_ap_t::valid())
+	  bool less = true;
+	  switch (i->get_op())
+	    {
+	    case AFFINE_AP_LESS:
+	    case AFFINE_AP_LESS_EQUAL:
+	      less = true;
+	      break;
+	    case AFFINE_AP_GREATER:
+	    case AFFINE_AP_GREATER_EQUAL:
+	      less = false;
+	      break;
+	    default:
+	      assert(0); //unknown arithmetic expression
+	    }
+	  size_t lower = 0, upper = size_t(-1);
+	  if (less != bool(negated))
+	    upper = i->get_treshold();
+	  else
+	    lower = i->get_treshold();
+
+	  //intersection with the interval of the same variable
+	  size_t var = i->get_index();
+	  size_t j = first;
+	  while (j < _intervals.size() && _intervals[j].var != var)
+	    j++;
+	  if (j == _intervals.size())
+	    {
+	      divine::affine_guard_interval_t interval = { var, lower, upper };
+	      _intervals.push_back(interval);
+	    }
+	  else
+	    {
+	      _intervals[j].lower = std::max(_intervals[j].lower, lower);
+	      _intervals[j].upper = std::min(_intervals[j].upper, upper);
+	    }
+	}
+    }
+
+  for (size_t j = first; j < _intervals.size(); j++)
+    if (_intervals[j].lower >= _intervals[j].upper)
+      {
+	_intervals.resize(first);
+	return false;
+      }
+  return true;
+}
+
 void divine::affine_property_transition_t::write(std::ostream&) const
 {
   gerr<<"affine_property_t does not implement write"<<thr();
@@ -402,6 +471,31 @@ void divine::affine_property_t::add_transition(divine::transition_t * _trans)
 
 // Methods needed for synchronization within affine_explicit_system_t::get_succs()
 
+void divine::affine_property_t::compile()
+{
+  compiled_begin.assign(state_names.size()+1, 0);
+  compiled.clear();
+  intervals.clear();
+
+  for (size_t from = 0; from < state_names.size(); from++)
+    {
+      compiled_begin[from] = compiled.size();
+      for (size_t t = 0; t < transitions.size(); t++)
+	{
+	  if (transitions[t]->get_from_id() != from)
+	    continue;
+	  affine_compiled_transition_t trans;
+	  trans.to_id = transitions[t]->get_to_id();
+	  trans.first_interval = intervals.size();
+	  if (!transitions[t]->compile(intervals))
+	    continue;
+	  trans.last_interval = intervals.size();
+	  compiled.push_back(trans);
+	}
+    }
+  compiled_begin[state_names.size()] = compiled.size();
+}
+
 //!Destructor
 divine::affine_property_t::~affine_property_t() 
 {
@@ -39,6 +39,8 @@
 #include <map>
 #include <math.h>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <system/transition.hh>
 #include <system/bio/affine_atomic_propositions.hh>
 
@@ -59,6 +61,24 @@
 namespace divine {
 #endif //DOXYGEN_PROCESSING
 
+  //!Interval of threshold indices of a variable
+  /*!A compiled guard is satisfied if lower <= _where[var] < upper holds for
+   * all its intervals (see affine_property_t::compile()).*/
+  struct affine_guard_interval_t {
+    size_t var;
+    size_t lower;
+    size_t upper;
+  };
+
+  //!Transition of a property process compiled by affine_property_t::compile()
+  /*!Its guard consists of the intervals first_interval, ..., last_interval-1
+   * of the property process.*/
+  struct affine_compiled_transition_t {
+    size_t to_id;
+    size_t first_interval;
+    size_t last_interval;
+  };
+
   //!Tranistion of a property process
   /*!Positive guards are list of affine APs that must be satisfied in order to
    * enable the transition. Simirarly, all negative guards must evaluate to
@@ -112,8 +132,13 @@ namespace divine {
       return to_name;
     }
 
-    //!Checks whether the transiotion is enabled over given state
-    bool enabled(divine::state_t);
+    //!Checks whether the transiotion is enabled over given (unpacked) state
+    bool enabled(const size_t *_where);
+
+    /*!Appends the guard of the transition as one interval per restricted
+     * variable to _intervals. Returns false (and appends nothing) if the
+     * transition cannot be enabled in any state.*/
+    bool compile(std::vector<divine::affine_guard_interval_t> & _intervals);
     
 
     //Obligatory virtual interface
@@ -157,6 +182,9 @@ namespace divine {
     //!Returns internal ID the  an initial state
     size_t get_initial_state();
 
+    //!Returns the number of states
+    size_t get_state_count() const { return state_names.size(); }
+
     /*!Marks accepting state. Assertion violated if the state to be marked as
      *accepting hasn't been inserted before.
      */
@@ -180,9 +208,32 @@ namespace divine {
      */
     virtual void add_transition(divine::transition_t * _trans);
 
+    /*!Compiles the transitions into the tables of transitions going from
+     * the single states with guards consisting of intervals of threshold
+     * indices (see get_compiled_transitions()). Transitions which cannot be
+     * enabled are left out. Has to be called after the last transition is
+     * added.*/
+    void compile();
 
+    /*!Returns the compiled transitions going from the state with internal
+     * ID _from, _count is set to their number.*/
+    const affine_compiled_transition_t * get_compiled_transitions(size_t _from, size_t & _count) const
+    {
+      _count = compiled_begin[_from+1] - compiled_begin[_from];
+      return (_count ? &compiled[compiled_begin[_from]] : 0);
+    }
 
-    
+    //!Checks whether the compiled transition is enabled over given (unpacked) state
+    bool enabled(const affine_compiled_transition_t & _trans, const size_t *_where) const
+    {
+      for (size_t i = _trans.first_interval; i < _trans.last_interval; i++)
+        {
+          const affine_guard_interval_t & interval = intervals[i];
+          if (_where[interval.var] < interval.lower || _where[interval.var] >= interval.upper)
+            return false;
+        }
+      return true;
+    }
         
     //!Destructor
     virtual ~affine_property_t();
@@ -192,6 +243,11 @@ namespace divine {
     array_t<bool> accepting;
     size_t initial;
     array_t<affine_property_transition_t *> transitions;
+    //the compiled transitions going from the state with ID i are
+    //compiled[compiled_begin[i]], ..., compiled[compiled_begin[i+1]-1]
+    std::vector<size_t> compiled_begin;
+    std::vector<affine_compiled_transition_t> compiled;
+    std::vector<affine_guard_interval_t> intervals;
   };
 
 #ifndef DOXYGEN_PROCESSING  
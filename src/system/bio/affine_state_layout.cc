@@ -0,0 +1,55 @@
+#include "system/bio/affine_state_layout.hh"
+#include <cstring>
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+affine_state_layout_t::affine_state_layout_t(): size(0)
+{
+}
+
+void affine_state_layout_t::set_fields(const std::vector<size_t> & _max_values)
+{
+  const size_t word_bits = 8*sizeof(size_t);
+
+  max_values = _max_values;
+  offset.resize(_max_values.size());
+  width.resize(_max_values.size());
+  mask.resize(_max_values.size());
+
+  size_t bit = 0;
+  for (size_t i = 0; i < _max_values.size(); i++)
+    {
+      size_t w = 0;
+      while (w < word_bits && (_max_values[i] >> w))
+        w++;
+
+      // get() and set() assemble the field in one size_t, hence the field
+      // together with its shift inside of the first byte has to fit into it
+      if ((bit & 7) + w > word_bits)
+        bit = (bit + 7) & ~size_t(7);
+
+      offset[i] = bit;
+      width[i] = w;
+      mask[i] = (w == word_bits ? ~size_t(0) : (size_t(1) << w) - 1);
+      bit += w;
+    }
+
+  size = (bit + 7) / 8;
+  if (!size)
+    size = 1; // states of zero size cannot be stored
+}
+
+void affine_state_layout_t::unpack(const char *_ptr, size_t *_values) const
+{
+  for (size_t i = 0; i < offset.size(); i++)
+    _values[i] = get(_ptr, i);
+}
+
+void affine_state_layout_t::pack(const size_t *_values, char *_ptr) const
+{
+  memset(_ptr, 0, size);
+  for (size_t i = 0; i < offset.size(); i++)
+    set(_ptr, i, _values[i]);
+}
@@ -0,0 +1,99 @@
+/*!\file
+ * The main contribution of this file is the class affine_state_layout_t -
+ * bit-packed layout of states of affine systems
+ */
+#ifndef DIVINE_AFFINE_STATE_LAYOUT_HH
+#define DIVINE_AFFINE_STATE_LAYOUT_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <vector>
+#include <cstddef>
+#include "system/state.hh"
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+//!Bit-packed layout of a state of affine system
+/*!The state of affine system is a vector of small numbers - threshold
+ * indices of all variables followed (if there is a property) by the
+ * position of the property automaton. Each of them is stored as a bit field
+ * of width given by the largest value it has to hold, fields are stored
+ * one after another (from the lowest bit of the first byte) and the state
+ * is padded to whole bytes.
+ *
+ * The byte order does not depend on the architecture, states can therefore
+ * be sent between workstations.
+ */
+class affine_state_layout_t
+{
+public:
+  //!A constructor - creates a layout with no fields
+  affine_state_layout_t();
+
+  //!Sets the fields, _max_values[i] is the largest value of i-th field
+  void set_fields(const std::vector<std::size_t> & _max_values);
+
+  //!Returns the number of fields
+  std::size_t get_fields() const { return offset.size(); }
+
+  //!Returns the largest values of the fields (as given to set_fields())
+  const std::vector<std::size_t> & get_max_values() const { return max_values; }
+
+  //!Returns the width of the given field in bits
+  std::size_t get_width(std::size_t _field) const { return width[_field]; }
+
+  //!Returns the size of the packed state in bytes
+  std::size_t get_size() const { return size; }
+
+  //!Returns the value of the given field of the state stored at _ptr
+  std::size_t get(const char *_ptr, std::size_t _field) const
+  {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(_ptr) + (offset[_field] >> 3);
+    std::size_t shift = offset[_field] & 7;
+    std::size_t bits = shift + width[_field];
+    std::size_t word = 0;
+    for (std::size_t i = 0; i*8 < bits; i++)
+      word |= std::size_t(p[i]) << (8*i);
+    return (word >> shift) & mask[_field];
+  }
+
+  //!Sets the value of the given field of the state stored at _ptr
+  void set(char *_ptr, std::size_t _field, std::size_t _value) const
+  {
+    unsigned char *p = reinterpret_cast<unsigned char *>(_ptr) + (offset[_field] >> 3);
+    std::size_t shift = offset[_field] & 7;
+    std::size_t bits = shift + width[_field];
+    std::size_t m = mask[_field] << shift;
+    std::size_t v = (_value & mask[_field]) << shift;
+    for (std::size_t i = 0; i*8 < bits; i++)
+      p[i] = static_cast<unsigned char>((p[i] & ~(m >> (8*i))) | (v >> (8*i)));
+  }
+
+  //!Returns the value of the given field of _state
+  std::size_t get(const state_t _state, std::size_t _field) const
+  { return get(_state.ptr, _field); }
+
+  //!Sets the value of the given field of _state
+  void set(state_t _state, std::size_t _field, std::size_t _value) const
+  { set(_state.ptr, _field, _value); }
+
+  //!Unpacks all fields of the state stored at _ptr to _values
+  void unpack(const char *_ptr, std::size_t *_values) const;
+
+  //!Packs _values to the state stored at _ptr (get_size() bytes)
+  void pack(const std::size_t *_values, char *_ptr) const;
+
+protected:
+  std::vector<std::size_t> max_values;
+  std::vector<std::size_t> offset;   // in bits
+  std::vector<std::size_t> width;    // in bits
+  std::vector<std::size_t> mask;
+  std::size_t size;
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
@@ -149,6 +149,7 @@ void affine_system_t::static_partitioning(std::string _varname, real_t _stFrom,
 affine_system_t::affine_system_t(error_vector_t & evect):system_t(evect),inited(0), dim(0), vars(0)  
 {
   property_process = 0;
+  selected_property = 0;
   has_system_keyword = false;
   get_abilities().system_can_property_process = true;
   significance=1;
@@ -161,6 +162,36 @@ affine_system_t::affine_system_t(error_vector_t & evect):system_t(evect),inited(
   randomize = 0;
   maxprob = 1;
   selfloops = true;
+  vertex_cache_size = DEFAULT_VERTEX_CACHE_SIZE;
+  batched_faces = false;
+}
+
+affine_system_t::affine_system_t(const affine_system_t & second):
+  system_t(second.terr), inited(second.inited), dim(second.dim), vars(second.vars),
+  model(second.model), kernel(second.kernel), vertex_cache(second.vertex_cache),
+  state_layout(second.state_layout)
+{
+  copy_private_part(second);
+  useFastApproximation = second.useFastApproximation;
+  precision_thr = second.precision_thr;
+  zero_range = second.zero_range;
+  property_process = second.property_process;
+  properties = second.properties;
+  model_text = second.model_text;
+  selected_property = second.selected_property;
+  initials = second.initials;
+  has_system_keyword = second.has_system_keyword;
+  array_of_values = 0;
+  if (second.array_of_values)
+    array_of_values = static_cast<real_t*>(malloc(sizeof(real_t)*model.getDims()*4));
+  most_signifficant_only = second.most_signifficant_only;
+  significance = second.significance;
+  refinement_iterations = second.refinement_iterations;
+  randomize = second.randomize;
+  maxprob = second.maxprob;
+  selfloops = second.selfloops;
+  vertex_cache_size = second.vertex_cache_size;
+  batched_faces = second.batched_faces;
 }
 
 //Destructor
@@ -170,6 +201,11 @@ affine_system_t::~affine_system_t()
     free(array_of_values);
 }
 
+void affine_system_t::set_vertex_cache_size(size_t _entries)
+{
+  vertex_cache_size = _entries;
+}
+
 void affine_system_t::set_iterations(size_t _it)
 {
   refinement_iterations = _it;
@@ -177,13 +213,26 @@ void affine_system_t::set_iterations(size_t _it)
 
 size_t affine_system_t::get_state_size()
 {
-  size_t retval;
+  return state_layout.get_size();
+}
 
-  if ( get_with_property() )
-    retval = (get_dim() + 1)*sizeof(size_t);
-  else
-    retval = get_dim()*sizeof(size_t);
-  return retval;
+void affine_system_t::set_state_layout()
+{
+  // coordinate i is in 0..get_treshs(i) (get_treshs(0) in the pre-initial state)
+  std::vector<size_t> max_values(get_dim());
+  for (size_t i=0; i < get_dim(); i++)
+    max_values[i] = get_treshs(i);
+  if (get_with_property())
+    {
+      size_t states = 0;
+      for (size_t p=0; p < properties.size(); p++)
+        states = std::max(states, properties[p]->get_state_count());
+      max_values.push_back(states ? states-1 : 0);
+      // the index of the property process (see add_property())
+      if (properties.size() > 1)
+        max_values.push_back(properties.size()-1);
+    }
+  state_layout.set_fields(max_values);
 }
 
 std::string affine_system_t::write_state(divine::state_t _state)
@@ -195,7 +244,7 @@ std::string affine_system_t::write_state(divine::state_t _state)
   retval<<"[";
   for (size_t i=0; i < get_dim(); i++)
     {
-      size_t aux=*(static_cast<size_t*>(static_cast<void*>(sizeof(size_t)*i+_state.ptr)));
+      size_t aux=state_layout.get(_state,i);
       if (i == 0 and aux == get_treshs(0))
 		{
 		  retval <<"pre-initial]";	       	   
@@ -205,8 +254,10 @@ std::string affine_system_t::write_state(divine::state_t _state)
     }
   if (get_with_property()) 
     {
-      size_t aux=*(static_cast<size_t*>(static_cast<void*>(sizeof(size_t)*get_dim()+_state.ptr)));
+      size_t aux=state_layout.get(_state,get_dim());
       retval <<"-PP:"<<aux;
+      if (properties.size() > 1) //the index of the property process follows
+        retval <<","<<state_layout.get(_state,get_dim()+1);
     }
   retval <<"]";	       	   
   return retval.str();
@@ -220,7 +271,7 @@ divine::state_t affine_system_t::read_state(std::string _stateStr)
   size_t propPos=0;
   std::string _str=_stateStr;
   _s.size=get_state_size();
-  _s.ptr=new char[sizeof(size_t)*_s.size];
+  _s.ptr=new char[_s.size];
   if (!_s.ptr)
     {
       error("read_state",3);
@@ -232,14 +283,16 @@ divine::state_t affine_system_t::read_state(std::string _stateStr)
       //CONDITIONS on pre-initial state:
       // _s[0]=get_treshs(0); 
       // _s[get_dim()] = intial location of property process, if property process is present
+      // _s[get_dim()+1] = selected_property, if there are more property processes
 
-      (static_cast<size_t*>(static_cast<void*>(_s.ptr)))[0]=get_treshs(0);
+      state_layout.set(_s,0,get_treshs(0));
       if (get_with_property()) 
 	{
-	  affine_property_t *propproc = dynamic_cast<affine_property_t*>(get_property_process());
-	  assert (propproc!=0);
+	  affine_property_t *propproc = properties[selected_property];
 	  size_t temp_pp_pos=propproc->get_initial_state();
-	  (static_cast<size_t*>(static_cast<void*>(_s.ptr)))[get_dim()] = temp_pp_pos;
+	  state_layout.set(_s,get_dim(),temp_pp_pos);
+	  if (properties.size() > 1)
+	    state_layout.set(_s,get_dim()+1,selected_property);
 	}
       return _s;
     }
@@ -260,15 +313,19 @@ divine::state_t affine_system_t::read_state(std::string _stateStr)
       auxs=auxs.substr(auxs.find("(")+1);
       auxs=auxs.substr(0,auxs.size()-1); // erase terminating ')'
       size_t val=trunc(parseNumber(auxs));
-      (static_cast<size_t*>(static_cast<void*>(_s.ptr)))[index]=val;      
+      state_layout.set(_s,index,val);
       f1.pop();
       index++;
     }
   f.pop();
   if (get_with_property()) 
     {
-      propPos=trunc(parseNumber(f.front()));
-      (static_cast<size_t*>(static_cast<void*>(_s.ptr)))[get_dim()]=propPos;
+      std::queue<std::string> f2=split(",",f.front());
+      propPos=trunc(parseNumber(f2.front()));
+      state_layout.set(_s,get_dim(),propPos);
+      f2.pop();
+      if (properties.size() > 1 && !f2.empty())
+	state_layout.set(_s,get_dim()+1,trunc(parseNumber(f2.front())));
     }
   return _s;
 }
@@ -540,105 +597,45 @@ size_t affine_system_t::refineTreshs( size_t it )
 real_t affine_system_t::value(size_t *_where, size_t _var)
 {
   bool dbg = false;
-  real_t sum = 0;
   
   if(dbg) std::cerr << "Computing value() for var with index " << _var << "\n";
 
-	for(size_t s = 0; s < model.getEquationForVariable(_var).size(); s++) {
-	
-		//adding value of constant in actual summember 's' of equation for variable '_var'
-		real_t underSum = model.getSumForVarByIndex(_var,s).GetConstant();
-		if(dbg) std::cerr << "\tconstant is " << underSum << "\n";
-
-		//adding values of variables in actual summember 's' of equation for variable '_var' in given point
-		for(size_t v = 0; v < model.getSumForVarByIndex( _var, s ).GetVars().size(); v++) {		
-		
-			size_t actualVarIndex = model.getSumForVarByIndex(_var,s).GetVars().at(v) - 1;
-			real_t thres = model.getThresholdForVarByIndex( actualVarIndex, _where[ actualVarIndex ] );
-			
-			if(dbg) std::cerr << "\tthres for var " << actualVarIndex << " is " << thres << "\n";
-			
-			underSum *= thres;
-		}
-	
-		//adding average value of actual summember's parameter, if any exists
-		if(model.getSumForVarByIndex(_var,s).hasParam()) {
-			std::pair<real_t,real_t> param = model.getParamRange(model.getSumForVarByIndex(_var,s).GetParam() - 1);
-			underSum *= (param.second + param.first) * 0.5;
-		}
-		
-		//adding enumerated ramps for actual summember 's' of equation for variable '_var'
-		for(size_t r = 0; r < model.getSumForVarByIndex(_var, s).GetRamps().size(); r++) {
-			
-			size_t rampVarIndex = model.getSumForVarByIndex(_var, s).GetRamps().at(r).dim -1;
-			real_t thres = model.getThresholdForVarByIndex( rampVarIndex, _where[ rampVarIndex ] );
-			
-			underSum *= model.getSumForVarByIndex(_var, s).GetRamps().at(r).value(thres);
-		}
-		
-		//adding enumerated step functions for actual summember 's' of equation for variable '_var'
-		for(size_t r = 0; r < model.getSumForVarByIndex(_var, s).GetSteps().size(); r++) {
-			
-			size_t stepVarIndex = model.getSumForVarByIndex(_var, s).GetSteps().at(r).dim -1;
-			real_t thres = model.getThresholdForVarByIndex( stepVarIndex, _where[ stepVarIndex ] );
-			
-			underSum *= model.getSumForVarByIndex(_var, s).GetSteps().at(r).value(thres);
-		}
-/*
-		//adding enumerated hill functions for actual summember 's' of equation for variable '_var'
-		for(size_t r = 0; r < model.getSumForVarByIndex(_var, s).GetHills().size(); r++) {
-			
-			size_t hillVarIndex = model.getSumForVarByIndex(_var, s).GetHills().at(r).dim -1;
-			real_t thres = model.getThresholdForVarByIndex( hillVarIndex, _where[ hillVarIndex ] );
-			
-			underSum *= model.getSumForVarByIndex(_var, s).GetHills().at(r).value(thres);
-		}
-*/
-		
-		//adding enumerated summember 's' to sum
-		sum += underSum;
-	}
+  // the equations are evaluated over flat tables compiled after the abstraction
+  // (see affine_kernel_t), the original evaluation over Summember<T> copied
+  // the whole equation for every single summember and factor; neighbouring
+  // rectangles share most of their vertices, hence the values are cached
+  real_t sum;
+  if (!vertex_cache.lookup(_where, _var, sum))
+    {
+      sum = kernel.value(_where, _var);
+      vertex_cache.insert(_where, _var, sum);
+    }
 
   if ( dbg ) std::cerr << "final value = " << sum << std::endl;
 
-  // if smaller than the largest possible real_t numerical error
-  if ( (sum > 0 && sum < zero_range) || (sum < 0 && sum > -zero_range ) )
-    {
-      if ( dbg ) std::cerr << "value too small, taking as zero...[precision = " << zero_range << "]" << endl;
+  return cut_zero(sum);
+}
 
-      sum = 0;
-    }
+real_t affine_system_t::cut_zero(real_t _value)
+{
+  // if smaller than the largest possible real_t numerical error
+  if ( (_value > 0 && _value < zero_range) || (_value < 0 && _value > -zero_range ) )
+    return 0;
 
-  return sum;
+  return _value;
 }
 
 signed int affine_system_t::signum(size_t *_where, size_t _var)
 {
-  if (value(_where,_var)>0) return 1;
-  if (value(_where,_var)<0) return -1;
+  real_t val = value(_where,_var);
+  if (val>0) return 1;
+  if (val<0) return -1;
   return 0;
 }
 
 bool affine_system_t::dep( size_t _var, size_t _next_dim )
 {
-  bool retval = false;
-  
-  for( size_t i = 0; i < model.getEquationForVariable(_var).size(); i++ ) {
-		for( size_t v = 0; v < model.getSumForVarByIndex(_var, i).GetVars().size(); v++ ) {
-			if( model.getSumForVarByIndex(_var, i).GetVars().at(v) - 1 == _next_dim ) {
-				retval = true;
-				break;
-			}
-		}
-  }
-/*
-  for ( size_t i = 0; i < vars[_var].n_sums; i++ )
-    if ( vars[_var].sums[i].used_vars.get(_next_dim) ) {
-      retval = true;
-      break;
-    }
-*/
-  return retval;
+  return kernel.dep(_var, _next_dim);
 }
 
 void affine_system_t::recursive(
@@ -664,63 +661,24 @@ void affine_system_t::recursive(
       if (dbg)
         {
           divine::state_t s;
-          s.ptr = static_cast<char *>(static_cast<void*>(_state));
           s.size = get_state_size();
+          s.ptr = new char[s.size];
+          state_layout.pack(_state, s.ptr);
           std::cout << write_state(s);
+          delete [] s.ptr;
         }
 
-      if (all_values_array==NULL)
-		{
-		  if (_up_direction && signum(_state,_var) > 0)
-			{
-			  if (dbg) std::cerr << endl << value(_state,_var) << endl;
-			  *_result = true;
-			}
-
-		  if (!_up_direction && signum(_state,_var) < 0)
-			{
-			  if (dbg) std::cerr << endl << value(_state,_var) << endl;
-			  *_result = true;
-			}
-		}
-      else
-		{
-		  if ( dbg ) std::cerr << "affine_system::recursive: computing array_of_values" << endl;
+      vertex(_result, _var, _up_direction, value(_state,_var), all_values_array, dbg);
 
-		  if (_up_direction)
-			{
-			  if (signum(_state,_var) > 0) 
-				{
-				  all_values_array[4*_var + 0] += value(_state,_var);
-				  // if most_signifficant, we only compute the array
-				  if ( !most_signifficant_only && selfloops )
-				  		*_result = true;
-		       	}	
-			  if (signum(_state,_var) < 0)
-				  all_values_array[4*_var + 1] += (-1)*value(_state,_var);
-			}
-		  if (!_up_direction)
-			{
-			  if (signum(_state,_var) > 0)
-					all_values_array[4*_var + 2] += value(_state,_var);
-			  if (signum(_state,_var) < 0)
-				{ 
-				  all_values_array[4*_var + 3] += (-1)*value(_state,_var);	
-				  // if most_signifficant, we only compute the array
-			  	  if ( !most_signifficant_only && selfloops )
-			            *_result=true;
-				}
-			}
-		  if (dbg) {
-		        cerr << "Point: ";
-		        for ( size_t i = 0; i < get_dim(); i++ ) 
-		        	cerr << _state[i] << ".";
-		        cerr << ": ";
-		        for ( size_t i = 0; i < 4*get_dim(); i++ ) 
-		        	cerr << all_values_array[i] << ", ";
-				cerr << endl;
-	      }
-		}
+      if (dbg && all_values_array!=NULL) {
+		cerr << "Point: ";
+		for ( size_t i = 0; i < get_dim(); i++ ) 
+		  cerr << _state[i] << ".";
+		cerr << ": ";
+		for ( size_t i = 0; i < 4*get_dim(); i++ ) 
+		  cerr << all_values_array[i] << ", ";
+		cerr << endl;
+	  }
 
       if (dbg) std::cerr << " res = " << (*_result) << std::endl;
       return;
@@ -761,6 +719,134 @@ void affine_system_t::recursive(
     }
 }
 
+void affine_system_t::vertex(bool *_result, size_t _var, bool _up_direction,
+			     real_t _value, real_t *all_values_array, bool dbg)
+{
+  if (all_values_array==NULL)
+	{
+	  if (_up_direction && _value > 0)
+		{
+		  if (dbg) std::cerr << endl << _value << endl;
+		  *_result = true;
+		}
+
+	  if (!_up_direction && _value < 0)
+		{
+		  if (dbg) std::cerr << endl << _value << endl;
+		  *_result = true;
+		}
+	}
+  else
+	{
+	  if ( dbg ) std::cerr << "affine_system::vertex: computing array_of_values" << endl;
+
+	  if (_up_direction)
+		{
+		  if (_value > 0) 
+			{
+			  all_values_array[4*_var + 0] += _value;
+			  // if most_signifficant, we only compute the array
+			  if ( !most_signifficant_only && selfloops )
+				*_result = true;
+			}	
+		  if (_value < 0)
+			all_values_array[4*_var + 1] += (-1)*_value;
+		}
+	  if (!_up_direction)
+		{
+		  if (_value > 0)
+			all_values_array[4*_var + 2] += _value;
+		  if (_value < 0)
+			{ 
+			  all_values_array[4*_var + 3] += (-1)*_value;	
+			  // if most_signifficant, we only compute the array
+			  if ( !most_signifficant_only && selfloops )
+				*_result=true;
+			}
+		}
+	}
+}
+
+void affine_system_t::enumerate_face(size_t _var, size_t *_state, size_t _next_dim)
+{
+  // the same enumeration (and order of vertices) as in recursive()
+  if (_next_dim == get_dim())
+    {
+      face_points.insert(face_points.end(), _state, _state + get_dim());
+      return;
+    }
+
+  if (_next_dim == _var)
+    {
+      enumerate_face(_var, _state, _next_dim+1);
+      return;
+    }
+
+  while ((_next_dim < get_dim()) && (! dep(_var, _next_dim)))
+    _next_dim++;
+  if (_next_dim < get_dim())
+    {
+      enumerate_face(_var, _state, _next_dim+1);
+      _state[_next_dim]++;
+      enumerate_face(_var, _state, _next_dim+1);
+      _state[_next_dim]--;
+    }
+  else
+    enumerate_face(_var, _state, _next_dim);
+}
+
+void affine_system_t::batch_face(bool *_result, size_t _var, bool _up_direction,
+				 size_t *_state, real_t *all_values_array)
+{
+  size_t d = get_dim();
+
+  face_points.clear();
+  enumerate_face(_var, _state, 0);
+
+  // threshold values of the vertices, one row per variable (only rows of
+  // variables used in the equation are filled), the rows are padded by the
+  // last vertex to the multiple of the batch width
+  size_t n = face_points.size() / d;
+  size_t width = affine_kernel_t::batch_width();
+  size_t stride = (n + width - 1) / width * width;
+
+  face_values.resize(stride);
+  face_x.resize(d * stride);
+  const size_t *points = &face_points[0];
+  for (size_t u = 0; u < kernel.get_used_count(_var); u++)
+    {
+      size_t v = kernel.get_used(_var, u);
+      const real_t *treshs = kernel.get_treshs_values(v);
+      real_t *row = &face_x[v*stride];
+      for (size_t j = 0; j < n; j++)
+        row[j] = treshs[points[j*d + v]];
+      for (size_t j = n; j < stride; j++)
+        row[j] = row[n-1];
+    }
+
+  const real_t *values = &face_values[0];
+  kernel.value_batch(&face_x[0], stride, n, _var, &face_values[0]);
+
+  // the values are accumulated in the order of enumeration, hence
+  // array_of_values is the same as after recursive()
+  for (size_t j = 0; j < n; j++)
+    vertex(_result, _var, _up_direction, cut_zero(values[j]), all_values_array);
+}
+
+void affine_system_t::face(bool *_result, size_t _var, bool _up_direction,
+			   size_t *_state, real_t *all_values_array)
+{
+  if (batched_faces)
+    batch_face(_result, _var, _up_direction, _state, all_values_array);
+  else
+    recursive(_result, _var, _up_direction, _state, 0, all_values_array);
+}
+
+void affine_system_t::set_batched_faces(bool _batched)
+{
+  batched_faces = _batched;
+}
+
 std::string affine_system_t::getNextPart(std::string& _str)
 {
   trim(_str);
@@ -1746,74 +1832,167 @@ slong_int_t affine_system_t::read(const char * const fn)
   if (dbg)
     std::cerr << "Reading file '" << fn << "'" << std::endl;
   
-  std::string line;
-  std::ifstream modelfile (fn);
-  std::ifstream modelfile2 (fn);
-
-  std::string modelline="";
-
-  if (dbg) std::cerr << fn << " is_open: " 
-		     << modelfile.is_open() 
-		     << modelfile.good() 
-		     << modelfile.fail() 
-		     << std::endl;
-
-  if (modelfile2.is_open())
+  if (Model<real_t>::IsCompiled(fn))
   {
+    // thresholds are already computed, the abstraction is skipped
+    if (!model.ReadCompiled(fn))
+      {
+        error ("affine_system::read","Cannot read compiled model.");
+        return 1;
+      }
+  }
+  else
+  {
+    // the file is read only once, the model is parsed from the buffer and
+    // the property process is taken from it as well
+    std::ifstream modelfile (fn);
+    if (!modelfile.is_open())
+      {
+        error ("affine_system::read","Cannot open requested file.");
+        return 1;
+      }
+    std::ostringstream buffer;
+    buffer << modelfile.rdbuf();
+    modelfile.close();
+
     if (dbg) std::cerr << "Parsing file ..." << std::endl;
 
-	
-	Parser parser(modelfile2);
+    std::istringstream modelstream(buffer.str());
+    Parser parser(modelstream);
     parser.parse();
 
     model = parser.returnStorage();
 
     model.RunAbstraction(useFastApproximation);
 
-	inited = 1;
-	update_initials();
-  }
-  else
+    std::string line;
+    std::string modelline="";
+    std::istringstream lines(buffer.str());
+    while (getline (lines,line))
     {
-      error ("affine_system::read","Cannot open requested file.");
-      return 1;
-    }
-
-
-  if (modelfile.is_open())
-  {
-    while (! modelfile.eof() )
-    {
-      getline (modelfile,line);
       if (is_comment(line)) continue;
       trim(line);
       modelline+= line;
     }
-	
-	size_t start, end;
+    size_t start = modelline.find("process");
+    model.SetProperty(start == std::string::npos ? "" : modelline.substr(start));
+    model_text = modelline.substr(0, start);
+  }
 
-	start = modelline.find("process");
-	end = modelline.find("system",start);
+  kernel.compile(model);
+  vertex_cache.set_size(vertex_cache_size, kernel);
+  // faces are evaluated in SIMD batches if the CPU supports it, the vertex
+  // cache works with single vertices only; intrinsics are not worth it in
+  // unoptimized builds
+#ifdef __OPTIMIZE__
+  batched_faces = (kernel.get_simd() != affine_kernel_t::SIMD_NONE && !vertex_cache.enabled());
+#endif
 
-	std::string part = modelline.substr(start, end - start);
-	trim(part);
-	parse(part);
+  inited = 1;
+  update_initials();
 
-	part = modelline.substr(end);
-	trim(part);
-	parse(part);
+  parse_property(model.getProperty());
+  if (property_process)
+    properties.push_back(property_process);
 
-    array_of_values = static_cast<real_t*>(malloc(sizeof(real_t)*model.getDims()*4));  //4 = up/down * inside/outside
-  }
+  array_of_values = static_cast<real_t*>(malloc(sizeof(real_t)*model.getDims()*4));  //4 = up/down * inside/outside
+  set_state_layout();
+
+  return 0;
+}
+
+bool affine_system_t::write_compiled(const char * const filename) const
+{
+  return model.WriteCompiled(filename);
+}
+
+bool affine_system_t::write_compiled(std::ostream & out) const
+{
+  return model.WriteCompiled(out);
+}
+
+void affine_system_t::parse_property(const std::string & _text)
+{
+  size_t end = _text.find("system");
+
+  std::string part = _text.substr(0, end);
+  trim(part);
+  parse(part);
+
+  if (end != std::string::npos)
+    {
+      part = _text.substr(end);
+      trim(part);
+      parse(part);
+    }
+
+  if (property_process)
+    property_process->compile();
+}
+
+slong_int_t affine_system_t::add_property(const char * const fn)
+{
+  if (inited==0) error ("affine_system::add_property",1);
+
+  std::string text;
+  if (Model<real_t>::IsCompiled(fn))
+    {
+      Model<real_t> other;
+      if (!other.ReadCompiled(fn))
+        error ("affine_system::add_property","Cannot read compiled model.");
+      if (!model_text.empty() || !model.SameModel(other))
+        error ("affine_system::add_property",std::string(fn)+" does not hold the same model.");
+      text = other.getProperty();
+    }
   else
     {
-      error ("affine_system::read","Cannot open requested file.");
-      return 1;
+      // the model part is only compared, it is neither parsed nor abstracted
+      std::ifstream modelfile (fn);
+      if (!modelfile.is_open())
+        error ("affine_system::add_property","Cannot open requested file.");
+      std::string line;
+      std::string modelline="";
+      while (getline (modelfile,line))
+        {
+          if (is_comment(line)) continue;
+          trim(line);
+          modelline+= line;
+        }
+      size_t start = modelline.find("process");
+      if (model_text.empty() || modelline.substr(0, start) != model_text)
+        error ("affine_system::add_property",std::string(fn)+" does not hold the same model.");
+      if (start != std::string::npos)
+        text = modelline.substr(start);
     }
 
+  // parse() sets property_process, the first property process stays there
+  affine_property_t * first = property_process;
+  property_process = 0;
+  parse_property(text);
+  affine_property_t * added = property_process;
+  property_process = first;
+  if (!added || !first)
+    error ("affine_system::add_property","Property process is missing.");
+
+  properties.push_back(added);
+  set_state_layout();
   return 0;
 }
 
+void affine_system_t::select_property(size_t _index)
+{
+  if (_index >= properties.size())
+    error ("affine_system::select_property","Property process does not exist.");
+  selected_property = _index;
+}
+
+affine_property_t * affine_system_t::get_property_of(divine::state_t _state)
+{
+  if (properties.size() > 1)
+    return properties[state_layout.get(_state,get_dim()+1)];
+  return property_process;
+}
+
 slong_int_t affine_system_t::read(std::istream & ins)
 {
   gerr << "affine_system_t::read not yet implemented" << thr(); //TODO
@@ -1917,7 +2096,7 @@ size_t affine_system_t::get_tresh_pos( size_t _var, real_t _thr_value)
     error("get_treshs",1);
   if (_var >= model.getDims())
     error ("get_treshs",2);
-  return model.getThresholdsForVariable(_var).size();
+  return kernel.get_treshs(_var);
  }
 
 
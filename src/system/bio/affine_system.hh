@@ -50,6 +50,9 @@
 
 //#include "./parser/Parser.h"
 #include "./data_model/Model.h"
+#include "system/bio/affine_kernel.hh"
+#include "system/bio/affine_vertex_cache.hh"
+#include "system/bio/affine_state_layout.hh"
 
 #ifdef count
  #undef count
@@ -68,9 +71,14 @@
 namespace divine {
 #endif //DOXYGEN_PROCESSING
 
-typedef double real_t;
 const real_t RT_PRECISION = DBL_EPSILON;
 
+//!Default number of entries of the vertex cache of affine_system_t
+/*!The cache is turned off by default - with the compiled kernel the
+ * evaluation of an equation is usually as cheap as computing the key of the
+ * cache, it pays off only for equations with many summembers (ramps).*/
+const size_t DEFAULT_VERTEX_CACHE_SIZE = 0;
+
 typedef struct {
   size_t from;
   size_t to;
@@ -114,11 +122,25 @@ public:
   
 	Model<real_t> model;
 
+  //!Flat form of the equations of model, compiled after the abstraction
+  affine_kernel_t kernel;
+
+  //!Values of the equations in already visited vertices of the threshold grid
+  affine_vertex_cache_t vertex_cache;
+
+  //!Bit-packed layout of states (threshold indices and the property position)
+  affine_state_layout_t state_layout;
+
   //!A constructor.
   /*!\param estack =
    * the <b>error vector</b>, that will be used by created instance of system_t
    */
   affine_system_t(error_vector_t & evect = gerr);
+  //!A copy constructor.
+  /*!The copy shares the (read only) variables and property process with
+   * \a second but has its own buffers, so the copies may generate
+   * successors in different threads. The system is read only once. */
+  affine_system_t(const affine_system_t & second);
   //!A destructor.
   virtual ~affine_system_t();
 
@@ -164,6 +186,18 @@ virtual  void recursive(bool *result,
 			real_t *all_values_array, bool dbg = false//FIXME SVEN
 			);
 
+  //! Decides whether the face of the rectangle _state in direction _var is enabled
+  /*!The same as recursive(_result,_var,_up_direction,_state,0,all_values_array)
+   * but the vertices of the face are evaluated in SIMD batches (see
+   * affine_kernel_t::value_batch()) if batched faces are turned on.*/
+virtual  void face(bool *_result, size_t _var, bool _up_direction,
+		   size_t *_state, real_t *all_values_array);
+
+  //! Turns on/off the batched evaluation of faces in face()
+  /*!It is turned on by read() in optimized builds if the CPU supports
+   * SSE2 or AVX2 and the vertex cache is off.*/
+  void set_batched_faces(bool _batched);
+
 //zrejme nebude treba
 virtual  void check_sanity();
 
@@ -242,6 +276,40 @@ virtual  void add_sum(size_t _var, real_t _k, bitarray_t _usedvars);
   virtual slong_int_t read(const char * const filename);
 
   virtual slong_int_t read(const char * const filename, bool fast);
+
+  //!Writes the model read by read() as a compiled model
+  /*!A compiled model (see Model<T>::WriteCompiled()) holds the model after
+   * the abstraction together with the property process. read() recognizes
+   * it by its header and loads it without parsing and abstraction (the
+   * fast switch of read() is then irrelevant). Returns false on failure.*/
+  bool write_compiled(const char * const filename) const;
+  //!Writes the compiled model to a stream (see write_compiled())
+  bool write_compiled(std::ostream & out) const;
+
+  //!Adds the property process of another model file
+  /*!The file (.bio or .cbio, of the same kind as the file given to read())
+   * has to hold the same model as the file read by read() - e.g. the files
+   * made by divine.combine from one model for several LTL formulae. Only
+   * its property process is parsed.
+   *
+   * With more property processes a state holds the index of its property
+   * process next to its position, hence the products with the single
+   * properties are disjoint and can be stored together. The successors
+   * keep the property of their state and get_initial_state() returns the
+   * initial state of the product chosen by select_property().
+   *
+   * Has to be called after read() and before any state is generated.
+   * Returns 0 on success.*/
+  slong_int_t add_property(const char * const filename);
+
+  //!Returns the number of property processes (see add_property())
+  size_t get_property_count() const { return properties.size(); }
+
+  //!Chooses the product whose initial state get_initial_state() returns
+  void select_property(size_t _index);
+
+  //!Returns the property process of the state (see add_property())
+  divine::affine_property_t * get_property_of(divine::state_t _state);
   
   //Neuplne implementovane
   virtual slong_int_t from_string(const std::string str);
@@ -327,6 +395,16 @@ virtual  void add_sum(size_t _var, real_t _k, bitarray_t _usedvars);
   //! Sets the number of treshold refinment iterations.
   void set_iterations(size_t _it);
 
+  //! Sets the number of entries of the vertex cache, 0 turns the cache off
+  /*!Has to be called before read(), the default is DEFAULT_VERTEX_CACHE_SIZE*/
+  void set_vertex_cache_size(size_t _entries);
+
+  //! Returns the number of values found in the vertex cache
+  size_t get_vertex_cache_hits() const { return vertex_cache.get_hits(); }
+
+  //! Returns the number of values not found in the vertex cache
+  size_t get_vertex_cache_misses() const { return vertex_cache.get_misses(); }
+
 //ZMAZAT
   //! Sets the zero precision, if 0 is set, turns of the feature
   void set_zero_range(real_t);
@@ -366,6 +444,12 @@ virtual  void add_sum(size_t _var, real_t _k, bitarray_t _usedvars);
   real_t precision_thr;
   real_t zero_range;
   divine::affine_property_t *property_process;
+  //!All property processes, property_process is the first one
+  std::vector<divine::affine_property_t *> properties;
+  //!The model part of the .bio file given to read() (see add_property())
+  std::string model_text;
+  //!The index of the property chosen by select_property()
+  size_t selected_property;
 
   std::list<interval_t*> initials;
 
@@ -382,6 +466,33 @@ virtual  void add_sum(size_t _var, real_t _k, bitarray_t _usedvars);
   real_t maxprob;  // this constant is used to globally lower down the probability of rand. trans.
 
   bool selfloops;  // true implies generating of selfloops at any place where we are not sure of transiency
+
+  size_t vertex_cache_size;
+
+  bool batched_faces;
+  std::vector<size_t> face_points;  // vertices of the face, get_dim() indices each
+  std::vector<real_t> face_x;       // threshold values of vertices, see value_batch()
+  std::vector<real_t> face_values;
+
+  //! Sets state_layout according to the numbers of thresholds and property states
+  void set_state_layout();
+
+  //! Parses the property process and the system keyword of a model
+  void parse_property(const std::string & _text);
+
+  //! Returns 0 for values smaller than the zero precision, _value otherwise
+  real_t cut_zero(real_t _value);
+
+  //! Updates _result and all_values_array by the value in one vertex of a face
+  void vertex(bool *_result, size_t _var, bool _up_direction,
+	      real_t _value, real_t *all_values_array, bool dbg = false);
+
+  //! Appends the vertices of the face (as enumerated by recursive()) to face_points
+  void enumerate_face(size_t _var, size_t *_state, size_t _next_dim);
+
+  //! Batched version of recursive() used by face()
+  void batch_face(bool *_result, size_t _var, bool _up_direction,
+		  size_t *_state, real_t *all_values_array);
   
  };
 
@@ -0,0 +1,92 @@
+#include "system/bio/affine_vertex_cache.hh"
+
+#ifndef DOXYGEN_PROCESSING
+using namespace divine;
+#endif //DOXYGEN_PROCESSING
+
+const size_t affine_vertex_cache_t::WAYS;
+const size_t affine_vertex_cache_t::NO_SETS;
+const size_t affine_vertex_cache_t::NO_KEY;
+
+affine_vertex_cache_t::affine_vertex_cache_t():
+  dim(0), sets_mask(NO_SETS), hits(0), misses(0), evictions(0)
+{
+}
+
+void affine_vertex_cache_t::set_size(size_t _entries, const affine_kernel_t & _kernel)
+{
+  dim = _kernel.get_dim();
+  sets_mask = NO_SETS;
+  entries.clear();
+  referenced.clear();
+  hands.clear();
+
+  if (!_entries)
+    return;
+
+  // the key is a mixed radix number: the index of variable is the lowest
+  // digit (base dim), then the threshold indices of variables follow
+  strides.resize(dim);
+  size_t stride = (dim ? dim : 1);
+  for (size_t i = 0; i < dim; i++)
+    {
+      size_t base = _kernel.get_treshs(i);
+      strides[i] = stride;
+      if (base && stride > (NO_KEY - 1) / base)
+        return; // grid too large for the key, the cache stays disabled
+      stride *= (base ? base : 1);
+    }
+
+  size_t sets = 1;
+  while (sets * WAYS < _entries)
+    sets <<= 1;
+  sets_mask = sets - 1;
+
+  entry_t empty = { NO_KEY, 0 };
+  entries.assign(sets * WAYS, empty);
+  referenced.assign(sets * WAYS, 0);
+  hands.assign(sets, 0);
+}
+
+void affine_vertex_cache_t::clear()
+{
+  entry_t empty = { NO_KEY, 0 };
+  entries.assign(entries.size(), empty);
+  referenced.assign(referenced.size(), 0);
+  hands.assign(hands.size(), 0);
+}
+
+void affine_vertex_cache_t::insert(const size_t *_where, size_t _var, real_t _value)
+{
+  if (!enabled())
+    return;
+
+  size_t key = get_key(_where, _var);
+  size_t set = get_set(key);
+  size_t first = set * WAYS;
+  size_t victim = first + WAYS;
+
+  for (size_t e = first; e < first + WAYS; e++)
+    if (entries[e].key == NO_KEY)
+      {
+        victim = e;
+        break;
+      }
+
+  if (victim == first + WAYS)
+    {
+      // clock: skip (and unmark) referenced entries
+      while (referenced[first + hands[set]])
+        {
+          referenced[first + hands[set]] = 0;
+          hands[set] = (hands[set] + 1) % WAYS;
+        }
+      victim = first + hands[set];
+      hands[set] = (hands[set] + 1) % WAYS;
+      evictions++;
+    }
+
+  entries[victim].key = key;
+  entries[victim].value = _value;
+  referenced[victim] = 0;
+}
@@ -0,0 +1,127 @@
+/*!\file
+ * The main contribution of this file is the class affine_vertex_cache_t - a
+ * bounded cache of values of the equations in vertices of the threshold grid
+ */
+#ifndef DIVINE_AFFINE_VERTEX_CACHE_HH
+#define DIVINE_AFFINE_VERTEX_CACHE_HH
+
+#ifndef DOXYGEN_PROCESSING
+#include <vector>
+#include "system/bio/affine_kernel.hh"
+
+//The main DiVinE namespace - we do not want Doxygen to see it
+namespace divine {
+#endif //DOXYGEN_PROCESSING
+
+//!Bounded cache of values of equations in vertices of the threshold grid
+/*!Neighbouring rectangles share most of their vertices, hence during the
+ * generation of the state space affine_system_t::recursive() evaluates the
+ * same grid points again and again. This cache stores the value of the
+ * equation of a variable in a grid point.
+ *
+ * The key is the tuple of threshold indices together with the index of the
+ * variable, linearized into one integer (mixed radix number with the
+ * numbers of thresholds as bases). If the grid is too large for the key to
+ * fit into size_t, the cache stays disabled.
+ *
+ * The cache is set-associative - every key is hashed to a set of
+ * ways() entries and the victim in a full set is chosen by the clock
+ * (second chance) policy. The memory consumption is therefore fixed by the
+ * number of entries given to set_size().
+ */
+class affine_vertex_cache_t
+{
+public:
+  //!A constructor - creates a disabled cache (of size 0)
+  affine_vertex_cache_t();
+
+  //!Sets the number of entries and the shape of the grid, clears the cache
+  /*!The number of entries is rounded up to a power of two multiple of
+   * ways(), size 0 disables the cache.*/
+  void set_size(size_t _entries, const affine_kernel_t & _kernel);
+
+  //!Returns the number of entries (0 means the cache is disabled)
+  size_t get_size() const { return entries.size(); }
+
+  //!Returns true if the cache is enabled
+  bool enabled() const { return sets_mask != NO_SETS; }
+
+  //!Removes all entries from the cache (counters are kept)
+  void clear();
+
+  //!Looks up the value of equation of _var in the grid point _where
+  /*!Returns true and sets _value if the entry has been found.*/
+  bool lookup(const size_t *_where, size_t _var, real_t & _value)
+  {
+    if (!enabled())
+      return false;
+
+    size_t key = get_key(_where, _var);
+    size_t first = get_set(key) * WAYS;
+    for (size_t e = first; e < first + WAYS; e++)
+      if (entries[e].key == key)
+        {
+          referenced[e] = 1;
+          _value = entries[e].value;
+          hits++;
+          return true;
+        }
+
+    misses++;
+    return false;
+  }
+
+  //!Stores the value of equation of _var in the grid point _where
+  void insert(const size_t *_where, size_t _var, real_t _value);
+
+  //!Returns the number of successful lookups
+  size_t get_hits() const { return hits; }
+
+  //!Returns the number of unsuccessful lookups
+  size_t get_misses() const { return misses; }
+
+  //!Returns the number of entries that have been evicted
+  size_t get_evictions() const { return evictions; }
+
+  //!Returns the number of entries in one set
+  static size_t ways() { return WAYS; }
+
+protected:
+  static const size_t WAYS = 4;
+  static const size_t NO_SETS = size_t(-1);
+  static const size_t NO_KEY = size_t(-1);
+
+  typedef struct {
+    size_t key;
+    real_t value;
+  } entry_t;
+
+  size_t dim;
+  size_t sets_mask;             // number of sets - 1, NO_SETS if disabled
+  std::vector<size_t> strides;  // strides of threshold indices in the key
+
+  std::vector<entry_t> entries;
+  std::vector<unsigned char> referenced;
+  std::vector<unsigned char> hands;  // clock hand of each set
+
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+
+  size_t get_key(const size_t *_where, size_t _var) const
+  {
+    size_t key = _var;
+    for (size_t i = 0; i < dim; i++)
+      key += _where[i] * strides[i];
+    return key;
+  }
+
+  size_t get_set(size_t _key) const
+  { return ((_key * size_t(0x9E3779B97F4A7C15ULL)) >> 17) & sets_mask; }
+};
+
+#ifndef DOXYGEN_PROCESSING
+} //END of namespace divine
+#endif //DOXYGEN_PROCESSING
+
+#endif
@@ -1,1259 +1,1718 @@
-#pragma once
-#include <stdlib.h>
-#include <string>
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <vector>
-#include <cmath>
-#include <time.h>
-#include <climits>
-#include <algorithm>
-
-#include "Summember.h"
-
-
-
-
-using std::string;
-
-template <typename T>
-class Model
-{
-	typedef T value_type;
-
-private:
-
-	struct sigmoid
-	{
-		std::size_t dim;
-		value_type k;
-		value_type theta;
-		value_type a;
-		value_type b;
-		std::size_t n;
-		bool positive;
-		bool isInverse;
-
-		friend std::ostream& operator<<(std::ostream& out, const sigmoid& s) {
-			if (!s.positive)
-				out << "S(-)[";
-			else
-				out << "S(+)[";
-			out << s.n << "](" << s.dim << "," << s.k << "," << s.theta << "," << s.a << "," << s.b << ")";
-			return out;
-			
-		}
-		
-		std::vector<value_type> enumerateYPoints(std::vector<value_type> x)
-		{
-			std::vector<value_type> y;
-			value_type tempA = a;
-			value_type tempB = b;
-			
-			for (size_t i = 0; i < x.size(); i++) {
-				y.push_back(tempA + (tempB - tempA)*((1 + tanh(k*(x.at(i) - theta)))*0.5));
-			}
-			
-			return y;
-		}
-
-	};
-	
-	
-	struct hill {
-	    std::size_t dim;		//Warning: index of var_name from Model.h but indexing from 1 (not 0)
-	    value_type theta;
-	    value_type n;
-	    value_type a;
-	    value_type b;
-	    bool positive;
-	    
-        hill() {}
-		hill(std::size_t new_dim, value_type new_theta, value_type new_n, value_type new_a, value_type new_b, bool new_positive = true)
-                    : dim(new_dim), theta(new_theta), n(new_n), a(new_a), b(new_b), positive(new_positive) {
-        	if( (positive && a > b) || (!positive && a < b) ) {        		
-        		a = new_b;
-        		b = new_a;
-        	}
-        }
-        hill(const hill& s) : dim(s.dim), theta(s.theta), n(s.n), a(s.a), b(s.b), positive(s.positive) {}
-
-
-		value_type value(value_type value) const
-		{
-			value_type result = a + (b - a)*(std::pow(1.0,n) / (std::pow(1.0,n) + std::pow(theta/value,n))); 
-			return result;
-		}
-		
-		std::vector<value_type> enumerateYPoints(std::vector<value_type> x) {
-			std::vector<value_type> y;
-			for(size_t i = 0; i < x.size(); i++) {
-				y.push_back(value(x.at(i)));
-			}
-			return y;
-		}
-
-		friend std::ostream& operator<<(std::ostream& out, const hill& s) {
-		    if(s.positive)
-                out << "Hill(-)(";
-            else
-                out << "Hill(+)(";
-            out << s.dim << "," << s.theta << "," << s.n << "," << s.a << "," << s.b << ")";
-            return out;
-		}
-	};
-
-public:
-	void AddVariable(string var);
-	void AddParam(string param);
-	void AddParamRange(value_type a, value_type b);
-	void AddConstantName(string constant);
-	void AddConstantValue(value_type constant);
-
-	void AddSigmoid(std::size_t segments, std::size_t dim, value_type k, value_type theta,
-		value_type a, value_type b, bool positive = 1, bool isInverse = 0);
-	void AddSigmoid(sigmoid & new_sigmoid);
-	
-	void AddHill(std::size_t dim, value_type theta, value_type n, value_type a, value_type b, bool positive = 1);
-	void AddHill(hill & copy);
-
-	void AddEquation(std::vector<Summember<T> > summs);
-	void AddEquationName(std::string var);
-
-	void AddThresholdName(std::string var);
-	void AddThresholdValue(std::string value);
-
-	void AddVarPointsName(std::string var);
-	void AddVarPointsFstValue(std::string value);
-	void AddVarPointsSndValue(std::string value);
-
-	void AddInitsName(std::string var);
-	void AddInitsFstValue(std::string value);
-	void AddInitsSndValue(std::string value);
-
-	void AddBaLine(std::string);
-
-	std::size_t GetSigmoidsSize();
-
-    const std::vector<std::string> getVariables() const;
-	const std::string getVariable(int index) const;
-	const size_t getVariableIndex(std::string var) const;
-	const size_t getDims() const { return var_names.size(); }
-
-    const std::vector<std::string> getParamNames() const;
-	const std::string getParamName(int index) const;
-	const std::vector<std::pair<value_type, value_type> > getParamRanges() const;
-	const std::pair<value_type, value_type> getParamRange(int index) const;
-
-	const std::vector<std::pair<std::string, value_type> > getConstants() const;
-	const std::pair<std::string, value_type> getConstant(int index) const;
-
-	const std::vector<std::pair<std::size_t, std::vector<Summember<T> > > > getEquations() const;
-	const std::vector<Summember<T> > getEquationForVariable(size_t varIndex) const;
-	const Summember<T> getSumForVarByIndex(size_t varIndex, size_t i) const;
-
-	const std::vector<std::pair<std::size_t, std::vector<value_type> > > getThresholds() const;
-	const std::vector<value_type> getThresholdsForVariable(size_t varIndex) const;
-	const value_type getThresholdForVarByIndex(size_t varIndex, size_t i) const;
-
-	const std::vector<std::pair<value_type, value_type> > getVarPointsValues() const;
-	const std::vector<std::string> getVarPointsNames() const;
-
-	const std::vector<std::pair<value_type, value_type> > getInitsValues() const;
-	const std::vector<std::string> getInitsNames() const;
-	const std::pair<value_type, value_type> getInitsValuesForVariable(size_t varIndex) const;
-
-	const std::vector<std::string> getBaLines() const;
-
-	const std::vector<sigmoid> getSigmoids() const;
-	const std::vector<hill> getHills() const;
-
-	void RunAbstraction(bool useFastApproximation = true);
-
-private:
-	std::vector<std::size_t> FindSigmoids(std::size_t dim);
-	std::vector<std::size_t> FindHills(std::size_t dim);
-
-	std::vector<sigmoid> sigmoids;
-	std::vector<hill> hills;
-	std::vector<std::string> var_names;  
-	std::vector<std::string> param_names;
-	std::vector<std::pair<value_type, value_type> > param_ranges;
-	std::vector<std::pair<std::string, value_type> > constants;  
-	std::vector<std::pair<std::size_t, std::vector<Summember<T> > > > equations;
-	std::vector<std::pair<std::size_t, std::vector<value_type> > > thresholds;
-	std::vector<std::size_t> var_points;
-	std::vector<std::pair<value_type, value_type> > var_points_values;
-	std::vector<std::size_t> inits;
-	std::vector<std::pair<value_type, value_type> > inits_values;
-	std::vector<std::string> ba_lines;
-
-
-    std::vector<double> computeThresholds(std::vector<std::size_t> s, std::vector<std::size_t> hfs, int numOfSegments, int numOfX = 0, bool fast = true);
-    std::vector<std::vector<double> > generateSpace(std::vector<std::size_t> s, std::vector<std::size_t> hfs, std::vector<double> &x, int numOfX);
-    std::vector<double> generateXPoints (double ai, double bi, int num_segments);
-    std::vector<double> segmentErr (std::vector <double> x, std::vector <double> y);
-    std::vector<double> optimalGlobalLinearApproximation(std::vector<double> x, std::vector<std::vector<double> > y, int n_segments);
-    std::vector<double> optimalFastGlobalLinearApproximation2 (std::vector<double> x, std::vector<std::vector<double> > y, int n_segments);
-    std::vector<std::vector<typename Summember<value_type>::ramp> > generateNewRamps(std::vector<double> x, std::vector< std::vector<double> > y, std::size_t dim);
-};
-
-
-template <typename T>
-void Model<T>::AddBaLine(std::string ba) {
-    ba_lines.push_back(ba);
-}
-
-template <typename T>
-void Model<T>::AddInitsName(std::string var) {
-    size_t indexOfVar = -1;
-    for (size_t i = 0; i < var_names.size(); i++) {
-        if (var_names.at(i).compare(var) == 0 ) {
-            indexOfVar = i;
-            break;
-        }
-    }
-    if(indexOfVar >= 0 && indexOfVar < var_names.size())
-        inits.push_back(indexOfVar);
-}
-
-template <typename T>
-void Model<T>::AddInitsFstValue(std::string value) {
-    std::pair<T, T> values;
-    values.first = (T)std::stod(value);
-    bool correctValue = false;
-    for(size_t i = 0; i < getThresholdsForVariable(inits.back()).size(); i++) {
-    	if(values.first == getThresholdsForVariable(inits.back()).at(i)) {
-    		correctValue = true;
-    		break;
-		}
-    }
-    if(!correctValue) {
-    	std::cerr  << "Error: INIT values of variable must be from THRES values of that variable.\n";
-    	exit(15);
-    }
-    inits_values.push_back(values);
-}
-
-template <typename T>
-void Model<T>::AddInitsSndValue(std::string value) {
-    inits_values.back().second = (T)std::stod(value);
-    bool correctValue = false;
-    for(size_t i = 0; i < getThresholdsForVariable(inits.back()).size(); i++) {
-    	if(inits_values.back().second == getThresholdsForVariable(inits.back()).at(i)) {
-    		correctValue = true;
-    		break;
-		}
-    }
-    if(!correctValue) {
-    	std::cerr  << "Error: INIT values of variable must be from THRES values of that variable.\n";
-    	exit(15);
-    }
-}
-
-template <typename T>
-void Model<T>::AddVarPointsName(std::string var) {
-    size_t indexOfVar = -1;
-    for (size_t i = 0; i < var_names.size(); i++) {
-        if (var_names.at(i).compare(var) == 0 ) {
-            indexOfVar = i;
-            break;
-        }
-    }
-    if(indexOfVar >= 0 && indexOfVar < var_names.size())
-        var_points.push_back(indexOfVar);
-}
-
-template <typename T>
-void Model<T>::AddVarPointsFstValue(std::string value) {
-    std::pair<T, T> values;
-    values.first = (T)std::stod(value);
-    var_points_values.push_back(values);
-}
-
-template <typename T>
-void Model<T>::AddVarPointsSndValue(std::string value) {
-    var_points_values.back().second = (T)std::stod(value);
-}
-
-template <typename T>
-void Model<T>::AddThresholdName(std::string var) {
-
-	// Finding for index of given variable
-    int indexOfVar = -1;
-    for (size_t i = 0; i < var_names.size(); i++) {
-        if (var_names.at(i).compare(var) == 0 ) {
-            indexOfVar = i;
-            break;
-        }
-    }
-    
-    // If given variable could not be found
-    if(indexOfVar == -1) {
-    	std::cerr << "ERROR: Wrong given variable " << var << "\n";
-    	return;
-	}
-
-	// Finding previous thresholds for given variable
-    size_t i = 0;
-    for( ; i < thresholds.size(); i++) {
-        if(thresholds.at(i).first == indexOfVar) {
-            if(i < thresholds.size() - 1) {
-                swap(thresholds.at(i), thresholds.at(thresholds.size() - 1));
-            }
-            i = 0;
-            break;
-        }
-    }
-    
-    // No previous thresholds were found - variable need new record of thresholds
-    if(i == thresholds.size()) {
-        std::pair<std::size_t, std::vector<T> > p;
-        std::vector<T> th;
-        p.first = indexOfVar;
-        p.second = th;
-        thresholds.push_back(p);
-    }
-}
-
-template <typename T>
-void Model<T>::AddThresholdValue(std::string value) {
-
-	value_type val = (T)std::stod(value);
-	
-    if(!thresholds.empty()) {
-    	if(std::find(thresholds.back().second.begin(),thresholds.back().second.end(),val) == thresholds.back().second.end()) {
-		    thresholds.back().second.push_back(val);
-		    std::sort(thresholds.back().second.begin(),thresholds.back().second.end());
-	    }
-    }
-}
-
-template <typename T>
-void Model<T>::AddEquationName(std::string var) {
-    std::pair<std::size_t, std::vector<Summember<T> > > eq;
-
-    for (int i = 0; i != var_names.size(); i++) {
-        if (var_names.at(i).compare(var) == 0 ) {
-            eq.first = i;
-        }
-    }
-    equations.push_back(eq);
-}
-
-template <typename T>
-void Model<T>::AddEquation(std::vector<Summember<T> > summs) {
-    if(!equations.empty()) {
-        equations.back().second = summs;
-    }
-}
-
-
-template <typename T>
-void Model<T>::AddVariable(string var)
-{
-	var_names.push_back(var);
-}
-
-template <typename T>
-void Model<T>::AddParam(string param)
-{
-	param_names.push_back(param);
-}
-
-template <typename T>
-void Model<T>::AddParamRange(value_type a, value_type b)
-{
-	std::pair<value_type, value_type> p;
-	p.first = a;
-	p.second = b;
-
-	param_ranges.push_back(p);
-}
-
-template <typename T>
-void Model<T>::AddConstantName(string constant)
-{
-	std::pair<std::string, value_type> p;
-	p.first = constant;
-	constants.push_back(p);
-}
-
-template <typename T>
-void Model<T>::AddConstantValue(value_type constant)
-{
-	if (constants.empty())
-	{
-		std::cerr << "ERROR: No constant name to adding a value.\n";
-	}
-
-	std::pair<std::string, value_type> & p = constants.back();
-	p.second = constant;
-}
-
-template <typename T>
-void Model<T>::AddHill(std::size_t dim, value_type theta, value_type n, value_type a, value_type b, bool positive) {
-	hill h;
-	h.dim = dim;
-	h.theta = theta;
-	h.n = n;
-	h.a = a;
-	h.b = b;
-	hills.push_back(h);
-}
-
-template <typename T>
-void Model<T>::AddHill(hill & copy) {
-	hills.push_back(copy);
-}
-
-template <typename T>
-void Model<T>::AddSigmoid(std::size_t segments, std::size_t dim, value_type k, value_type theta,
-	value_type a, value_type b, bool positive, bool isInverse)
-{
-	sigmoid s;
-	s.n = segments;
-	s.dim = dim;
-	s.k = k;
-	s.theta = theta;
-	s.positive = positive;
-	s.isInverse = isInverse;
-	s.a = a;
-	s.b = b;
-	sigmoids.push_back(s);
-}
-
-template <typename T>
-void Model<T>::AddSigmoid(sigmoid & new_sigmoid)
-{
-	sigmoids.push_back(new_sigmoid);
-}
-
-template <typename T>
-std::size_t Model<T>::GetSigmoidsSize()
-{
-	return sigmoids.size();
-}
-
-
-template <typename T>
-const std::vector<std::string> Model<T>::getVariables() const {
-	return var_names;
-}
-
-template <typename T>
-const std::string Model<T>::getVariable(int index) const {
-	return var_names.at(index);
-}
-
-template <typename T>
-const size_t Model<T>::getVariableIndex(std::string var) const {
-	for(size_t i = 0; i < var_names.size(); i++) {
-		if(var_names.at(i).compare(var) == 0)
-			return i;
-	}
-	return UINT_MAX;
-}
-
-template <typename T>
-const std::vector<std::string> Model<T>::getParamNames() const {
-    return param_names;
-}
-
-template <typename T>
-const std::string Model<T>::getParamName(int index) const {
-    return param_names.at(index);
-}
-
-template <typename T>
-const std::vector<std::pair<T, T> > Model<T>::getParamRanges() const {
-    return param_ranges;
-}
-
-template <typename T>
-const std::pair<T, T> Model<T>::getParamRange(int index) const {
-    return param_ranges.at(index);
-}
-
-template <typename T>
-const std::vector<std::pair<std::string, T> > Model<T>::getConstants() const {
-    return constants;
-}
-
-template <typename T>
-const std::pair<std::string, T> Model<T>::getConstant(int index) const {
-    return constants.at(index);
-}
-
-template <typename T>
-const std::vector<std::pair<std::size_t, typename std::vector<Summember<T> > > > Model<T>::getEquations() const {
-    return equations;
-}
-
-template <typename T>
-const std::vector<Summember<T> > Model<T>::getEquationForVariable(size_t varIndex) const {
-	for(size_t i = 0; i < equations.size(); i++) {
-		if(varIndex == equations.at(i).first) {
-			return equations.at(i).second;
-		}
-	}
-	
-	return std::vector<Summember<T> >();
-}
-
-template <typename T>
-const Summember<T> Model<T>::getSumForVarByIndex(size_t varIndex, size_t i) const {
-	return getEquationForVariable(varIndex).at(i);
-}
-
-template <typename T>
-const std::vector<std::pair<std::size_t, std::vector<T> > > Model<T>::getThresholds() const {
-    return thresholds;
-}
-
-template <typename T>
-const std::vector<T> Model<T>::getThresholdsForVariable(size_t varIndex) const {
-	for(size_t i = 0; i < thresholds.size(); i++) {
-		if(varIndex == thresholds.at(i).first)
-			return thresholds.at(i).second;
-	}
-}
-
-template <typename T>
-const T Model<T>::getThresholdForVarByIndex(size_t varIndex, size_t i) const {
-	return getThresholdsForVariable(varIndex).at(i);
-}
-
-template <typename T>
-const std::vector<std::pair<T, T> > Model<T>::getVarPointsValues() const {
-    return var_points_values;
-}
-
-template <typename T>
-const std::vector<std::string> Model<T>::getVarPointsNames() const {
-    std::vector<std::string> vpn;
-    for(int i = 0; i < var_points.size(); i++) {
-        vpn.push_back(var_names.at(var_points.at(i)));
-    }
-    return vpn;
-}
-
-template <typename T>
-const std::vector<std::pair<T, T> > Model<T>::getInitsValues() const {
-    return inits_values;
-}
-
-template <typename T>
-const std::pair<T, T> Model<T>::getInitsValuesForVariable(size_t varIndex) const {
-    for(int i = 0; i < inits.size(); i++) {
-		if(varIndex == inits.at(i)) {
-			return inits_values.at(i);
-		}
-	}
-	std::cerr << "ERROR: Wrong index of variable\n";
-	return std::pair<T,T>();
-}
-
-template <typename T>
-const std::vector<std::string> Model<T>::getInitsNames() const {
-    std::vector<std::string> vpn;
-    for(int i = 0; i < inits.size(); i++) {
-        vpn.push_back(var_names.at(inits.at(i)));
-    }
-    return vpn;
-}
-
-template <typename T>
-const std::vector<std::string> Model<T>::getBaLines() const {
-    return ba_lines;
-}
-
-template <typename T>
-const std::vector<typename Model<T>::sigmoid> Model<T>::getSigmoids() const {
-    return sigmoids;
-}
-
-template <typename T>
-const std::vector<typename Model<T>::hill> Model<T>::getHills() const {
-	return hills;
-}
-
-
-template <typename T>
-std::vector<std::size_t> Model<T>::FindHills(std::size_t dim) {
-	std::vector<std::size_t> result;
-	
-	for (uint i = 0; i < hills.size(); i++) {
-		if(hills.at(i).dim == dim + 1)
-			result.push_back(i);
-	}
-	return result;
-}
-
-template <typename T>
-std::vector<std::size_t> Model<T>::FindSigmoids(std::size_t dim) {
-	std::vector<std::size_t> result;
-
-	for (uint i = 0; i < sigmoids.size(); i++)
-	{
-		if (sigmoids.at(i).dim == dim + 1)
-			result.push_back(i);
-	}
-	return result;
-}
-
-template <typename T>
-void Model<T>::RunAbstraction(bool useFastApproximation)
-{
-
-	std::vector<std::vector<typename Summember<T>::ramp> > new_sigmoids_ramps;
-	std::vector<std::vector<typename Summember<T>::ramp> > new_hills_ramps;	
-	unsigned int curveNum = 0;
-	bool dbg = false;
-
-    for(size_t i = 0; i < var_names.size(); i++) {
-
-        std::vector<std::size_t> groupOfSigmoids = FindSigmoids(i);
-        std::cerr << "\t" << groupOfSigmoids.size() << " sigmoids has been found\n";
-        
-        std::vector<std::size_t> groupOfHills = FindHills(i);
-        std::cerr << "\t" << groupOfHills.size() << " Hill functions has been found\n";        
-
-        if(groupOfSigmoids.empty() && groupOfHills.empty())
-            continue;       // no need for abstraction for this variable
-
-        int numOfSegments = 5;
-        int numOfXPoints = 0;
-
-        for(size_t j = 0; j < var_points.size(); j++) {
-            if(i == var_points.at(j)) {
-				// check if default number of requested segments is enough against number from input file
-                if(numOfSegments < var_points_values.at(j).second)
-                    numOfSegments = var_points_values.at(j).second;
-
-				// check if default number of requested x-points is enough against number from input file
-                if(numOfXPoints < var_points_values.at(j).first)
-                    numOfXPoints = var_points_values.at(j).first;
-            }
-        }
-
-        std::vector<double> thresholdsX = computeThresholds(groupOfSigmoids,groupOfHills,numOfSegments,numOfXPoints,useFastApproximation);
-
-    // New generated thresholds from computeThresholds() are storing to the previous ones here
-		if(dbg) std::cerr << "New threses for var " << getVariable(i) << ": ";	//just for testing
-        AddThresholdName(getVariable(i));
-        for(size_t t = 0; t < thresholdsX.size(); t++) {
-            std::stringstream ss;
-            ss << thresholdsX.at(t);
-            AddThresholdValue(ss.str());
-            if(dbg) std::cerr << ss.str() << ", ";		//Just for testing
-        }
-        if(dbg) std::cerr << "\n";		//just for testing
-
-        
-        // Testing-----------------------------------------------------
-        if(dbg) {
-		    std::cerr << "All threses for var " << getVariable(i) << ": ";
-		    for(int t = 0; t < getThresholdsForVariable(i).size(); t++) {
-		    	std::cerr << getThresholdForVarByIndex(i,t) << ", ";
-		    }
-		    std::cerr << "\n";
-	    }
-		// End of testing----------------------------------------------
-
-
-        std::vector<std::vector<double> > thresholdsY;
-
-        for(size_t j = 0; j < groupOfSigmoids.size(); j++) {
-
-            thresholdsY.push_back(sigmoids.at(groupOfSigmoids.at(j)).enumerateYPoints(thresholdsX));
-/*
-            // Testing functionality
-            std::stringstream ss;
-            ss << curveNum++;
-            std::string fileName = "nezmysel";
-            if(useFastApproximation)
-            	fileName = "test_curve" + ss.str() + ".fast.dat";
-            else
-            	fileName = "test_curve" + ss.str() + ".slow.dat";
-            std::ofstream out(fileName,std::ofstream::out | std::ofstream::trunc);
-            if(out.is_open()) {
-				for (size_t sp = 0; sp < thresholdsX.size(); sp++) {
-                    out << thresholdsX.at(sp) << "\t" << thresholdsY.back().at(sp) << "\n";
-                }
-            }
-            out.close();
-            // End of testing
-*/
-        }
-        new_sigmoids_ramps = generateNewRamps(thresholdsX, thresholdsY, i+1);
-        
-        thresholdsY.clear();
-		for (size_t j = 0; j < groupOfHills.size(); j++) {
-            thresholdsY.push_back(hills.at(groupOfHills.at(j)).enumerateYPoints(thresholdsX));
-/*
-            // Testing functionality
-            std::stringstream ss;
-            ss << curveNum++;
-            std::string fileName = "nezmysel";
-            if(useFastApproximation)
-            	fileName = "test_curve" + ss.str() + ".fast.dat";
-            else
-            	fileName = "test_curve" + ss.str() + ".slow.dat";
-            std::ofstream out(fileName,std::ofstream::out | std::ofstream::trunc);
-            if(out.is_open()) {
-				for (size_t sp = 0; sp < thresholdsX.size(); sp++) {
-                    out << thresholdsX.at(sp) << "\t" << thresholdsY.back().at(sp) << "\n";
-                }
-            }
-            out.close();
-            // End of testing
-*/
-        }
-        new_hills_ramps = generateNewRamps(thresholdsX, thresholdsY, i+1);
-
-        // For testing----------------------------------------------------
-        if(dbg && groupOfSigmoids.size() > 0) {
-		    std::cerr << "----------new sigmoids ramps----------\n";
-		    for(size_t vr = 0; vr < new_sigmoids_ramps.size(); vr++) {
-		        std::cerr << "----new sigmoid----\n";
-		        for(size_t r = 0; r < new_sigmoids_ramps.at(vr).size(); r++) {
-		            std::cerr << new_sigmoids_ramps.at(vr).at(r) << std::endl;
-		        }
-		    }
-		    std::cerr << "------end of new sigmoids ramps-------\n";
-   		}
-        
-        // For testing-------------------------------------------------------
-        if(dbg && groupOfHills.size() > 0) {
-		    std::cerr << "----------new hills ramps----------\n";
-		    for(size_t vr = 0; vr < new_hills_ramps.size(); vr++) {
-		        std::cerr << "----new hill----\n";
-		        for(size_t r = 0; r < new_hills_ramps.at(vr).size(); r++) {
-		            std::cerr << new_hills_ramps.at(vr).at(r) << std::endl;
-		        }
-		    }
-		    std::cerr << "------end of new hills ramps-------\n";
-	    }
-
-        // for all equations
-        for(size_t j = 0; j < equations.size(); j++) {
-            if(dbg) std::cerr << "in EQ " << j << "\n";
-            int summsCounter = 0;
-            
-            // for all summembers in one equation
-            for(typename std::vector<Summember<T> >::iterator sit = equations.at(j).second.begin(); sit != equations.at(j).second.end(); sit++) {
-            
-                if(dbg) std::cerr << "in Summember:" << summsCounter++ << "\n";
-                Summember<T> summ = *sit;
-
-                // for all sigmoids in one summember
-                for(size_t g = 0; g < summ.GetSigmoids().size(); g++) {
-                    if(dbg) std::cerr << "in sigmoid " << g << "\n";
-                    std::size_t index = (summ.GetSigmoids().at(g)) - 1;
-
-                    // for all sigmoids found for one variable
-					for (size_t v = 0; v < groupOfSigmoids.size(); v++) {
-                        if(index == groupOfSigmoids.at(v)) {
-                            if(dbg) std::cerr << "TERAZ TREBA NAHRADIT SIGMOID " << v << " RAMPAMI\n";
-                            std::vector<Summember<T> > newSummembers = summ.sigmoidAbstraction(new_sigmoids_ramps.at(v), index+1);
-                            if(dbg) std::cerr << "pocet new summs:" << newSummembers.size() << "\n";
-
-                            if(dbg) std::cerr << "pocty summs:" << equations.at(j).second.size() << ",";
-                            typename std::vector<Summember<T> >::iterator newSit;
-                            newSit = equations.at(j).second.erase(sit);
-                            if(dbg) std::cerr << equations.at(j).second.size() << ",";
-
-                            typename std::vector<Summember<T> >::iterator replacingSit;
-                            for(replacingSit = newSummembers.begin(); replacingSit != newSummembers.end(); replacingSit++) {
-                                sit = equations.at(j).second.insert(newSit, *replacingSit);
-                                newSit = sit;
-                            }
-                            
-                            if(dbg) std::cerr << equations.at(j).second.size() << "\n";
-                            summ = *sit;
-                            g = -1;
-                            summsCounter = 0;
-                            if(dbg) std::cerr << "USPESNE NAHRADENE\n";
-
-                            break;
-                        }
-                    }
-                }
-                
-                // for all hill functions in one summember
-                for(size_t g = 0; g < summ.GetHills().size(); g++) {
-                    if(dbg) std::cerr << "in hill function " << g << "\n";
-                    std::size_t index = (summ.GetHills().at(g)) - 1;
-
-                    // for all hill functions found for one variable
-                    for(size_t v = 0; v < groupOfHills.size(); v++) {
-                        if(index == groupOfHills.at(v)) {
-                            if(dbg) std::cerr << "TERAZ TREBA NAHRADIT HILLOVU FUNKCIU " << v << " RAMPAMI\n";
-                            std::vector<Summember<T> > newSummembers = summ.hillAbstraction(new_hills_ramps.at(v), index+1);
-                            if(dbg) std::cerr << "pocet new summs:" << newSummembers.size() << "\n";
-
-                            if(dbg) std::cerr << "pocty summs:" << equations.at(j).second.size() << ",";
-                            typename std::vector<Summember<T> >::iterator newSit;
-                            newSit = equations.at(j).second.erase(sit);
-                            if(dbg) std::cerr << equations.at(j).second.size() << ",";
-
-                            typename std::vector<Summember<T> >::iterator replacingSit;
-                            for(replacingSit = newSummembers.begin(); replacingSit != newSummembers.end(); replacingSit++) {
-                                sit = equations.at(j).second.insert(newSit, *replacingSit);
-                                newSit = sit;
-                            }
-                            
-                            if(dbg) std::cerr << equations.at(j).second.size() << "\n";
-                            summ = *sit;
-                            g = -1;
-                            summsCounter = 0;
-                            if(dbg) std::cerr << "USPESNE NAHRADENE\n";
-
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
-
-template <typename T>
-std::vector<std::vector<typename Summember<T>::ramp> > Model<T>::generateNewRamps(std::vector<double> x, std::vector< std::vector<double> > y, std::size_t dim) {
-    std::vector<std::vector<typename Summember<T>::ramp> > result;
-
-    for(size_t i = 0; i < y.size(); i++) {
-
-        std::vector<typename Summember<T>::ramp> ramps;
-
-        for(size_t t = 0; t < x.size() - 1; t++) {
-            double x1 = x.at(t);
-            double x2 = x.at(t+1);
-            double y1 = y.at(i).at(t);
-            double y2 = y.at(i).at(t+1);
-
-            if(y1 <= y2)
-                ramps.push_back(typename Summember<T>::ramp::ramp(dim, x1, x2, y1, y2));
-            else
-                ramps.push_back(typename Summember<T>::ramp::ramp(dim, x1, x2, y1, y2, true));
-        }
-
-        result.push_back(ramps);
-    }
-
-    return result;
-}
-
-template <typename T>
-std::vector<double> Model<T>::computeThresholds(std::vector<std::size_t> s, std::vector<std::size_t> hfs, int numOfSegments, int numOfX, bool fast) {
-
-	bool dbg = false;
-
-    for(size_t i = 0; i < s.size(); i++) {
-        if(numOfSegments < sigmoids.at(s.at(i)).n) {
-            numOfSegments = sigmoids.at(s.at(i)).n;
-        }
-    }
-
-    std::cerr << "\tnumber of searching segments = " << numOfSegments << std::endl;
-
-    std::vector<double> xPoints;
-    std::vector<std::vector<double> > curves = generateSpace(s,hfs,xPoints,numOfX);
-    std::vector<double> segmentsPoints;
-
-    std::cerr << "\tnumber of evaluating points = " << xPoints.size() << std::endl;
-    if(dbg) std::cerr << "\tnumber of curves = " << curves.size() << std::endl;
-    
-    for(size_t i = 0; i < curves.size(); i++) {
-    	if(dbg) std::cerr << "curve " << i << " size: " << curves.at(i).size() << std::endl;
-    }
-
-    clock_t start, finish; 
-    double durationInSec;  
-
-
-	if(fast) {
-	
-		start = clock();   
-		if(dbg) std::cerr << "before fast approximation...\n";
-		segmentsPoints = optimalFastGlobalLinearApproximation2 (xPoints, curves, numOfSegments);
-		if(dbg) std::cerr << "after fast approximation...\n";
-
-		finish = clock();  
-		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;      
-		if(dbg) std::cerr << "duration = " << durationInSec << " sec. Found = ";
-		for(size_t i = 0; i < segmentsPoints.size(); i++)
-		    if(dbg) std::cerr << segmentsPoints.at(i) << ",";
-		if(dbg) std::cerr << std::endl;
-		
-	} else {
-
-		start = clock();
-
-		if(dbg) std::cerr << "before slow approximation...\n";
-		segmentsPoints = optimalGlobalLinearApproximation (xPoints, curves, numOfSegments);
-		if(dbg) std::cerr << "after slow approximation...\n";
-
-		finish = clock();  
-		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;
-		if(dbg) std::cerr << "duration = " << durationInSec << " sec. Found = "; 
-		for(size_t i = 0; i < segmentsPoints.size(); i++)          
-		    if(dbg) std::cerr << segmentsPoints.at(i) << ",";   
-		if(dbg) std::cerr << std::endl;                         
-		
-	}
-
-    return segmentsPoints;
-}
-
-
-template <typename T>
-std::vector <double>  Model<T>::generateXPoints (double ai, double bi, int num_segments)
-{
-	   double a = ai;
-	   double b = bi;
-
-	   std::vector <double > x;
-
-	   double dx = (b-a)/(num_segments-1);
-
-	   for (int i = 0; i < num_segments; i++)
-	   {
-		   double cx = a + dx*i;
-		   x.push_back(cx);
-	   }
-
-	   return x;
-}
-
-
-template <typename T>
-std::vector<std::vector<double> > Model<T>::generateSpace(std::vector<std::size_t> s, std::vector<std::size_t> hfs, std::vector<double> &x, int numOfX) {
-
-    std::vector<std::vector<double> > y;
-
-    if(s.size() > 0 || hfs.size() > 0) {
-
-        double intervalDeviationParam = 1.5;
-
-        double min = 0.0;
-        double max = 0.0;
-        if(s.size() > 0) {
-        	min =  sigmoids.at(s.at(0)).theta - (2.0 / sigmoids.at(s.at(0)).k) * intervalDeviationParam;
-        	max = sigmoids.at(s.at(0)).theta + (2.0 / sigmoids.at(s.at(0)).k) * intervalDeviationParam;
-        	
-		    if(s.size() > 1) {
-
-		        for(size_t i = 1; i < s.size(); i++) {
-
-		            double tempMin = sigmoids.at(s.at(i)).theta - (2.0 / sigmoids.at(s.at(i)).k) * intervalDeviationParam;
-		            double tempMax = sigmoids.at(s.at(i)).theta + (2.0 / sigmoids.at(s.at(i)).k) * intervalDeviationParam;
-
-		            if(tempMin < min) {
-		                min = tempMin;
-		            }
-		            if(tempMax > max) {
-		                max = tempMax;
-		            }
-		        }
-		    }
-        }
-        
-        if(hfs.size() > 0) {
-        
-        	min = 0.0;
-        	for (size_t i = 0; i < hfs.size(); i++) {
-        	
-        		value_type tempMax = 2.0*hills.at(hfs.at(i)).theta + (5.0/hills.at(hfs.at(i)).n)*hills.at(hfs.at(i)).theta;
-        		if(max < tempMax)
-        			max = tempMax;
-        	}
-        }
-
-        if(min < 0.0)
-            min = 0.0;
-
-        if(numOfX != 0) {
-            x = generateXPoints(min, max, numOfX);
-        } else {
-            x = generateXPoints(min, max, (max - min)*100);
-        }
-
-        for(size_t i = 0; i < s.size(); i++) {
-            y.push_back(sigmoids.at(s.at(i)).enumerateYPoints(x));
-        }
-        
-        for(size_t i = 0; i < hfs.size(); i++) {
-        	y.push_back(hills.at(hfs.at(i)).enumerateYPoints(x));
-        }
-    }
-
-    return y;
-}
-
-
-template <typename T>
-std::vector <double> Model<T>::segmentErr (std::vector <double> x, std::vector <double> y)
-{
-       // Find out size of x
-       int nx = x.size();
-       int ny = y.size();
-
-       std::vector<double> result (3, 0.0);
-
-       if (nx != ny) {
-           std::cerr << "ERROR: number of x-points is not consistent with number of y-points\n";
-           return result;
-       }
-
-       // Compute line segment coefficients
-       double a = (y[nx-1] - y[0]) / (x[nx-1] - x[0]);
-       double b = (y[0] * x[nx-1] - y[nx-1] * x[0]) / (x[nx-1] - x[0]);
-
-       // Compute error for above line segment
-       double e = 0;
-
-	   for (int k = 0; k < nx; k++) {
-		    e += pow((y[k] - a * x[k] - b),2);
-	   }
-	   e /= (pow(a,2) + 1);
-
-       result[0] = e;
-       result[1] = a;
-       result[2] = b;
-
-       return result;
-}
-
-
-template <typename T>
-std::vector<double> Model<T>::optimalGlobalLinearApproximation(std::vector<double> x, std::vector<std::vector<double> > y,
-                                                               int n_segments) {
-	bool dbg = true;
-
-	int n_points = x.size();
-	int n_curves = y.size();
-
-	std::vector<std::vector<double> > mCost(n_points, std::vector<double>(n_segments, INFINITY));
-	std::vector<std::vector<double> > hCst(n_points, std::vector<double>(n_points, INFINITY));
-
-    mCost[1][0] = 0.0;
-
-    std::vector<std::vector<int> > father(n_points, std::vector<int>(n_segments, 0));
-
-
-
-    for (int n = 1; n < n_points; n++) {
-       
-    	double temp = -1 * INFINITY;
-        for (int ic = 0; ic < n_curves; ic++) {
-            
-        	std::vector<double> v1 (x.begin(), x.begin() + n+1);
-            std::vector<double> v2 (y[ic].begin(), y[ic].begin() + n+1);
-            std::vector<double> seg_err = segmentErr(v1, v2);
-
-            temp = std::max(seg_err[0], temp);
-        }
-
-            mCost[n][0] = temp;
-            father[n][0] = 0;
-            //std::cerr << " n=" << n << " mCost[" << n << "][0]=" << temp << " father[" << n << "][0]=" << father[n][0] << "\n";
-    }
-
-    double minErr, currErr;
-    int minIndex;
-
-	std::cerr << "\tcomputing segment ";
-    for (int m = 1; m < n_segments; m++) {
-    
-        std::cerr << m << "... ";
-            
-        for (int n = 2; n < n_points; n++) {
-
-            minErr = mCost[n-1][m-1];
-            minIndex = n - 1;
-
-            for (int i = m; i <= n-2; i++) {
-                
-                if (hCst[i][n]==INFINITY) {
-                    double temp = -1 * INFINITY;
-
-                    for (int ic = 0; ic < n_curves; ic++) {
-                         std::vector<double> v1 (x.begin() + i, x.begin() + n+1);
-                         std::vector<double> v2 (y[ic].begin() + i, y[ic].begin() + n+1);
-                         std::vector<double> seg_err = segmentErr(v1, v2);
-
-                         temp = std::max(seg_err[0], temp);
-                    }
-
-                    hCst[i][n] = temp;
-                }
-
-                currErr = mCost[i][m-1] + hCst[i][n];
-
-                if (currErr < minErr) {
-                    minErr = currErr;
-                    minIndex = i;
-                }
-            }
-            mCost[n][m]  = minErr;
-            father[n][m] = minIndex;
-//            std::cerr << " n=" << n << " mCost[" << n << "][" << m << "]=" << mCost[n][m] << " father[" << n << "][" << m << "]=" << father[n][m] << "\n";
-        }
-    }
-    std::cerr << "\n";
-
-    std::vector<int> ib (n_segments+1, 0);
-    std::vector<double> xb (n_segments+1, 0.0);
-
-    ib[n_segments] = n_points-1;
-    xb[n_segments] = x[ib[n_segments]];
-    
-    for (int i = n_segments-1; i >= 0; i--) {
-        ib[i] = father[ib[i+1]][i];
-        xb[i] = x[ib[i]];
-    }
-
-    if(dbg) {
-    	std::cerr << "\tSegments thresholds found:\n";
-		for (int i = 0; i < n_segments + 1; i++) {
-		    std::cerr << "\t" << xb[i] << "\n";
-		}
-	}
-
-    return xb;
-}
-
-template <typename T>
-std::vector <double> Model<T>::optimalFastGlobalLinearApproximation2 (std::vector<double> x, std::vector<std::vector<double> > y, int n_segments) {
-	
-	bool dbg = true;
-	
-	int n_points = x.size();
-	int n_curves = y.size();
-	
-	std::vector<std::vector<double> > mCost (n_points, std::vector<double>(n_segments, INFINITY));
-	std::vector<std::vector<double> > hCst  (n_points, std::vector<double>(n_points, INFINITY));
-	
-	mCost[1][0] = 0.0;
-	
-	std::vector<std::vector<int> > father (n_points, std::vector<int> (n_segments, 0));
-	
-	
-	for (int n=1; n < n_points; n++) {
-		double temp = -1 * INFINITY;
-		
-		//cerr << "temp =" << temp << "\n";
-		
-		for (int ic=0; ic < n_curves; ic++) {
-			std::vector<double> v1 (x.begin(), x.begin() + n+1);
-			std::vector<double> v2 (y[ic].begin(), y[ic].begin() + n+1);    
-			std::vector<double> seg_err = segmentErr(v1, v2);
-			
-			temp = std::max(seg_err[0], temp);
-		} 
-		
-		mCost [n][0] = temp;
-		father[n][0] = 0;
-		//cerr << " n=" << n << " mCost[" << n << "][0]=" << temp << " father[" << n << "][0]=" << father[n][0] << "\n";
-	}
-	
-	
-	std::vector<std::vector<double> > sy2 (n_curves, std::vector<double> (n_points, 0.0));
-	std::vector<std::vector<double> > sy  (n_curves, std::vector<double> (n_points, 0.0));
-	std::vector<std::vector<double> > sxy (n_curves, std::vector<double> (n_points, 0.0));
-	
-	std::vector<double> sx2 (n_points, 0);
-	std::vector<double> sx (n_points, 0);
-	
-	for (int ic=0; ic < n_curves; ic++) {
-		sy2[ic][0] = y[ic][0] * y[ic][0];
-		sy [ic][0] = y[ic][0];
-		sxy[ic][0] = y[ic][0] * x[0];
-		
-		for (int ip=1; ip < n_points; ip++) {
-			sy2[ic][ip] = sy2[ic][ip-1] + (y[ic][ip] * y[ic][ip]);
-			sy [ic][ip] = sy [ic][ip-1] + (y[ic][ip]);
-			sxy[ic][ip] = sxy[ic][ip-1] + (y[ic][ip] * x[ip]);
-		}
-	}
-	
-	sx2[0] = x[0] * x[0];
-	sx[0] = x[0];
-	
-	for (int ip=1; ip < n_points; ip++) {
-	    sx2[ip] = sx2[ip-1] + (x[ip] * x[ip]);
-	    sx [ip] = sx [ip-1]  + x[ip];
-	}
-    
-	double minErr, currErr;
-	int minIndex;
-
-	std::cerr << "\tcomputing segment ";    
-	
-	for (int m = 1; m < n_segments; m++) {
-	
-        std::cerr << m << "... ";
-        
-		for (int n = 2; n < n_points; n++) {
-			
-			minErr = mCost[n-1][m-1];
-			minIndex = n - 1;
-			
-			for (int i = m; i <= n-2; i++) {
-				if (hCst[i][n] == INFINITY) {
-				
-					double temp = -1 * INFINITY;
-					
-					for (int ic = 0; ic < n_curves; ic++)	{
-						
-						double a = (y[ic][n] - y[ic][0]) / (x[n] - x[0]);
-						double b = (y[ic][0] * x[n] - y[ic][n] * x[0]) / (x[n] - x[0]);
-						double seg_err = (sy2[ic][n] - sy2[ic][i-1]) - 2 * a * (sxy[ic][n] - sxy[ic][i-1]) - 2 * b * (sy[ic][n] - sy[ic][i-1]) + a * a * (sx2[n] - sx2[i-1]) + 2 * a * b * (sx[n] - sx[i-1]) + b * (n - i);
-						
-						temp = std::max(seg_err, temp);
-					}
-					
-					hCst[i][n] = temp;
-				}
-				
-				currErr = mCost[i][m-1] + hCst[i][n];
-				
-				if (currErr < minErr) {
-					minErr = currErr;
-					minIndex = i;
-				}
-			} 
-			mCost[n][m]  = minErr;
-			father[n][m] = minIndex;
-//			std::cerr << " n=" << n << " mCost[" << n << "][" << m << "]=" << mCost[n][m] << " father[" << n << "][" << m << "]=" << father[n][m] << "\n";
-        }
-    }         
-    std::cerr << "\n";
-	
-    std::vector<int> ib (n_segments+1, 0  );
-    std::vector<double> xb (n_segments+1, 0.0);	
-	
-    ib[n_segments] = n_points-1;
-    xb[n_segments] = x[ib[n_segments]];
-    if(dbg) std::cerr << "x[ib[n_segments]]=" << x[ib[n_segments]] << "\n";
-    
-    for (int i=n_segments-1; i >= 0; i--) {
-		ib[i] = father[ib[i+1]][i];
-		xb[i] = x[ib[i]];
-		// std::cerr << "x" << n_points - i << "=" << xb[i] << "\n";
-    }         
-
-    if(dbg) {
-    	std::cerr << "\tSegments thresholds found:\n";
-		for (int i = 0; i < n_segments + 1; i++) {
-		    std::cerr << "\t" << xb[i] << "\n";
-		}
-	}
-	
-    return xb;
-}
-
-
+#pragma once
+#include <stdlib.h>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <time.h>
+#include <climits>
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Summember.h"
+
+
+
+
+using std::string;
+
+template <typename T>
+class Model
+{
+	typedef T value_type;
+
+private:
+
+	struct sigmoid
+	{
+		std::size_t dim;
+		value_type k;
+		value_type theta;
+		value_type a;
+		value_type b;
+		std::size_t n;
+		bool positive;
+		bool isInverse;
+
+		friend std::ostream& operator<<(std::ostream& out, const sigmoid& s) {
+			if (!s.positive)
+				out << "S(-)[";
+			else
+				out << "S(+)[";
+			out << s.n << "](" << s.dim << "," << s.k << "," << s.theta << "," << s.a << "," << s.b << ")";
+			return out;
+			
+		}
+		
+		std::vector<value_type> enumerateYPoints(std::vector<value_type> x)
+		{
+			std::vector<value_type> y;
+			value_type tempA = a;
+			value_type tempB = b;
+			
+			for (size_t i = 0; i < x.size(); i++) {
+				y.push_back(tempA + (tempB - tempA)*((1 + tanh(k*(x.at(i) - theta)))*0.5));
+			}
+			
+			return y;
+		}
+
+	};
+	
+	
+	struct hill {
+	    std::size_t dim;		//Warning: index of var_name from Model.h but indexing from 1 (not 0)
+	    value_type theta;
+	    value_type n;
+	    value_type a;
+	    value_type b;
+	    bool positive;
+	    
+        hill() {}
+		hill(std::size_t new_dim, value_type new_theta, value_type new_n, value_type new_a, value_type new_b, bool new_positive = true)
+                    : dim(new_dim), theta(new_theta), n(new_n), a(new_a), b(new_b), positive(new_positive) {
+        	if( (positive && a > b) || (!positive && a < b) ) {        		
+        		a = new_b;
+        		b = new_a;
+        	}
+        }
+        hill(const hill& s) : dim(s.dim), theta(s.theta), n(s.n), a(s.a), b(s.b), positive(s.positive) {}
+
+
+		value_type value(value_type value) const
+		{
+			value_type result = a + (b - a)*(std::pow(1.0,n) / (std::pow(1.0,n) + std::pow(theta/value,n))); 
+			return result;
+		}
+		
+		std::vector<value_type> enumerateYPoints(std::vector<value_type> x) {
+			std::vector<value_type> y;
+			for(size_t i = 0; i < x.size(); i++) {
+				y.push_back(value(x.at(i)));
+			}
+			return y;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const hill& s) {
+		    if(s.positive)
+                out << "Hill(-)(";
+            else
+                out << "Hill(+)(";
+            out << s.dim << "," << s.theta << "," << s.n << "," << s.a << "," << s.b << ")";
+            return out;
+		}
+	};
+
+public:
+	void AddVariable(string var);
+	void AddParam(string param);
+	void AddParamRange(value_type a, value_type b);
+	void AddConstantName(string constant);
+	void AddConstantValue(value_type constant);
+
+	void AddSigmoid(std::size_t segments, std::size_t dim, value_type k, value_type theta,
+		value_type a, value_type b, bool positive = 1, bool isInverse = 0);
+	void AddSigmoid(sigmoid & new_sigmoid);
+	
+	void AddHill(std::size_t dim, value_type theta, value_type n, value_type a, value_type b, bool positive = 1);
+	void AddHill(hill & copy);
+
+	void AddEquation(std::vector<Summember<T> > summs);
+	void AddEquationName(std::string var);
+
+	void AddThresholdName(std::string var);
+	void AddThresholdValue(std::string value);
+
+	void AddVarPointsName(std::string var);
+	void AddVarPointsFstValue(std::string value);
+	void AddVarPointsSndValue(std::string value);
+
+	void AddInitsName(std::string var);
+	void AddInitsFstValue(std::string value);
+	void AddInitsSndValue(std::string value);
+
+	void AddBaLine(std::string);
+
+	std::size_t GetSigmoidsSize();
+
+    const std::vector<std::string> getVariables() const;
+	const std::string getVariable(int index) const;
+	const size_t getVariableIndex(std::string var) const;
+	const size_t getDims() const { return var_names.size(); }
+
+    const std::vector<std::string> getParamNames() const;
+	const std::string getParamName(int index) const;
+	const std::vector<std::pair<value_type, value_type> > getParamRanges() const;
+	const std::pair<value_type, value_type> getParamRange(int index) const;
+
+	const std::vector<std::pair<std::string, value_type> > getConstants() const;
+	const std::pair<std::string, value_type> getConstant(int index) const;
+
+	const std::vector<std::pair<std::size_t, std::vector<Summember<T> > > > getEquations() const;
+	const std::vector<Summember<T> > getEquationForVariable(size_t varIndex) const;
+	const Summember<T> getSumForVarByIndex(size_t varIndex, size_t i) const;
+
+	const std::vector<std::pair<std::size_t, std::vector<value_type> > > getThresholds() const;
+	const std::vector<value_type> getThresholdsForVariable(size_t varIndex) const;
+	const value_type getThresholdForVarByIndex(size_t varIndex, size_t i) const;
+
+	const std::vector<std::pair<value_type, value_type> > getVarPointsValues() const;
+	const std::vector<std::string> getVarPointsNames() const;
+
+	const std::vector<std::pair<value_type, value_type> > getInitsValues() const;
+	const std::vector<std::string> getInitsNames() const;
+	const std::pair<value_type, value_type> getInitsValuesForVariable(size_t varIndex) const;
+
+	const std::vector<std::string> getBaLines() const;
+
+	const std::vector<sigmoid> getSigmoids() const;
+	const std::vector<hill> getHills() const;
+
+	// threads == 0 means one thread per available core
+	void RunAbstraction(bool useFastApproximation = true, std::size_t threads = 0);
+
+	// Text of the property process (the part of the model file starting by
+	// 'process' with comments removed and lines joined), parsed by the tools
+	// and kept in compiled models
+	void SetProperty(std::string text);
+	const std::string & getProperty() const { return property; }
+
+	// Compiled model - the model after RunAbstraction() (thresholds,
+	// equations with ramps, initial regions, Buchi automata) in a binary
+	// form loaded by mmap() without parsing and abstraction. The data are
+	// stored in the native format of the machine, files of another version
+	// or machine are refused.
+	static const unsigned int COMPILED_VERSION = 1;
+	static bool IsCompiled(const std::string &fileName);
+	bool WriteCompiled(const std::string &fileName) const;
+	bool WriteCompiled(std::ostream &file) const;
+	bool ReadCompiled(const std::string &fileName);
+
+	// True if both models are the same apart from the property process
+	// (the files made by divine.combine from one model for several
+	// properties)
+	bool SameModel(const Model<T> &other) const;
+
+private:
+	std::vector<std::size_t> FindSigmoids(std::size_t dim);
+	std::vector<std::size_t> FindHills(std::size_t dim);
+
+	std::vector<sigmoid> sigmoids;
+	std::vector<hill> hills;
+	std::vector<std::string> var_names;  
+	std::vector<std::string> param_names;
+	std::vector<std::pair<value_type, value_type> > param_ranges;
+	std::vector<std::pair<std::string, value_type> > constants;  
+	std::vector<std::pair<std::size_t, std::vector<Summember<T> > > > equations;
+	std::vector<std::pair<std::size_t, std::vector<value_type> > > thresholds;
+	std::vector<std::size_t> var_points;
+	std::vector<std::pair<value_type, value_type> > var_points_values;
+	std::vector<std::size_t> inits;
+	std::vector<std::pair<value_type, value_type> > inits_values;
+	std::vector<std::string> ba_lines;
+	std::string property;
+
+	// Writer and reader of the binary form of compiled models
+	struct compiled_writer {
+		std::ostream &out;
+		compiled_writer(std::ostream &o) : out(o) {}
+		template <class V> void put(const V &v) { out.write(reinterpret_cast<const char *>(&v), sizeof(V)); }
+		void put(const std::string &s) { put(s.size()); out.write(s.data(), s.size()); }
+		template <class A, class B> void put(const std::pair<A, B> &p) { put(p.first); put(p.second); }
+		template <class E> void put(const std::vector<E> &v) {
+			put(v.size());
+			for (size_t i = 0; i < v.size(); i++)
+				put(v.at(i));
+		}
+	};
+
+	struct compiled_reader {
+		const char *pos;
+		const char *end;
+		compiled_reader(const char *p, const char *e) : pos(p), end(e) {}
+		template <class V> bool get(V &v) {
+			if (size_t(end - pos) < sizeof(V))
+				return false;
+			memcpy(&v, pos, sizeof(V));
+			pos += sizeof(V);
+			return true;
+		}
+		bool get(std::string &s) {
+			size_t n;
+			if (!get(n) || size_t(end - pos) < n)
+				return false;
+			s.assign(pos, n);
+			pos += n;
+			return true;
+		}
+		// a number of elements, each of them takes a byte at least
+		bool getCount(size_t &n) { return get(n) && n <= size_t(end - pos); }
+		template <class A, class B> bool get(std::pair<A, B> &p) { return get(p.first) && get(p.second); }
+		template <class E> bool get(std::vector<E> &v) {
+			size_t n;
+			if (!getCount(n))
+				return false;
+			v.resize(n);
+			for (size_t i = 0; i < n; i++)
+				if (!get(v.at(i)))
+					return false;
+			return true;
+		}
+	};
+
+	static const char COMPILED_MAGIC[8];
+	void writeCompiledData(compiled_writer &out) const;
+	bool readCompiledData(compiled_reader &in);
+
+
+	// Abstraction of one variable. Jobs of different variables are
+	// independent and are computed in parallel, the log is printed
+	// afterwards in the order of variables.
+	struct abstraction_job {
+		std::vector<std::size_t> sigmoids;
+		std::vector<std::size_t> hills;
+		int numOfSegments;
+		int numOfXPoints;
+		std::vector<double> thresholds;
+		std::string log;
+	};
+
+	void computeAllThresholds(std::vector<abstraction_job> &jobs, bool fast, std::size_t threads);
+	void computeJobThresholds(abstraction_job &job, bool fast);
+
+	// On-disk cache of computed thresholds, shared by all tools working
+	// with the same model. The directory is given by DIVINE_ABSTRACTION_CACHE
+	// (empty value disables the cache), by default ~/.cache/divine/abstraction.
+	std::string abstractionKey(const abstraction_job &job, bool fast) const;
+	static std::string abstractionCacheFile(const std::string &key);
+	static bool loadThresholds(const std::string &key, std::vector<double> &thresholds);
+	static void storeThresholds(const std::string &key, const std::vector<double> &thresholds);
+
+    std::vector<double> computeThresholds(std::vector<std::size_t> s, std::vector<std::size_t> hfs, int numOfSegments, int numOfX = 0, bool fast = true, std::ostream &log = std::cerr);
+    std::vector<std::vector<double> > generateSpace(std::vector<std::size_t> s, std::vector<std::size_t> hfs, std::vector<double> &x, int numOfX);
+    std::vector<double> generateXPoints (double ai, double bi, int num_segments);
+    std::vector<double> segmentErr (std::vector <double> x, std::vector <double> y);
+    std::vector<double> optimalGlobalLinearApproximation(std::vector<double> x, std::vector<std::vector<double> > y, int n_segments, std::ostream &log = std::cerr);
+    std::vector<double> optimalFastGlobalLinearApproximation2 (std::vector<double> x, std::vector<std::vector<double> > y, int n_segments, std::ostream &log = std::cerr);
+    std::vector<std::vector<typename Summember<value_type>::ramp> > generateNewRamps(std::vector<double> x, std::vector< std::vector<double> > y, std::size_t dim);
+};
+
+
+template <typename T>
+void Model<T>::AddBaLine(std::string ba) {
+    ba_lines.push_back(ba);
+}
+
+template <typename T>
+void Model<T>::SetProperty(std::string text) {
+    property = text;
+}
+
+template <typename T>
+void Model<T>::AddInitsName(std::string var) {
+    size_t indexOfVar = -1;
+    for (size_t i = 0; i < var_names.size(); i++) {
+        if (var_names.at(i).compare(var) == 0 ) {
+            indexOfVar = i;
+            break;
+        }
+    }
+    if(indexOfVar >= 0 && indexOfVar < var_names.size())
+        inits.push_back(indexOfVar);
+}
+
+template <typename T>
+void Model<T>::AddInitsFstValue(std::string value) {
+    std::pair<T, T> values;
+    values.first = (T)std::stod(value);
+    bool correctValue = false;
+    for(size_t i = 0; i < getThresholdsForVariable(inits.back()).size(); i++) {
+    	if(values.first == getThresholdsForVariable(inits.back()).at(i)) {
+    		correctValue = true;
+    		break;
+		}
+    }
+    if(!correctValue) {
+    	std::cerr  << "Error: INIT values of variable must be from THRES values of that variable.\n";
+    	exit(15);
+    }
+    inits_values.push_back(values);
+}
+
+template <typename T>
+void Model<T>::AddInitsSndValue(std::string value) {
+    inits_values.back().second = (T)std::stod(value);
+    bool correctValue = false;
+    for(size_t i = 0; i < getThresholdsForVariable(inits.back()).size(); i++) {
+    	if(inits_values.back().second == getThresholdsForVariable(inits.back()).at(i)) {
+    		correctValue = true;
+    		break;
+		}
+    }
+    if(!correctValue) {
+    	std::cerr  << "Error: INIT values of variable must be from THRES values of that variable.\n";
+    	exit(15);
+    }
+}
+
+template <typename T>
+void Model<T>::AddVarPointsName(std::string var) {
+    size_t indexOfVar = -1;
+    for (size_t i = 0; i < var_names.size(); i++) {
+        if (var_names.at(i).compare(var) == 0 ) {
+            indexOfVar = i;
+            break;
+        }
+    }
+    if(indexOfVar >= 0 && indexOfVar < var_names.size())
+        var_points.push_back(indexOfVar);
+}
+
+template <typename T>
+void Model<T>::AddVarPointsFstValue(std::string value) {
+    std::pair<T, T> values;
+    values.first = (T)std::stod(value);
+    var_points_values.push_back(values);
+}
+
+template <typename T>
+void Model<T>::AddVarPointsSndValue(std::string value) {
+    var_points_values.back().second = (T)std::stod(value);
+}
+
+template <typename T>
+void Model<T>::AddThresholdName(std::string var) {
+
+	// Finding for index of given variable
+    int indexOfVar = -1;
+    for (size_t i = 0; i < var_names.size(); i++) {
+        if (var_names.at(i).compare(var) == 0 ) {
+            indexOfVar = i;
+            break;
+        }
+    }
+    
+    // If given variable could not be found
+    if(indexOfVar == -1) {
+    	std::cerr << "ERROR: Wrong given variable " << var << "\n";
+    	return;
+	}
+
+	// Finding previous thresholds for given variable
+    size_t i = 0;
+    for( ; i < thresholds.size(); i++) {
+        if(thresholds.at(i).first == indexOfVar) {
+            if(i < thresholds.size() - 1) {
+                swap(thresholds.at(i), thresholds.at(thresholds.size() - 1));
+            }
+            i = 0;
+            break;
+        }
+    }
+    
+    // No previous thresholds were found - variable need new record of thresholds
+    if(i == thresholds.size()) {
+        std::pair<std::size_t, std::vector<T> > p;
+        std::vector<T> th;
+        p.first = indexOfVar;
+        p.second = th;
+        thresholds.push_back(p);
+    }
+}
+
+template <typename T>
+void Model<T>::AddThresholdValue(std::string value) {
+
+	value_type val = (T)std::stod(value);
+	
+    if(!thresholds.empty()) {
+    	if(std::find(thresholds.back().second.begin(),thresholds.back().second.end(),val) == thresholds.back().second.end()) {
+		    thresholds.back().second.push_back(val);
+		    std::sort(thresholds.back().second.begin(),thresholds.back().second.end());
+	    }
+    }
+}
+
+template <typename T>
+void Model<T>::AddEquationName(std::string var) {
+    std::pair<std::size_t, std::vector<Summember<T> > > eq;
+
+    for (int i = 0; i != var_names.size(); i++) {
+        if (var_names.at(i).compare(var) == 0 ) {
+            eq.first = i;
+        }
+    }
+    equations.push_back(eq);
+}
+
+template <typename T>
+void Model<T>::AddEquation(std::vector<Summember<T> > summs) {
+    if(!equations.empty()) {
+        equations.back().second = summs;
+    }
+}
+
+
+template <typename T>
+void Model<T>::AddVariable(string var)
+{
+	var_names.push_back(var);
+}
+
+template <typename T>
+void Model<T>::AddParam(string param)
+{
+	param_names.push_back(param);
+}
+
+template <typename T>
+void Model<T>::AddParamRange(value_type a, value_type b)
+{
+	std::pair<value_type, value_type> p;
+	p.first = a;
+	p.second = b;
+
+	param_ranges.push_back(p);
+}
+
+template <typename T>
+void Model<T>::AddConstantName(string constant)
+{
+	std::pair<std::string, value_type> p;
+	p.first = constant;
+	constants.push_back(p);
+}
+
+template <typename T>
+void Model<T>::AddConstantValue(value_type constant)
+{
+	if (constants.empty())
+	{
+		std::cerr << "ERROR: No constant name to adding a value.\n";
+	}
+
+	std::pair<std::string, value_type> & p = constants.back();
+	p.second = constant;
+}
+
+template <typename T>
+void Model<T>::AddHill(std::size_t dim, value_type theta, value_type n, value_type a, value_type b, bool positive) {
+	hill h;
+	h.dim = dim;
+	h.theta = theta;
+	h.n = n;
+	h.a = a;
+	h.b = b;
+	hills.push_back(h);
+}
+
+template <typename T>
+void Model<T>::AddHill(hill & copy) {
+	hills.push_back(copy);
+}
+
+template <typename T>
+void Model<T>::AddSigmoid(std::size_t segments, std::size_t dim, value_type k, value_type theta,
+	value_type a, value_type b, bool positive, bool isInverse)
+{
+	sigmoid s;
+	s.n = segments;
+	s.dim = dim;
+	s.k = k;
+	s.theta = theta;
+	s.positive = positive;
+	s.isInverse = isInverse;
+	s.a = a;
+	s.b = b;
+	sigmoids.push_back(s);
+}
+
+template <typename T>
+void Model<T>::AddSigmoid(sigmoid & new_sigmoid)
+{
+	sigmoids.push_back(new_sigmoid);
+}
+
+template <typename T>
+std::size_t Model<T>::GetSigmoidsSize()
+{
+	return sigmoids.size();
+}
+
+
+template <typename T>
+const std::vector<std::string> Model<T>::getVariables() const {
+	return var_names;
+}
+
+template <typename T>
+const std::string Model<T>::getVariable(int index) const {
+	return var_names.at(index);
+}
+
+template <typename T>
+const size_t Model<T>::getVariableIndex(std::string var) const {
+	for(size_t i = 0; i < var_names.size(); i++) {
+		if(var_names.at(i).compare(var) == 0)
+			return i;
+	}
+	return UINT_MAX;
+}
+
+template <typename T>
+const std::vector<std::string> Model<T>::getParamNames() const {
+    return param_names;
+}
+
+template <typename T>
+const std::string Model<T>::getParamName(int index) const {
+    return param_names.at(index);
+}
+
+template <typename T>
+const std::vector<std::pair<T, T> > Model<T>::getParamRanges() const {
+    return param_ranges;
+}
+
+template <typename T>
+const std::pair<T, T> Model<T>::getParamRange(int index) const {
+    return param_ranges.at(index);
+}
+
+template <typename T>
+const std::vector<std::pair<std::string, T> > Model<T>::getConstants() const {
+    return constants;
+}
+
+template <typename T>
+const std::pair<std::string, T> Model<T>::getConstant(int index) const {
+    return constants.at(index);
+}
+
+template <typename T>
+const std::vector<std::pair<std::size_t, typename std::vector<Summember<T> > > > Model<T>::getEquations() const {
+    return equations;
+}
+
+template <typename T>
+const std::vector<Summember<T> > Model<T>::getEquationForVariable(size_t varIndex) const {
+	for(size_t i = 0; i < equations.size(); i++) {
+		if(varIndex == equations.at(i).first) {
+			return equations.at(i).second;
+		}
+	}
+	
+	return std::vector<Summember<T> >();
+}
+
+template <typename T>
+const Summember<T> Model<T>::getSumForVarByIndex(size_t varIndex, size_t i) const {
+	return getEquationForVariable(varIndex).at(i);
+}
+
+template <typename T>
+const std::vector<std::pair<std::size_t, std::vector<T> > > Model<T>::getThresholds() const {
+    return thresholds;
+}
+
+template <typename T>
+const std::vector<T> Model<T>::getThresholdsForVariable(size_t varIndex) const {
+	for(size_t i = 0; i < thresholds.size(); i++) {
+		if(varIndex == thresholds.at(i).first)
+			return thresholds.at(i).second;
+	}
+}
+
+template <typename T>
+const T Model<T>::getThresholdForVarByIndex(size_t varIndex, size_t i) const {
+	return getThresholdsForVariable(varIndex).at(i);
+}
+
+template <typename T>
+const std::vector<std::pair<T, T> > Model<T>::getVarPointsValues() const {
+    return var_points_values;
+}
+
+template <typename T>
+const std::vector<std::string> Model<T>::getVarPointsNames() const {
+    std::vector<std::string> vpn;
+    for(int i = 0; i < var_points.size(); i++) {
+        vpn.push_back(var_names.at(var_points.at(i)));
+    }
+    return vpn;
+}
+
+template <typename T>
+const std::vector<std::pair<T, T> > Model<T>::getInitsValues() const {
+    return inits_values;
+}
+
+template <typename T>
+const std::pair<T, T> Model<T>::getInitsValuesForVariable(size_t varIndex) const {
+    for(int i = 0; i < inits.size(); i++) {
+		if(varIndex == inits.at(i)) {
+			return inits_values.at(i);
+		}
+	}
+	std::cerr << "ERROR: Wrong index of variable\n";
+	return std::pair<T,T>();
+}
+
+template <typename T>
+const std::vector<std::string> Model<T>::getInitsNames() const {
+    std::vector<std::string> vpn;
+    for(int i = 0; i < inits.size(); i++) {
+        vpn.push_back(var_names.at(inits.at(i)));
+    }
+    return vpn;
+}
+
+template <typename T>
+const std::vector<std::string> Model<T>::getBaLines() const {
+    return ba_lines;
+}
+
+template <typename T>
+const std::vector<typename Model<T>::sigmoid> Model<T>::getSigmoids() const {
+    return sigmoids;
+}
+
+template <typename T>
+const std::vector<typename Model<T>::hill> Model<T>::getHills() const {
+	return hills;
+}
+
+
+template <typename T>
+std::vector<std::size_t> Model<T>::FindHills(std::size_t dim) {
+	std::vector<std::size_t> result;
+	
+	for (uint i = 0; i < hills.size(); i++) {
+		if(hills.at(i).dim == dim + 1)
+			result.push_back(i);
+	}
+	return result;
+}
+
+template <typename T>
+std::vector<std::size_t> Model<T>::FindSigmoids(std::size_t dim) {
+	std::vector<std::size_t> result;
+
+	for (uint i = 0; i < sigmoids.size(); i++)
+	{
+		if (sigmoids.at(i).dim == dim + 1)
+			result.push_back(i);
+	}
+	return result;
+}
+
+template <typename T>
+void Model<T>::RunAbstraction(bool useFastApproximation, std::size_t threads)
+{
+
+	std::vector<std::vector<typename Summember<T>::ramp> > new_sigmoids_ramps;
+	std::vector<std::vector<typename Summember<T>::ramp> > new_hills_ramps;	
+	unsigned int curveNum = 0;
+	bool dbg = false;
+
+	std::vector<abstraction_job> jobs(var_names.size());
+
+    for(size_t i = 0; i < var_names.size(); i++) {
+
+        abstraction_job &job = jobs.at(i);
+        std::ostringstream log;
+
+        job.sigmoids = FindSigmoids(i);
+        log << "\t" << job.sigmoids.size() << " sigmoids has been found\n";
+        
+        job.hills = FindHills(i);
+        log << "\t" << job.hills.size() << " Hill functions has been found\n";        
+        job.log = log.str();
+
+        job.numOfSegments = 5;
+        job.numOfXPoints = 0;
+
+        for(size_t j = 0; j < var_points.size(); j++) {
+            if(i == var_points.at(j)) {
+				// check if default number of requested segments is enough against number from input file
+                if(job.numOfSegments < var_points_values.at(j).second)
+                    job.numOfSegments = var_points_values.at(j).second;
+
+				// check if default number of requested x-points is enough against number from input file
+                if(job.numOfXPoints < var_points_values.at(j).first)
+                    job.numOfXPoints = var_points_values.at(j).first;
+            }
+        }
+    }
+
+    computeAllThresholds(jobs, useFastApproximation, threads);
+
+    for(size_t i = 0; i < var_names.size(); i++) {
+
+        std::cerr << jobs.at(i).log;
+
+        std::vector<std::size_t> &groupOfSigmoids = jobs.at(i).sigmoids;
+        std::vector<std::size_t> &groupOfHills = jobs.at(i).hills;
+
+        if(groupOfSigmoids.empty() && groupOfHills.empty())
+            continue;       // no need for abstraction for this variable
+
+        std::vector<double> &thresholdsX = jobs.at(i).thresholds;
+
+    // New generated thresholds from computeThresholds() are storing to the previous ones here
+		if(dbg) std::cerr << "New threses for var " << getVariable(i) << ": ";	//just for testing
+        AddThresholdName(getVariable(i));
+        for(size_t t = 0; t < thresholdsX.size(); t++) {
+            std::stringstream ss;
+            ss << thresholdsX.at(t);
+            AddThresholdValue(ss.str());
+            if(dbg) std::cerr << ss.str() << ", ";		//Just for testing
+        }
+        if(dbg) std::cerr << "\n";		//just for testing
+
+        
+        // Testing-----------------------------------------------------
+        if(dbg) {
+		    std::cerr << "All threses for var " << getVariable(i) << ": ";
+		    for(int t = 0; t < getThresholdsForVariable(i).size(); t++) {
+		    	std::cerr << getThresholdForVarByIndex(i,t) << ", ";
+		    }
+		    std::cerr << "\n";
+	    }
+		// End of testing----------------------------------------------
+
+
+        std::vector<std::vector<double> > thresholdsY;
+
+        for(size_t j = 0; j < groupOfSigmoids.size(); j++) {
+
+            thresholdsY.push_back(sigmoids.at(groupOfSigmoids.at(j)).enumerateYPoints(thresholdsX));
+/*
+            // Testing functionality
+            std::stringstream ss;
+            ss << curveNum++;
+            std::string fileName = "nezmysel";
+            if(useFastApproximation)
+            	fileName = "test_curve" + ss.str() + ".fast.dat";
+            else
+            	fileName = "test_curve" + ss.str() + ".slow.dat";
+            std::ofstream out(fileName,std::ofstream::out | std::ofstream::trunc);
+            if(out.is_open()) {
+				for (size_t sp = 0; sp < thresholdsX.size(); sp++) {
+                    out << thresholdsX.at(sp) << "\t" << thresholdsY.back().at(sp) << "\n";
+                }
+            }
+            out.close();
+            // End of testing
+*/
+        }
+        new_sigmoids_ramps = generateNewRamps(thresholdsX, thresholdsY, i+1);
+        
+        thresholdsY.clear();
+		for (size_t j = 0; j < groupOfHills.size(); j++) {
+            thresholdsY.push_back(hills.at(groupOfHills.at(j)).enumerateYPoints(thresholdsX));
+/*
+            // Testing functionality
+            std::stringstream ss;
+            ss << curveNum++;
+            std::string fileName = "nezmysel";
+            if(useFastApproximation)
+            	fileName = "test_curve" + ss.str() + ".fast.dat";
+            else
+            	fileName = "test_curve" + ss.str() + ".slow.dat";
+            std::ofstream out(fileName,std::ofstream::out | std::ofstream::trunc);
+            if(out.is_open()) {
+				for (size_t sp = 0; sp < thresholdsX.size(); sp++) {
+                    out << thresholdsX.at(sp) << "\t" << thresholdsY.back().at(sp) << "\n";
+                }
+            }
+            out.close();
+            // End of testing
+*/
+        }
+        new_hills_ramps = generateNewRamps(thresholdsX, thresholdsY, i+1);
+
+        // For testing----------------------------------------------------
+        if(dbg && groupOfSigmoids.size() > 0) {
+		    std::cerr << "----------new sigmoids ramps----------\n";
+		    for(size_t vr = 0; vr < new_sigmoids_ramps.size(); vr++) {
+		        std::cerr << "----new sigmoid----\n";
+		        for(size_t r = 0; r < new_sigmoids_ramps.at(vr).size(); r++) {
+		            std::cerr << new_sigmoids_ramps.at(vr).at(r) << std::endl;
+		        }
+		    }
+		    std::cerr << "------end of new sigmoids ramps-------\n";
+   		}
+        
+        // For testing-------------------------------------------------------
+        if(dbg && groupOfHills.size() > 0) {
+		    std::cerr << "----------new hills ramps----------\n";
+		    for(size_t vr = 0; vr < new_hills_ramps.size(); vr++) {
+		        std::cerr << "----new hill----\n";
+		        for(size_t r = 0; r < new_hills_ramps.at(vr).size(); r++) {
+		            std::cerr << new_hills_ramps.at(vr).at(r) << std::endl;
+		        }
+		    }
+		    std::cerr << "------end of new hills ramps-------\n";
+	    }
+
+        // for all equations
+        for(size_t j = 0; j < equations.size(); j++) {
+            if(dbg) std::cerr << "in EQ " << j << "\n";
+            int summsCounter = 0;
+            
+            // for all summembers in one equation
+            for(typename std::vector<Summember<T> >::iterator sit = equations.at(j).second.begin(); sit != equations.at(j).second.end(); sit++) {
+            
+                if(dbg) std::cerr << "in Summember:" << summsCounter++ << "\n";
+                Summember<T> summ = *sit;
+
+                // for all sigmoids in one summember
+                for(size_t g = 0; g < summ.GetSigmoids().size(); g++) {
+                    if(dbg) std::cerr << "in sigmoid " << g << "\n";
+                    std::size_t index = (summ.GetSigmoids().at(g)) - 1;
+
+                    // for all sigmoids found for one variable
+					for (size_t v = 0; v < groupOfSigmoids.size(); v++) {
+                        if(index == groupOfSigmoids.at(v)) {
+                            if(dbg) std::cerr << "TERAZ TREBA NAHRADIT SIGMOID " << v << " RAMPAMI\n";
+                            std::vector<Summember<T> > newSummembers = summ.sigmoidAbstraction(new_sigmoids_ramps.at(v), index+1);
+                            if(dbg) std::cerr << "pocet new summs:" << newSummembers.size() << "\n";
+
+                            if(dbg) std::cerr << "pocty summs:" << equations.at(j).second.size() << ",";
+                            typename std::vector<Summember<T> >::iterator newSit;
+                            newSit = equations.at(j).second.erase(sit);
+                            if(dbg) std::cerr << equations.at(j).second.size() << ",";
+
+                            typename std::vector<Summember<T> >::iterator replacingSit;
+                            for(replacingSit = newSummembers.begin(); replacingSit != newSummembers.end(); replacingSit++) {
+                                sit = equations.at(j).second.insert(newSit, *replacingSit);
+                                newSit = sit;
+                            }
+                            
+                            if(dbg) std::cerr << equations.at(j).second.size() << "\n";
+                            summ = *sit;
+                            g = -1;
+                            summsCounter = 0;
+                            if(dbg) std::cerr << "USPESNE NAHRADENE\n";
+
+                            break;
+                        }
+                    }
+                }
+                
+                // for all hill functions in one summember
+                for(size_t g = 0; g < summ.GetHills().size(); g++) {
+                    if(dbg) std::cerr << "in hill function " << g << "\n";
+                    std::size_t index = (summ.GetHills().at(g)) - 1;
+
+                    // for all hill functions found for one variable
+                    for(size_t v = 0; v < groupOfHills.size(); v++) {
+                        if(index == groupOfHills.at(v)) {
+                            if(dbg) std::cerr << "TERAZ TREBA NAHRADIT HILLOVU FUNKCIU " << v << " RAMPAMI\n";
+                            std::vector<Summember<T> > newSummembers = summ.hillAbstraction(new_hills_ramps.at(v), index+1);
+                            if(dbg) std::cerr << "pocet new summs:" << newSummembers.size() << "\n";
+
+                            if(dbg) std::cerr << "pocty summs:" << equations.at(j).second.size() << ",";
+                            typename std::vector<Summember<T> >::iterator newSit;
+                            newSit = equations.at(j).second.erase(sit);
+                            if(dbg) std::cerr << equations.at(j).second.size() << ",";
+
+                            typename std::vector<Summember<T> >::iterator replacingSit;
+                            for(replacingSit = newSummembers.begin(); replacingSit != newSummembers.end(); replacingSit++) {
+                                sit = equations.at(j).second.insert(newSit, *replacingSit);
+                                newSit = sit;
+                            }
+                            
+                            if(dbg) std::cerr << equations.at(j).second.size() << "\n";
+                            summ = *sit;
+                            g = -1;
+                            summsCounter = 0;
+                            if(dbg) std::cerr << "USPESNE NAHRADENE\n";
+
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void Model<T>::computeAllThresholds(std::vector<abstraction_job> &jobs, bool fast, std::size_t threads) {
+
+    std::vector<std::size_t> todo;
+    for(size_t i = 0; i < jobs.size(); i++) {
+        if(!jobs.at(i).sigmoids.empty() || !jobs.at(i).hills.empty())
+            todo.push_back(i);
+    }
+
+    if(threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if(threads > todo.size())
+        threads = todo.size();
+    if(threads == 0)
+        threads = 1;
+
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        for(std::size_t n = next++; n < todo.size(); n = next++)
+            computeJobThresholds(jobs.at(todo.at(n)), fast);
+    };
+
+    std::vector<std::thread> pool;
+    for(size_t t = 1; t < threads; t++)
+        pool.push_back(std::thread(worker));
+    worker();
+    for(size_t t = 0; t < pool.size(); t++)
+        pool.at(t).join();
+}
+
+template <typename T>
+void Model<T>::computeJobThresholds(abstraction_job &job, bool fast) {
+
+    std::ostringstream log;
+    std::string key = abstractionKey(job, fast);
+
+    if(loadThresholds(key, job.thresholds)) {
+        log << "\tthresholds loaded from " << abstractionCacheFile(key) << std::endl;
+    } else {
+        job.thresholds = computeThresholds(job.sigmoids, job.hills, job.numOfSegments, job.numOfXPoints, fast, log);
+        storeThresholds(key, job.thresholds);
+    }
+
+    job.log += log.str();
+}
+
+// The key describes everything the thresholds are computed from. It is
+// stored in the cache file as well, so that a hash collision is detected.
+template <typename T>
+std::string Model<T>::abstractionKey(const abstraction_job &job, bool fast) const {
+
+    std::ostringstream key;
+    key << std::setprecision(17);
+    key << (fast ? "fast" : "slow") << " " << job.numOfSegments << " " << job.numOfXPoints;
+    for(size_t i = 0; i < job.sigmoids.size(); i++) {
+        const sigmoid &s = sigmoids.at(job.sigmoids.at(i));
+        key << " S(" << s.n << "," << s.k << "," << s.theta << "," << s.a << "," << s.b << ")";
+    }
+    for(size_t i = 0; i < job.hills.size(); i++) {
+        const hill &h = hills.at(job.hills.at(i));
+        key << " H(" << h.theta << "," << h.n << "," << h.a << "," << h.b << ")";
+    }
+    return key.str();
+}
+
+template <typename T>
+std::string Model<T>::abstractionCacheFile(const std::string &key) {
+
+    std::string dir;
+    const char *env = getenv("DIVINE_ABSTRACTION_CACHE");
+    if(env != NULL) {
+        dir = env;
+    } else {
+        const char *home = getenv("HOME");
+        if(home == NULL || *home == '\0')
+            return "";
+        dir = std::string(home) + "/.cache/divine/abstraction";
+    }
+    if(dir.empty())
+        return "";
+
+    // FNV-1a
+    unsigned long long hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < key.size(); i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ULL;
+    }
+
+    std::ostringstream file;
+    file << dir << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".thr";
+    return file.str();
+}
+
+template <typename T>
+bool Model<T>::loadThresholds(const std::string &key, std::vector<double> &thresholds) {
+
+    std::string fileName = abstractionCacheFile(key);
+    if(fileName.empty())
+        return false;
+
+    std::ifstream in(fileName.c_str());
+    std::string storedKey;
+    if(!in.is_open() || !std::getline(in, storedKey) || storedKey != key)
+        return false;
+
+    std::size_t count;
+    if(!(in >> count))
+        return false;
+    std::vector<double> result(count);
+    for(size_t i = 0; i < count; i++) {
+        if(!(in >> result.at(i)))
+            return false;
+    }
+
+    thresholds.swap(result);
+    return true;
+}
+
+// The file is written under a temporary name and renamed, so that tools
+// running concurrently on the same model never read a partial file.
+template <typename T>
+void Model<T>::storeThresholds(const std::string &key, const std::vector<double> &thresholds) {
+
+    std::string fileName = abstractionCacheFile(key);
+    if(fileName.empty())
+        return;
+
+    // mkdir -p
+    for(size_t pos = fileName.find('/', 1); pos != std::string::npos; pos = fileName.find('/', pos + 1))
+        mkdir(fileName.substr(0, pos).c_str(), 0755);
+
+    std::ostringstream tmpName;
+    tmpName << fileName << "." << getpid() << "." << std::this_thread::get_id();
+
+    std::ofstream out(tmpName.str().c_str(), std::ofstream::out | std::ofstream::trunc);
+    if(!out.is_open())
+        return;
+    out << key << "\n" << thresholds.size() << "\n" << std::setprecision(17);
+    for(size_t i = 0; i < thresholds.size(); i++)
+        out << thresholds.at(i) << "\n";
+    out.close();
+
+    if(!out || std::rename(tmpName.str().c_str(), fileName.c_str()) != 0)
+        std::remove(tmpName.str().c_str());
+}
+
+template <typename T>
+const char Model<T>::COMPILED_MAGIC[8] = { 'D', 'V', 'C', 'B', 'I', 'O', 0, 0 };
+
+template <typename T>
+bool Model<T>::IsCompiled(const std::string &fileName) {
+
+    char magic[sizeof(COMPILED_MAGIC)];
+    std::ifstream in(fileName.c_str(), std::ifstream::in | std::ifstream::binary);
+    return in.read(magic, sizeof(magic)) && memcmp(magic, COMPILED_MAGIC, sizeof(magic)) == 0;
+}
+
+// Like the cache of thresholds, the file is written under a temporary name
+// and renamed.
+template <typename T>
+bool Model<T>::WriteCompiled(const std::string &fileName) const {
+
+    std::string tmpName = fileName + ".tmp";
+    std::ofstream file(tmpName.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if(!file.is_open())
+        return false;
+
+    WriteCompiled(file);
+
+    file.close();
+    if(!file || std::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+        std::remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool Model<T>::WriteCompiled(std::ostream &file) const {
+
+    compiled_writer out(file);
+    writeCompiledData(out);
+    return bool(file);
+}
+
+template <typename T>
+void Model<T>::writeCompiledData(compiled_writer &out) const {
+
+    out.out.write(COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+    out.put((unsigned int)COMPILED_VERSION);
+    out.put((unsigned int)sizeof(value_type));
+    out.put((unsigned int)sizeof(std::size_t));
+    out.put((unsigned int)0x01020304);  // byte order
+
+    out.put(var_names);
+    out.put(param_names);
+    out.put(param_ranges);
+    out.put(constants);
+    out.put(thresholds);
+    out.put(var_points);
+    out.put(var_points_values);
+    out.put(inits);
+    out.put(inits_values);
+    out.put(ba_lines);
+    out.put(property);
+
+    out.put(sigmoids.size());
+    for(size_t i = 0; i < sigmoids.size(); i++) {
+        const sigmoid &s = sigmoids.at(i);
+        out.put(s.dim); out.put(s.k); out.put(s.theta); out.put(s.a); out.put(s.b);
+        out.put(s.n); out.put(s.positive); out.put(s.isInverse);
+    }
+    out.put(hills.size());
+    for(size_t i = 0; i < hills.size(); i++) {
+        const hill &h = hills.at(i);
+        out.put(h.dim); out.put(h.theta); out.put(h.n); out.put(h.a); out.put(h.b); out.put(h.positive);
+    }
+
+    out.put(equations.size());
+    for(size_t i = 0; i < equations.size(); i++) {
+        out.put(equations.at(i).first);
+        out.put(equations.at(i).second.size());
+        for(size_t j = 0; j < equations.at(i).second.size(); j++)
+            equations.at(i).second.at(j).Write(out);
+    }
+}
+
+template <typename T>
+bool Model<T>::ReadCompiled(const std::string &fileName) {
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        std::cerr << "ERROR: Cannot open compiled model " << fileName << "\n";
+        return false;
+    }
+    struct stat info;
+    void *data = MAP_FAILED;
+    if(fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        std::cerr << "ERROR: Cannot map compiled model " << fileName << "\n";
+        return false;
+    }
+
+    compiled_reader in(static_cast<const char *>(data), static_cast<const char *>(data) + info.st_size);
+    Model<T> loaded;
+    bool ok = loaded.readCompiledData(in) && in.pos == in.end;
+    munmap(data, info.st_size);
+
+    if(!ok) {
+        std::cerr << "ERROR: " << fileName << " is not a compiled model of this version "
+                  << COMPILED_VERSION << ", recompile it\n";
+        return false;
+    }
+    *this = loaded;
+    return true;
+}
+
+template <typename T>
+bool Model<T>::readCompiledData(compiled_reader &in) {
+
+    char magic[sizeof(COMPILED_MAGIC)];
+    unsigned int version, valueSize, sizeSize, byteOrder;
+    for(size_t i = 0; i < sizeof(magic); i++)
+        if(!in.get(magic[i]))
+            return false;
+    if(memcmp(magic, COMPILED_MAGIC, sizeof(magic)) != 0 ||
+       !in.get(version) || version != COMPILED_VERSION ||
+       !in.get(valueSize) || valueSize != sizeof(value_type) ||
+       !in.get(sizeSize) || sizeSize != sizeof(std::size_t) ||
+       !in.get(byteOrder) || byteOrder != 0x01020304)
+        return false;
+
+    if(!in.get(var_names) || !in.get(param_names) || !in.get(param_ranges) ||
+       !in.get(constants) || !in.get(thresholds) || !in.get(var_points) ||
+       !in.get(var_points_values) || !in.get(inits) || !in.get(inits_values) ||
+       !in.get(ba_lines) || !in.get(property))
+        return false;
+
+    size_t n;
+    if(!in.getCount(n))
+        return false;
+    sigmoids.resize(n);
+    for(size_t i = 0; i < n; i++) {
+        sigmoid &s = sigmoids.at(i);
+        if(!in.get(s.dim) || !in.get(s.k) || !in.get(s.theta) || !in.get(s.a) || !in.get(s.b) ||
+           !in.get(s.n) || !in.get(s.positive) || !in.get(s.isInverse))
+            return false;
+    }
+    if(!in.getCount(n))
+        return false;
+    hills.resize(n);
+    for(size_t i = 0; i < n; i++) {
+        hill &h = hills.at(i);
+        if(!in.get(h.dim) || !in.get(h.theta) || !in.get(h.n) || !in.get(h.a) || !in.get(h.b) || !in.get(h.positive))
+            return false;
+    }
+
+    if(!in.getCount(n))
+        return false;
+    equations.resize(n);
+    for(size_t i = 0; i < n; i++) {
+        size_t sums;
+        if(!in.get(equations.at(i).first) || !in.getCount(sums))
+            return false;
+        equations.at(i).second.resize(sums);
+        for(size_t j = 0; j < sums; j++)
+            if(!equations.at(i).second.at(j).Read(in))
+                return false;
+    }
+    return true;
+}
+
+// The models are compared in the compiled form, which holds everything
+// the tools use.
+template <typename T>
+bool Model<T>::SameModel(const Model<T> &other) const {
+
+    Model<T> first(*this), second(other);
+    first.property.clear();
+    second.property.clear();
+
+    std::ostringstream firstData, secondData;
+    compiled_writer firstOut(firstData), secondOut(secondData);
+    first.writeCompiledData(firstOut);
+    second.writeCompiledData(secondOut);
+    return firstData.str() == secondData.str();
+}
+
+template <typename T>
+std::vector<std::vector<typename Summember<T>::ramp> > Model<T>::generateNewRamps(std::vector<double> x, std::vector< std::vector<double> > y, std::size_t dim) {
+    std::vector<std::vector<typename Summember<T>::ramp> > result;
+
+    for(size_t i = 0; i < y.size(); i++) {
+
+        std::vector<typename Summember<T>::ramp> ramps;
+
+        for(size_t t = 0; t < x.size() - 1; t++) {
+            double x1 = x.at(t);
+            double x2 = x.at(t+1);
+            double y1 = y.at(i).at(t);
+            double y2 = y.at(i).at(t+1);
+
+            if(y1 <= y2)
+                ramps.push_back(typename Summember<T>::ramp::ramp(dim, x1, x2, y1, y2));
+            else
+                ramps.push_back(typename Summember<T>::ramp::ramp(dim, x1, x2, y1, y2, true));
+        }
+
+        result.push_back(ramps);
+    }
+
+    return result;
+}
+
+template <typename T>
+std::vector<double> Model<T>::computeThresholds(std::vector<std::size_t> s, std::vector<std::size_t> hfs, int numOfSegments, int numOfX, bool fast, std::ostream &log) {
+
+	bool dbg = false;
+
+    for(size_t i = 0; i < s.size(); i++) {
+        if(numOfSegments < sigmoids.at(s.at(i)).n) {
+            numOfSegments = sigmoids.at(s.at(i)).n;
+        }
+    }
+
+    log << "\tnumber of searching segments = " << numOfSegments << std::endl;
+
+    std::vector<double> xPoints;
+    std::vector<std::vector<double> > curves = generateSpace(s,hfs,xPoints,numOfX);
+    std::vector<double> segmentsPoints;
+
+    log << "\tnumber of evaluating points = " << xPoints.size() << std::endl;
+    if(dbg) log << "\tnumber of curves = " << curves.size() << std::endl;
+    
+    for(size_t i = 0; i < curves.size(); i++) {
+    	if(dbg) log << "curve " << i << " size: " << curves.at(i).size() << std::endl;
+    }
+
+    clock_t start, finish; 
+    double durationInSec;  
+
+
+	if(fast) {
+	
+		start = clock();   
+		if(dbg) log << "before fast approximation...\n";
+		segmentsPoints = optimalFastGlobalLinearApproximation2 (xPoints, curves, numOfSegments, log);
+		if(dbg) log << "after fast approximation...\n";
+
+		finish = clock();  
+		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;      
+		if(dbg) log << "duration = " << durationInSec << " sec. Found = ";
+		for(size_t i = 0; i < segmentsPoints.size(); i++)
+		    if(dbg) log << segmentsPoints.at(i) << ",";
+		if(dbg) log << std::endl;
+		
+	} else {
+
+		start = clock();
+
+		if(dbg) log << "before slow approximation...\n";
+		segmentsPoints = optimalGlobalLinearApproximation (xPoints, curves, numOfSegments, log);
+		if(dbg) log << "after slow approximation...\n";
+
+		finish = clock();  
+		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;
+		if(dbg) log << "duration = " << durationInSec << " sec. Found = "; 
+		for(size_t i = 0; i < segmentsPoints.size(); i++)          
+		    if(dbg) log << segmentsPoints.at(i) << ",";   
+		if(dbg) log << std::endl;                         
+		
+	}
+
+    return segmentsPoints;
+}
+
+
+template <typename T>
+std::vector <double>  Model<T>::generateXPoints (double ai, double bi, int num_segments)
+{
+	   double a = ai;
+	   double b = bi;
+
+	   std::vector <double > x;
+
+	   double dx = (b-a)/(num_segments-1);
+
+	   for (int i = 0; i < num_segments; i++)
+	   {
+		   double cx = a + dx*i;
+		   x.push_back(cx);
+	   }
+
+	   return x;
+}
+
+
+template <typename T>
+std::vector<std::vector<double> > Model<T>::generateSpace(std::vector<std::size_t> s, std::vector<std::size_t> hfs, std::vector<double> &x, int numOfX) {
+
+    std::vector<std::vector<double> > y;
+
+    if(s.size() > 0 || hfs.size() > 0) {
+
+        double intervalDeviationParam = 1.5;
+
+        double min = 0.0;
+        double max = 0.0;
+        if(s.size() > 0) {
+        	min =  sigmoids.at(s.at(0)).theta - (2.0 / sigmoids.at(s.at(0)).k) * intervalDeviationParam;
+        	max = sigmoids.at(s.at(0)).theta + (2.0 / sigmoids.at(s.at(0)).k) * intervalDeviationParam;
+        	
+		    if(s.size() > 1) {
+
+		        for(size_t i = 1; i < s.size(); i++) {
+
+		            double tempMin = sigmoids.at(s.at(i)).theta - (2.0 / sigmoids.at(s.at(i)).k) * intervalDeviationParam;
+		            double tempMax = sigmoids.at(s.at(i)).theta + (2.0 / sigmoids.at(s.at(i)).k) * intervalDeviationParam;
+
+		            if(tempMin < min) {
+		                min = tempMin;
+		            }
+		            if(tempMax > max) {
+		                max = tempMax;
+		            }
+		        }
+		    }
+        }
+        
+        if(hfs.size() > 0) {
+        
+        	min = 0.0;
+        	for (size_t i = 0; i < hfs.size(); i++) {
+        	
+        		value_type tempMax = 2.0*hills.at(hfs.at(i)).theta + (5.0/hills.at(hfs.at(i)).n)*hills.at(hfs.at(i)).theta;
+        		if(max < tempMax)
+        			max = tempMax;
+        	}
+        }
+
+        if(min < 0.0)
+            min = 0.0;
+
+        if(numOfX != 0) {
+            x = generateXPoints(min, max, numOfX);
+        } else {
+            x = generateXPoints(min, max, (max - min)*100);
+        }
+
+        for(size_t i = 0; i < s.size(); i++) {
+            y.push_back(sigmoids.at(s.at(i)).enumerateYPoints(x));
+        }
+        
+        for(size_t i = 0; i < hfs.size(); i++) {
+        	y.push_back(hills.at(hfs.at(i)).enumerateYPoints(x));
+        }
+    }
+
+    return y;
+}
+
+
+template <typename T>
+std::vector <double> Model<T>::segmentErr (std::vector <double> x, std::vector <double> y)
+{
+       // Find out size of x
+       int nx = x.size();
+       int ny = y.size();
+
+       std::vector<double> result (3, 0.0);
+
+       if (nx != ny) {
+           std::cerr << "ERROR: number of x-points is not consistent with number of y-points\n";
+           return result;
+       }
+
+       // Compute line segment coefficients
+       double a = (y[nx-1] - y[0]) / (x[nx-1] - x[0]);
+       double b = (y[0] * x[nx-1] - y[nx-1] * x[0]) / (x[nx-1] - x[0]);
+
+       // Compute error for above line segment
+       double e = 0;
+
+	   for (int k = 0; k < nx; k++) {
+		    e += pow((y[k] - a * x[k] - b),2);
+	   }
+	   e /= (pow(a,2) + 1);
+
+       result[0] = e;
+       result[1] = a;
+       result[2] = b;
+
+       return result;
+}
+
+
+template <typename T>
+std::vector<double> Model<T>::optimalGlobalLinearApproximation(std::vector<double> x, std::vector<std::vector<double> > y,
+                                                               int n_segments, std::ostream &log) {
+	bool dbg = true;
+
+	int n_points = x.size();
+	int n_curves = y.size();
+
+	std::vector<std::vector<double> > mCost(n_points, std::vector<double>(n_segments, INFINITY));
+	std::vector<std::vector<double> > hCst(n_points, std::vector<double>(n_points, INFINITY));
+
+    mCost[1][0] = 0.0;
+
+    std::vector<std::vector<int> > father(n_points, std::vector<int>(n_segments, 0));
+
+
+
+    for (int n = 1; n < n_points; n++) {
+       
+    	double temp = -1 * INFINITY;
+        for (int ic = 0; ic < n_curves; ic++) {
+            
+        	std::vector<double> v1 (x.begin(), x.begin() + n+1);
+            std::vector<double> v2 (y[ic].begin(), y[ic].begin() + n+1);
+            std::vector<double> seg_err = segmentErr(v1, v2);
+
+            temp = std::max(seg_err[0], temp);
+        }
+
+            mCost[n][0] = temp;
+            father[n][0] = 0;
+            //std::cerr << " n=" << n << " mCost[" << n << "][0]=" << temp << " father[" << n << "][0]=" << father[n][0] << "\n";
+    }
+
+    double minErr, currErr;
+    int minIndex;
+
+	log << "\tcomputing segment ";
+    for (int m = 1; m < n_segments; m++) {
+    
+        log << m << "... ";
+            
+        for (int n = 2; n < n_points; n++) {
+
+            minErr = mCost[n-1][m-1];
+            minIndex = n - 1;
+
+            for (int i = m; i <= n-2; i++) {
+                
+                if (hCst[i][n]==INFINITY) {
+                    double temp = -1 * INFINITY;
+
+                    for (int ic = 0; ic < n_curves; ic++) {
+                         std::vector<double> v1 (x.begin() + i, x.begin() + n+1);
+                         std::vector<double> v2 (y[ic].begin() + i, y[ic].begin() + n+1);
+                         std::vector<double> seg_err = segmentErr(v1, v2);
+
+                         temp = std::max(seg_err[0], temp);
+                    }
+
+                    hCst[i][n] = temp;
+                }
+
+                currErr = mCost[i][m-1] + hCst[i][n];
+
+                if (currErr < minErr) {
+                    minErr = currErr;
+                    minIndex = i;
+                }
+            }
+            mCost[n][m]  = minErr;
+            father[n][m] = minIndex;
+//            std::cerr << " n=" << n << " mCost[" << n << "][" << m << "]=" << mCost[n][m] << " father[" << n << "][" << m << "]=" << father[n][m] << "\n";
+        }
+    }
+    log << "\n";
+
+    std::vector<int> ib (n_segments+1, 0);
+    std::vector<double> xb (n_segments+1, 0.0);
+
+    ib[n_segments] = n_points-1;
+    xb[n_segments] = x[ib[n_segments]];
+    
+    for (int i = n_segments-1; i >= 0; i--) {
+        ib[i] = father[ib[i+1]][i];
+        xb[i] = x[ib[i]];
+    }
+
+    if(dbg) {
+    	log << "\tSegments thresholds found:\n";
+		for (int i = 0; i < n_segments + 1; i++) {
+		    log << "\t" << xb[i] << "\n";
+		}
+	}
+
+    return xb;
+}
+
+template <typename T>
+std::vector <double> Model<T>::optimalFastGlobalLinearApproximation2 (std::vector<double> x, std::vector<std::vector<double> > y, int n_segments, std::ostream &log) {
+	
+	bool dbg = true;
+	
+	int n_points = x.size();
+	int n_curves = y.size();
+	
+	std::vector<std::vector<double> > mCost (n_points, std::vector<double>(n_segments, INFINITY));
+	std::vector<std::vector<double> > hCst  (n_points, std::vector<double>(n_points, INFINITY));
+	
+	mCost[1][0] = 0.0;
+	
+	std::vector<std::vector<int> > father (n_points, std::vector<int> (n_segments, 0));
+	
+	
+	for (int n=1; n < n_points; n++) {
+		double temp = -1 * INFINITY;
+		
+		//cerr << "temp =" << temp << "\n";
+		
+		for (int ic=0; ic < n_curves; ic++) {
+			std::vector<double> v1 (x.begin(), x.begin() + n+1);
+			std::vector<double> v2 (y[ic].begin(), y[ic].begin() + n+1);    
+			std::vector<double> seg_err = segmentErr(v1, v2);
+			
+			temp = std::max(seg_err[0], temp);
+		} 
+		
+		mCost [n][0] = temp;
+		father[n][0] = 0;
+		//cerr << " n=" << n << " mCost[" << n << "][0]=" << temp << " father[" << n << "][0]=" << father[n][0] << "\n";
+	}
+	
+	
+	std::vector<std::vector<double> > sy2 (n_curves, std::vector<double> (n_points, 0.0));
+	std::vector<std::vector<double> > sy  (n_curves, std::vector<double> (n_points, 0.0));
+	std::vector<std::vector<double> > sxy (n_curves, std::vector<double> (n_points, 0.0));
+	
+	std::vector<double> sx2 (n_points, 0);
+	std::vector<double> sx (n_points, 0);
+	
+	for (int ic=0; ic < n_curves; ic++) {
+		sy2[ic][0] = y[ic][0] * y[ic][0];
+		sy [ic][0] = y[ic][0];
+		sxy[ic][0] = y[ic][0] * x[0];
+		
+		for (int ip=1; ip < n_points; ip++) {
+			sy2[ic][ip] = sy2[ic][ip-1] + (y[ic][ip] * y[ic][ip]);
+			sy [ic][ip] = sy [ic][ip-1] + (y[ic][ip]);
+			sxy[ic][ip] = sxy[ic][ip-1] + (y[ic][ip] * x[ip]);
+		}
+	}
+	
+	sx2[0] = x[0] * x[0];
+	sx[0] = x[0];
+	
+	for (int ip=1; ip < n_points; ip++) {
+	    sx2[ip] = sx2[ip-1] + (x[ip] * x[ip]);
+	    sx [ip] = sx [ip-1]  + x[ip];
+	}
+    
+	double minErr, currErr;
+	int minIndex;
+
+	log << "\tcomputing segment ";    
+	
+	for (int m = 1; m < n_segments; m++) {
+	
+        log << m << "... ";
+        
+		for (int n = 2; n < n_points; n++) {
+			
+			minErr = mCost[n-1][m-1];
+			minIndex = n - 1;
+			
+			for (int i = m; i <= n-2; i++) {
+				if (hCst[i][n] == INFINITY) {
+				
+					double temp = -1 * INFINITY;
+					
+					for (int ic = 0; ic < n_curves; ic++)	{
+						
+						double a = (y[ic][n] - y[ic][0]) / (x[n] - x[0]);
+						double b = (y[ic][0] * x[n] - y[ic][n] * x[0]) / (x[n] - x[0]);
+						double seg_err = (sy2[ic][n] - sy2[ic][i-1]) - 2 * a * (sxy[ic][n] - sxy[ic][i-1]) - 2 * b * (sy[ic][n] - sy[ic][i-1]) + a * a * (sx2[n] - sx2[i-1]) + 2 * a * b * (sx[n] - sx[i-1]) + b * (n - i);
+						
+						temp = std::max(seg_err, temp);
+					}
+					
+					hCst[i][n] = temp;
+				}
+				
+				currErr = mCost[i][m-1] + hCst[i][n];
+				
+				if (currErr < minErr) {
+					minErr = currErr;
+					minIndex = i;
+				}
+			} 
+			mCost[n][m]  = minErr;
+			father[n][m] = minIndex;
+//			std::cerr << " n=" << n << " mCost[" << n << "][" << m << "]=" << mCost[n][m] << " father[" << n << "][" << m << "]=" << father[n][m] << "\n";
+        }
+    }         
+    log << "\n";
+	
+    std::vector<int> ib (n_segments+1, 0  );
+    std::vector<double> xb (n_segments+1, 0.0);	
+	
+    ib[n_segments] = n_points-1;
+    xb[n_segments] = x[ib[n_segments]];
+    if(dbg) log << "x[ib[n_segments]]=" << x[ib[n_segments]] << "\n";
+    
+    for (int i=n_segments-1; i >= 0; i--) {
+		ib[i] = father[ib[i+1]][i];
+		xb[i] = x[ib[i]];
+		// std::cerr << "x" << n_points - i << "=" << xb[i] << "\n";
+    }         
+
+    if(dbg) {
+    	log << "\tSegments thresholds found:\n";
+		for (int i = 0; i < n_segments + 1; i++) {
+		    log << "\t" << xb[i] << "\n";
+		}
+	}
+	
+    return xb;
+}
+
+
@@ -198,6 +198,14 @@ public:
 
 	const Summember<T>  operator*(/*const*/ Summember<T> &);
 
+	// Binary form used by compiled models (see Model<T>::WriteCompiled()),
+	// the writer has put(value), the reader has bool get(value) and
+	// bool getCount(number of elements)
+	template <class Writer>
+	void Write(Writer & out) const;
+	template <class Reader>
+	bool Read(Reader & in);
+
     template <class U>
 	friend std::ostream& operator<<(std::ostream& out, const Summember<U>& sum);
 
@@ -366,3 +374,91 @@ const Summember<T> Summember<T>::operator*(/*const*/ Summember<T> & s2)
 	return s_final;
 
 }
+
+template <typename T>
+template <class Writer>
+void Summember<T>::Write(Writer & out) const
+{
+	out.put(constant);
+	out.put(param);
+	out.put(vars.size());
+	for (size_t i = 0; i < vars.size(); i++)
+		out.put(vars.at(i));
+	out.put(ramps.size());
+	for (size_t i = 0; i < ramps.size(); i++) {
+		const ramp & r = ramps.at(i);
+		out.put(r.dim);
+		out.put(r.min);
+		out.put(r.max);
+		out.put(r.min_value);
+		out.put(r.max_value);
+		out.put(r.negative);
+	}
+	out.put(sigmoids.size());
+	for (size_t i = 0; i < sigmoids.size(); i++)
+		out.put(sigmoids.at(i));
+	out.put(steps.size());
+	for (size_t i = 0; i < steps.size(); i++) {
+		const step & st = steps.at(i);
+		out.put(st.dim);
+		out.put(st.theta);
+		out.put(st.a);
+		out.put(st.b);
+		out.put(st.positive);
+	}
+	out.put(hills.size());
+	for (size_t i = 0; i < hills.size(); i++)
+		out.put(hills.at(i));
+}
+
+template <typename T>
+template <class Reader>
+bool Summember<T>::Read(Reader & in)
+{
+	std::size_t n;
+	if (!in.get(constant) || !in.get(param))
+		return false;
+
+	if (!in.getCount(n))
+		return false;
+	vars.resize(n);
+	for (size_t i = 0; i < n; i++)
+		if (!in.get(vars.at(i)))
+			return false;
+
+	if (!in.getCount(n))
+		return false;
+	ramps.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		ramp & r = ramps.at(i);
+		if (!in.get(r.dim) || !in.get(r.min) || !in.get(r.max) ||
+		    !in.get(r.min_value) || !in.get(r.max_value) || !in.get(r.negative))
+			return false;
+	}
+
+	if (!in.getCount(n))
+		return false;
+	sigmoids.resize(n);
+	for (size_t i = 0; i < n; i++)
+		if (!in.get(sigmoids.at(i)))
+			return false;
+
+	if (!in.getCount(n))
+		return false;
+	steps.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		step & st = steps.at(i);
+		if (!in.get(st.dim) || !in.get(st.theta) || !in.get(st.a) ||
+		    !in.get(st.b) || !in.get(st.positive))
+			return false;
+	}
+
+	if (!in.getCount(n))
+		return false;
+	hills.resize(n);
+	for (size_t i = 0; i < n; i++)
+		if (!in.get(hills.at(i)))
+			return false;
+
+	return true;
+}
@@ -0,0 +1,234 @@
+#!/bin/sh
+#
+# Benchmark harness of the verification and estimation tools (used by
+# `make bench` and `make bench-baseline`). Runs owcty, distr_map and
+# owcty_reversed at several MPI rank counts (and owcty at several thread
+# counts), pepmc at several -j values, storage_bench and generator (when they
+# are built) over a fixed corpus taken from examples/. For every run one line
+# of tab separated values is written to the results file:
+#
+#   tool model config status time init states trans states/s trans/s rss bytes
+#
+# time is the wall time of the run [s], init the time spent before the search
+# (parsing and abstraction of the model) [s], states/s and trans/s are counted
+# from the search time (time - init), rss is the peak resident set size summed
+# over all ranks [MB] and bytes the number of bytes sent over the network.
+# Values the tool does not report are "-".
+#
+# With -b the results are compared with a stored baseline (written by an
+# earlier run with -o). A run that is slower (or needs more memory) than in
+# the baseline by more than BENCH_TOLERANCE is reported as a regression and
+# the script exits with 1. Differing numbers of states are only warned about.
+#
+# usage: bench.sh [-f] [-B bindir] [-E examples] [-o results] [-b baseline]
+#  -f           full corpus (adds enzyme_15complex, enzyme_20complex and tcbb1,
+#               which take much longer)
+#  -B bindir    directory with the divine.* binaries (default ../../bin)
+#  -E examples  directory with the example models (default ../../examples)
+#  -o results   file to write the results to (default bench.tsv)
+#  -b baseline  compare the results with this file
+#
+# environment:
+#  MPIRUN           how to start an MPI run (default "mpirun"), the number of
+#                   ranks is appended as "-np N"
+#  BENCH_NP         MPI rank counts (default "1 2"; 1 runs without MPIRUN)
+#  BENCH_THREADS    thread counts of owcty -T (default "2", empty = none)
+#  BENCH_J          thread counts of pepmc -j (default "1 2")
+#  BENCH_TIMEOUT    time limit of one run in seconds (default 600)
+#  BENCH_TOLERANCE  allowed relative slowdown (default 0.25)
+#  BENCH_SLACK      differences below this many seconds are noise (default 0.2)
+
+DIR=`dirname $0`
+BIN=$DIR/../../bin
+EXAMPLES=$DIR/../../examples
+RESULTS=bench.tsv
+BASELINE=
+FULL=no
+
+while getopts "fB:E:o:b:" c; do
+    case $c in
+	f) FULL=yes;;
+	B) BIN=$OPTARG;;
+	E) EXAMPLES=$OPTARG;;
+	o) RESULTS=$OPTARG;;
+	b) BASELINE=$OPTARG;;
+	*) sed -n 's/^# usage: /usage: /p' $0 >&2; exit 1;;
+    esac
+done
+
+MPIRUN=${MPIRUN:-mpirun}
+BENCH_NP=${BENCH_NP:-1 2}
+BENCH_THREADS=${BENCH_THREADS-2}
+BENCH_J=${BENCH_J:-1 2}
+BENCH_TIMEOUT=${BENCH_TIMEOUT:-600}
+BENCH_TOLERANCE=${BENCH_TOLERANCE:-0.25}
+BENCH_SLACK=${BENCH_SLACK:-0.2}
+
+#the abstraction would be read from the cache otherwise and init would not
+#measure it
+DIVINE_ABSTRACTION_CACHE=
+export DIVINE_ABSTRACTION_CACHE
+
+if [ ! -x $BIN/divine.owcty ]; then
+    echo "$BIN/divine.owcty not found" >&2
+    exit 1
+fi
+
+ENZYME="enzyme_1complex enzyme_2complexes enzyme_5complex enzyme_10complex"
+TCBB=
+if [ $FULL = yes ]; then
+    ENZYME="$ENZYME enzyme_15complex enzyme_20complex"
+    TCBB=$EXAMPLES/tcbb2010/tcbb1.bio.prop1.bio
+fi
+MODELS=
+for m in $ENZYME; do
+    MODELS="$MODELS $EXAMPLES/$m.bio"
+done
+MODELS="$MODELS `ls $EXAMPLES/cardiac_cell/CardiacCell.bio.prop*.bio` $TCBB"
+PEPMC_MODELS=`ls $EXAMPLES/cardiac_cell/CardiacCell.bio.prop*.bio`
+
+if type timeout > /dev/null 2>&1; then
+    LIMIT="timeout $BENCH_TIMEOUT"
+else
+    LIMIT=
+fi
+
+WORK=`mktemp -d`
+trap 'rm -rf $WORK' EXIT
+
+now() { date +%s.%N; }
+
+#value of a key in the report file ($1 = key, $2 = sum|max)
+report_value()
+{
+    v=`sed -n "s/^$1:$2://p" $WORK/run.report`
+    echo ${v:--}
+}
+
+#status of the last run ($1 = exit code)
+status()
+{
+    case $1 in
+	0) echo ok;;
+	124) echo timeout;;
+	*) echo fail$1;;
+    esac
+}
+
+#prints one line of results; $1..$4 = tool model config status, $5..$8 =
+#time init states trans, $9 = rss, $10 = bytes
+result()
+{
+    echo "$5 $6 $7 $8" | awk -v OFS='\t' -v h="$1	$2	$3	$4" -v r="$9" -v b="${10}" '
+	{ t = $1 - ($2 == "-" ? 0 : $2)
+	  s = ($3 != "-" && t > 0) ? sprintf("%.0f", $3 / t) : "-"
+	  e = ($4 != "-" && t > 0) ? sprintf("%.0f", $4 / t) : "-"
+	  print h, $1, $2, $3, $4, s, e, r, b }' | tee -a $RESULTS
+}
+
+#runs a tool producing a report ($1 = tool, $2 = ranks, $3 = options,
+#$4 = model, $5 = config)
+run_report()
+{
+    rm -f $WORK/run.report
+    if [ $2 -gt 1 ]; then
+	$LIMIT $MPIRUN -np $2 $BIN/divine.$1 -r -X $WORK/run $3 $4 > $WORK/out 2>&1
+    else
+	$LIMIT $BIN/divine.$1 -r -X $WORK/run $3 $4 > $WORK/out 2>&1
+    fi
+    st=`status $?`
+    if [ -f $WORK/run.report ]; then
+	result $1 `basename $4` $5 $st `report_value Time max` \
+	    `report_value InitTime max` `report_value States sum` \
+	    `report_value Trans sum` `report_value VMPeakRSS sum` \
+	    `report_value BytesSent sum`
+    else
+	result $1 `basename $4` $5 $st - - - - - -
+    fi
+}
+
+#runs a tool without a report and measures it from outside ($1 = tool,
+#$2 = options, $3 = model); leaves the output in $WORK/out
+run_plain()
+{
+    start=`now`
+    if [ -x /usr/bin/time ]; then
+	$LIMIT /usr/bin/time -f "max memory: %M" -o $WORK/mem $BIN/divine.$1 $2 $3 > $WORK/out 2>&1
+	st=`status $?`
+	rss=`sed -n 's/^max memory: //p' $WORK/mem | awk '{ printf "%.1f", $1 / 1024 }'`
+    else
+	$LIMIT $BIN/divine.$1 $2 $3 > $WORK/out 2>&1
+	st=`status $?`
+    fi
+    end=`now`
+    time=`echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }'`
+}
+
+: > $RESULTS
+printf "tool\tmodel\tconfig\tstatus\ttime\tinit\tstates\ttrans\tstates/s\ttrans/s\trss\tbytes\n" \
+    | tee -a $RESULTS
+for m in $MODELS; do
+    for np in $BENCH_NP; do
+	for t in owcty distr_map owcty_reversed; do
+	    run_report $t $np "" $m np$np
+	done
+    done
+    for th in $BENCH_THREADS; do
+	run_report owcty 1 "-T $th" $m T$th
+    done
+    if [ -x $BIN/divine.storage_bench ]; then
+	rss=-
+	run_plain storage_bench "-r 1" $m
+	states=`sed -n 's/^states:[ 	]*//p' $WORK/out`
+	rate=`awk '$1 == "none" { print $4 }' $WORK/out`
+	echo "$time - ${states:--} - ${rate:--} - $rss -" | awk -v OFS='\t' \
+	    -v h="storage_bench	`basename $m`	none	$st" '{ $1 = $1; print h, $0 }' \
+	    | tee -a $RESULTS
+    fi
+    if [ -x $BIN/divine.generator ]; then
+	rss=-
+	run_plain generator "-q -S" $m
+	states=`awk '$1 == "States" { print $2 }' $WORK/out`
+	trans=`awk '$1 == "Transitions" { print $2 }' $WORK/out`
+	result generator `basename $m` np1 $st $time - ${states:--} ${trans:--} $rss -
+    fi
+done
+
+if [ -x $BIN/divine.pepmc ]; then
+    for m in $PEPMC_MODELS; do
+	for j in $BENCH_J; do
+	    rss=-
+	    run_plain pepmc "-V -j $j" $m
+	    states=`tr '\r' '\n' < $WORK/out | sed -n 's/^reachable vertices: //p' | tail -1`
+	    result pepmc `basename $m` j$j $st $time - ${states:--} - $rss -
+	done
+    done
+fi
+
+echo "results written to $RESULTS"
+
+if [ -z "$BASELINE" ]; then
+    exit 0
+fi
+if [ ! -f "$BASELINE" ]; then
+    echo "baseline $BASELINE not found (make one by make bench-baseline)" >&2
+    exit 1
+fi
+
+awk -F '\t' -v tol=$BENCH_TOLERANCE -v slack=$BENCH_SLACK '
+    NR == FNR { key = $1 " " $2 " " $3; status[key] = $4; time[key] = $5;
+		states[key] = $7; rss[key] = $11; next }
+    { key = $1 " " $2 " " $3 }
+    !(key in status) { next }
+    status[key] == "ok" && $4 != "ok" {
+	print "REGRESSION " key ": " $4; bad++; next }
+    $4 != "ok" || status[key] != "ok" { next }
+    $5 > time[key] * (1 + tol) && $5 - time[key] > slack {
+	printf "REGRESSION %s: time %s s (baseline %s s)\n", key, $5, time[key]; bad++ }
+    rss[key] != "-" && $11 != "-" && $11 > rss[key] * (1 + tol) && $11 - rss[key] > 1 {
+	printf "REGRESSION %s: peak RSS %s MB (baseline %s MB)\n", key, $11, rss[key]; bad++ }
+    states[key] != $7 {
+	printf "warning %s: %s states (baseline %s)\n", key, $7, states[key] }
+    { compared++ }
+    END { printf "%d runs compared with the baseline, %d regressions\n", compared, bad
+	  exit (bad > 0) }' "$BASELINE" $RESULTS
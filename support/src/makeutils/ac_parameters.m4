@@ -80,6 +80,23 @@ AC_ARG_ENABLE(
 AC_SUBST(CUSTOM_CXXFLAGS)
 AC_SUBST(CUSTOM_CPPFLAGS)
 
+################################################################################
+# profile - flag for compiling in the timers and counters of hot paths and
+#           the timeline of phases (see src/common/profile.hh)
+################################################################################
+
+AC_ARG_ENABLE(
+   [profile],
+   AS_HELP_STRING([--enable-profile],
+                  [compile in timers and counters of hot paths; the tools
+                   then write a timeline trace of every run (defaultly
+                   disabled)]),
+   PROFILE_CPPFLAGS=-DDIVINE_PROFILE,
+   PROFILE_CPPFLAGS=
+)
+
+AC_SUBST(PROFILE_CPPFLAGS)
+
 
 ################################################################################
 # gui - flag for disabling compilation of GUI (defaultly enabled)
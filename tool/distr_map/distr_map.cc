@@ -42,20 +42,24 @@ struct appendix_t
 public:
  map_value_t act_map; //actual value of function map && "pointer" to predecessor during counterexample reconstruction ("global_state_ref_t")
   map_value_t old_map; // value of function map from the previous iteration && auxiliary value during counterexample reconstruction
-  list<state_ref_t>::iterator shrinkA_ptr;
+  list<state_ref_t>::iterator shrinkA_ptr; // shrinkA.end() if not in shrinkA
 } appendix;
 
 struct info_shrinkA_t
 { int size_of_all_shrinkA_sets;
   void update(void);
+  void merge(const info_shrinkA_t &other);
 };
 
 struct info_state_space_t {
   long int all_states;
   unsigned long all_succ_calls;
   unsigned long all_edges_relaxed;
+  unsigned long all_trans;
+  unsigned long all_cross;
   long int all_mem;
   void update();
+  void merge(const info_state_space_t &other);
 };
 
 // }}}
@@ -88,6 +92,15 @@ bool fastApproximation = false;
 string set_base_name;
 
 size_int_t htsize=0;
+bool open_hashing = false;
+size_t vertex_cache_size = DEFAULT_VERTEX_CACHE_SIZE;
+string partition_spec;
+string graph_file;
+partitioner_t * p_partitioner = 0;
+size_t succ_cache_mb = 0;
+succ_cache_t succ_cache;
+bool checkpoint = false, resume = false;
+snapshot_t resumed_snapshot; //holds the states restored by load_checkpoint()
 
 size_int_t iter_count = 0;
 unsigned long succs_calls = 0, edges_relaxed = 0, trans = 0, cross_trans = 0;
@@ -115,6 +128,7 @@ vminfo_t vm;
 // {{{ declaration of some functions
 
 void RELAX(state_t state, map_value_t propag, map_value_t subgraph);
+void RELAX_STORED(state_t *state, map_value_t propag, map_value_t subgraph);
 void RELAX_PATH(state_t state, map_value_t propag, size_int_t depth);
 void RELAX_CYCLE(state_t state, map_value_t propag, size_int_t depth);
 void process_ce_cycle_state(map_value_t _ref, size_int_t depth);
@@ -137,7 +151,11 @@ void usage()
   cout <<"Distributed Maximal Accepting Predecessors" << endl;
   version();
   cout <<"--------------------------------------------------------------"<<endl;
-  cout <<"Usage: [mpirun -np N] distr_map [options] file.dve"<<endl;
+  cout <<"Usage: [mpirun -np N] distr_map [options] file.bio|file.cbio [file.bio|file.cbio ...]"<<endl;
+  cout <<"More input files have to hold the same model with different properties"<<endl;
+  cout <<"(e.g. the files made by divine.combine). The model is read once and the"<<endl;
+  cout <<"properties are checked one after another (with -X w, the files of the"<<endl;
+  cout <<"k-th property are named w.propk.*)."<<endl;
   cout <<"Options: "<<endl;
   cout <<" -v, --version \t show distr_map version"<<endl;
   cout <<" -h, --help \t show this help"<<endl;
@@ -146,10 +164,22 @@ void usage()
   cout <<" -f, --fast \t use faster but less accurate algorithm for abstraction" << endl;
   cout <<" -c, --statelist \t show counterexample states"<<endl;
   cout <<" -H x, --htsize x \t set the size of hash table to ( x<33 ? 2^x : x )"<<endl;
+  cout <<" -O, --openhash \t use open addressing hash table (grows on the fly)"<<endl;
+  cout <<" -K x, --vcache x \t set the number of entries of vertex cache (0 = off, default)"<<endl;
+  cout <<" -M x, --succcache x \t cache successors of states in at most x MB (0 = off, default)"<<endl;
+  cout <<" -P p, --partition p \t partition states among workstations by p (affine systems only;"<<endl;
+  cout <<"\t slab[:x] or block[:x,y,...], optionally followed by @n to balance"<<endl;
+  cout <<"\t the parts by the first n states; default = hash)"<<endl;
   cout <<" -V, --verbose \t print some statistics"<<endl;
   cout <<" -q, --quiet \t quiet mode (do not print anything "
        <<"- overrides all except -h and -v)"<<endl;
   cout <<" -L, --log \t perform logging"<<endl;
+  cout <<" -k, --checkpoint \t save a checkpoint after every iteration to w.ckpt.N"<<endl;
+  cout <<" -u, --resume \t resume the computation from the checkpoint w.ckpt.N"<<endl;
+  cout <<"\t (-k and -u do not work with -O)"<<endl;
+  cout <<" -G f, --graph f \t explore the state graph f written by divine.generator -b"<<endl;
+  cout <<"\t instead of computing successors (the input file has to be the model"<<endl;
+  cout <<"\t the graph was generated from)"<<endl;
   cout <<" -X w \t sets base name of produced files to w (w.trail,w.report,w.00-w.N)"<<endl;
 }
 
@@ -169,6 +199,8 @@ void info_state_space_t::update()
       all_states = st.get_states_stored();
       all_succ_calls = succs_calls;
       all_edges_relaxed = edges_relaxed;
+      all_trans = trans;
+      all_cross = cross_trans;
       all_mem = vm.getvmsize();
     }
   else
@@ -176,10 +208,22 @@ void info_state_space_t::update()
       all_states += st.get_states_stored();
       all_succ_calls += succs_calls;
       all_edges_relaxed += edges_relaxed;
+      all_trans += trans;
+      all_cross += cross_trans;
       all_mem += vm.getvmsize();
     }
 }
 
+void info_state_space_t::merge(const info_state_space_t &other)
+{
+  all_states += other.all_states;
+  all_succ_calls += other.all_succ_calls;
+  all_edges_relaxed += other.all_edges_relaxed;
+  all_trans += other.all_trans;
+  all_cross += other.all_cross;
+  all_mem += other.all_mem;
+}
+
 void info_shrinkA_t::update(void)
 { 
   if (nid == 0)
@@ -190,6 +234,10 @@ void info_shrinkA_t::update(void)
   }
 }
 
+void info_shrinkA_t::merge(const info_shrinkA_t &other)
+{ size_of_all_shrinkA_sets += other.size_of_all_shrinkA_sets;
+}
+
 
 void send_cycle_detect(state_ref_t *state_ref)
 { if (debug>1)
@@ -206,18 +254,12 @@ void send_state(int dest, state_t *state, map_value_t *propag,
 		map_value_t *old_map)
 { if (debug>1)
     cerr << nid << " -> " << dest << ": " << TAG_SEND_STATE << endl;
-  message.rewind();
-  message.append_state(*state);
-  message.append_size_int(propag->bfs_order);
-  message.append_size_int(propag->nid);
-  message.append_size_int(propag->id);
-  message.append_size_int(old_map->bfs_order);
-  message.append_size_int(old_map->nid);
-  message.append_size_int(old_map->id);
+  size_int_t maps[6] = { propag->bfs_order, propag->nid, propag->id,
+			 old_map->bfs_order, old_map->nid, old_map->id };
 
-  distributed.network.send_message(message,
-                              dest,
-			      TAG_SEND_STATE);  
+  distributed.network.send_state(*state, (char *)maps, sizeof(maps),
+                                 dest,
+                                 TAG_SEND_STATE);
 }
 
 void send_ce_recovering(int dest, state_t *state, map_value_t *propag, 
@@ -262,17 +304,17 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	if (!acc_cycle_found)
 	  { 
 	    map_value_t propag, old_map;
-            received_message.load_data((byte_t*)(buf),size);
-            received_message.read_state(recv_state);
-            received_message.read_size_int(propag.bfs_order);
-            received_message.read_size_int(propag.nid);
-            received_message.read_size_int(propag.id);
-            received_message.read_size_int(old_map.bfs_order);
-            received_message.read_size_int(old_map.nid);
-            received_message.read_size_int(old_map.id);
+	    size_int_t maps[6];
+	    memcpy(maps, message_t::read_state_in_place((byte_t*)(buf),recv_state),
+		   sizeof(maps));
+	    propag.bfs_order = maps[0];
+	    propag.nid = maps[1];
+	    propag.id = maps[2];
+	    old_map.bfs_order = maps[3];
+	    old_map.nid = maps[4];
+	    old_map.id = maps[5];
 
 	    RELAX(recv_state, propag, old_map);
-	    delete_state(recv_state);
 	    if (!(waiting.empty())) //I will something process, I will be busy
 	      distributed.set_busy();
 	  }
@@ -457,6 +499,21 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 
 // }}}
 
+// {{{ bool is_accepting_ref(state_t *state)
+
+//is the state state_ref accepting? (state is its explicit form or 0)
+bool is_accepting_ref(state_t *state)
+{
+  if (state)
+    return p_sys->is_accepting(*state);
+  state_t stored = st.reconstruct(state_ref);
+  bool result = p_sys->is_accepting(stored);
+  delete_state(stored);
+  return result;
+}
+
+// }}}
+
 // {{{ void RELAX(state_t state, map_value_t propag, map_value_t subgraph)
 
 void RELAX(state_t state, map_value_t propag, map_value_t subgraph)
@@ -477,81 +534,77 @@ void RELAX(state_t state, map_value_t propag, map_value_t subgraph)
 	else 
 	  { 
 	    app.act_map=propag; //due to execution of this line the next iteration 
-	    list<state_ref_t> e;
-            e.push_back(state_ref_t());
-            app.shrinkA_ptr = e.begin(); //is necessary	    
+            app.shrinkA_ptr = shrinkA.end(); //is necessary	    
  	  }
       }
     else 
       {
 	app.act_map = propag;
-list<state_ref_t> e;
-      e.push_back(state_ref_t());	
-app.shrinkA_ptr = e.begin();
+app.shrinkA_ptr = shrinkA.end();
       }
     waiting.push(state_ref);
     st.set_app_by_ref(state_ref, app);
   }
   else //state already visited
+    RELAX_STORED(&state, propag, subgraph);
+}
+
+// }}}
+
+// {{{ void RELAX_STORED(state_t *state, map_value_t propag, map_value_t subgraph)
+
+//relaxation of the already visited state state_ref, state is its explicit
+//form or 0 if it is not at hand (successors taken from the successor cache)
+void RELAX_STORED(state_t *state, map_value_t propag, map_value_t subgraph)
+{
+  appendix_t app;
+  st.get_app_by_ref(state_ref, app);
+  if ((propag == app.act_map) && (app.shrinkA_ptr != shrinkA.end()))
     {
-      st.get_app_by_ref(state_ref, app);
-      list<state_ref_t> e;
-      e.push_back(state_ref_t());
-      if ((propag == app.act_map) && (app.shrinkA_ptr != e.begin()))
+      //accepting cycle revealed
+      send_cycle_detect(&state_ref);
+    }
+  else
+    {
+      if (app.act_map == subgraph) //first visitation of this vertex during
+	// this iteration
 	{
-	  //accepting cycle revealed
-	  send_cycle_detect(&state_ref);
+	  app.old_map = subgraph;
+	  if (is_accepting_ref(state))
+	    { 
+	      app.act_map=prirad_novy_map(&(state_ref));
+	      if (cmp_map(propag, app.act_map))
+		{
+		  shrinkA.push_front(state_ref);
+		  app.shrinkA_ptr = shrinkA.begin();
+		}
+	      else
+		{
+		  app.act_map=propag; //due to execution of this line the next iteration 
+		  app.shrinkA_ptr = shrinkA.end(); //is necessary
+		}
+	    }
+	  else 
+	    {
+	      app.act_map = propag;
+app.shrinkA_ptr = shrinkA.end();
+	    }
+	  waiting.push(state_ref);
+	  st.set_app_by_ref(state_ref, app);
 	}
       else
 	{
-	  if (app.act_map == subgraph) //first visitation of this vertex during
-	    // this iteration
-	    {
-	      app.old_map = subgraph;
-	      if (p_sys->is_accepting(state))
-		{ 
-		  app.act_map=prirad_novy_map(&(state_ref));
-		  if (cmp_map(propag, app.act_map))
-		    {
-		      shrinkA.push_front(state_ref);
-		      app.shrinkA_ptr = shrinkA.begin();
-		    }
-		  else
-		    {
-		      app.act_map=propag; //due to execution of this line the next iteration 
-		      list<state_ref_t> e;
-                      e.push_back(state_ref_t());
-                      app.shrinkA_ptr = e.begin(); //is necessary
-		    }
-		}
-	      else 
+	  if (((app.old_map == subgraph)||((app.old_map.nid==divine::MAX_ULONG_INT) && (subgraph==NULL_MAP_VISIT))) && (cmp_map(app.act_map,propag)))
+	    {                           //this (after "||") is necessary due to counting of states+transitions
+	      app.act_map = propag;
+if (app.shrinkA_ptr != shrinkA.end())
 		{
-		  app.act_map = propag;
-list<state_ref_t> e;
-      e.push_back(state_ref_t());		  
-app.shrinkA_ptr = e.begin();
+		  shrinkA.erase(app.shrinkA_ptr);
+app.shrinkA_ptr = shrinkA.end();
 		}
 	      waiting.push(state_ref);
 	      st.set_app_by_ref(state_ref, app);
 	    }
-	  else
-	    {
-	      if (((app.old_map == subgraph)||((app.old_map.nid==divine::MAX_ULONG_INT) && (subgraph==NULL_MAP_VISIT))) && (cmp_map(app.act_map,propag)))
-		{                           //this (after "||") is necessary due to counting of states+transitions
-		  app.act_map = propag;
-list<state_ref_t> e;
-      e.push_back(state_ref_t());		  
-if (app.shrinkA_ptr != e.begin())
-		    {
-		      shrinkA.erase(app.shrinkA_ptr);
-list<state_ref_t> e;
-      e.push_back(state_ref_t());		      
-app.shrinkA_ptr = e.begin();
-		    }
-		  waiting.push(state_ref);
-		  st.set_app_by_ref(state_ref, app);
-		}
-	    }
 	}
     }
 }
@@ -743,9 +796,7 @@ void cycle_recovering()
   if (acc_cycle_is_mine)
     {
       appendix.act_map=NULL_MAP;
-      list<state_ref_t> e;
-      e.push_back(state_ref_t());
-      appendix.shrinkA_ptr=e.begin();
+      appendix.shrinkA_ptr=shrinkA.end();
       appendix.old_map.bfs_order=0;
       appendix.old_map.nid=nid;
       appendix.old_map.id=EXTRACT_CYCLE_VISIT;
@@ -833,9 +884,7 @@ void path_recovering()
   if ((size_int_t)distributed.get_state_net_id(s0) == nid)
     { 
       appendix.act_map=NULL_MAP;
-list<state_ref_t> e;
-      e.push_back(state_ref_t());
-      appendix.shrinkA_ptr=e.begin();
+      appendix.shrinkA_ptr=shrinkA.end();
       appendix.old_map.bfs_order=0;
       appendix.old_map.nid=nid;
       appendix.old_map.id=EXTRACT_PATH_VISIT;
@@ -920,10 +969,12 @@ list<state_ref_t> e;
 void MAP()
 {
   succ_container_t succs(*p_sys);
+  vector<succ_cache_t::succ_t> cached_succs;
   state_t succ_state;
   appendix_t app;
   size_int_t state_nid;
-  bool first_visit;
+  bool first_visit, cached;
+  size_int_t succs_count;
   end_of_iteration = false;
 
   while ((!end_of_iteration)&&(!distributed.synchronized(info_shrinkA)))
@@ -938,7 +989,9 @@ void MAP()
 	    { 
 	      state_ref = waiting.front();
 	      waiting.pop();
-	      current_state = st.reconstruct(state_ref);
+	      cached = succ_cache.lookup(state_ref, cached_succs);
+	      if (!cached || debug>1)
+		current_state = st.reconstruct(state_ref);
 
 	      if (debug>1)
 		{
@@ -961,20 +1014,45 @@ void MAP()
 		  vypis_map_value(app.old_map, cout);
 		  cout << endl;
 		}
-	      p_sys->get_succs(current_state, succs);
-	      succs_calls++;
-	      edges_relaxed+=succs.size();
+	      if (cached)
+		succs_count = cached_succs.size();
+	      else
+		{
+		  p_sys->get_succs(current_state, succs);
+		  succs_calls++;
+		  succs_count = succs.size();
+		  succ_cache.start(state_ref); //RELAX() changes state_ref
+		}
+	      edges_relaxed+=succs_count;
 	      if (first_visit)
-		trans+=succs.size();
+		trans+=succs_count;
 
-	      for (size_int_t i = 0; ((i<succs.size())&&(!acc_cycle_found)); 
+	      for (size_int_t i = 0; ((i<succs_count)&&(!acc_cycle_found)); 
 		   i++)
 		{ 
+		  if (cached)
+		    {
+		      if (cached_succs[i].is_local())
+			{
+			  state_ref = cached_succs[i].ref;
+			  RELAX_STORED(0, app.act_map, app.old_map);
+			}
+		      else
+			{
+			  if (first_visit)
+			    cross_trans++;
+			  send_state(cached_succs[i].network_id, &cached_succs[i].state,
+				     &(app.act_map), &(app.old_map));
+			}
+		      continue;
+		    }
+
 		  succ_state = succs[i];
 		  state_nid = distributed.get_state_net_id(succ_state);
 		  if (state_nid == nid) //state is mine?
 		    { 
 		      RELAX(succ_state, app.act_map, app.old_map);
+		      succ_cache.add_local(state_ref);
 		    }
 		  else //send the message to the owner of the state
 		    { 
@@ -982,10 +1060,14 @@ void MAP()
 			cross_trans++;		      
 		      send_state(state_nid, &succ_state, &(app.act_map), 
 				 &(app.old_map));
+		      succ_cache.add_remote(succ_state, state_nid);
 		    }
 		  delete_state(succ_state);
 		  }
-	      delete_state(current_state);	    
+	      if (!cached && !acc_cycle_found) //otherwise the record is not complete
+		succ_cache.finish();
+	      if (!cached || debug>1)
+		delete_state(current_state);	    
 #if defined(ORIG_POLL)
 	      if (aux_counter>100) { distributed.process_messages(); aux_counter = 0; }
 	      else aux_counter++;
@@ -1035,9 +1117,7 @@ void DEL_ACC()
     st.get_app_by_ref(state_ref,app);
     app.old_map=app.act_map;
     app.act_map=NULL_MAP;
-    list<state_ref_t> e;
-      e.push_back(state_ref_t());
-    app.shrinkA_ptr=e.begin(); //really necessary?
+    app.shrinkA_ptr=shrinkA.end(); //really necessary?
     st.set_app_by_ref(state_ref,app);
     
     //removing states from shrinkA to structure waiting
@@ -1048,6 +1128,246 @@ void DEL_ACC()
 
 // }}}
 
+// {{{ checkpoints
+
+string checkpoint_file(const string & base)
+{
+  ostringstream oss;
+  oss << base << ".ckpt." << nid;
+  return oss.str();
+}
+
+//saves the computation after DEL_ACC() (all workstations are synchronized,
+//shrinkA is empty and the states of the next iteration are in waiting)
+void save_checkpoint(const string & base)
+{
+  snapshot_t snapshot;
+  snapshot.create(checkpoint_file(base));
+  snapshot.write_value(iter_count);
+  snapshot.write_value(succs_calls);
+  snapshot.write_value(edges_relaxed);
+  snapshot.write_value(trans);
+  snapshot.write_value(cross_trans);
+  snapshot.write_queue(waiting);
+  snapshot.align();
+  st.save_snapshot(snapshot);
+  //the previous checkpoint is replaced only when all the new ones are written
+  distributed.network.barrier();
+  snapshot.commit();
+}
+
+//the saved iterators to shrinkA are not valid in this process
+void reset_shrinkA_ptr(state_ref_t ref)
+{
+  appendix_t app;
+  st.get_app_by_ref(ref, app);
+  app.shrinkA_ptr = shrinkA.end();
+  st.set_app_by_ref(ref, app);
+}
+
+//restores the computation saved by save_checkpoint(), the states are
+//mapped from the checkpoint file instead of being inserted again
+void load_checkpoint(const string & base)
+{
+  size_int_t loaded_iter_count = divine::MAX_ULONG_INT;
+  try
+    {
+      resumed_snapshot.map(checkpoint_file(base));
+      resumed_snapshot.read_value(iter_count);
+      resumed_snapshot.read_value(succs_calls);
+      resumed_snapshot.read_value(edges_relaxed);
+      resumed_snapshot.read_value(trans);
+      resumed_snapshot.read_value(cross_trans);
+      resumed_snapshot.read_queue(waiting);
+      resumed_snapshot.skip_align();
+      st.load_snapshot(resumed_snapshot, reset_shrinkA_ptr);
+      loaded_iter_count = iter_count;
+    }
+  catch (ERR_throw_t & err)
+    {
+      //reported below on all workstations
+    }
+
+  //a run killed while replacing the checkpoints leaves some of them older
+  vector<size_int_t> iter_counts(nnn);
+  distributed.network.all_gather((char *)&loaded_iter_count, sizeof(size_int_t),
+				 (char *)&iter_counts[0], sizeof(size_int_t));
+  for (size_int_t i = 0; i < nnn; i++)
+    if (iter_counts[i] == divine::MAX_ULONG_INT || iter_counts[i] != iter_counts[0])
+      gerr << nid << ": " << "Cannot resume from the checkpoints " << base << ".ckpt.*" << thr();
+}
+
+// }}}
+
+// {{{ phases of MAP
+
+//seeds the initial state of the selected product and iterates MAP and DEL_ACC
+//until an accepting cycle is found or no accepting state is left
+void map_iterations(const string & checkpoint_base)
+{
+  s0 = p_sys->get_initial_state();
+
+  if (resume)
+    {
+      if (!waiting.empty())
+	distributed.set_busy();
+      else
+	distributed.set_idle();
+    }
+  else if ((size_int_t)distributed.get_state_net_id(s0) == nid)
+    { 
+      st.insert(s0, state_ref);
+      if (p_sys->is_accepting(s0))
+	{ 
+	  appendix.act_map=prirad_novy_map(&(state_ref));
+	  shrinkA.push_front(state_ref);
+	  appendix.shrinkA_ptr=shrinkA.begin();
+	}
+      else
+	{ 
+	  appendix.act_map=NULL_MAP;
+	  appendix.shrinkA_ptr=shrinkA.end();
+	}
+      appendix.old_map=NULL_MAP_VISIT;
+      appendix.old_map.nid = divine::MAX_ULONG_INT; //to detect whether a state is handled for the first time in MAP() in order to count (cross) trans correctly
+      st.set_app_by_ref(state_ref, appendix);
+      waiting.push(state_ref);
+
+      distributed.set_busy();
+    }
+  else
+    distributed.set_idle();
+  
+  do
+    {
+      iter_count++;
+      if (nid == 0)
+	cout << nid << ": iteration nr. " << iter_count 
+	     << ": shrinkA.size: " 
+	     << info_shrinkA.data.size_of_all_shrinkA_sets << endl;
+      DIVINE_PROFILE_BEGIN("Map");
+      MAP();
+      DIVINE_PROFILE_END();
+
+      if (!(acc_cycle_found)) // probably next iteration is necessary
+	{ 
+	  DIVINE_PROFILE_BEGIN("DelAcc");
+	  DEL_ACC();
+	  DIVINE_PROFILE_END();
+	  finish=(info_shrinkA.data.size_of_all_shrinkA_sets==0);
+	  if (checkpoint && !finish)
+	    save_checkpoint(checkpoint_base);
+	}	  
+    }
+  while (!finish);
+}
+
+//recovers the accepting cycle found by map_iterations() and a path to it,
+//writes them to base.trail and base.ce_states
+void generate_counterexample(const string & base)
+{
+  cycle_length = path_length = 0; //a counterexample of the previous property leaves them set
+
+  //first, recovering of cycle
+  DIVINE_PROFILE_BEGIN("Counterexample");
+  cycle_recovering();
+
+  //reconstruction of the cycle
+  if (acc_cycle_is_mine)
+    { 	  
+      st.get_app_by_ref(acc_cycle_ref, appendix);
+      map_value_t _ref;
+      _ref.bfs_order = acc_cycle_ref.hres;
+      _ref.id = acc_cycle_ref.id;
+      _ref.nid = nid;
+      process_ce_cycle_state(_ref, appendix.old_map.bfs_order);
+    }
+	
+  while(!end_of_iteration)//it stands for end_of_cycle_reconstruct. now
+    { 
+      distributed.process_messages();
+    }
+
+  //synchronization: NECESSARY to call
+  distributed.set_idle();
+  distributed.network.flush_all_buffers();
+  while (!distributed.synchronized())
+    distributed.process_messages();
+	
+  while (!waiting.empty())
+    waiting.pop();
+	
+  end_of_iteration = false;
+  
+  //now recovering path from initial state to the cycle
+  path_recovering();
+  
+  //reconstruction of the path
+  if (acc_cycle_is_mine)
+    { 	  
+      st.get_app_by_ref(acc_cycle_ref, appendix);
+      map_value_t _ref;
+      _ref.bfs_order = acc_cycle_ref.hres;
+      _ref.id = acc_cycle_ref.id;
+      _ref.nid = nid;
+      process_ce_path_state(_ref, appendix.old_map.bfs_order);
+    }
+	
+  while(!distributed.synchronized())
+    { 
+      distributed.process_messages();
+    }
+  DIVINE_PROFILE_END();
+  
+  //output
+  if (nid == 0)
+    {
+      path_t ce(p_sys);
+      ofstream ce_out;
+      string pom_fn;
+      if ((show_ce) || (trail))
+	{
+	  for (size_int_t i=0; i<path_length-1; i++)
+	    ce.push_back(path_state[i]);
+	  ce.push_back(cycle_state[0]);
+	  ce.mark_cycle_start_back();
+	  for (size_int_t i=1; i<cycle_length-1; i++)
+	    ce.push_back(cycle_state[i]);		  
+	  if (trail)
+	    {
+	      pom_fn = base+".trail";
+	      ce_out.open(pom_fn.c_str());
+	      if (p_sys->can_system_transitions())			
+		ce.write_trans(ce_out);
+	      else
+		ce.write_states(ce_out);
+	      ce_out.close();
+	    }
+
+	  if (show_ce)
+	    {
+	      pom_fn = base+".ce_states";
+	      ce_out.open(pom_fn.c_str());
+	      ce.write_states(ce_out);
+	      ce_out.close();
+	    }
+	  ce.erase();
+	}
+
+      //deleting allocated memory
+      for (size_int_t i=0; i<cycle_length; i++)
+	delete_state(cycle_state[i]);
+	
+      delete[] cycle_state;
+      for (size_int_t i=0; i<path_length; i++)
+	delete_state(path_state[i]);
+	
+      delete[] path_state;
+    }
+}
+
+// }}}
+
 // {{{ int main(int argc, char **argv)
 
 int main(int argc, char **argv)
@@ -1073,13 +1393,20 @@ int main(int argc, char **argv)
 		{ "fast",		no_argument, 0, 'f'},
 	    { "log",        no_argument, 0, 'L'},
 		{ "htsize",     required_argument, 0, 'H' },
+		{ "openhash",   no_argument, 0, 'O' },
+		{ "vcache",     required_argument, 0, 'K' },
+		{ "succcache",  required_argument, 0, 'M' },
+		{ "partition",  required_argument, 0, 'P' },
+		{ "checkpoint", no_argument, 0, 'k' },
+		{ "resume",     no_argument, 0, 'u' },
+		{ "graph",      required_argument, 0, 'G' },
 		{ "statelist",  no_argument, 0, 'c'},
 		{ "verbose", 	no_argument, 0, 'V'},
 		{ "version",    no_argument, 0, 'v'},
 		{ 0, 0, 0, 0 }
       };
 
-      while ((c = getopt_long(argc, argv, "LX:H:SVfqhtrvc", longopts, 0)) != -1)
+      while ((c = getopt_long(argc, argv, "LOX:G:H:K:M:P:SVfqhtrvcku", longopts, 0)) != -1)
 		{
 		  oss1 <<" -"<<(char)c;
 		  switch (c) {
@@ -1093,6 +1420,10 @@ int main(int argc, char **argv)
 			  case 'L': logging = true; break;
 			  case 'X': set_base_name = optarg; base_name = true; break;
 			  case 'H': htsize=atoi(optarg);break;
+			  case 'O': open_hashing = true;break;
+			  case 'K': vertex_cache_size=atoi(optarg);break;
+			  case 'M': succ_cache_mb=atoi(optarg);break;
+			  case 'P': partition_spec = optarg;break;
 			  case 'V':
 			  case 'S': statistics = true;break;
 			  case 'q': quietmode = true;break;
@@ -1100,6 +1431,9 @@ int main(int argc, char **argv)
 			  case 'f': fastApproximation = true; break;
 			  case 'r': report = true;break;
 			  case 'c': show_ce = true; break;
+			  case 'k': checkpoint = true; break;
+			  case 'u': resume = true; break;
+			  case 'G': graph_file = optarg; break;
 			  case 'v': 
 			  	if (distributed.network_id == 0) 
 				{ 
@@ -1144,23 +1478,38 @@ int main(int argc, char **argv)
             }
           st.set_ht_size(htsize);
         }
+      if (open_hashing)
+        {
+          if (checkpoint || resume)
+            gerr << nid << ": " << "Checkpoints cannot be used with -O" << thr();
+          st.set_hashing_method(OPEN_ADDRESSING);
+        }
       appendix.act_map=NULL_MAP; 
       appendix.old_map=NULL_MAP;
-      list<state_ref_t> e;
-      e.push_back(state_ref_t());	 
-      appendix.shrinkA_ptr=e.begin();
+      appendix.shrinkA_ptr=shrinkA.end();
       st.set_appendix(appendix);
+      succ_cache.set_mem_limit(succ_cache_mb*1024*1024);
+      st.set_succ_cache(&succ_cache);
 
       /* decisions about the type of an input */
       char * filename = argv[optind];
       int filename_length = strlen(filename);
 
       if (filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0)
+		input_file_ext = ".bio";
+      else if (filename_length>=5 && strcmp(filename+filename_length-5,".cbio")==0)
+		input_file_ext = ".cbio"; //compiled model (see divine.compile_bio)
+      if (input_file_ext)
 		{
 		  if (nid==0)
 			cout << "Reading bio source..." << endl;
-		  input_file_ext = ".bio";
-		  p_sys = new affine_explicit_system_t(gerr);
+		  affine_explicit_system_t * p_affine_sys;
+		  if (graph_file.empty())
+			p_affine_sys = new affine_explicit_system_t(gerr);
+		  else //successors are read from the precomputed state graph
+			p_affine_sys = new affine_graph_explicit_system_t(gerr, graph_file);
+		  p_affine_sys->set_vertex_cache_size(vertex_cache_size);
+		  p_sys = p_affine_sys;
 		}
 
     
@@ -1177,6 +1526,14 @@ int main(int argc, char **argv)
 			}
 		  if (file_opening)
 			gerr << thr();
+
+		  for (int k=optind+1; k<argc; k++) //the other properties of the same model
+			{
+			  affine_system_t * p_affine_sys = dynamic_cast<affine_system_t *>(p_sys);
+			  if (!p_affine_sys)
+				gerr << nid << ": " << "More input files need an affine system" << thr();
+			  p_affine_sys->add_property(argv[k]);
+			}
 		}
       catch (ERR_throw_t & err)
 		{ 
@@ -1185,20 +1542,37 @@ int main(int argc, char **argv)
 		}
 
       file_base_name = argv[optind];
-      size_t pos = file_base_name.find(input_file_ext, file_base_name.length() - 4);
+      size_t pos = file_base_name.find(input_file_ext, file_base_name.length() - strlen(input_file_ext));
       if (pos != string::npos)
-		file_base_name.erase(pos, 4);
+		file_base_name.erase(pos, strlen(input_file_ext));
 
       if (p_sys->get_with_property() && p_sys->get_property_type()!=BUCHI)
 		{
 		  gerr << nid << ": "<< "Cannot work with other than standard Buchi accepting condition." <<thr();
 		}
 
+      if (!partition_spec.empty())
+		{
+		  affine_explicit_system_t * p_affine_sys = dynamic_cast<affine_explicit_system_t *>(p_sys);
+		  if (!p_affine_sys)
+			gerr << nid << ": " << "Partition functions other than hash need an affine system" << thr();
+		  p_partitioner = new affine_partitioner_t(*p_affine_sys, partition_spec, nnn);
+		  distributed.set_partitioner(p_partitioner);
+		}
+
       st.init();
 
       file_name = argv[optind];
       int position = file_name.find(input_file_ext,0);
       file_name.erase(position,strlen(input_file_ext));
+
+      string checkpoint_base = (base_name ? set_base_name : file_name);
+      if ((checkpoint || resume) && argc > optind+1)
+        gerr << nid << ": " << "Checkpoints cannot be used with more input files" << thr();
+      if (!graph_file.empty() && argc > optind+1)
+        gerr << nid << ": " << "A state graph holds one property, it cannot be used with more input files" << thr();
+      if (resume)
+        load_checkpoint(checkpoint_base);
       
       if (report)
 		{
@@ -1229,50 +1603,54 @@ int main(int argc, char **argv)
 		  //timer.reset(); //computation time includes initialization
 		}
 
-      s0 = p_sys->get_initial_state();
+      affine_system_t * p_affine_sys = dynamic_cast<affine_system_t *>(p_sys);
+      size_t property_count = (p_affine_sys ? max(p_affine_sys->get_property_count(), size_t(1)) : 1);
+      vector<bool> cycle_found(property_count, false);
+      vector<size_int_t> iterations(property_count, 0);
+      for (size_t property=0; property<property_count; property++)
+	{
+	  if (property > 0) //the next product is stored next to the previous ones
+	    {
+	      //messages of the previous product must not reach the next one
+	      distributed.set_idle();
+	      distributed.network.flush_all_buffers();
+	      while (!distributed.synchronized())
+		distributed.process_messages();
+	      while (!waiting.empty())
+		waiting.pop();
+	      shrinkA.clear();
+	      acc_cycle_found = finish = end_of_iteration = acc_cycle_is_mine = false;
+	      info_shrinkA.data.size_of_all_shrinkA_sets = 0;
+	      iter_count = 0;
+	      delete_state(s0);
+	      p_affine_sys->select_property(property);
+	      if (nid == 0)
+		cout << nid << ": property #" << property+1 << " (" << argv[optind+property] << ")" << endl;
+	    }
 
-      if ((size_int_t)distributed.get_state_net_id(s0) == nid)
-		{ 
-		  st.insert(s0, state_ref);
-		  if (p_sys->is_accepting(s0))
-			{ 
-			  appendix.act_map=prirad_novy_map(&(state_ref));
-			  shrinkA.push_front(state_ref);
-			  appendix.shrinkA_ptr=shrinkA.begin();
-			}
-		  else
-			{ 
-			  appendix.act_map=NULL_MAP;
-                          list<state_ref_t> e;
-                          e.push_back(state_ref_t());
-			  appendix.shrinkA_ptr=e.begin();
-			}
-		  appendix.old_map=NULL_MAP_VISIT;
-		  appendix.old_map.nid = divine::MAX_ULONG_INT; //to detect whether a state is handled for the first time in MAP() in order to count (cross) trans correctly
-		  st.set_app_by_ref(state_ref, appendix);
-		  waiting.push(state_ref);
+	  map_iterations(checkpoint_base);
+	  cycle_found[property] = acc_cycle_found;
+	  iterations[property] = iter_count;
 
-		  distributed.set_busy();
-		}
-      else
-		distributed.set_idle();
-      
-      do
-	 	{
-		  iter_count++;
-		  if (nid == 0)
-			  cout << nid << ": iteration nr. " << iter_count 
-			   << ": shrinkA.size: " 
-			   << info_shrinkA.data.size_of_all_shrinkA_sets << endl;
-		  MAP();
-
-		  if (!(acc_cycle_found)) // probably next iteration is necessary
-			{ 
-			  DEL_ACC();
-			  finish=(info_shrinkA.data.size_of_all_shrinkA_sets==0);
-			}	  
+	  if ((acc_cycle_found) && (trail || show_ce))
+	    {
+	      string ce_base = (base_name ? set_base_name : file_name);
+	      if (property_count > 1)
+		{
+		  ostringstream prop_base;
+		  if (base_name)
+		    prop_base << set_base_name << ".prop" << property+1;
+		  else
+		    {
+		      string pom_fn = argv[optind+property];
+		      pom_fn.erase(pom_fn.find(input_file_ext,0),strlen(input_file_ext));
+		      prop_base << pom_fn;
+		    }
+		  ce_base = prop_base.str();
 		}
-      while (!finish);
+	      generate_counterexample(ce_base);
+	    }
+	}
       
       if (logging)
         {
@@ -1280,124 +1658,11 @@ int main(int argc, char **argv)
           logger.stop_SIGALRM();
         }
 
-      if ((acc_cycle_found) && (trail || show_ce))
-		{ 	  
-		  //first, recovering of cycle
-		  cycle_recovering();
-
-		  //reconstruction of the cycle
-		  if (acc_cycle_is_mine)
-			{ 	  
-			  st.get_app_by_ref(acc_cycle_ref, appendix);
-			  map_value_t _ref;
-			  _ref.bfs_order = acc_cycle_ref.hres;
-			  _ref.id = acc_cycle_ref.id;
-			  _ref.nid = nid;
-			  process_ce_cycle_state(_ref, appendix.old_map.bfs_order);
-			}
-			
-		  while(!end_of_iteration)//it stands for end_of_cycle_reconstruct. now
-			{ 
-			  distributed.process_messages();
-			}
-
-		  //synchronization: NECESSARY to call
-		  distributed.set_idle();
-		  distributed.network.flush_all_buffers();
-		  while (!distributed.synchronized())
-			distributed.process_messages();
-			
-		  while (!waiting.empty())
-			waiting.pop();
-			
-		  end_of_iteration = false;
-		  
-		  //now recovering path from initial state to the cycle
-		  path_recovering();
-		  
-		  //reconstruction of the path
-		  if (acc_cycle_is_mine)
-			{ 	  
-			  st.get_app_by_ref(acc_cycle_ref, appendix);
-			  map_value_t _ref;
-			  _ref.bfs_order = acc_cycle_ref.hres;
-			  _ref.id = acc_cycle_ref.id;
-			  _ref.nid = nid;
-			  process_ce_path_state(_ref, appendix.old_map.bfs_order);
-			}
-			
-		  while(!distributed.synchronized())
-			{ 
-			  distributed.process_messages();
-			}
-		  
-		  //output
-		  if (nid == 0)
-			{
-			  path_t ce(p_sys);
-			  ofstream ce_out;
-			  string pom_fn;
-			  if ((show_ce) || (trail))
-				{
-				  for (size_int_t i=0; i<path_length-1; i++)
-					ce.push_back(path_state[i]);
-				  ce.push_back(cycle_state[0]);
-				  ce.mark_cycle_start_back();
-				  for (size_int_t i=1; i<cycle_length-1; i++)
-					ce.push_back(cycle_state[i]);		  
-				  if (trail)
-					{
-					  if (base_name)
-						{
-						  pom_fn = set_base_name+".trail";
-						}
-					  else
-						{
-						  pom_fn = file_name+".trail";
-						}
-					  ce_out.open(pom_fn.c_str());
-					  if (p_sys->can_system_transitions())			
-						ce.write_trans(ce_out);
-					  else
-						ce.write_states(ce_out);
-					  ce_out.close();
-					}
-
-				  if (show_ce)
-					{
-					  if (base_name)
-						{
-						  pom_fn = set_base_name+".ce_states";
-						}
-					  else
-						{
-						  pom_fn = file_name+".ce_states";
-						}
-					  ce_out.open(pom_fn.c_str());
-					  ce.write_states(ce_out);
-					  ce_out.close();
-					}
-				  ce.erase();
-				}
-
-			  //deleting allocated memory
-			  for (size_int_t i=0; i<cycle_length; i++)
-				delete_state(cycle_state[i]);
-				
-			  delete[] cycle_state;
-			  for (size_int_t i=0; i<path_length; i++)
-				delete_state(path_state[i]);
-				
-			delete[] path_state;
-			}
-		  
-		} //end of "if ((acc_cycle_found) && (trail || show_ce))"
-
       // ----------------------------------------
       // finalization, collecting statistics etc.
       // ----------------------------------------
 
-      if (statistics)
+      if (statistics || report)
 		{
 		  while (!(distributed.synchronized(info_state_space)))
 			distributed.process_messages();
@@ -1420,21 +1685,37 @@ int main(int argc, char **argv)
 		  reporter.set_info("States", st.get_states_stored());
 		  reporter.set_info("Trans", trans);
 		  reporter.set_info("CrossTrans", cross_trans);
+		  reporter.set_info("SyncRounds", distributed.get_all_sync_rounds_cnt());
+		  reporter.set_info("SyncTime", distributed.get_all_sync_rounds_time());
+		  if (affine_system_t * p_affine_sys = dynamic_cast<affine_system_t *>(p_sys))
+			{
+			  reporter.set_info("VCacheHits", p_affine_sys->get_vertex_cache_hits(), REPORTER_SUM);
+			  reporter.set_info("VCacheMisses", p_affine_sys->get_vertex_cache_misses(), REPORTER_SUM);
+			}
+		  if (succ_cache.enabled())
+			{
+			  reporter.set_info("SCacheHits", succ_cache.get_hits(), REPORTER_SUM);
+			  reporter.set_info("SCacheMisses", succ_cache.get_misses(), REPORTER_SUM);
+			}
+		  reporter.set_profile_info();
 		  if  (nid == 0)
 			{
-			  if (acc_cycle_found)
+			  reporter.set_global_info("Partition", distributed.get_partitioner_name());
+			  if (info_state_space.data.all_trans)
+				reporter.set_global_info("CrossRatio", double(info_state_space.data.all_cross)/info_state_space.data.all_trans);
+			  string is_valid, ce_generated; //one value for each property
+			  for (size_t k=0; k<property_count; k++)
 				{
-				  reporter.set_global_info("IsValid","No");
-				  if (trail || show_ce)
-					reporter.set_global_info("CEGenerated", "Yes");
-				  else
-					reporter.set_global_info("CEGenerated", "No");
-				}
-			  else
-				{
-				  reporter.set_global_info("IsValid","Yes");
-				  reporter.set_global_info("CEGenerated", "No");
+				  if (k>0)
+					{
+					  is_valid += " ";
+					  ce_generated += " ";
+					}
+				  is_valid += (cycle_found[k] ? "No" : "Yes");
+				  ce_generated += (cycle_found[k] && (trail || show_ce) ? "Yes" : "No");
 				}
+			  reporter.set_global_info("IsValid", is_valid);
+			  reporter.set_global_info("CEGenerated", ce_generated);
 			}
 		  reporter.stop_timer();
 		  reporter.collect_and_print(REPORTER_OUTPUT_LONG,report_out);
@@ -1456,6 +1737,13 @@ int main(int argc, char **argv)
   				info_state_space.data.all_succ_calls<<endl;
 	      cout <<ids<<"trans. relaxed:\t"<<
 	   	  		info_state_space.data.all_edges_relaxed<<endl;
+	      cout <<ids<<"partition function:\t"<<
+	   	  		distributed.get_partitioner_name()<<endl;
+	      cout <<ids<<"cross transitions:\t"<<
+	   	  		info_state_space.data.all_cross<<endl;
+	      if (info_state_space.data.all_trans)
+	        cout <<ids<<"cross ratio:\t\t"<<
+	   	  		double(info_state_space.data.all_cross)/info_state_space.data.all_trans<<endl;
 	      cout <<ids<<"all memory used:\t"<<
 		  		info_state_space.data.all_mem/1024.0<<" MB"<<endl;
 	      cout <<ids<<"Computation done:\t"<<timer.gettime()<<" s"<<endl;
@@ -1463,13 +1751,22 @@ int main(int argc, char **argv)
 		}
       
       if (nid == 0)
-		{ 
-		  cout << ' ' << nid << ": Accepting cycle:\t" 
-			   << ((acc_cycle_found)?("YES"):("NO")) << endl
-			   << ' ' << nid << ": Number of iterations:\t" << iter_count 
-			   << endl;
-		}      
+		for (size_t k=0; k<property_count; k++)
+		  { 
+			if (property_count > 1)
+			  cout << ' ' << nid << ": Property #" << k+1 << " (" << argv[optind+k] << ")" << endl;
+			cout << ' ' << nid << ": Accepting cycle:\t" 
+				 << ((cycle_found[k])?("YES"):("NO")) << endl
+				 << ' ' << nid << ": Number of iterations:\t" << iterations[k] 
+				 << endl;
+		  }      
+#if defined(DIVINE_PROFILE)
+      profiler.write_trace_file(checkpoint_base, nid);
+      if (nid == 0 && statistics)
+		profiler.write_summary(cout);
+#endif
       distributed.finalize();
+      delete p_partitioner;
       delete p_sys;
     }
   catch (...)
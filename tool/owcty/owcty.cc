@@ -3,8 +3,16 @@
 #include <iostream>
 #include <fstream>
 #include <queue>
+#include <deque>
 #include <stack>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <time.h>
+#include <signal.h>
+#include <pthread.h>
 #include "divine.h"
 
 using namespace std;
@@ -83,6 +91,7 @@ distributed_t distributed;
 distr_reporter_t reporter(&distributed);
 explicit_system_t * p_sys = 0;
 explicit_storage_t st;
+succ_cache_t succ_cache;
 timeinfo_t timer;
 vminfo_t vm;
 logger_t logger;
@@ -166,6 +175,7 @@ struct info_t {
   size_t allexpand_due_to_proviso;
   long int allmem;
   virtual void update();
+  void merge(const info_t &other);
   virtual ~info_t() {}
 };
 
@@ -195,6 +205,18 @@ void info_t::update()
     }
 }
 
+void info_t::merge(const info_t &other)
+{
+  allstored += other.allstored;
+  allSsize += other.allSsize;
+  alltrans += other.alltrans;
+  allcross += other.allcross;
+  allfullexpand += other.allfullexpand;
+  allreexplored_states += other.allreexplored_states;
+  allexpand_due_to_proviso += other.allexpand_due_to_proviso;
+  allmem += other.allmem;
+}
+
 updateable_info_t<info_t> info;
 
 void full_expand_state(state_t state);
@@ -207,9 +229,9 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
   
   switch (tag) {
   case TAG_SEND_STATE:
-    received_message.load_data((byte_t*)buf,size);
-    received_message.read_state(state_received);
-    received_message.read_data((char *)&net_ref_received,sizeof(net_state_ref_t));
+    memcpy(&net_ref_received,
+	   message_t::read_state_in_place((byte_t*)buf,state_received),
+	   sizeof(net_state_ref_t));
     if (!st.is_stored(state_received,ref))
       {
 	st.insert(state_received,ref);
@@ -228,11 +250,9 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	  }
 	distributed.set_busy();
       }
-    delete_state(state_received);
     break;
   case TAG_SEND_RESET:
-    received_message.load_data((byte_t*)buf,size);
-    received_message.read_state(state_received);
+    message_t::read_state_in_place((byte_t*)buf,state_received);
     st.is_stored(state_received,ref);
     st.get_app_by_ref(ref,appendix);
     if (appendix.iteration < iteration)
@@ -249,11 +269,9 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	    q_queue.push(ref);
 	  }
       }
-    delete_state(state_received);
     break;
   case TAG_SEND_REACH:
-    received_message.load_data((byte_t*)buf,size);
-    received_message.read_state(state_received);
+    message_t::read_state_in_place((byte_t*)buf,state_received);
     st.is_stored(state_received,ref);
     st.get_app_by_ref(ref,appendix);
     if (!appendix.in_S) 
@@ -265,16 +283,14 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
       }
     appendix.p ++;
     st.set_app_by_ref(ref,appendix);		     
-    delete_state(state_received);
     break;
   case TAG_SEND_POR_STATE:
     {
       net_state_ref_t net_ref_received2;
       bool revisited=false;
-      received_message.load_data((byte_t*)buf,size);
-      received_message.read_state(state_received);
-      received_message.read_data((char *)&net_ref_received,sizeof(net_state_ref_t)); //parent
-      received_message.read_data((char *)&net_ref_received2,sizeof(net_state_ref_t)); //propagated max_pred_seed
+      const byte_t *refs = message_t::read_state_in_place((byte_t*)buf,state_received);
+      memcpy(&net_ref_received,refs,sizeof(net_state_ref_t)); //parent
+      memcpy(&net_ref_received2,refs+sizeof(net_state_ref_t),sizeof(net_state_ref_t)); //propagated max_pred_seed
       if (!st.is_stored(state_received, ref))
 	{
 	  revisited=true;
@@ -322,12 +338,10 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	  distributed.set_busy();
 	  waiting_queue.push(ref);
 	}
-      delete_state(state_received);      
       break;
     }
   case TAG_SEND_ELIMI:
-    received_message.load_data((byte_t*)buf,size);
-    received_message.read_state(state_received);
+    message_t::read_state_in_place((byte_t*)buf,state_received);
     st.is_stored(state_received,ref);
     st.get_app_by_ref(ref,appendix);
     appendix.p --;
@@ -337,7 +351,6 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	L_queue.push(ref);
 	distributed.set_busy();
       }
-    delete_state(state_received);
     break;
   case TAG_CANDIDATE_DETECT:
     {
@@ -524,21 +537,40 @@ void usage()
   version();
   cout <<"-----------------------------------------------------------------"<<endl;
 
-  cout <<"Usage: [mpirun -np N] owcty [options] input_file"<<endl;
+  cout <<"Usage: [mpirun -np N] owcty [options] input_file [input_file ...]"<<endl;
+  cout <<"More input files have to hold the same model with different properties"<<endl;
+  cout <<"(e.g. the files made by divine.combine). The model is read once and the"<<endl;
+  cout <<"properties are checked one after another (with -X w, the files of the"<<endl;
+  cout <<"k-th property are named w.propk.*)."<<endl;
   cout <<"Options: "<<endl;
   cout <<" -v,--version\t\tshow version"<<endl;
   cout <<" -h,--help\t\tshow this help"<<endl;
   cout <<" -H x,--htsize x\tset the size of hash table to ( x<33 ? 2^x : x )"<<endl;
+  cout <<" -O,--openhash\t\tuse open addressing hash table (grows on the fly)"<<endl;
+  cout <<" -K x,--vcache x\tset the number of entries of vertex cache (0 = off, default)"<<endl;
+  cout <<" -M x,--succcache x\tcache successors of states in at most x MB (0 = off, default;"<<endl;
+  cout <<"\t\t\tignored with -T)"<<endl;
+  cout <<" -T x,--threads x\tuse x worker threads sharing one hash table (implies -O)"<<endl;
+  cout <<" -P p,--partition p\tpartition states among workstations by p (affine systems only)"<<endl;
+  cout <<"\t\t\t(slab[:x] or block[:x,y,...], optionally followed by @n"<<endl;
+  cout <<"\t\t\tto balance the parts by the first n states; default = hash)"<<endl;
   cout <<" -V,--verbose\t\tprint some statistics"<<endl;
   cout <<" -q,--quiet\t\tquite mode"<<endl;
   cout <<" -c, --statelist\tshow counterexample states"<<endl;
   cout <<" -C x,--compress x\tset state compression method"<<endl;
-  cout <<"\t\t\t(0 = no compression, 1 = Huffman static compression)"<<endl;
+  cout <<"\t\t\t(0 = no compression, 1 = Huffman static compression,"<<endl;
+  cout <<"\t\t\t 2 = mixed radix packing of affine states)"<<endl;
   cout <<" -t,--trail\t\tproduce trail file"<<endl;
   cout <<" -f, --fast\t\tuse faster but less accurate algorithm for abstraction" << endl;
   cout <<" -r,--report\t\tproduce report file"<<endl;
   cout <<" -s,--simple\t\tperform simple reachability only"<<endl;
   cout <<" -L,--log\t\tproduce logfiles (log period is 1 second)"<<endl;
+  cout <<" -k,--checkpoint\tsave a checkpoint after every iteration to w.ckpt.N"<<endl;
+  cout <<" -u,--resume\t\tresume the computation from the checkpoint w.ckpt.N"<<endl;
+  cout <<"\t\t\t(-k and -u do not work with -O and -T)"<<endl;
+  cout <<" -G f,--graph f\texplore the state graph f written by divine.generator -b"<<endl;
+  cout <<"\t\t\tinstead of computing successors (the input file has to be"<<endl;
+  cout <<"\t\t\tthe model the graph was generated from)"<<endl;
   cout <<" -X w\t\t\tsets base name of produced files to w (w.trail,w.report,w.00-w.N)"<<endl;
 }
 
@@ -547,6 +579,122 @@ void generate_successors(state_t state, state_ref_t ref, enabled_trans_container
     p_sys->get_succs(state,*succs_cont);
 }
 
+//successors of the stored state ref: the local ones by their references,
+//the others explicitly - taken from the successor cache if possible,
+//otherwise generated (and cached); the states in succs are valid until
+//the next call
+void get_stored_succs(state_ref_t ref, vector<succ_cache_t::succ_t> & succs)
+{
+  static succ_container_t succs_cont(*p_sys);
+  static vector<state_t> generated;
+
+  for (size_t k=0; k<generated.size(); k++)
+    delete_state(generated[k]);
+  generated.clear();
+
+  if (succ_cache.lookup(ref, succs))
+    return;
+
+  state_t state = st.reconstruct(ref);
+  succs_calls++;
+  succs_cont.clear();
+  generate_successors(state, ref, all_enabled_trans, &succs_cont);
+  delete_state(state);
+
+  succ_cache.start(ref);
+  succs.resize(succs_cont.size());
+  for (size_t k=0; k<succs_cont.size(); k++)
+    {
+      state_t r = succs_cont[k];
+      int owner = distributed.partition_function(r);
+      succs[k].network_id = owner;
+      if (owner != distributed.network_id)
+        {
+          succs[k].state = r;
+          succ_cache.add_remote(r, owner);
+          generated.push_back(r);
+        }
+      else
+        {
+          succs[k].state.ptr = 0;
+          st.is_stored(r, succs[k].ref);
+          succ_cache.add_local(succs[k].ref);
+          delete_state(r);
+        }
+    }
+  succ_cache.finish();
+}
+
+bool is_accepting_ref(state_ref_t ref)
+{
+  state_t state = st.reconstruct(ref);
+  bool result = p_sys->is_accepting(state);
+  delete_state(state);
+  return result;
+}
+
+snapshot_t resumed_snapshot; //holds the states restored by load_checkpoint()
+
+string checkpoint_file(const string & base)
+{
+  ostringstream oss;
+  oss << base << ".ckpt." << distributed.network_id;
+  return oss.str();
+}
+
+//saves the computation between two iterations (all workstations are
+//synchronized, waiting_queue and L_queue are empty)
+void save_checkpoint(const string & base)
+{
+  snapshot_t snapshot;
+  snapshot.create(checkpoint_file(base));
+  snapshot.write_value(iteration);
+  snapshot.write_value(oldSsize);
+  snapshot.write_value(Ssize);
+  snapshot.write_value(trans);
+  snapshot.write_value(transcross);
+  snapshot.write_value(succs_calls);
+  snapshot.write_queue(q_queue);
+  snapshot.align();
+  st.save_snapshot(snapshot);
+  //the previous checkpoint is replaced only when all the new ones are written
+  distributed.network.barrier();
+  snapshot.commit();
+}
+
+//restores the computation saved by save_checkpoint(), the states are
+//mapped from the checkpoint file instead of being inserted again
+void load_checkpoint(const string & base)
+{
+  size_t loaded_iteration = MAX_ULONG_INT;
+  try
+    {
+      resumed_snapshot.map(checkpoint_file(base));
+      resumed_snapshot.read_value(iteration);
+      resumed_snapshot.read_value(oldSsize);
+      resumed_snapshot.read_value(Ssize);
+      resumed_snapshot.read_value(trans);
+      resumed_snapshot.read_value(transcross);
+      resumed_snapshot.read_value(succs_calls);
+      resumed_snapshot.read_queue(q_queue);
+      resumed_snapshot.skip_align();
+      st.load_snapshot(resumed_snapshot);
+      loaded_iteration = iteration;
+    }
+  catch (ERR_throw_t & err)
+    {
+      //reported below on all workstations
+    }
+
+  //a run killed while replacing the checkpoints leaves some of them older
+  vector<size_t> iterations(distributed.cluster_size);
+  distributed.network.all_gather((char *)&loaded_iteration, sizeof(size_t),
+				 (char *)&iterations[0], sizeof(size_t));
+  for (int k=0; k<distributed.cluster_size; k++)
+    if (iterations[k] == MAX_ULONG_INT || iterations[k] != iterations[0])
+      gerr << "Cannot resume from the checkpoints " << base << ".ckpt.*" << thr();
+}
+
 void full_expand_state(state_t state)
 { 
   succ_container_t succs_cont(*p_sys);
@@ -576,13 +724,10 @@ void full_expand_state(state_t state)
       if (distributed.partition_function(succ_state)!=distributed.network_id)
 	{
 	  transcross++;
-	  message.rewind();
-	  message.append_state(succ_state);
-	  message.append_data((byte_t *)&nref,sizeof(net_state_ref_t));
-	  message.append_data((byte_t *)&NET_STATE_REF_NULL,sizeof(net_state_ref_t));
-	  distributed.network.send_message(message,
-					   distributed.partition_function(succ_state),
-					   TAG_SEND_POR_STATE);
+	  net_state_ref_t refs[2] = {nref, NET_STATE_REF_NULL};
+	  distributed.network.send_state(succ_state, (char *)refs, sizeof(refs),
+					 distributed.partition_function(succ_state),
+					 TAG_SEND_POR_STATE);
 	}
       else
 	{
@@ -611,6 +756,351 @@ void full_expand_state(state_t state)
   succs_cont.clear();
 }
 
+// {{{ hybrid mode - more worker threads on one workstation
+
+/* Worker threads of one workstation share the storage (open addressing
+ * hash table in the shared mode) and the appendices of states. Each of them
+ * has its own copy of the system and its own queue of states to be
+ * processed, idle workers steal states from queues of the others. Fields of
+ * appendices are updated by atomic instructions. Only the main thread
+ * communicates: successors owned by other workstations are collected in
+ * outboxes of workers and sent when the workers run out of work, received
+ * states are given to the workers in the next round. */
+
+enum phase_t { PHASE_FIRST, PHASE_REACH, PHASE_ELIMI, PHASE_RESET };
+
+struct outgoing_t
+{
+  int dest;
+  int tag;
+  state_t state;
+  net_state_ref_t parent; //TAG_SEND_STATE only
+};
+
+struct worker_t
+{
+  explicit_system_t * sys;
+  deque<state_ref_t> tasks;
+  mutex tasks_mutex;
+  vector<state_ref_t> accepting; //states to be pushed to q_queue
+  vector<outgoing_t> outbox;
+  size_t trans, transcross, succs_calls;
+  long int Sdelta;
+  worker_t(explicit_system_t * _sys):
+    sys(_sys), trans(0), transcross(0), succs_calls(0), Sdelta(0) {}
+};
+
+size_t threads = 1;
+vector<worker_t *> workers;
+vector<thread> worker_threads;
+mutex pool_mutex;
+condition_variable pool_start, pool_finish;
+size_t pool_round = 0;
+size_t pool_running = 0;
+bool pool_quit = false;
+phase_t pool_phase;
+atomic<size_t> pending(0); //states in queues and states being processed
+
+void push_task(worker_t & w, state_ref_t ref)
+{
+  pending.fetch_add(1);
+  lock_guard<mutex> lock(w.tasks_mutex);
+  w.tasks.push_back(ref);
+}
+
+bool pop_task(size_t me, state_ref_t & ref)
+{
+  {
+    lock_guard<mutex> lock(workers[me]->tasks_mutex);
+    if (!workers[me]->tasks.empty())
+      {
+	ref = workers[me]->tasks.back();
+	workers[me]->tasks.pop_back();
+	return true;
+      }
+  }
+  for (size_t k=1; k<threads; k++)
+    {
+      worker_t & victim = *workers[(me+k) % threads];
+      lock_guard<mutex> lock(victim.tasks_mutex);
+      if (!victim.tasks.empty())
+	{
+	  ref = victim.tasks.front();
+	  victim.tasks.pop_front();
+	  return true;
+	}
+    }
+  return false;
+}
+
+void process_task(worker_t & w, state_ref_t ref, succ_container_t & succs_cont)
+{
+  appendix_t * app;
+
+  if (pool_phase == PHASE_ELIMI)
+    {
+      app = static_cast<appendix_t *>(st.app_by_ref(ref));
+      if (__atomic_load_n(&app->p, __ATOMIC_ACQUIRE) != 0)
+	return;
+      app->in_S = false;
+      w.Sdelta --;
+    }
+
+  state_t state = st.reconstruct(ref);
+  w.succs_calls++;
+  succs_cont.clear();
+  w.sys->get_succs(state,succs_cont);
+
+  for (succ_container_t::iterator i=succs_cont.begin(); i!=succs_cont.end(); i++)
+    {
+      state_t r = *i;
+      if (pool_phase == PHASE_FIRST)
+	w.trans++;
+
+      int dest = distributed.partition_function(r);
+      if (dest != distributed.network_id)
+	{
+	  outgoing_t out;
+	  out.dest = dest;
+	  out.state = r; //deleted by the main thread
+	  switch (pool_phase) {
+	  case PHASE_FIRST:
+	    w.transcross++;
+	    out.tag = TAG_SEND_STATE;
+	    out.parent.state_ref = ref;
+	    out.parent.network_id = distributed.network_id;
+	    break;
+	  case PHASE_REACH: out.tag = TAG_SEND_REACH; break;
+	  case PHASE_ELIMI: out.tag = TAG_SEND_ELIMI; break;
+	  case PHASE_RESET: out.tag = TAG_SEND_RESET; break;
+	  }
+	  w.outbox.push_back(out);
+	  continue;
+	}
+
+      state_ref_t r_ref;
+      switch (pool_phase) {
+      case PHASE_FIRST:
+	if (!st.is_stored_if_not_insert(r,r_ref)) //only one thread inserts r
+	  {
+	    appendix_t new_app;
+	    new_app.in_S = w.sys->is_accepting(r);
+	    new_app.p = 0;
+	    new_app.ample_set = 0;
+	    new_app.iteration = 0;
+	    new_app.parent.state_ref = ref;
+	    new_app.parent.network_id = distributed.network_id;
+	    new_app.max_pred_seed = NET_STATE_REF_NULL;
+	    st.set_app_by_ref(r_ref,new_app);
+	    if (new_app.in_S) //perform Reset together with first reachability
+	      {
+		w.Sdelta ++;
+		w.accepting.push_back(r_ref);
+	      }
+	    push_task(w,r_ref);
+	  }
+	break;
+      case PHASE_REACH:
+	st.is_stored(r,r_ref);
+	app = static_cast<appendix_t *>(st.app_by_ref(r_ref));
+	if (!__atomic_exchange_n(&app->in_S, true, __ATOMIC_ACQ_REL))
+	  {
+	    w.Sdelta ++;
+	    push_task(w,r_ref);
+	  }
+	__atomic_add_fetch(&app->p, 1, __ATOMIC_ACQ_REL);
+	break;
+      case PHASE_ELIMI:
+	st.is_stored(r,r_ref);
+	app = static_cast<appendix_t *>(st.app_by_ref(r_ref));
+	if (__atomic_sub_fetch(&app->p, 1, __ATOMIC_ACQ_REL) == 0)
+	  push_task(w,r_ref);
+	break;
+      case PHASE_RESET:
+	{
+	  st.is_stored(r,r_ref);
+	  app = static_cast<appendix_t *>(st.app_by_ref(r_ref));
+	  size_t old = __atomic_load_n(&app->iteration, __ATOMIC_ACQUIRE);
+	  bool claimed = false;
+	  while (old < iteration && !claimed)
+	    claimed = __atomic_compare_exchange_n(&app->iteration, &old, iteration, false,
+						  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	  if (claimed)
+	    {
+	      app->in_S = app->in_S && w.sys->is_accepting(r);
+	      app->p = 0;
+	      push_task(w,r_ref);
+	      if (app->in_S)
+		{
+		  w.Sdelta ++;
+		  w.accepting.push_back(r_ref);
+		}
+	    }
+	  break;
+	}
+      }
+      delete_state(r);
+    }
+  delete_state(state);
+  succs_cont.clear();
+}
+
+void work(size_t me)
+{
+  worker_t & w = *workers[me];
+  succ_container_t succs_cont(*w.sys);
+  state_ref_t ref;
+
+  while (pending.load() > 0)
+    {
+      if (pop_task(me,ref))
+	{
+	  process_task(w,ref,succs_cont);
+	  pending.fetch_sub(1);
+	}
+      else
+	this_thread::yield();
+    }
+}
+
+void worker_main(size_t me)
+{
+  //logging is done by the main thread
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGALRM);
+  pthread_sigmask(SIG_BLOCK, &signals, 0);
+
+  size_t round = 0;
+  for (;;)
+    {
+      {
+	unique_lock<mutex> lock(pool_mutex);
+	pool_start.wait(lock, [&]{ return pool_quit || pool_round != round; });
+	if (pool_quit)
+	  return;
+	round = pool_round;
+      }
+      work(me);
+      {
+	lock_guard<mutex> lock(pool_mutex);
+	if (--pool_running == 0)
+	  pool_finish.notify_one();
+      }
+    }
+}
+
+void start_workers()
+{
+  affine_explicit_system_t * p_affine_sys = dynamic_cast<affine_explicit_system_t *>(p_sys);
+  affine_graph_explicit_system_t * p_graph_sys = dynamic_cast<affine_graph_explicit_system_t *>(p_sys);
+  workers.push_back(new worker_t(p_sys));
+  for (size_t k=1; k<threads; k++)
+    if (p_graph_sys)
+      workers.push_back(new worker_t(new affine_graph_explicit_system_t(*p_graph_sys)));
+    else
+      workers.push_back(new worker_t(new affine_explicit_system_t(*p_affine_sys)));
+  for (size_t k=1; k<threads; k++)
+    worker_threads.push_back(thread(worker_main,k));
+}
+
+void stop_workers()
+{
+  {
+    lock_guard<mutex> lock(pool_mutex);
+    pool_quit = true;
+  }
+  pool_start.notify_all();
+  for (size_t k=0; k<worker_threads.size(); k++)
+    worker_threads[k].join();
+  for (size_t k=1; k<workers.size(); k++)
+    delete workers[k]->sys;
+  for (size_t k=0; k<workers.size(); k++)
+    delete workers[k];
+  workers.clear();
+}
+
+//processes all states of the given queue (and their descendants) by all workers
+void run_workers(phase_t phase, queue<state_ref_t> & seeds)
+{
+  for (size_t k=0; !seeds.empty(); k=(k+1) % threads)
+    {
+      push_task(*workers[k],seeds.front());
+      seeds.pop();
+    }
+
+  {
+    lock_guard<mutex> lock(pool_mutex);
+    pool_phase = phase;
+    pool_running = threads - 1;
+    pool_round++;
+  }
+  pool_start.notify_all();
+  work(0);
+  {
+    unique_lock<mutex> lock(pool_mutex);
+    pool_finish.wait(lock, []{ return pool_running == 0; });
+  }
+
+  for (size_t k=0; k<threads; k++)
+    {
+      worker_t & w = *workers[k];
+      Ssize += w.Sdelta;
+      trans += w.trans;
+      transcross += w.transcross;
+      succs_calls += w.succs_calls;
+      w.Sdelta = 0; w.trans = 0; w.transcross = 0; w.succs_calls = 0;
+      for (size_t j=0; j<w.accepting.size(); j++)
+	q_queue.push(w.accepting[j]);
+      w.accepting.clear();
+      for (size_t j=0; j<w.outbox.size(); j++)
+	{
+	  outgoing_t & out = w.outbox[j];
+	  if (out.tag == TAG_SEND_STATE)
+	    distributed.network.send_state(out.state, (char *)&out.parent,
+					   sizeof(net_state_ref_t), out.dest, out.tag);
+	  else
+	    distributed.network.send_state(out.state, 0, 0, out.dest, out.tag);
+	  delete_state(out.state);
+	}
+      w.outbox.clear();
+    }
+}
+
+//one phase of the algorithm in the hybrid mode
+void hybrid_phase(phase_t phase)
+{
+  while (!distributed.synchronized(info))
+    {
+      if (phase == PHASE_REACH)
+	{
+	  //states of q_queue are candidates for L_queue (see the sequential code)
+	  while (!q_queue.empty())
+	    {
+	      L_queue.push(q_queue.front());
+	      waiting_queue.push(q_queue.front());
+	      q_queue.pop();
+	    }
+	}
+
+      queue<state_ref_t> & seeds = (phase == PHASE_ELIMI ? L_queue : waiting_queue);
+      if (!seeds.empty())
+	run_workers(phase,seeds);
+      else
+	{
+#if defined(ORIG_FLUSH)
+	  distributed.network.flush_all_buffers();
+#else
+	  distributed.network.flush_some_buffers();
+#endif
+	  distributed.set_idle();
+	}
+      distributed.process_messages();
+    }
+}
+
+// }}}
+
 // {{{ functions for recovering counterexample
 
 void broadcast_candidate()
@@ -749,35 +1239,32 @@ void cycle_find()
 	  while (!(waiting_queue.empty()))
 	    {
 	      distributed.set_busy();
+	      state_ref = waiting_queue.front();
+	      waiting_queue.pop(); //visit2() may push more states after the cycle is recovered
 	      if (!end_of_iteration)
 		{
-		  state_ref = waiting_queue.front();
-		  waiting_queue.pop();
-		  if (!end_of_iteration)
-		    {
-		      current_state = st.reconstruct(state_ref);
-		      generate_successors(current_state, state_ref, all_enabled_trans, &succs);
-		      st.get_app_by_ref(state_ref,appendix);
+		  current_state = st.reconstruct(state_ref);
+		  generate_successors(current_state, state_ref, all_enabled_trans, &succs);
+		  st.get_app_by_ref(state_ref,appendix);
 		      
-		      for (std::size_t i = 0; i<succs.size(); i++)
-			{
-			  succ_state = succs[i];
+		  for (std::size_t i = 0; i<succs.size(); i++)
+		    {
+		      succ_state = succs[i];
 			  
-			  state_nid = distributed.get_state_net_id(succ_state);
-			  if (state_nid == distributed.network_id) //state is mine
-			    visit2(succ_state, state_ref, appendix.p,distributed.network_id);
-			  else //send the message to the owner of the state
-			    {
-			      send_ce_recovering(state_nid, &(succ_state),
-						 &(state_ref),
-						 &(distributed.network_id),
-						 &(appendix.p),
-						 TAG_VISIT2_STATE);
-			    }
-			  delete_state(succ_state);			  
+		      state_nid = distributed.get_state_net_id(succ_state);
+		      if (state_nid == distributed.network_id) //state is mine
+			visit2(succ_state, state_ref, appendix.p,distributed.network_id);
+		      else //send the message to the owner of the state
+			{
+			  send_ce_recovering(state_nid, &(succ_state),
+					     &(state_ref),
+					     &(distributed.network_id),
+					     &(appendix.p),
+					     TAG_VISIT2_STATE);
 			}
-		      delete_state(current_state);
+		      delete_state(succ_state);                       
 		    }
+		  delete_state(current_state);
 		}
 	    } //end of "while (!(waiting_queue.empty()))"
 	  distributed.network.flush_all_buffers();
@@ -1017,269 +1504,67 @@ void process_ce_path_state(state_ref_t _ref, size_t depth)
 }
 
 
-int main(int argc, char** argv) 
-{
+// {{{ phases of OWCTY
 
-  /* parsing switches ... */
-  distributed.network_initialize(argc, argv);  
+//generation of the state space reachable from the initial state together
+//with the first Reset (only synchronizes the restored states if resuming)
+void first_reachability(bool resume, bool print_statistics)
+{
+  state_t state;
+  state_ref_t ref;
+  succ_container_t succs_cont(*p_sys);
+  succ_container_t::iterator i;
 
-  int c;
-  size_t htsize=0;
-  bool produce_report=false;
-  bool print_statistics=false;
-  bool perform_logging=false;
-  bool base_name_is_set=false;
-  string set_base_name;
-  bool quiet = false;
-  bool trail = false;
-  bool show_ce = false;  
-  int compression=0;
+  state = p_sys->get_initial_state();
+  if (!resume && distributed.partition_function(state)==distributed.network_id)
+    {
+      st.insert(state,ref);
+      appendix.in_S = p_sys->is_accepting(state);
+      appendix.p = 0;
+      appendix.iteration = 0;
+      appendix.parent.state_ref.invalidate();
+      appendix.parent.network_id = -1;
+      appendix.ample_set = 0;
+      appendix.max_pred_seed.state_ref = succ_ref;
+      appendix.max_pred_seed.network_id = distributed.network_id;
+      st.set_app_by_ref(ref,appendix);
+      waiting_queue.push(ref);
+      distributed.set_busy();
+      if (appendix.in_S) //perform Reset together with first reachability
+		{
+		  Ssize ++;
+		  q_queue.push(ref);
+		}
+    }
+  delete_state(state);
+  
+  /* reachability (only synchronizes the restored states if resuming) */
   
-  bool fastApproximation = false;
 
+  if (distributed.network_id == 0 && print_statistics)
+    {
+	  cout <<"======================================="<<endl;
+	  if (resume)
+		cout <<"Resuming after iteration #"<<iteration<<" ..."<<flush;
+	  else
+		cout <<"Reachability & Reset ..."<<flush;
+    }
 
-  ostringstream oss,oss1;
-  oss1<<"owcty";
-  static struct option longopts[] = {
-    { "help",       no_argument, 0, 'h'},
-    { "quiet",      no_argument, 0, 'q'},
-    { "trail",      no_argument, 0, 't'},
-    { "report",     no_argument, 0, 'r'},
-    { "fast",		no_argument, 0, 'f'},
-    { "verbose",    no_argument, 0, 'V'},
-    { "log",        no_argument, 0, 'L'},
-    { "statelist",  no_argument, 0, 'c'},
-    { "simple",     no_argument, 0, 's'},
-    { "comp",       required_argument, 0, 'C' },
-    { "htsize",     required_argument, 0, 'H' },
-    { "basename",   required_argument, 0, 'X' },
-    { "version",    no_argument, 0, 'v'},
-    { NULL, 0, NULL, 0 }
-  };
-
-  while ((c = getopt_long(argc, argv, "cfshqtrvLC:X:H:VS", longopts, NULL)) != -1)
-    {
-      oss1 <<" -"<<(char)c;
-      switch (c) {
-      case 'h': usage();return 0; break;
-      case 'v': version();return 0; break;
-      case 'H': htsize=atoi(optarg); break;
-      case 'V':
-      case 'S': print_statistics = true; break;
-      case 'c': show_ce = true; break;
-      case 's': simple = true; break;
-      case 'f': fastApproximation = true; break;
-      case 'q': quiet = true; break;
-      case 'L': perform_logging = true; break;
-      case 'X': base_name_is_set = true; set_base_name = optarg; break;
-      case 'r': produce_report=true; break;
-      case 't': trail=true; break;
-      case 'C': compression = atoi(optarg); break;
-      case '?': cerr <<"unknown switch -"<<(char)optopt<<endl;
-      }
-    }  
-
-  if (quiet || simple)
-    {
-      print_statistics = false;
-    }
-
-  if (argc < optind+1)
-    {
-      usage();
-      return 0;
-    }
-
-  
-  /* decisions about the type of an input */
-  char * filename = argv[optind];
-  int filename_length = strlen(filename);
-  if (filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0)
-   {
-     if (distributed.network_id==NETWORK_ID_MANAGER && print_statistics)
-       {
-		 cout << "Reading affine system..." << endl;
-       }
-     input_file_ext = ".bio";
-     p_sys = new affine_explicit_system_t(gerr);
-   }
-
-  ce.set_system(p_sys);
-  
-  /* opening and parsing file ... */
-  string file_name;
-  int file_opening;
-  
-  clock_t start, finish;
-  double durationInSec = 0.0;
-  cout << "\tDURATION: " << durationInSec << "\n";
-
-  try
-    {
-    	start = clock();
-    
-		if ((file_opening=p_sys->read(argv[optind],fastApproximation))&&(distributed.network_id==NETWORK_ID_MANAGER))
-			{
-			
-		finish = clock();
-		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;
-		cout << "\tDURATION: " << durationInSec << "\n";
-			
-				if (file_opening==system_t::ERR_FILE_NOT_OPEN)
-					gerr << distributed.network_id << ": " << "Cannot open file ...";
-				else 
-					gerr << distributed.network_id << ": " << "Syntax error ...";
-			}
-			
-		finish = clock();
-		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;
-		cout << "\tDURATION: " << durationInSec << "\n";
-			
-		if (file_opening)
-			gerr << thr();
-    }
-  catch (ERR_throw_t & err)
-    { 
-		distributed.finalize();
-    	return err.id; 
-    }
-    
-
-  file_name = argv[optind];
-  int position = file_name.find(input_file_ext,0);
-  file_name.erase(position,4);
-  
-  if (p_sys->get_with_property() && p_sys->get_property_type()!=BUCHI)
-    {
-      if (distributed.network_id==NETWORK_ID_MANAGER) 
-		{
-		  cerr<<"Cannot work with other than standard Buchi accepting condition."<<endl;
-		}
-      distributed.finalize();
-      return 1;
-    }
-    
-  if ((!p_sys->get_with_property())&&(distributed.network_id==NETWORK_ID_MANAGER)&&(!simple))
-    {
-      cout << "Warning: No property included in model. Switched to simple mode." << endl;
-      simple=true;
-    }
-
-  /* initialization ... */
-  if (htsize != 0)
-    {
-      if (htsize < 33)
-		{
-		  int z = htsize;
-		  htsize = 1;
-		  for (;z>0; z--)
-			{
-			  htsize = 2* htsize;
-			}
-		}
-      st.set_ht_size(htsize);
-    }
-  
-  st.set_appendix(appendix);
-  if (compression >=0 && compression <=1)
-    {
-      if (compression == 0)
-        st.set_compression_method(NO_COMPRESS);
-      if (compression == 1)
-        st.set_compression_method(HUFFMAN_COMPRESS);
-    }
-  else
-    {
-      gerr<<"Invalid compression method. Allowed values: \n"
-	  <<"  -C0 for no compression,\n"
-	  <<"  -C1 for Huffman's compression with static codebook."<<thr();
-    }
-  st.init();
-
-  distributed.process_user_message = process_message;
-  distributed.initialize();
-  
-  if (produce_report)
-    {
-      reporter.set_info("InitTime", timer.gettime());
-      reporter.start_timer();
-    }
-
-  if (perform_logging)
-    {
-      logger.set_storage(&st);
-      logger.register_unsigned(log_wrapper1,"w_queue");
-      logger.register_unsigned(log_wrapper2,"q_queue");
-      logger.register_unsigned(log_wrapper3,"L_queue");
-      logger.register_unsigned(log_wrapper4,"all_qs");
-
-      if (base_name_is_set)
-		{
-		  logger.init(&distributed,set_base_name);
-		}
-      else
-		{
-		  logger.init(&distributed,file_name);
-		}
-      logger.use_SIGALRM(1);
-    }
-
-  state_t state;
-  state_ref_t ref;
-  succ_container_t succs_cont(*p_sys);
-  succ_container_t::iterator i;
- 
-
-  // ========================================================
-  // ========================================================
-  // ========================================================
-
-
-
-  state = p_sys->get_initial_state();
-  if (distributed.partition_function(state)==distributed.network_id)
-    {
-      st.insert(state,ref);
-      appendix.in_S = p_sys->is_accepting(state);
-      appendix.p = 0;
-      appendix.iteration = 0;
-      appendix.parent.state_ref.invalidate();
-      appendix.parent.network_id = -1;
-      appendix.ample_set = 0;
-      appendix.max_pred_seed.state_ref = succ_ref;
-      appendix.max_pred_seed.network_id = distributed.network_id;
-      st.set_app_by_ref(ref,appendix);
-      waiting_queue.push(ref);
-      distributed.set_busy();
-      if (appendix.in_S) //perform Reset together with first reachability
-		{
-		  Ssize ++;
-		  q_queue.push(ref);
-		}
-    }
-  delete_state(state);
-  
-  /* reachability */
-  
-
-  if (distributed.network_id == 0 && print_statistics)
-    {
-	  cout <<"======================================="<<endl;
-	  cout <<"Reachability & Reset ..."<<flush;
-    }
-
-
-  while (!distributed.synchronized(info))
-	{
-	  if (!waiting_queue.empty())
-		{
-		  ref = waiting_queue.front();
-		  waiting_queue.pop();
-		  
-		  state = st.reconstruct(ref);
-		  succs_calls++;
-		  succs_cont.clear();
-		  p_sys->get_succs(state,succs_cont);
+  DIVINE_PROFILE_BEGIN("FirstReachability");
+  if (threads > 1)
+    hybrid_phase(PHASE_FIRST);
+  else while (!distributed.synchronized(info))
+	{
+	  if (!waiting_queue.empty())
+		{
+		  ref = waiting_queue.front();
+		  waiting_queue.pop();
+		  
+		  state = st.reconstruct(ref);
+		  succs_calls++;
+		  succs_cont.clear();
+		  p_sys->get_succs(state,succs_cont);
+		  succ_cache.start(ref);
 
 		  for (i=succs_cont.begin(); i!=succs_cont.end(); i++)
 			{		
@@ -1291,12 +1576,10 @@ int main(int argc, char** argv)
 				  nref.state_ref = ref;
 				  nref.network_id = distributed.network_id;
 				  transcross++;
-				  message.rewind();
-				  message.append_state(r);
-				  message.append_data((byte_t *)&nref,sizeof(net_state_ref_t));
-				  distributed.network.send_message(message,
-								   distributed.partition_function(r),
-								   TAG_SEND_STATE);
+				  distributed.network.send_state(r, (char *)&nref, sizeof(net_state_ref_t),
+								 distributed.partition_function(r),
+								 TAG_SEND_STATE);
+				  succ_cache.add_remote(r, distributed.partition_function(r));
 				}
 			  else
 				{
@@ -1318,9 +1601,11 @@ int main(int argc, char** argv)
 						}
 					  waiting_queue.push(r_ref);
 					}
+				  succ_cache.add_local(r_ref);
 				}
 			  delete_state(r);
 			}
+		  succ_cache.finish();
 		  delete_state(state);
 		  succs_cont.clear();
 		}
@@ -1335,7 +1620,7 @@ int main(int argc, char** argv)
 		}
 	  distributed.process_messages();
 	}
-
+  DIVINE_PROFILE_END();
 
   if (distributed.network_id == 0 && print_statistics)
     {
@@ -1343,10 +1628,15 @@ int main(int argc, char** argv)
       cout <<"  Number of states in S: "<<info.data.allSsize<<endl;
       cout <<"  all memory:  "<<info.data.allmem/1024.0<<" MB"<<endl;
     }
+}
 
-  iteration = 0;    
-  
-  /* while */
+//iterations of Reachability, Elimination and Reset until S is stable
+void owcty_iterations(bool print_statistics, bool checkpoint, const string & checkpoint_base)
+{
+  state_ref_t ref;
+  state_t state;
+  vector<succ_cache_t::succ_t> stored_succs;
+  vector<succ_cache_t::succ_t>::iterator j;
 
   while (!simple && info.data.allSsize != oldSsize && info.data.allSsize >0)
     {
@@ -1362,11 +1652,14 @@ int main(int argc, char** argv)
 
       
       /* reachability */
+      DIVINE_PROFILE_BEGIN("Reachability");
       if (!q_queue.empty())
 		{
 		  distributed.set_busy();
 		}
-      while (!distributed.synchronized(info))
+      if (threads > 1)
+	hybrid_phase(PHASE_REACH);
+      else while (!distributed.synchronized(info))
 		{
 		  if (!waiting_queue.empty() || !q_queue.empty())
 			{
@@ -1387,25 +1680,19 @@ int main(int argc, char** argv)
 					}
 				}
 			  
-			  state = st.reconstruct(ref);
-			  succs_calls++;
-			  generate_successors(state, ref, all_enabled_trans, &succs_cont);
+			  get_stored_succs(ref, stored_succs);
 			  
-			  for (i=succs_cont.begin(); i!=succs_cont.end(); i++)
+			  for (j=stored_succs.begin(); j!=stored_succs.end(); j++)
 				{		
-				  state_t r = *i;	  
-				  if (distributed.partition_function(r)!=distributed.network_id)
+				  if (!j->is_local())
 					{
-					  message.rewind();
-					  message.append_state(r);
-					  distributed.network.send_message(message,
-								  distributed.partition_function(r),
-								  TAG_SEND_REACH);
+					  distributed.network.send_state(j->state, 0, 0,
+								j->network_id,
+								TAG_SEND_REACH);
 					}
 				  else
 					{
-					  state_ref_t r_ref;
-					  st.is_stored(r,r_ref);
+					  state_ref_t r_ref = j->ref;
 					  st.get_app_by_ref(r_ref,appendix);
 					  if (!appendix.in_S) 
 						{
@@ -1416,9 +1703,7 @@ int main(int argc, char** argv)
 					  appendix.p ++;
 					  st.set_app_by_ref(r_ref,appendix);		     
 					}
-				  delete_state(r);				      
 				}
-			  delete_state(state);
 			}
 		  else
 			{
@@ -1452,6 +1737,7 @@ int main(int argc, char** argv)
 		{
 		  distributed.process_messages();
 		}
+      DIVINE_PROFILE_END();
 
       if (distributed.network_id == 0 && print_statistics)
 		{	 
@@ -1463,12 +1749,15 @@ int main(int argc, char** argv)
 		}       
       
       /* elimination */
+      DIVINE_PROFILE_BEGIN("Elimination");
       if (!L_queue.empty())
 		{
 		  distributed.set_busy();
 		}
       
-      while (!distributed.synchronized(info))
+      if (threads > 1)
+	hybrid_phase(PHASE_ELIMI);
+      else while (!distributed.synchronized(info))
 		{
 		  if (!L_queue.empty())
 			{
@@ -1484,25 +1773,19 @@ int main(int argc, char** argv)
 			  st.set_app_by_ref(ref,appendix);
 			  Ssize --;
 			  
-			  state = st.reconstruct(ref);
-			  succs_calls++;
-			  generate_successors(state, ref, all_enabled_trans, &succs_cont);
+			  get_stored_succs(ref, stored_succs);
 
-			  for (i=succs_cont.begin(); i!=succs_cont.end(); i++)
+			  for (j=stored_succs.begin(); j!=stored_succs.end(); j++)
 				{		
-				  state_t r = *i;	  
-				  if (distributed.partition_function(r)!=distributed.network_id)
+				  if (!j->is_local())
 					{
-					  message.rewind();
-					  message.append_state(r);
-					  distributed.network.send_message(message,
-								  distributed.partition_function(r),
-								  TAG_SEND_ELIMI);
+					  distributed.network.send_state(j->state, 0, 0,
+								j->network_id,
+								TAG_SEND_ELIMI);
 					}
 				  else
 					{
-					  state_ref_t r_ref;
-					  st.is_stored(r,r_ref);
+					  state_ref_t r_ref = j->ref;
 					  st.get_app_by_ref(r_ref,appendix);		      
 					  appendix.p --;
 					  st.set_app_by_ref(r_ref,appendix);
@@ -1511,9 +1794,7 @@ int main(int argc, char** argv)
 						  L_queue.push(r_ref);
 						}
 					}
-				  delete_state(r);
 				}
-			  delete_state(state);	      
 			}
 		  else
 			{
@@ -1526,6 +1807,7 @@ int main(int argc, char** argv)
 			}
 		  distributed.process_messages();
 		}
+      DIVINE_PROFILE_END();
       
       if (distributed.network_id == 0 && print_statistics)
 		{	 
@@ -1543,6 +1825,7 @@ int main(int argc, char** argv)
 			}
 
 		  /* reset */
+		  DIVINE_PROFILE_BEGIN("Reset");
 		  Ssize = 0;
 		  
 		  state = p_sys->get_initial_state();
@@ -1564,34 +1847,31 @@ int main(int argc, char** argv)
 			}
 		  delete_state(state);
 		  
-		  while (!distributed.synchronized(info))
+		  if (threads > 1)
+		    hybrid_phase(PHASE_RESET);
+		  else while (!distributed.synchronized(info))
 			{
 			  if (!waiting_queue.empty())
 				{
 				  ref = waiting_queue.front();
 				  waiting_queue.pop();
-				  state = st.reconstruct(ref);
-				  succs_calls++;
-				  generate_successors(state, ref, all_enabled_trans, &succs_cont);
+				  get_stored_succs(ref, stored_succs);
 				  state_ref_t r_ref;
-				  for (i=succs_cont.begin(); i!=succs_cont.end(); i++)
+				  for (j=stored_succs.begin(); j!=stored_succs.end(); j++)
 					{		
-					  state_t r = *i;	  
-					  if (distributed.partition_function(r)!=distributed.network_id)
+					  if (!j->is_local())
 						{
-						  message.rewind();
-						  message.append_state(r);
-						  distributed.network.send_message(message,
-										   distributed.partition_function(r),
-										   TAG_SEND_RESET);
+						  distributed.network.send_state(j->state, 0, 0,
+										 j->network_id,
+										 TAG_SEND_RESET);
 						}
 					  else
 						{
-						  st.is_stored(r,r_ref);
+						  r_ref = j->ref;
 						  st.get_app_by_ref(r_ref,appendix);
 						  if (appendix.iteration < iteration)
 							{
-							  appendix.in_S = appendix.in_S && p_sys->is_accepting(r);
+							  appendix.in_S = appendix.in_S && is_accepting_ref(r_ref);
 							  appendix.iteration = iteration;
 							  appendix.p = 0;
 							  st.set_app_by_ref(r_ref,appendix);		     
@@ -1603,9 +1883,7 @@ int main(int argc, char** argv)
 								}
 							}
 						}
-					  delete_state(r);
 					}
-				  delete_state(state);
 				}
 			  else
 				{
@@ -1618,6 +1896,7 @@ int main(int argc, char** argv)
 				}
 			  distributed.process_messages();
 			}
+		  DIVINE_PROFILE_END();
 		  
 		  if (distributed.network_id == 0 && print_statistics)
 			{	 	  
@@ -1627,135 +1906,508 @@ int main(int argc, char** argv)
 			  cout <<"  all memory:  "<<info.data.allmem/1024.0<<" MB"<<endl;
 			}
 		} //end of "if (info.data.allSsize>0)"
+
+      if (checkpoint && info.data.allSsize != oldSsize && info.data.allSsize > 0)
+		{
+		  save_checkpoint(checkpoint_base);
+		}
     }
+}
 
-  if (perform_logging)
+//finds an accepting cycle in S and a path to it, writes them to
+//base.trail and base.ce_states
+void generate_counterexample(const string & base, bool trail, bool show_ce, bool print_statistics)
+{
+  if (distributed.network_id == 0 && print_statistics)
     {
-      logger.stop_SIGALRM();
-      logger.log_now();
+      cout <<"Generating counterexample ..."<<flush;
     }
 
+  //a counterexample of the previous property leaves them set
+  who_has_candidates = 0;
+  end_of_iteration = false;
 
-  /* printing statistics ... */
-  if (!quiet)
+  DIVINE_PROFILE_BEGIN("Counterexample");
+  cycle_find(); //detect an accepting state lying in in_S and on a cycle
+
+  //I own an initial state so I can start to find a path to a cycle
+  state_t s0 = p_sys->get_initial_state();
+  if (distributed.get_state_net_id(s0) == distributed.network_id)
     {
-      if (distributed.network_id == 0 && !quiet)
-		{
-		  if (!simple)
-			{
-			  cout <<"======================================="<<endl;	  
-	  	      if (info.data.allSsize !=0) 
-				{
-				  cout <<"       --- Accepting cycle ---"<<endl;
-				}     
-			  else
-				{
-				  cout <<"      --- No accepting cycle ---"<<endl;
-				}
-			  cout <<"======================================="<<endl;	  
-			}
-		}
+      appendix.p=0;
+      appendix.in_S=false;
+      st.is_stored(s0,state_ref);
+      st.set_app_by_ref(state_ref, appendix);
+      distributed.set_busy();
+      waiting_queue.push(state_ref);
     }
+  else
+    distributed.set_idle();
 
-  
-  /* counterexample generation */
-
-  if (info.data.allSsize!=0 && (trail || show_ce))
+  end_of_iteration = false; //it stands for end_of_path_recovering now
+  path_find();
+  DIVINE_PROFILE_END();
+  delete_state(s0);
+  //output
+  if (distributed.network_id == 0)
     {
-      if (distributed.network_id == 0 && print_statistics)
-		{
-		  cout <<"Generating counterexample ..."<<flush;
-		}
-      
-      cycle_find(); //detect an accepting state lying in in_S and on a cycle
+      path_t ce(p_sys);
+      if ((show_ce)||(trail))
+	{
+	  if (path_state[0]==path_state[1])
+	    {
+	      delete_state(path_state[1]);
+	      path_length--;
+	    }
+	  for (size_int_t i=0; i<path_length-1; i++)
+	    ce.push_back(path_state[i]);
+	  ce.push_back(cycle_state[0]);
+	  ce.mark_cycle_start_back();
+	  for (size_int_t i=1; i<cycle_length-1; i++)
+	    ce.push_back(cycle_state[i]);
+	  ofstream ce_out;
+	  string pom_fn;
+	  if (trail)
+	    {
+	      pom_fn = base+".trail";
+	      ce_out.open(pom_fn.c_str());
+	      if (!p_sys->can_system_transitions())
+		ce.write_states(ce_out);
+	      else
+		ce.write_trans(ce_out);
+	      ce_out.close();
+	    }
 
-      //I own an initial state so I can start to find a path to a cycle
-      state_t s0 = p_sys->get_initial_state();
-      if (distributed.get_state_net_id(s0) == distributed.network_id)
-		{
-		  appendix.p=0;
-		  appendix.in_S=false;
-		  st.is_stored(s0,state_ref);
-		  st.set_app_by_ref(state_ref, appendix);
-		  distributed.set_busy();
-		  waiting_queue.push(state_ref);
-		}
-      else
-		distributed.set_idle();
-      
-      end_of_iteration = false; //it stands for end_of_path_recovering now
-      path_find();
-      delete_state(s0);
-      //output
-      if (distributed.network_id == 0)
+	  if (show_ce)
+	    {
+	      pom_fn = base+".ce_states";
+	      ce_out.open(pom_fn.c_str());
+	      ce.write_states(ce_out);
+	      ce_out.close();
+	    }
+	  ce.erase();
+	}
+
+      //deleting allocated memory
+      for (size_t i=0; i<cycle_length; i++)
+	delete_state(cycle_state[i]);
+      delete[] cycle_state;
+      for (size_t i=0; i<path_length; i++)
+	delete_state(path_state[i]);
+      delete[] path_state;
+    }
+
+  if (distributed.network_id == 0 && print_statistics)
+    {
+      cout <<" done."<<endl;
+      cout <<"---------------------------------------"<<endl;
+    }
+}
+
+// }}}
+
+
+int main(int argc, char** argv) 
+{
+
+  /* parsing switches ... */
+  distributed.network_initialize(argc, argv);  
+
+  int c;
+  size_t htsize=0;
+  bool produce_report=false;
+  bool print_statistics=false;
+  bool perform_logging=false;
+  bool base_name_is_set=false;
+  string set_base_name;
+  bool quiet = false;
+  bool trail = false;
+  bool show_ce = false;  
+  int compression=0;
+  bool open_hashing = false;
+  size_t vertex_cache_size = DEFAULT_VERTEX_CACHE_SIZE;
+  size_t succ_cache_mb = 0;
+  bool checkpoint = false;
+  bool resume = false;
+  string partition_spec;
+  partitioner_t * p_partitioner = 0;
+  string graph_file;
+  
+  bool fastApproximation = false;
+
+
+  ostringstream oss,oss1;
+  oss1<<"owcty";
+  static struct option longopts[] = {
+    { "help",       no_argument, 0, 'h'},
+    { "quiet",      no_argument, 0, 'q'},
+    { "trail",      no_argument, 0, 't'},
+    { "report",     no_argument, 0, 'r'},
+    { "fast",		no_argument, 0, 'f'},
+    { "verbose",    no_argument, 0, 'V'},
+    { "log",        no_argument, 0, 'L'},
+    { "statelist",  no_argument, 0, 'c'},
+    { "simple",     no_argument, 0, 's'},
+    { "comp",       required_argument, 0, 'C' },
+    { "htsize",     required_argument, 0, 'H' },
+    { "openhash",   no_argument, 0, 'O' },
+    { "vcache",     required_argument, 0, 'K' },
+    { "succcache",  required_argument, 0, 'M' },
+    { "threads",    required_argument, 0, 'T' },
+    { "partition",  required_argument, 0, 'P' },
+    { "basename",   required_argument, 0, 'X' },
+    { "checkpoint", no_argument, 0, 'k' },
+    { "resume",     no_argument, 0, 'u' },
+    { "graph",      required_argument, 0, 'G' },
+    { "version",    no_argument, 0, 'v'},
+    { NULL, 0, NULL, 0 }
+  };
+
+  while ((c = getopt_long(argc, argv, "cfshqtrvkuLOC:X:G:H:K:M:T:P:VS", longopts, NULL)) != -1)
+    {
+      oss1 <<" -"<<(char)c;
+      switch (c) {
+      case 'h': usage();return 0; break;
+      case 'v': version();return 0; break;
+      case 'H': htsize=atoi(optarg); break;
+      case 'O': open_hashing = true; break;
+      case 'K': vertex_cache_size=atoi(optarg); break;
+      case 'M': succ_cache_mb=atoi(optarg); break;
+      case 'T': threads=atoi(optarg); break;
+      case 'P': partition_spec = optarg; break;
+      case 'V':
+      case 'S': print_statistics = true; break;
+      case 'c': show_ce = true; break;
+      case 's': simple = true; break;
+      case 'f': fastApproximation = true; break;
+      case 'q': quiet = true; break;
+      case 'L': perform_logging = true; break;
+      case 'k': checkpoint = true; break;
+      case 'u': resume = true; break;
+      case 'G': graph_file = optarg; break;
+      case 'X': base_name_is_set = true; set_base_name = optarg; break;
+      case 'r': produce_report=true; break;
+      case 't': trail=true; break;
+      case 'C': compression = atoi(optarg); break;
+      case '?': cerr <<"unknown switch -"<<(char)optopt<<endl;
+      }
+    }  
+
+  if (quiet || simple)
+    {
+      print_statistics = false;
+    }
+
+  if (argc < optind+1)
+    {
+      usage();
+      return 0;
+    }
+
+  
+  /* decisions about the type of an input */
+  char * filename = argv[optind];
+  int filename_length = strlen(filename);
+  if (filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0)
+    input_file_ext = ".bio";
+  else if (filename_length>=5 && strcmp(filename+filename_length-5,".cbio")==0)
+    input_file_ext = ".cbio"; //compiled model (see divine.compile_bio)
+  if (input_file_ext)
+   {
+     if (distributed.network_id==NETWORK_ID_MANAGER && print_statistics)
+       {
+		 cout << "Reading affine system..." << endl;
+       }
+     affine_explicit_system_t * p_affine_sys;
+     if (graph_file.empty())
+       p_affine_sys = new affine_explicit_system_t(gerr);
+     else //successors are read from the precomputed state graph
+       p_affine_sys = new affine_graph_explicit_system_t(gerr, graph_file);
+     p_affine_sys->set_vertex_cache_size(vertex_cache_size);
+     p_sys = p_affine_sys;
+   }
+
+  ce.set_system(p_sys);
+  
+  /* opening and parsing file ... */
+  string file_name;
+  int file_opening;
+  
+  clock_t start, finish;
+  double durationInSec = 0.0;
+  cout << "\tDURATION: " << durationInSec << "\n";
+
+  try
+    {
+    	start = clock();
+    
+		if ((file_opening=p_sys->read(argv[optind],fastApproximation))&&(distributed.network_id==NETWORK_ID_MANAGER))
+			{
+			
+		finish = clock();
+		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;
+		cout << "\tDURATION: " << durationInSec << "\n";
+			
+				if (file_opening==system_t::ERR_FILE_NOT_OPEN)
+					gerr << distributed.network_id << ": " << "Cannot open file ...";
+				else 
+					gerr << distributed.network_id << ": " << "Syntax error ...";
+			}
+			
+		finish = clock();
+		durationInSec = (double)(finish - start) / CLOCKS_PER_SEC;
+		cout << "\tDURATION: " << durationInSec << "\n";
+			
+		if (file_opening)
+			gerr << thr();
+
+		for (int k=optind+1; k<argc; k++) //the other properties of the same model
+			{
+			  affine_system_t * p_affine_sys = dynamic_cast<affine_system_t *>(p_sys);
+			  if (!p_affine_sys)
+				gerr << "More input files need an affine system" << thr();
+			  p_affine_sys->add_property(argv[k]);
+			}
+    }
+  catch (ERR_throw_t & err)
+    { 
+		distributed.finalize();
+    	return err.id; 
+    }
+    
+
+  file_name = argv[optind];
+  int position = file_name.find(input_file_ext,0);
+  file_name.erase(position,strlen(input_file_ext));
+  
+  if (p_sys->get_with_property() && p_sys->get_property_type()!=BUCHI)
+    {
+      if (distributed.network_id==NETWORK_ID_MANAGER) 
+		{
+		  cerr<<"Cannot work with other than standard Buchi accepting condition."<<endl;
+		}
+      distributed.finalize();
+      return 1;
+    }
+    
+  if ((!p_sys->get_with_property())&&(distributed.network_id==NETWORK_ID_MANAGER)&&(!simple))
+    {
+      cout << "Warning: No property included in model. Switched to simple mode." << endl;
+      simple=true;
+    }
+
+  /* initialization ... */
+  if (htsize != 0)
+    {
+      if (htsize < 33)
 		{
-		  path_t ce(p_sys);
-		  ofstream ce_out;
-		  string pom_fn;
-		  if ((show_ce)||(trail))
+		  int z = htsize;
+		  htsize = 1;
+		  for (;z>0; z--)
 			{
-			  if (path_state[0]==path_state[1])
-				{
-				  delete_state(path_state[1]);
-				  path_length--;
-				}
-			  for (size_int_t i=0; i<path_length-1; i++)
-				ce.push_back(path_state[i]);
-			  ce.push_back(cycle_state[0]);
-			  ce.mark_cycle_start_back();
-			  for (size_int_t i=1; i<cycle_length-1; i++)
-				ce.push_back(cycle_state[i]);
-			  ofstream ce_out;
-			  string pom_fn;
-			  if (trail)
-				{
-				  if (base_name_is_set)
-					{
-					  pom_fn = set_base_name+".trail";
-					}
-				  else
-					{
-					  pom_fn = file_name+".trail";
-					}
-				  ce_out.open(pom_fn.c_str());
-				  if (!p_sys->can_system_transitions())
-					ce.write_states(ce_out);
-				  else
-					ce.write_trans(ce_out);
-				  ce_out.close();
-				}
-			  
-			  if (show_ce)
-				{
-				  if (base_name_is_set)
-					{
-					  pom_fn = set_base_name+".ce_states";
-					}
-				  else
-					{
-					  pom_fn = file_name+".ce_states";
-					}
-				  ce_out.open(pom_fn.c_str());
-				  ce.write_states(ce_out);
-				  ce_out.close();
-				}
-			  ce.erase();
+			  htsize = 2* htsize;
 			}
-		  
-		  //deleting allocated memory
-		  for (size_t i=0; i<cycle_length; i++)
-			delete_state(cycle_state[i]);
-		  delete[] cycle_state;
-		  for (size_t i=0; i<path_length; i++)
-			delete_state(path_state[i]);
-		  delete[] path_state;
 		}
+      st.set_ht_size(htsize);
+    }
+  if (threads == 0)
+    threads = 1;
+  if ((checkpoint || resume) && (open_hashing || threads > 1))
+    {
+      if (distributed.network_id==NETWORK_ID_MANAGER)
+		{
+		  cerr<<"Checkpoints cannot be used with -O and -T."<<endl;
+		}
+      distributed.finalize();
+      return 1;
+    }
+  if ((checkpoint || resume) && argc > optind+1)
+    {
+      if (distributed.network_id==NETWORK_ID_MANAGER)
+		{
+		  cerr<<"Checkpoints cannot be used with more input files."<<endl;
+		}
+      distributed.finalize();
+      return 1;
+    }
+  if (!graph_file.empty() && argc > optind+1)
+    {
+      if (distributed.network_id==NETWORK_ID_MANAGER)
+		{
+		  cerr<<"A state graph holds one property, it cannot be used with more input files."<<endl;
+		}
+      distributed.finalize();
+      return 1;
+    }
+  if (open_hashing || threads > 1)
+    st.set_hashing_method(OPEN_ADDRESSING);
+  if (threads > 1)
+    st.set_shared(true);
+  
+  st.set_appendix(appendix);
+  affine_system_t * p_affine_sys = dynamic_cast<affine_system_t *>(p_sys);
+  if ((compression >=0 && compression <=1) || (compression == 2 && p_affine_sys))
+    {
+      if (compression == 0)
+        st.set_compression_method(NO_COMPRESS);
+      if (compression == 1)
+        st.set_compression_method(HUFFMAN_COMPRESS);
+      if (compression == 2)
+        {
+          st.set_compression_method(RADIX_COMPRESS);
+          st.set_compression_fields(p_affine_sys->state_layout.get_max_values());
+        }
+    }
+  else
+    {
+      gerr<<"Invalid compression method. Allowed values: \n"
+	  <<"  -C0 for no compression,\n"
+	  <<"  -C1 for Huffman's compression with static codebook,\n"
+	  <<"  -C2 for mixed radix packing (affine systems only)."<<thr();
+    }
+  if (!partition_spec.empty())
+    {
+      try
+		{
+		  affine_explicit_system_t * p_affine_sys = dynamic_cast<affine_explicit_system_t *>(p_sys);
+		  if (!p_affine_sys)
+			gerr << "Partition functions other than hash need an affine system" << thr();
+		  p_partitioner = new affine_partitioner_t(*p_affine_sys, partition_spec, distributed.cluster_size);
+		}
+      catch (ERR_throw_t & err)
+		{
+		  distributed.finalize();
+		  return err.id;
+		}
+      distributed.set_partitioner(p_partitioner);
+    }
 
-      if (distributed.network_id == 0 && print_statistics)
+  if (threads == 1 && !simple) //the successors are used only by the iterations
+    {
+      succ_cache.set_mem_limit(succ_cache_mb*1024*1024);
+      st.set_succ_cache(&succ_cache);
+    }
+  st.init();
+  if (threads > 1)
+    start_workers();
+
+  distributed.process_user_message = process_message;
+  distributed.initialize();
+
+  string checkpoint_base = (base_name_is_set ? set_base_name : file_name);
+  if (resume)
+    {
+      try
 		{
-		  cout <<" done."<<endl;
-		  cout <<"---------------------------------------"<<endl;
-		}     
+		  load_checkpoint(checkpoint_base);
+		}
+      catch (ERR_throw_t & err)
+		{
+		  distributed.finalize();
+		  return err.id;
+		}
+    }
+  
+  if (produce_report)
+    {
+      reporter.set_info("InitTime", timer.gettime());
+      reporter.start_timer();
+    }
+
+  if (perform_logging)
+    {
+      logger.set_storage(&st);
+      logger.register_unsigned(log_wrapper1,"w_queue");
+      logger.register_unsigned(log_wrapper2,"q_queue");
+      logger.register_unsigned(log_wrapper3,"L_queue");
+      logger.register_unsigned(log_wrapper4,"all_qs");
+
+      if (base_name_is_set)
+		{
+		  logger.init(&distributed,set_base_name);
+		}
+      else
+		{
+		  logger.init(&distributed,file_name);
+		}
+      logger.use_SIGALRM(1);
+    }
+
+  state_t state;
+ 
+
+  // ========================================================
+  // ========================================================
+  // ========================================================
+
+
+
+
+  size_t property_count = max(p_affine_sys->get_property_count(), size_t(1)); //none in simple mode
+  vector<bool> cycle_found(property_count, false);
+  for (size_t property=0; property<property_count; property++)
+    {
+      if (property > 0) //the next product is stored next to the previous ones
+	{
+	  p_affine_sys->select_property(property);
+	  Ssize = 0;
+	  oldSsize = 0;
+	  while (!q_queue.empty())
+	    q_queue.pop();
+	}
+
+      first_reachability(resume, print_statistics);
+
+      if (!resume)
+	{
+	  iteration = 0;    
+	  if (checkpoint && !simple)
+	    save_checkpoint(checkpoint_base);
+	}
+  
+      /* while */
+
+      owcty_iterations(print_statistics, checkpoint, checkpoint_base);
+      cycle_found[property] = (info.data.allSsize != 0);
+
+      /* printing statistics ... */
+      if (!quiet && distributed.network_id == 0 && !simple)
+	{
+	  cout <<"======================================="<<endl;	  
+	  if (property_count > 1)
+	    cout <<"  Property #"<<property+1<<" ("<<argv[optind+property]<<")"<<endl;
+	  if (cycle_found[property])
+	    cout <<"       --- Accepting cycle ---"<<endl;
+	  else
+	    cout <<"      --- No accepting cycle ---"<<endl;
+	  cout <<"======================================="<<endl;	  
+	}
+
+      /* counterexample generation */
+      if (cycle_found[property] && (trail || show_ce))
+	{
+	  string ce_base = (base_name_is_set ? set_base_name : file_name);
+	  if (property_count > 1)
+	    {
+	      ostringstream prop_base;
+	      if (base_name_is_set)
+		prop_base << set_base_name << ".prop" << property+1;
+	      else
+		{
+		  string pom_fn = argv[optind+property];
+		  pom_fn.erase(pom_fn.find(input_file_ext,0),strlen(input_file_ext));
+		  prop_base << pom_fn;
+		}
+	      ce_base = prop_base.str();
+	    }
+	  generate_counterexample(ce_base, trail, show_ce, print_statistics);
+	}
+    }
+
+  if (perform_logging)
+    {
+      logger.stop_SIGALRM();
+      logger.log_now();
     }
 
   if (!quiet && distributed.network_id==0)
@@ -1772,7 +2424,10 @@ int main(int argc, char** argv)
       if (htsize != 0)
 		cout <<"hashtable size:\t\t"<<htsize<<endl;
 		
+      cout <<"partition function:\t"<<distributed.get_partitioner_name()<<endl;
       cout <<"cross transitions:\t"<<info.data.allcross<<endl;
+      if (info.data.alltrans)
+		cout <<"cross ratio:\t\t"<<double(info.data.allcross)/info.data.alltrans<<endl;
       cout <<"all memory:\t\t"<<info.data.allmem/1024.0<<" MB"<<endl;
       cout <<"time:\t\t\t"<<timer.gettime()<<" s"<<endl;
       cout <<"------------------------"<<endl;
@@ -1812,27 +2467,49 @@ int main(int argc, char** argv)
       reporter.set_info("States", st.get_states_stored());
       reporter.set_info("Trans", trans);
       reporter.set_info("CrossTrans", transcross);      
+      reporter.set_info("SyncRounds", distributed.get_all_sync_rounds_cnt());
+      reporter.set_info("SyncTime", distributed.get_all_sync_rounds_time());
+      if (affine_system_t * p_affine_sys = dynamic_cast<affine_system_t *>(p_sys))
+		{
+		  size_t hits = p_affine_sys->get_vertex_cache_hits();
+		  size_t misses = p_affine_sys->get_vertex_cache_misses();
+		  for (size_t k=1; k<workers.size(); k++) //copies of the system used by worker threads
+			{
+			  affine_system_t * p_worker_sys = dynamic_cast<affine_system_t *>(workers[k]->sys);
+			  hits += p_worker_sys->get_vertex_cache_hits();
+			  misses += p_worker_sys->get_vertex_cache_misses();
+			}
+		  reporter.set_info("VCacheHits", hits, REPORTER_SUM);
+		  reporter.set_info("VCacheMisses", misses, REPORTER_SUM);
+		}
+      if (succ_cache.enabled())
+		{
+		  reporter.set_info("SCacheHits", succ_cache.get_hits(), REPORTER_SUM);
+		  reporter.set_info("SCacheMisses", succ_cache.get_misses(), REPORTER_SUM);
+		}
+      reporter.set_profile_info();
 
       if (distributed.network_id==0) //set global information to reporter
 		{
+		  reporter.set_global_info("Partition", distributed.get_partitioner_name());
+		  if (info.data.alltrans)
+			reporter.set_global_info("CrossRatio", double(info.data.allcross)/info.data.alltrans);
 		  if (!simple)
 			{
 
-			  if (info.data.allSsize!=0)
+			  string is_valid, ce_generated; //one value for each property
+			  for (size_t k=0; k<property_count; k++)
 				{
-				  reporter.set_global_info("IsValid", "No");
-				  if (info.data.allSsize!=0 && (trail || show_ce))
+				  if (k>0)
 					{
-					  reporter.set_global_info("CEGenerated", "Yes");
+					  is_valid += " ";
+					  ce_generated += " ";
 					}
-				  else
-					reporter.set_global_info("CEGenerated", "No");
-				}
-			  else
-				{
-				  reporter.set_global_info("IsValid", "Yes");
-				  reporter.set_global_info("CEGenerated", "No");
+				  is_valid += (cycle_found[k] ? "No" : "Yes");
+				  ce_generated += (cycle_found[k] && (trail || show_ce) ? "Yes" : "No");
 				}
+			  reporter.set_global_info("IsValid", is_valid);
+			  reporter.set_global_info("CEGenerated", ce_generated);
 			}
 		}
       
@@ -1843,6 +2520,15 @@ int main(int argc, char** argv)
 		}
     }
   
+#if defined(DIVINE_PROFILE)
+  profiler.write_trace_file(checkpoint_base, distributed.network_id);
+  if (distributed.network_id == 0 && !quiet)
+    profiler.write_summary(cout);
+#endif
+
+  if (threads > 1)
+    stop_workers();
+  delete p_partitioner;
   delete p_sys;
   distributed.finalize();
   return 0;
@@ -4,23 +4,18 @@
 #include <queue>
 #include <stack>
 #include "divine.h"
+#include "predecessors.hh"
 
 using namespace std;
 using namespace divine;
 
-typedef struct net_state_ref_t
-{
-  state_ref_t state_ref;
-  int network_id; 
-};
-
 typedef struct appendix_t 
 {
   short int remains;
   unsigned short int visited;
   unsigned short int inset;
   bool is_accepting;
-  array_t<net_state_ref_t> *predecessors;
+  predecessors_t::id_t id;
 };
 
 const int TAG_SEND_STATE = DIVINE_TAG_USER +0;
@@ -50,6 +45,7 @@ message_t message;
 message_t received_message;
 
 appendix_t appendix;
+predecessors_t predecessors;
 queue<state_ref_t> waiting_queue;
 queue<state_ref_t> backtracking_queue;
 queue<state_ref_t> marking_queue;
@@ -67,6 +63,8 @@ size_t visited = 0;
 size_t marked=0,oldmarked=0;
 unsigned short int iteration=1;
 
+snapshot_t resumed_snapshot; //holds the states restored by load_checkpoint()
+
 
 unsigned log_wrapper1()
 {
@@ -84,6 +82,7 @@ struct info_t {
   size_t allmarked;
   size_t allmarking_queues;
   virtual void update();
+  void merge(const info_t &other);
   virtual ~info_t() {}
 };
 
@@ -113,6 +112,18 @@ void info_t::update()
     }
 }
 
+void info_t::merge(const info_t &other)
+{
+  allstored += other.allstored;
+  allstates += other.allstates;
+  alltrans += other.alltrans;
+  allcross += other.allcross;
+  allmem += other.allmem;
+  alleliminated += other.alleliminated;
+  allmarked += other.allmarked;
+  allmarking_queues += other.allmarking_queues;
+}
+
 updateable_info_t<info_t> info;
 
 
@@ -120,14 +131,13 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 {
   state_t state_received;
   state_ref_t ref;
-  net_state_ref_t net_ref_received;
+  predecessors_t::id_t id_received;
   
   switch (tag) {
   case TAG_SEND_STATE:
-    received_message.load_data((byte_t*)buf,size);
-    received_message.read_state(state_received);
-    received_message.read_state_ref(net_ref_received.state_ref);
-    net_ref_received.network_id = src;
+    memcpy(&id_received,
+	   message_t::read_state_in_place((byte_t*)buf,state_received),
+	   sizeof(predecessors_t::id_t));
 			 
     if (!st.is_stored(state_received,ref))  //very first iteration
       {
@@ -136,7 +146,7 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	appendix.visited = 0;
 	if (!simple)
 	  {
-	    appendix.predecessors = new array_t<net_state_ref_t>(1,1);
+	    appendix.id = predecessors.add_state(ref);
 	    if (sys->is_accepting(state_received))
 	      {
 		appendix.is_accepting = true;
@@ -154,8 +164,8 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 
     if (appendix.inset != iteration)
       {
- 	distributed.network.send_message((char *)(&(net_ref_received.state_ref)),
-				    sizeof(state_ref_t),
+ 	distributed.network.send_message((char *)(&id_received),
+				    sizeof(predecessors_t::id_t),
 				    src,
 				    TAG_BACK_PROPAGATE);
       }
@@ -167,12 +177,12 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	      {
 		if (appendix.remains != 0)
 		  {
-		    appendix.predecessors->push_back(net_ref_received);
+		    predecessors.push(appendix.id, id_received, src);
 		  }
 		else
 		  {
-		    distributed.network.send_message((char *)(&(net_ref_received.state_ref)),
-						sizeof(state_ref_t),
+		    distributed.network.send_message((char *)(&id_received),
+						sizeof(predecessors_t::id_t),
 						src,
 						TAG_BACK_PROPAGATE);
 		  }
@@ -184,8 +194,8 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	    appendix.visited = iteration;
 	    if (!simple)
 	      {
-		appendix.predecessors->clear();
-		appendix.predecessors->push_back(net_ref_received);
+		predecessors.clear(appendix.id);
+		predecessors.push(appendix.id, id_received, src);
 		appendix.remains = -1; // this will be redefined
 		if (appendix.is_accepting && !simple)
 		  {
@@ -197,10 +207,10 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
 	    distributed.set_busy();
 	  }
       }
-    delete_state(state_received);
     break;
   case TAG_BACK_PROPAGATE:
-    memcpy(&ref,buf,sizeof(state_ref_t));
+    memcpy(&id_received,buf,sizeof(predecessors_t::id_t));
+    ref = predecessors.get_ref(id_received);
     st.get_app_by_ref(ref,appendix);
     if (appendix.remains != 0)
       {
@@ -214,7 +224,8 @@ void process_message(char *buf, int size, int src, int tag, bool urgent)
       }
     break;    
   case TAG_BACK_MARK:
-    memcpy(&ref,buf,sizeof(state_ref_t));
+    memcpy(&id_received,buf,sizeof(predecessors_t::id_t));
+    ref = predecessors.get_ref(id_received);
     st.get_app_by_ref(ref,appendix);
     if (appendix.inset == iteration && appendix.remains >0)
       {
@@ -299,19 +310,92 @@ void usage()
   cout <<" -v,--version\t\tshow version"<<endl;
   cout <<" -h,--help\t\tshow this help"<<endl;
   cout <<" -H x,--htsize x\tset the size of hash table to ( x<33 ? 2^x : x )"<<endl;
+  cout <<" -O,--openhash\t\tuse open addressing hash table (grows on the fly)"<<endl;
+  cout <<" -P p,--partition p\tpartition states among workstations by p (affine systems only)"<<endl;
+  cout <<"\t\t\t(slab[:x] or block[:x,y,...], optionally followed by @n"<<endl;
+  cout <<"\t\t\tto balance the parts by the first n states; default = hash)"<<endl;
   cout <<" -V,--verbose\t\tprint some statistics"<<endl;
   cout <<" -q,--quiet\t\tquite mode"<<endl;
   cout <<" -c, --statelist \t show counterexample states"<<endl;
   cout <<" -t,--trail\t\tproduce trail file"<<endl;
   cout <<" -f, --fast\t\tuse faster but less accurate algorithm for abstraction" << endl;
   cout <<" -r,--report\t\tproduce report file"<<endl;
-  cout <<" -R,--remove\t\tremoves transitions while backpropagating (very slow, saves memory)"
+  cout <<" -R,--remove\t\tremoves transitions while backpropagating (always done,"
        <<endl;
+  cout <<"\t\t\tthe switch is kept for compatibility)"<<endl;
   cout <<" -s,--simple\t\tperform simple reachability only"<<endl;
   cout <<" -L,--log\t\tproduce logfiles (log period is 1 second)"<<endl;
+  cout <<" -k,--checkpoint\tsave a checkpoint after every iteration to w.ckpt.N"<<endl;
+  cout <<" -u,--resume\t\tresume the computation from the checkpoint w.ckpt.N"<<endl;
+  cout <<"\t\t\t(-k and -u do not work with -O)"<<endl;
+  cout <<" -G f,--graph f\texplore the state graph f written by divine.generator -b"<<endl;
+  cout <<"\t\t\tinstead of computing successors (the input file has to be"<<endl;
+  cout <<"\t\t\tthe model the graph was generated from)"<<endl;
   cout <<" -X w\t\t\tsets base name of produced files to w (w.trail,w.report,w.00-w.N)"<<endl;
 }
 
+string checkpoint_file(const string & base)
+{
+  ostringstream oss;
+  oss << base << ".ckpt." << distributed.network_id;
+  return oss.str();
+}
+
+//saves the computation between two iterations (all workstations are
+//synchronized and all queues are empty, predecessors are generated again
+//in every iteration, only the ids of states are kept)
+void save_checkpoint(const string & base)
+{
+  snapshot_t snapshot;
+  snapshot.create(checkpoint_file(base));
+  snapshot.write_value(iteration);
+  snapshot.write_value(trans);
+  snapshot.write_value(transcross);
+  snapshot.write_value(succs_calls);
+  snapshot.write_value(preds_calls);
+  snapshot.write_vector(predecessors.get_refs());
+  snapshot.align();
+  st.save_snapshot(snapshot);
+  //the previous checkpoint is replaced only when all the new ones are written
+  distributed.network.barrier();
+  snapshot.commit();
+}
+
+//restores the computation saved by save_checkpoint(), the states are
+//mapped from the checkpoint file instead of being inserted again
+void load_checkpoint(const string & base)
+{
+  size_t loaded_iteration = 0;
+  try
+    {
+      vector<state_ref_t> refs;
+      resumed_snapshot.map(checkpoint_file(base));
+      resumed_snapshot.read_value(iteration);
+      resumed_snapshot.read_value(trans);
+      resumed_snapshot.read_value(transcross);
+      resumed_snapshot.read_value(succs_calls);
+      resumed_snapshot.read_value(preds_calls);
+      resumed_snapshot.read_vector(refs);
+      resumed_snapshot.skip_align();
+      for (size_t k=0; k<refs.size(); k++)
+	predecessors.add_state(refs[k]);
+      st.load_snapshot(resumed_snapshot);
+      loaded_iteration = iteration;
+    }
+  catch (ERR_throw_t & err)
+    {
+      //reported below on all workstations
+    }
+
+  //a run killed while replacing the checkpoints leaves some of them older
+  vector<size_t> iterations(distributed.cluster_size);
+  distributed.network.all_gather((char *)&loaded_iteration, sizeof(size_t),
+				 (char *)&iterations[0], sizeof(size_t));
+  for (int k=0; k<distributed.cluster_size; k++)
+    if (iterations[k] == 0 || iterations[k] != iterations[0])
+      gerr << "Cannot resume from the checkpoints " << base << ".ckpt.*" << thr();
+}
+
 
 int main(int argc, char** argv) 
 {
@@ -324,11 +408,16 @@ int main(int argc, char** argv)
   bool print_statistics=false;
   bool perform_logging=false;
   bool base_name_is_set=false;
-  bool remove_trans=false;
+  bool open_hashing=false;
   string set_base_name;
   bool quiet = false;
   bool trail = false;
   bool show_ce = false;
+  bool checkpoint = false;
+  bool resume = false;
+  string partition_spec;
+  partitioner_t * p_partitioner = 0;
+  string graph_file;
 
 	bool fastApproximation = false;
 
@@ -345,21 +434,28 @@ int main(int argc, char** argv)
     { "simple",     no_argument, 0, 's'},
     { "statelist",  no_argument, 0, 'c'},
     { "htsize",     required_argument, 0, 'H' },
+    { "openhash",   no_argument, 0, 'O' },
+    { "partition",  required_argument, 0, 'P' },
     { "basename",   required_argument, 0, 'X' },
+    { "checkpoint", no_argument, 0, 'k' },
+    { "resume",     no_argument, 0, 'u' },
+    { "graph",      required_argument, 0, 'G' },
     { "version",    no_argument, 0, 'v'},
     { NULL, 0, NULL, 0 }
   };
 
   ostringstream oss,oss1;
   oss1<<"owcty_reversed";
-  while ((c = getopt_long(argc, argv, "csfRhqtrvLX:H:VS", longopts, NULL)) != -1)
+  while ((c = getopt_long(argc, argv, "csfRhqtrvkuLOX:G:H:P:VS", longopts, NULL)) != -1)
     {
       oss1 <<" -"<<(char)c;
       switch (c) {
       case 'h': usage();return 0; break;
       case 'v': version();return 0; break;
       case 'H': htsize=atoi(optarg); break;
-      case 'R': remove_trans = true; break;
+      case 'O': open_hashing = true; break;
+      case 'P': partition_spec = optarg; break;
+      case 'R': break; // transitions are always removed
       case 'V':
       case 'S': print_statistics = true; break;
       case 's': simple = true; break;
@@ -367,6 +463,9 @@ int main(int argc, char** argv)
       case 'f': fastApproximation = true; break;
       case 'c': show_ce = true; break;
       case 'L': perform_logging = true; break;
+      case 'k': checkpoint = true; break;
+      case 'u': resume = true; break;
+      case 'G': graph_file = optarg; break;
       case 'X': base_name_is_set = true; set_base_name = optarg; break;
       case 'r': produce_report=true; break;
       case 't': trail=true; break;
@@ -390,11 +489,17 @@ int main(int argc, char** argv)
   int filename_length = strlen(filename);
 
   if (filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0)
+    input_file_ext = ".bio";
+  else if (filename_length>=5 && strcmp(filename+filename_length-5,".cbio")==0)
+    input_file_ext = ".cbio"; //compiled model (see divine.compile_bio)
+  if (input_file_ext)
    {
     if (distributed.network_id==NETWORK_ID_MANAGER)
       cout << "Reading Affine System ..." << endl;
-    input_file_ext = ".bio";
-    sys = new affine_explicit_system_t(gerr);
+    if (graph_file.empty())
+      sys = new affine_explicit_system_t(gerr);
+    else //successors are read from the precomputed state graph
+      sys = new affine_graph_explicit_system_t(gerr, graph_file);
    }
   
   ce.set_system(sys);
@@ -422,7 +527,7 @@ int main(int argc, char** argv)
 
   file_name = argv[optind];
   int position = file_name.find(input_file_ext,0);
-  file_name.erase(position,4);
+  file_name.erase(position,strlen(input_file_ext));
   
   if (sys->get_with_property() && sys->get_property_type()!=BUCHI)
     {
@@ -448,12 +553,56 @@ int main(int argc, char** argv)
 	}
       st.set_ht_size(htsize);
     }
+  if (open_hashing)
+    {
+      if (checkpoint || resume)
+	{
+	  if (distributed.network_id==NETWORK_ID_MANAGER)
+	    {
+	      cerr<<"Checkpoints cannot be used with -O."<<endl;
+	    }
+	  distributed.finalize();
+	  return 1;
+	}
+      st.set_hashing_method(OPEN_ADDRESSING);
+    }
   
+  if (!partition_spec.empty())
+    {
+      try
+	{
+	  affine_explicit_system_t * p_affine_sys = dynamic_cast<affine_explicit_system_t *>(sys);
+	  if (!p_affine_sys)
+	    gerr << "Partition functions other than hash need an affine system" << thr();
+	  p_partitioner = new affine_partitioner_t(*p_affine_sys, partition_spec, distributed.cluster_size);
+	}
+      catch (ERR_throw_t & err)
+	{
+	  distributed.finalize();
+	  return err.id;
+	}
+      distributed.set_partitioner(p_partitioner);
+    }
+
   st.set_appendix(appendix);
   st.init();
   
   distributed.process_user_message = process_message;
   distributed.initialize();
+
+  string checkpoint_base = (base_name_is_set ? set_base_name : file_name);
+  if (resume)
+    {
+      try
+	{
+	  load_checkpoint(checkpoint_base);
+	}
+      catch (ERR_throw_t & err)
+	{
+	  distributed.finalize();
+	  return err.id;
+	}
+    }
   
   if (produce_report)
     {
@@ -485,6 +634,7 @@ int main(int argc, char** argv)
   state_ref_t ref;
   succ_container_t succs_cont(*sys);
   succ_container_t::iterator i;
+  bool again;
  
 
   // ========================================================
@@ -503,8 +653,11 @@ int main(int argc, char** argv)
 	  cout <<"======================================"<<endl;
 	}
 
+      DIVINE_PROFILE_BEGIN("Reachability");
       visited = 0;
       eliminated = 0;
+      if (!simple)
+	predecessors.reset();
 
       state = sys->get_initial_state();
       if (distributed.partition_function(state)==distributed.network_id)
@@ -516,7 +669,7 @@ int main(int argc, char** argv)
 	      appendix.visited = 0;
 	      if (!simple)
 		{
-		  appendix.predecessors = new array_t<net_state_ref_t>(1,1);
+		  appendix.id = predecessors.add_state(ref);
 		  if (sys->is_accepting(state))
 		    {
 		      appendix.is_accepting = true;
@@ -538,7 +691,7 @@ int main(int argc, char** argv)
 	      visited ++;
 	      if (!simple)
 		{
-		  appendix.predecessors->clear();
+		  predecessors.clear(appendix.id);
 		  if (appendix.is_accepting)
 		    {
 		      marking_queue.push(ref);
@@ -565,32 +718,30 @@ int main(int argc, char** argv)
 	      st.get_app_by_ref(ref,appendix);
 	      
 	      preds_calls++;
-	      array_t<net_state_ref_t>::iterator l_end = appendix.predecessors->end();
-	      for (array_t<net_state_ref_t>::iterator i = appendix.predecessors->begin();
-		   i != l_end; i++)
+	      predecessors_t::iterator l_end = predecessors.end(appendix.id);
+	      for (predecessors_t::iterator i = predecessors.begin(appendix.id);
+		   i != l_end; ++i)
 		{
-		  net_state_ref_t p = *i;
-		  if (p.network_id == distributed.network_id)
+		  predecessors_t::pred_t p = *i;
+		  if (int(p.network_id) == distributed.network_id)
 		    {
-		      static_cast<appendix_t*>(st.app_by_ref(p.state_ref))->remains--;
-		      if (static_cast<appendix_t*>(st.app_by_ref(p.state_ref))->remains==0)
+		      state_ref_t p_ref = predecessors.get_ref(p.id);
+		      static_cast<appendix_t*>(st.app_by_ref(p_ref))->remains--;
+		      if (static_cast<appendix_t*>(st.app_by_ref(p_ref))->remains==0)
 				{
-				  backtracking_queue.push(p.state_ref);
+				  backtracking_queue.push(p_ref);
 				}
 		    }	 
 		  else
 		    {
-		      distributed.network.send_message((char *)(&(p.state_ref)),sizeof(state_ref_t),
+		      distributed.network.send_message((char *)(&(p.id)),sizeof(predecessors_t::id_t),
 						  p.network_id,
 						  TAG_BACK_PROPAGATE);
 		    }
 		}
-	      if (remove_trans)
-		{
-		  delete appendix.predecessors;
-		  appendix.predecessors = 0;
-		  st.set_app_by_ref(ref,appendix);
-		}
+	      // the eliminated state is not needed by the marking, its
+	      // entries are reused by other states
+	      predecessors.remove(appendix.id);
 	    }
 	  
 	  if (!waiting_queue.empty())
@@ -600,6 +751,7 @@ int main(int argc, char** argv)
 	      state = st.reconstruct(ref);
 	      sys->get_succs(state,succs_cont);
 	      succs_calls++;
+	      predecessors_t::id_t ref_id = static_cast<appendix_t*>(st.app_by_ref(ref))->id;
 	      
 	      if (!simple)
 			{
@@ -629,20 +781,13 @@ int main(int argc, char** argv)
 						{
 						  transcross++;
 						}
-	                  message.rewind();
-	                  message.append_state(r);
-	                  message.append_state_ref(ref);
-				                  
-					  distributed.network.send_message(message,
-									  distributed.partition_function(r),
-									  TAG_SEND_STATE);
+					  distributed.network.send_state(r, (char *)&ref_id, sizeof(predecessors_t::id_t),
+									 distributed.partition_function(r),
+									 TAG_SEND_STATE);
 					}
 				  else
 					{
 					  state_ref_t r_ref;
-					  net_state_ref_t net_ref;
-					  net_ref.network_id = distributed.network_id;
-					  net_ref.state_ref = ref;
 					  
 		 			  if (!st.is_stored(r,r_ref))  //first visit in first iteration
 						{
@@ -651,7 +796,7 @@ int main(int argc, char** argv)
 						  appendix.visited = 0;
 						  if (!simple)
 							{
-							  appendix.predecessors = new array_t<net_state_ref_t>(1,1);
+							  appendix.id = predecessors.add_state(r_ref);
 							  if (sys->is_accepting(r))
 								{
 								  appendix.is_accepting = true;
@@ -676,8 +821,8 @@ int main(int argc, char** argv)
 						  visited ++;
 						  if (!simple)
 							{
-							  appendix.predecessors->clear();
-							  appendix.predecessors->push_back(net_ref);
+							  predecessors.clear(appendix.id);
+							  predecessors.push(appendix.id, ref_id, distributed.network_id);
 							  if (appendix.is_accepting)
 								{
 								  marking_queue.push(r_ref);
@@ -694,7 +839,7 @@ int main(int argc, char** argv)
 							{
 							  if (appendix.remains != 0) // => appendix.inset == iteration
 								{
-								  appendix.predecessors->push_back(net_ref);
+								  predecessors.push(appendix.id, ref_id, distributed.network_id);
 								  st.set_app_by_ref(r_ref,appendix);
 								}				
 							  else
@@ -724,6 +869,7 @@ int main(int argc, char** argv)
 		}
 	    }
 	}
+      DIVINE_PROFILE_END();
 
       if (distributed.network_id == 0 && print_statistics)
 	{
@@ -735,6 +881,10 @@ int main(int argc, char** argv)
 	  cout <<"time:              "<<timer.gettime()<<" s"<<endl;
 	}
 
+      DIVINE_PROFILE_BEGIN("Marking");
+      if (!simple)
+	predecessors.compact();
+
       marked = 0;
 
 //        cout <<"Local queue: "<<marking_queue.size()<<endl;
@@ -753,15 +903,16 @@ int main(int argc, char** argv)
 			}
 	      
 	      preds_calls++;
-	      array_t<net_state_ref_t>::iterator l_end = appendix.predecessors->end();
-	      for (array_t<net_state_ref_t>::iterator i = appendix.predecessors->begin();
-		   i != l_end; i++)
+	      predecessors_t::iterator l_end = predecessors.end(appendix.id);
+	      for (predecessors_t::iterator i = predecessors.begin(appendix.id);
+		   i != l_end; ++i)
 		{
-		  net_state_ref_t p = *i;
+		  predecessors_t::pred_t p = *i;
 		  
-		  if (p.network_id == distributed.network_id)
+		  if (int(p.network_id) == distributed.network_id)
 		    {
-		      st.get_app_by_ref(p.state_ref,appendix);
+		      state_ref_t p_ref = predecessors.get_ref(p.id);
+		      st.get_app_by_ref(p_ref,appendix);
 
 		      if (appendix.inset == iteration && appendix.remains >0)
 				{
@@ -769,18 +920,18 @@ int main(int argc, char** argv)
 				  delete_state(state);
 				  appendix.inset = iteration+1;
 				  marked ++;
-				  marking_queue.push(p.state_ref);		      
+				  marking_queue.push(p_ref);		      
 				}
 		      else
 				{
 	//  			  cout <<" NO"<<endl;
 				}
-		      st.set_app_by_ref(p.state_ref,appendix);
+		      st.set_app_by_ref(p_ref,appendix);
 		    }	 
 		  else
 		    {
 //  		      cout <<" - predecessor is remote"<<endl;
-		      distributed.network.send_message((char *)(&(p.state_ref)),sizeof(state_ref_t),
+		      distributed.network.send_message((char *)(&(p.id)),sizeof(predecessors_t::id_t),
 						  p.network_id,
 						  TAG_BACK_MARK);		  
 		    }
@@ -789,6 +940,7 @@ int main(int argc, char** argv)
 	  distributed.set_idle();
 	  distributed.process_messages();
 	}
+      DIVINE_PROFILE_END();
       
       if (distributed.network_id == 0 && print_statistics)
 	{
@@ -799,8 +951,12 @@ int main(int argc, char** argv)
 
       iteration ++;
 
-     } while (info.data.allmarked != (info.data.allstates-info.data.alleliminated) 
-	     && info.data.allmarked!=0 && !simple);  
+      again = (info.data.allmarked != (info.data.allstates-info.data.alleliminated) 
+	       && info.data.allmarked!=0 && !simple);
+      if (checkpoint && again)
+	save_checkpoint(checkpoint_base);
+
+     } while (again);  
       
   // ========================================================
   // ========================================================
@@ -846,6 +1002,7 @@ int main(int argc, char** argv)
   /* counterexample generation */
   if (info.data.allmarked !=0 && (trail || show_ce))
     {
+      DIVINE_PROFILE_BEGIN("Counterexample");
       state = sys->get_initial_state();
       if (distributed.partition_function(state) == distributed.network_id)
 	{
@@ -918,6 +1075,7 @@ int main(int argc, char** argv)
 	      distributed.process_messages();
 	    }
 	}
+      DIVINE_PROFILE_END();
     }
 
   if (!quiet && distributed.network_id==0)
@@ -931,7 +1089,10 @@ int main(int argc, char** argv)
       delete_state(state);
       if (htsize != 0)
 	cout <<"hashtable size     "<<htsize<<endl;
+      cout <<"partition function: "<<distributed.get_partitioner_name()<<endl;
       cout <<"cross transitions: "<<info.data.allcross<<endl;
+      if (info.data.alltrans)
+	cout <<"cross ratio:       "<<double(info.data.allcross)/info.data.alltrans<<endl;
       cout <<"all memory         "<<info.data.allmem/1024.0<<" MB"<<endl;
       cout <<"time:              "<<timer.gettime()<<" s"<<endl;
       cout <<"-------------------"<<endl;
@@ -1005,7 +1166,16 @@ int main(int argc, char** argv)
       reporter.set_info("States", st.get_states_stored());
       reporter.set_info("Trans", trans);
       reporter.set_info("CrossTrans", transcross);      
+      reporter.set_info("SyncRounds", distributed.get_all_sync_rounds_cnt());
+      reporter.set_info("SyncTime", distributed.get_all_sync_rounds_time());
       reporter.set_info("PredsCalls", preds_calls);
+      reporter.set_profile_info();
+      if (distributed.network_id==0)
+	{
+	  reporter.set_global_info("Partition", distributed.get_partitioner_name());
+	  if (info.data.alltrans)
+	    reporter.set_global_info("CrossRatio", double(info.data.allcross)/info.data.alltrans);
+	}
       if  ((distributed.network_id==0) && (!simple))
 	{
 	  if (info.data.allmarked !=0)
@@ -1027,8 +1197,15 @@ int main(int argc, char** argv)
       if (distributed.network_id==0)
 	rep_out.close();
     }
+
+#if defined(DIVINE_PROFILE)
+  profiler.write_trace_file(checkpoint_base, distributed.network_id);
+  if (distributed.network_id == 0 && !quiet)
+    profiler.write_summary(cout);
+#endif
   
   distributed.finalize();
+  delete p_partitioner;
   delete sys;
   return 0;
 }
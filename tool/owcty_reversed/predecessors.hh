@@ -0,0 +1,196 @@
+#ifndef _OWCTY_REVERSED_PREDECESSORS_HH_
+#define _OWCTY_REVERSED_PREDECESSORS_HH_
+
+#include <stdint.h>
+#include <vector>
+#include "divine.h"
+
+//!Store of reversed edges of owcty_reversed
+/*!Every state stored on the workstation gets a local 32-bit id (see
+ * add_state()), predecessors are then kept as pairs (id, workstation) and
+ * the ids are sent in messages instead of whole state references.
+ *
+ * The store has two modes:
+ *  - during the reachability (and the elimination running along with it)
+ *    predecessors are appended to lists threaded through chunks of entries,
+ *    entries of lists removed by remove() are reused,
+ *  - compact() then copies the lists to the compressed sparse row form
+ *    (one array of predecessors and offsets of states) for the marking
+ *    phase and frees the chunks. reset() returns to the first mode.
+ */
+class predecessors_t
+{
+public:
+  typedef uint32_t id_t;
+
+  struct pred_t
+  {
+    id_t id;
+    uint32_t network_id;
+  };
+
+  static const id_t NIL = ~id_t(0);
+
+  class iterator
+  {
+  public:
+    iterator(const predecessors_t * _owner, id_t _pos): owner(_owner), pos(_pos) {}
+    const pred_t & operator*() const
+    { return (owner->compacted ? owner->csr[pos] : owner->entry(pos).pred); }
+    const pred_t * operator->() const { return &**this; }
+    iterator & operator++()
+    {
+      pos = (owner->compacted ? pos + 1 : owner->entry(pos).next);
+      return *this;
+    }
+    bool operator!=(const iterator & _second) const { return pos != _second.pos; }
+  private:
+    const predecessors_t * owner;
+    id_t pos;
+  };
+
+  predecessors_t(): compacted(false), used(0), free_entry(NIL) {}
+  ~predecessors_t() { free_chunks(); }
+
+  //!Gives a new id to the state stored under _ref (with no predecessors)
+  id_t add_state(divine::state_ref_t _ref)
+  {
+    if (refs.size() == NIL)
+      divine::gerr << "Too many states for 32-bit ids of predecessors" << divine::thr();
+    refs.push_back(_ref);
+    head.push_back(id_t(NIL));
+    return refs.size() - 1;
+  }
+
+  //!Returns the reference of the state with the given id
+  divine::state_ref_t get_ref(id_t _state) const { return refs[_state]; }
+
+  //!Returns the references of all states indexed by their ids
+  const std::vector<divine::state_ref_t> & get_refs() const { return refs; }
+
+  //!Removes all predecessors of the state (the old ones of previous iteration)
+  void clear(id_t _state) { head[_state] = NIL; }
+
+  //!Appends the predecessor _pred of the state
+  void push(id_t _state, id_t _pred, uint32_t _network_id)
+  {
+    id_t e = new_entry();
+    entry_t & en = entry(e);
+    en.pred.id = _pred;
+    en.pred.network_id = _network_id;
+    en.next = head[_state];
+    head[_state] = e;
+  }
+
+  //!Frees the predecessors of the state for other states
+  void remove(id_t _state)
+  {
+    id_t e = head[_state];
+    if (e == NIL)
+      return;
+    id_t last = e;
+    while (entry(last).next != NIL)
+      last = entry(last).next;
+    entry(last).next = free_entry;
+    free_entry = e;
+    head[_state] = NIL;
+  }
+
+  iterator begin(id_t _state) const
+  { return iterator(this, compacted ? offset[_state] : head[_state]); }
+  iterator end(id_t _state) const
+  { return iterator(this, compacted ? offset[_state + 1] : NIL); }
+
+  //!Copies predecessors to the compressed sparse row form
+  void compact()
+  {
+    size_t edges = 0;
+    for (size_t s = 0; s < head.size(); s++)
+      for (id_t e = head[s]; e != NIL; e = entry(e).next)
+        edges++;
+    if (edges >= NIL)
+      divine::gerr << "Too many predecessors for 32-bit offsets" << divine::thr();
+
+    csr.resize(edges);
+    offset.resize(head.size() + 1);
+    id_t pos = 0;
+    for (size_t s = 0; s < head.size(); s++)
+      {
+        offset[s] = pos;
+        for (id_t e = head[s]; e != NIL; e = entry(e).next)
+          csr[pos++] = entry(e).pred;
+      }
+    offset[head.size()] = pos;
+
+    free_chunks();
+    std::vector<id_t>().swap(head);
+    compacted = true;
+  }
+
+  //!Drops all predecessors and returns to appending of lists
+  void reset()
+  {
+    std::vector<pred_t>().swap(csr);
+    std::vector<id_t>().swap(offset);
+    head.assign(refs.size(), id_t(NIL));
+    compacted = false;
+  }
+
+  //!Returns the number of bytes allocated by the store
+  size_t get_mem_used() const
+  {
+    return refs.capacity() * sizeof(divine::state_ref_t) + head.capacity() * sizeof(id_t) +
+      chunks.size() * CHUNK * sizeof(entry_t) + csr.capacity() * sizeof(pred_t) +
+      offset.capacity() * sizeof(id_t);
+  }
+
+private:
+  struct entry_t
+  {
+    pred_t pred;
+    id_t next;
+  };
+
+  static const size_t CHUNK_BITS = 16;
+  static const size_t CHUNK = size_t(1) << CHUNK_BITS;
+
+  entry_t & entry(id_t _e) { return chunks[_e >> CHUNK_BITS][_e & (CHUNK - 1)]; }
+  const entry_t & entry(id_t _e) const { return chunks[_e >> CHUNK_BITS][_e & (CHUNK - 1)]; }
+
+  id_t new_entry()
+  {
+    if (free_entry != NIL)
+      {
+        id_t e = free_entry;
+        free_entry = entry(e).next;
+        return e;
+      }
+    if (used == NIL)
+      divine::gerr << "Too many predecessors for 32-bit ids" << divine::thr();
+    if ((used >> CHUNK_BITS) == chunks.size())
+      chunks.push_back(new entry_t[CHUNK]);
+    return used++;
+  }
+
+  void free_chunks()
+  {
+    for (size_t i = 0; i < chunks.size(); i++)
+      delete [] chunks[i];
+    chunks.clear();
+    used = 0;
+    free_entry = NIL;
+  }
+
+  bool compacted;
+  std::vector<divine::state_ref_t> refs;
+  // lists: the first entry of every state, entries in chunks of CHUNK
+  std::vector<id_t> head;
+  std::vector<entry_t *> chunks;
+  id_t used;
+  id_t free_entry;
+  // compressed sparse row: predecessors of s are csr[offset[s]..offset[s+1])
+  std::vector<pred_t> csr;
+  std::vector<id_t> offset;
+};
+
+#endif
@@ -0,0 +1,117 @@
+ /* DiVinE - Distributed Verification Environment
+  *
+  * DiVinE (both programs and libraries included in the distribution) is free
+  * software; you can redistribute it and/or modify it under the terms of the
+  * GNU General Public License as published by the Free Software Foundation;
+  * either version 2 of the License, or (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program; if not, write to the Free Software
+  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+  * or see http://www.gnu.org/licenses/gpl.txt
+  */
+
+
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <cstring>
+
+#include "sevine.h"
+
+using namespace std;
+using namespace divine;
+
+void version()
+{
+  cout <<"compile_bio 1.0"<<endl;
+}
+
+void usage()
+{
+  cout <<"-----------------------------------------------------------------"<<endl;
+  cout <<"DiVinE Tool Set"<<endl;
+  cout <<"-----------------------------------------------------------------"<<endl;
+  version();
+  cout <<"-----------------------------------------------------------------"<<endl;
+  cout <<endl;
+  cout <<"Compile_bio parses a .bio file, computes its abstraction and writes"<<endl;
+  cout <<"it as a compiled model (.cbio). The tools accept the compiled model"<<endl;
+  cout <<"instead of the .bio file and skip parsing and abstraction."<<endl;
+  cout <<"The compiled model is valid only on machines of the same kind and"<<endl;
+  cout <<"for the same version of the tools."<<endl;
+  cout <<endl;
+  cout <<"Usage: compile_bio [switches] file.bio"<<endl;
+  cout <<"Switches:"<<endl;
+  cout <<" -h       show this help" <<endl;
+  cout <<" -v       show compile_bio version"<<endl;
+  cout <<" -f       faster but less accurate abstraction" <<endl;
+  cout <<" -o file  write the compiled model to file (default file.cbio)" <<endl;
+  return;
+}
+
+int main(int argc, char **argv)
+{
+  bool useFastAproximation = false;
+  string output;
+  int c;
+
+  static const option longopts[]={
+    {"version",0,0,'v'},
+    {NULL,0,0,0}
+  };
+
+  opterr = 0;
+  while ((c = getopt_long(argc, argv, "fho:v", longopts, NULL)) != -1) {
+    switch (c) {
+    case 'f': useFastAproximation = true; break;
+    case 'h': usage(); return 0;break;
+    case 'o': output = optarg; break;
+    case 'v': version();return 0;break;
+    case '?': cerr <<"skipping unknown switch -"<<(char)optopt<<endl;break;
+    }
+  }
+
+  if (argc<optind+1)
+    {
+      usage();
+      return 0;
+    }
+  char *filename = argv[optind];
+  int filename_length = strlen(filename);
+
+  if (!(filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0))
+    {
+      cerr << "File type not recognized. Supported extension is .bio" << endl;
+      return 1;
+    }
+  if (output.empty())
+    output = string(filename, filename_length-4) + ".cbio";
+
+  affine_system_t asys(gerr);
+  try
+    {
+      if (asys.read(filename,useFastAproximation))
+        {
+          cerr <<"Filename "<<filename<<" does not exist."<<endl;
+          return 1;
+        }
+    }
+  catch (ERR_throw_t & err)
+    {
+      return err.id;
+    }
+
+  if (!asys.write_compiled(output.c_str()))
+    {
+      cerr <<"Cannot write "<<output<<endl;
+      return 1;
+    }
+  cout <<"Compiled model written to "<<output<<endl;
+  return 0;
+}
@@ -4,6 +4,7 @@
 #include <cstring>
 #include "sevine.h"
 #include <queue>
+#include <string>
 
 using namespace std;
 using namespace divine;
@@ -22,14 +23,17 @@ int main(int argc, char** argv) {
        
   int verbose_level =0, states=0, transitions=0, counter=1;
   int hash_table = 65536;
+  string graph_file;
+  affine_graph_writer_t graph;
   bool quiet_and_quick = false;
   size_t deadlock_count = 0;
   size_t error_count = 0;
   explicit_storage_t st;
   
-  while ((c = getopt(argc, argv, "ahdqtv:sSH:C:gDE")) != -1) {
+  while ((c = getopt(argc, argv, "ab:hdqtv:sSH:C:gDE")) != -1) {
     switch (c) {
     case 'a': print_acc = true;break;
+    case 'b': graph_file = optarg;break;
     case 't': print_trans = true;break;
     case 'd': print_dot = true;break;
     case 's': print_states = true;break;
@@ -47,12 +51,14 @@ int main(int argc, char** argv) {
 
   if (print_help) {
     cout << "Usage:\n"
-"divine.generator [-ahdgqstSDE] [-v number] [-H size] input_file\n"
+"divine.generator [-ahdgqstSDE] [-v number] [-H size] [-b file] input_file\n"
 "\n"
 "Generates the entire state space and prints it in various formats.\n"
 "\n"
 "Options:\n"
 "-a print flags A/N telling whether a state is accepting or not after each state\n"
+"-b f write the state graph to the binary file f (explored by divine.owcty,\n"
+"     divine.distr_map and divine.owcty_reversed with -G f)\n"
 "-d   output in dot format\n"
 "-g   print graph\n"
 "-h   this help\n"
@@ -75,18 +81,19 @@ int main(int argc, char** argv) {
 
     try {
       //initialization
-      explicit_system_t * p_System;
+      affine_explicit_system_t * p_System;
       char * filename = argv[optind];
       int filename_length = strlen(filename);
-      if (filename_length>=2 && strcmp(filename+filename_length-2,".b")==0)
+      if ((filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0) ||
+          (filename_length>=5 && strcmp(filename+filename_length-5,".cbio")==0))
        {
-        cout << "Reading bytecode source..." << endl;
+        cout << "Reading bio source..." << endl;
         p_System = new affine_explicit_system_t(gerr);
        }
       else
        {
-        cout << "Reading DVE source..." << endl;
-        p_System = new dve_explicit_system_t(gerr);
+        cerr << "File type not recognized. Supported extensions are .bio and .cbio" << endl;
+        return 1;
        }
 
       int file_opening = p_System->read(filename);
@@ -109,8 +116,14 @@ int main(int argc, char** argv) {
 	st.set_compression_method(compression);
        }
 
-      if (!quiet_and_quick && (print_graph || print_dot))
+      //states are numbered from 1 in the order of insertion (the state graph
+      //numbers them from 0)
+      bool numbering = (!quiet_and_quick && (print_graph || print_dot)) ||
+                       !graph_file.empty();
+      if (numbering)
         st.set_appendix(counter);
+      if (!graph_file.empty())
+        graph.create(graph_file, *p_System);
         
       st.init();
     
@@ -124,10 +137,11 @@ int main(int argc, char** argv) {
       
       st.insert(init,pom);
       Wait.push(pom);
+      if (numbering) st.set_app_by_ref(pom,counter++);
+      if (!graph_file.empty()) graph.add_initial(graph.add_state(init));
       delete_state(init);
       
       if (!quiet_and_quick) {
-        if (print_graph || print_dot) st.set_app_by_ref(pom,counter++);
         if (print_dot) { cout <<"digraph G {"<<endl;}
       }
 
@@ -144,9 +158,10 @@ int main(int argc, char** argv) {
         else is_erroneous=false;
         is_deadlock=false;
         is_leading_to_error=false;
+        int return_value = SUCC_ERROR;
         
         if (!is_erroneous) {
-          int return_value=p_System->get_succs(q, succs);
+          return_value=p_System->get_succs(q, succs);
 	  if (succs_deadlock(return_value))
             { deadlock_count++; is_deadlock=true; }
           if (succs_error(return_value)) is_leading_to_error=true;
@@ -154,9 +169,16 @@ int main(int argc, char** argv) {
           if (quiet_and_quick) {
             for (succ_container_t::iterator i=succs.begin();i!=succs.end();++i){
               state_t & r=*i;
-              if (! st.is_stored(r)) {
+              if (! st.is_stored(r,pom)) {
                 st.insert(r,pom);  //stiring a state to queue and "visited" set
                 Wait.push(pom);
+                if (numbering) st.set_app_by_ref(pom,counter++);
+                if (!graph_file.empty()) graph.add_state(r);
+              }
+              if (!graph_file.empty()) {
+                int x;
+                st.get_app_by_ref(pom,x);
+                graph.add_succ(x-1);
               }
 	      delete_state(r); //deleting a copy of (potent.) inserted state
             }
@@ -184,10 +206,16 @@ int main(int argc, char** argv) {
             }
             for (succ_container_t::iterator i=succs.begin();i!=succs.end();++i){
               state_t & r=*i;
-              if (! st.is_stored(r)) {
+              if (! st.is_stored(r,pom)) {
                 st.insert(r,pom);
                 Wait.push(pom);
-                if (print_dot || print_graph) st.set_app_by_ref(pom,counter++);
+                if (numbering) st.set_app_by_ref(pom,counter++);
+                if (!graph_file.empty()) graph.add_state(r);
+              }
+              if (!graph_file.empty()) {
+                int x;
+                st.get_app_by_ref(pom,x);
+                graph.add_succ(x-1);
               }
               if (print_dot) {
                 cout << "\"";
@@ -205,7 +233,6 @@ int main(int argc, char** argv) {
 	        p_System->print_state(r,cout);	    
 	        cout <<endl;
 	      } else if (print_graph) {
-	        st.is_stored(r,pom);
 	        int x;
 	        st.get_app_by_ref(pom,x);
 	        cout << " "<<x;
@@ -219,28 +246,30 @@ int main(int argc, char** argv) {
         }
         else error_count++;
 
+        if (!graph_file.empty())
+          graph.close_state(p_System->is_accepting(q), return_value);
         delete_state(q);  //deleting a copy reconstructed state
       } //end of the main BFS loop
       
+      if (!graph_file.empty()) {
+        graph.commit();
+        cout << "State graph written to " << graph_file << endl;
+      }
       if (!quiet_and_quick && print_dot) cout << "}"<<endl;
       if (!quiet_and_quick)
         cerr << "                                                          "
                 "     "<<endl;
       if (print_statistics) {
-        dve_explicit_system_t * p_dve_system;
-
 	cout << "Statistics:\nStates\t\t\t\t"<<st.get_states_stored()<<"\nTransitions\t\t\t"<<transitions<<endl;
         cout << "Deadlock states:\t\t"<< deadlock_count << endl;
         cout << "Erroneous states:\t\t"<< error_count << endl;
 	cout << "Max. memory for states set:\t"<< float(st.get_mem_max_used())/1024 << " MB" <<endl;
 // 	cout << "Actually used virtual memory:\t"<< get_consumed_memory() << " MB" <<endl;
-	if ((p_dve_system = dynamic_cast<dve_explicit_system_t*>(p_System)))
-          cout << "Size of state:\t\t\t"<< p_dve_system->get_space_sum() <<endl;
+        cout << "Size of state:\t\t\t"<< p_System->get_state_size() <<endl;
 	cout << "Size of hash table:\t\t"<< hash_table <<endl;
 	cout << "Max. collision table:\t\t"<< st.get_max_coltable()<<endl;
 	cout << "Average collision table:\t"<< (double) states/hash_table <<endl;
-	if ((p_dve_system = dynamic_cast<dve_explicit_system_t*>(p_System)))
-	  cout << "Storage efficiency:\t\t" << (double) (st.get_mem_max_used() - (p_dve_system->get_space_sum() *states))/st.get_mem_max_used()<<endl;
+	cout << "Storage efficiency:\t\t" << (double) (st.get_mem_max_used() - (p_System->get_state_size() *states))/st.get_mem_max_used()<<endl;
       } 
 
     } catch  (ERR_throw_t & err_type)
@@ -105,9 +105,9 @@ void usage()
   version();
   cout <<"-----------------------------------------------------------------"<<endl;
   cout <<endl;
-  cout <<"Predot transforms a .bio file to format readable by 'dot'."<<endl;
+  cout <<"Predot transforms a .bio file (or a compiled .cbio) to format readable by 'dot'."<<endl;
   cout <<endl;
-  cout <<"Usage: predot [switches] file.bio"<<endl;
+  cout <<"Usage: predot [switches] file.bio|file.cbio"<<endl;
   cout <<"Switches:"<<endl;
   cout <<" -h    show this help" <<endl;
   cout <<" -v    show predot version"<<endl;
@@ -158,7 +158,8 @@ int main(int argc, char **argv)
   int file_opening=0;
 
 
-  if (filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0)
+  if ((filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0) ||
+      (filename_length>=5 && strcmp(filename+filename_length-5,".cbio")==0))
     {
       file_opening = asys.read(argv[optind],useFastAproximation);
       recognized = true;
@@ -167,7 +168,7 @@ int main(int argc, char **argv)
 
   if (!recognized)
     {
-      cerr << "File type not recognized. Supported extensions are .dve, and .probdve" << endl;
+      cerr << "File type not recognized. Supported extensions are .bio and .cbio" << endl;
       return 1;
     }
 
@@ -0,0 +1,241 @@
+ /* DiVinE - Distributed Verification Environment
+  * Copyright (C) 2002-2007  Pavel Simecek, Jiri Barnat, Pavel Moravec,
+  *     Radek Pelanek, Jakub Chaloupka, David Safranek, Faculty of Informatics Masaryk
+  *     University Brno
+  *
+  * DiVinE (both programs and libraries included in the distribution) is free
+  * software; you can redistribute it and/or modify it under the terms of the
+  * GNU General Public License as published by the Free Software Foundation;
+  * either version 2 of the License, or (at your option) any later version.
+  *
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+  *
+  * You should have received a copy of the GNU General Public License
+  * along with this program; if not, write to the Free Software
+  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+  * or see http://www.gnu.org/licenses/gpl.txt
+  */
+
+
+#include <getopt.h>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+#include "sevine.h"
+
+using namespace std;
+using namespace divine;
+
+affine_explicit_system_t asys(gerr);
+
+struct method_t {
+  const char * name;
+  size_t id;
+};
+
+const method_t methods[] = {
+  { "none", NO_COMPRESS },
+  { "huffman", HUFFMAN_COMPRESS },
+  { "radix", RADIX_COMPRESS }
+};
+
+void version()
+{
+  cout <<"Storage benchmark 1.0"<<endl;
+}
+
+void usage()
+{
+  cout <<"-----------------------------------------------------------------"<<endl;
+  cout <<"DiVinE Tool Set"<<endl;
+  cout <<"-----------------------------------------------------------------"<<endl;
+  version();
+  cout <<"-----------------------------------------------------------------"<<endl;
+  cout <<endl;
+  cout <<"Storage_bench generates states of a .bio file (or a compiled .cbio) and stores them"<<endl;
+  cout <<"with every compression method of explicit_storage_t."<<endl;
+  cout <<endl;
+  cout <<"Usage: storage_bench [switches] file.bio|file.cbio"<<endl;
+  cout <<"Switches:"<<endl;
+  cout <<" -h    show this help" <<endl;
+  cout <<" -v    show storage_bench version"<<endl;
+  cout <<" -f    faster but less accurate abstraction" <<endl;
+  cout <<" -n x  use at most x states (0 = all reachable states, default)" <<endl;
+  cout <<" -O    use open addressing hash table" <<endl;
+  cout <<" -r x  repeat the measurement x times and take the fastest (default 3)" <<endl;
+  return;
+}
+
+// breadth-first search from the initial state, at most _limit states
+void generate(size_t _limit, vector<state_t> & _states)
+{
+  explicit_storage_t seen;
+  seen.init();
+
+  succ_container_t succs(asys);
+  state_t state = asys.get_initial_state();
+  seen.insert(state);
+  _states.push_back(state);
+
+  for (size_t i = 0; i < _states.size(); i++)
+    {
+      asys.get_succs(_states[i], succs);
+      for (size_t j = 0; j < succs.size(); j++)
+        {
+          if ((_limit == 0 || _states.size() < _limit) && !seen.is_stored(succs[j]))
+            {
+              seen.insert(succs[j]);
+              _states.push_back(succs[j]);
+            }
+          else
+            delete_state(succs[j]);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+  bool useFastAproximation = false;
+  bool open_hashing = false;
+  size_t limit = 0;
+  int repeat = 3;
+  int c;
+
+  static const option longopts[]={
+    {"version",0,0,'v'},
+    {NULL,0,0,0}
+  };
+
+  opterr = 0;
+  while ((c = getopt_long(argc, argv, "hvfn:Or:", longopts, NULL)) != -1) {
+    switch (c) {
+    case 'h': usage(); return 0;break;
+    case 'v': version();return 0;break;
+    case 'f': useFastAproximation = true; break;
+    case 'n': limit = atoi(optarg); break;
+    case 'O': open_hashing = true; break;
+    case 'r': repeat = atoi(optarg); break;
+    case '?': cerr <<"skipping unknown switch -"<<(char)optopt<<endl;break;
+    }
+  }
+
+  if (argc<optind+1)
+    {
+      usage();
+      return 0;
+    }
+  if (repeat < 1)
+    repeat = 1;
+
+  char *filename = argv[optind];
+  int filename_length = strlen(filename);
+  if (!(filename_length>=4 && strcmp(filename+filename_length-4,".bio")==0) &&
+      !(filename_length>=5 && strcmp(filename+filename_length-5,".cbio")==0))
+    {
+      cerr << "File type not recognized. Supported extensions are .bio and .cbio" << endl;
+      return 1;
+    }
+
+  if (asys.read(argv[optind],useFastAproximation))
+    {
+      cerr <<"Filename "<<argv[optind]<<" does not exist."<<endl;
+      return 1;
+    }
+
+  vector<state_t> states;
+  generate(limit, states);
+  const vector<size_t> & fields = asys.state_layout.get_max_values();
+
+  // a hash table of roughly the number of states, the storages are not
+  // deallocated (the hash table of explicit_storage_t is never freed)
+  size_t ht_size = 1024;
+  while (ht_size < states.size())
+    ht_size *= 2;
+
+  cout <<"states:\t\t"<<states.size()<<endl;
+  cout <<"size of a state:\t"<<asys.get_state_size()<<" B ("<<fields.size()<<" fields)"<<endl;
+  cout <<endl;
+  cout <<left<<setw(10)<<"method"
+       <<right<<setw(12)<<"B/state"
+       <<setw(14)<<"storage B/st"
+       <<setw(16)<<"insert st/s"
+       <<setw(16)<<"reconstr st/s"<<endl;
+
+  for (size_t m = 0; m < sizeof(methods)/sizeof(methods[0]); m++)
+    {
+      // the size of compressed states alone
+      compressor_t compressor;
+      compressor.clear();
+      compressor.set_fields(fields);
+      compressor.init(methods[m].id, 0);
+      size_t bytes = 0;
+      for (size_t i = 0; i < states.size(); i++)
+        {
+          char * cstate;
+          int csize;
+          compressor.compress(states[i], cstate, csize);
+          bytes += csize;
+          delete [] cstate;
+        }
+
+      double insert_time = 0, reconstruct_time = 0;
+      size_t mem_used = 0;
+      for (int k = 0; k < repeat; k++)
+        {
+          explicit_storage_t st;
+          st.set_ht_size(ht_size);
+          if (open_hashing)
+            st.set_hashing_method(OPEN_ADDRESSING);
+          st.set_compression_method(methods[m].id);
+          st.set_compression_fields(fields);
+          st.init();
+
+          vector<state_ref_t> refs(states.size());
+          timeinfo_t timer;
+          for (size_t i = 0; i < states.size(); i++)
+            st.insert(states[i], refs[i]);
+          double t = timer.gettime();
+          if (k == 0 || t < insert_time)
+            insert_time = t;
+          mem_used = st.get_mem_used();
+
+          timer.reset();
+          size_t wrong = 0;
+          for (size_t i = 0; i < states.size(); i++)
+            {
+              state_t s = st.reconstruct(refs[i]);
+              if (s.size != states[i].size || memcmp(s.ptr, states[i].ptr, s.size))
+                wrong++;
+              delete_state(s);
+            }
+          t = timer.gettime();
+          if (k == 0 || t < reconstruct_time)
+            reconstruct_time = t;
+
+          if (wrong)
+            {
+              cerr <<methods[m].name<<": "<<wrong<<" states reconstructed incorrectly"<<endl;
+              return 1;
+            }
+          st.delete_all_states();
+        }
+      compressor.clear();
+
+      cout <<left<<setw(10)<<methods[m].name<<right<<fixed
+           <<setw(12)<<setprecision(2)<<double(bytes)/states.size()
+           <<setw(14)<<setprecision(2)<<double(mem_used)/states.size()
+           <<setw(16)<<setprecision(0)<<states.size()/max(insert_time, 1e-6)
+           <<setw(16)<<setprecision(0)<<states.size()/max(reconstruct_time, 1e-6)
+           <<endl;
+    }
+
+  for (size_t i = 0; i < states.size(); i++)
+    delete_state(states[i]);
+  return 0;
+}